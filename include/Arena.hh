@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+/**
+ * @class Arena
+ * @brief A bump allocator that owns the text of one query's result rows.
+ *
+ * Strings are copied back to back into large blocks, so a page of results costs a
+ * handful of allocations instead of one per column. Blocks never move once allocated,
+ * which keeps every `std::string_view` handed out valid until the arena is destroyed,
+ * even if the arena itself is moved.
+ */
+class Arena
+{
+public:
+
+  /**
+   * @brief Constructs an empty arena.
+   *
+   * @param block_size The size of each block; strings over a quarter of this get a block of their own.
+   */
+  explicit Arena(size_t block_size = 16 * 1024);
+
+  /**
+   * @brief Takes over another arena's blocks, leaving it empty.
+   */
+  Arena(Arena&& other) noexcept;
+
+  /**
+   * @brief Frees this arena's blocks and takes over another's, leaving it empty.
+   */
+  Arena& operator=(Arena&& other) noexcept;
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  /**
+   * @brief Copies a string into the arena.
+   *
+   * @param data The bytes to copy; may be `nullptr` when `size` is 0.
+   * @param size The number of bytes to copy.
+   * @return A view of the copy, valid for the lifetime of the arena.
+   */
+  std::string_view copy(const char* data, size_t size);
+
+  /**
+   * @brief Returns the number of bytes handed out so far.
+   */
+  size_t bytesUsed() const { return _used; }
+
+private:
+  std::vector<std::unique_ptr<char[]>> _blocks;
+  size_t _block_size;
+  char* _cursor;
+  size_t _remaining;
+  size_t _used;
+};
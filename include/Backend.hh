@@ -0,0 +1,380 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "Clock.hh"
+#include "Deadline.hh"
+#include "Pond.hh"
+
+/**
+ * @class RowStream
+ * @brief The rows of one backend read, pulled a batch at a time.
+ *
+ * A stream holds whatever the read needs between batches, such as an open statement,
+ * and releases it once every row has been read or the stream is destroyed. Streams must
+ * not outlive their backend.
+ */
+template <typename Container>
+class RowStream
+{
+public:
+  virtual ~RowStream() = default;
+
+  /**
+   * @brief Appends up to `n` more rows to `out`.
+   *
+   * @return false if the backend failed; the stream is then done.
+   */
+  virtual bool next(size_t n, Container& out) = 0;
+
+  /**
+   * @brief Returns true once there are no more rows to read.
+   */
+  virtual bool done() const = 0;
+};
+
+/**
+ * @class Backend
+ * @brief The storage operations Pond is built on.
+ *
+ * Pond keeps the application logic (hashtag validation, ID allocation, feed formatting,
+ * recording) and delegates every read and write of users, follows, quacks, requacks,
+ * hashtags and lists to a backend. `SqliteBackend` stores them in a Quacker database
+ * file; `MemoryBackend` keeps them in hash maps and sorted vectors.
+ *
+ * Writes return true if the row was stored. Reads append to the `out` parameter and
+ * return false only if the backend failed, not when there are no rows.
+ */
+class Backend
+{
+public:
+
+  /**
+   * @brief One row of a user's feed: a followee's quack or a followee's requack.
+   */
+  struct FeedEntry {
+    int32_t tid;
+    std::string name;   // the followee who quacked or requacked
+    std::string date;   // quack date, or requack date for requacks
+    std::string time;
+    std::string text;
+    int64_t ts;         // quack ts, or requack ts for requacks
+  };
+
+  /**
+   * @brief One requack to upsert: a new one is stored with `spam`, a repeat is marked 1.
+   */
+  struct RequackWrite {
+    int32_t tid;
+    int32_t retweeter_id;
+    int32_t spam;  // 0, 2 for a user writing too fast, or 4 for a near copy of one already requacked
+  };
+
+  virtual ~Backend() = default;
+
+  /**
+   * @brief Bounds the reads that follow by `deadline`, until it is set back to nullptr.
+   *
+   * A read that outlives the deadline stops early, keeps the rows it has appended and
+   * returns false, and `interrupted` reports true until the deadline is set again.
+   * Streams are not bounded.
+   */
+  virtual void setDeadline(const Deadline* deadline) {
+    this->_deadline = deadline;
+    this->_interrupted = false;
+  }
+
+  /**
+   * @brief Returns true if a read was cut short since the deadline was last set.
+   */
+  bool interrupted() const { return this->_interrupted; }
+
+  // Users
+  virtual bool insertUser(int32_t usr, const std::string& name, const std::string& email,
+                          int64_t phone, const std::string& pwd) = 0;
+  virtual std::optional<int32_t> maxUserID() = 0;
+  virtual std::optional<int32_t> checkLogin(int32_t usr, const std::string& pwd) = 0;
+  virtual bool searchUsers(const std::string& search_terms, std::vector<Pond::User>& out) = 0;
+
+  /**
+   * @brief Opens a stream over the users `searchUsers` would append, in the same order.
+   *
+   * @return The stream, or nullptr if the backend failed.
+   */
+  virtual std::unique_ptr<RowStream<std::vector<Pond::User>>> streamUsers(const std::string& search_terms) = 0;
+
+  /**
+   * @brief Counts the users `searchUsers` would append, without reading them.
+   */
+  virtual std::optional<int64_t> countUsers(const std::string& search_terms) = 0;
+
+  virtual std::optional<std::string> username(int32_t usr) = 0;
+
+  /**
+   * @brief Appends the users with the given IDs, in the order given, skipping IDs with
+   *        no user.
+   */
+  virtual bool usersByID(const std::vector<int32_t>& usrs, std::vector<Pond::User>& out) = 0;
+
+  /**
+   * @brief Appends every user with an ID at or above `first_usr`, in ascending ID order,
+   *        for filling the username completions.
+   */
+  virtual bool usersFrom(int32_t first_usr, std::vector<Pond::User>& out) = 0;
+
+  // Follows
+  virtual bool insertFollow(int32_t flwer, int32_t flwee, const char* start_date) = 0;
+  virtual bool deleteFollow(int32_t flwer, int32_t flwee) = 0;
+
+  /**
+   * @brief Appends every `(flwer, flwee)` pair, for building a `FollowGraph`.
+   */
+  virtual bool followEdges(std::vector<std::pair<int32_t, int32_t>>& out) = 0;
+
+  /**
+   * @brief Returns a counter that goes up by one with every follow added or removed,
+   *        through any connection to the same store.
+   */
+  virtual std::optional<int64_t> followsVersion() = 0;
+
+  // Quacks
+
+  /**
+   * @brief Stores a quack along with the SimHash fingerprint of its text.
+   */
+  virtual bool insertQuack(int32_t tid, int32_t writer_id, const std::string& text, uint64_t simhash,
+                           const Clock::Stamp& now, std::optional<int32_t> replyto_tid) = 0;
+  virtual std::optional<int32_t> maxQuackID() = 0;
+  virtual bool quackByID(int32_t tid, Pond::QuackResults& out) = 0;
+
+  /**
+   * @brief Appends the quacks with the given IDs, most recent first, skipping IDs with
+   *        no quack.
+   */
+  virtual bool quacksByID(const std::vector<int32_t>& tids, Pond::QuackResults& out) = 0;
+
+  /**
+   * @brief Appends up to `limit` quacks with an ID at or above `first_tid`, in ascending
+   *        ID order, for filling the search index in batches.
+   */
+  virtual bool quacksFrom(int32_t first_tid, size_t limit, Pond::QuackResults& out) = 0;
+
+  /**
+   * @brief Appends `(tid, fingerprint)` for up to `limit` quacks with an ID at or above
+   *        `first_tid`, in ascending ID order, for filling the near-duplicate index.
+   */
+  virtual bool simhashesFrom(int32_t first_tid, size_t limit, std::vector<std::pair<int32_t, uint64_t>>& out) = 0;
+
+  virtual bool quacksByWriter(int32_t writer_id, Pond::QuackResults& out) = 0;
+  virtual bool replies(int32_t tid, std::vector<int32_t>& out) = 0;
+
+  /**
+   * @brief Appends up to `limit` quacks of the conversation under `root_tid`, in display
+   *        order, and the depth of each below the root to `depths`.
+   *
+   * The root comes first, and every reply follows its parent and that parent's earlier
+   * replies' subtrees, replies to one quack in ID order. Replies more than `max_depth`
+   * below the root are left out. Nothing is appended if the root does not exist.
+   */
+  virtual bool thread(int32_t root_tid, int32_t max_depth, size_t limit, Pond::QuackResults& out,
+                      std::vector<int32_t>& depths) = 0;
+
+  /**
+   * @brief Appends the quacks and non-spam requacks of the given users, most recent first.
+   *
+   * If reading stops early, e.g. at the deadline, the entries appended are still the
+   * most recent ones, in order.
+   *
+   * @param followees The IDs of the users whose activity makes up the feed.
+   */
+  virtual bool feed(const std::vector<int32_t>& followees, std::vector<FeedEntry>& out) = 0;
+
+  /**
+   * @brief Appends quacks with a hashtag matching `pattern` (a case-insensitive LIKE
+   *        pattern), most recent first, skipping those in `seen`.
+   *
+   * A pattern without `%` or `_` names one hashtag and is looked up exactly.
+   */
+  virtual bool searchQuacksByHashtag(const std::string& pattern, Pond::QuackResults& out,
+                                     const std::unordered_set<int32_t>& seen) = 0;
+
+  /**
+   * @brief Appends quacks containing `keyword` or `#keyword` as a whole word
+   *        (case-insensitively), most recent first, skipping and then adding to `seen`.
+   */
+  virtual bool searchQuacksByWord(const std::string& keyword, Pond::QuackResults& out,
+                                  std::unordered_set<int32_t>& seen) = 0;
+
+  /**
+   * @brief Opens a stream over the quacks `searchQuacksByHashtag` would append given an
+   *        empty `seen`, in the same order.
+   *
+   * @return The stream, or nullptr if the backend failed.
+   */
+  virtual std::unique_ptr<RowStream<Pond::QuackResults>> streamQuacksByHashtag(const std::string& pattern) = 0;
+
+  /**
+   * @brief Opens a stream over the quacks `searchQuacksByWord` would append given an
+   *        empty `seen`, in the same order.
+   *
+   * @return The stream, or nullptr if the backend failed.
+   */
+  virtual std::unique_ptr<RowStream<Pond::QuackResults>> streamQuacksByWord(const std::string& keyword) = 0;
+
+  /**
+   * @brief Counts the rows `streamQuacksByHashtag` would yield, without reading them.
+   */
+  virtual std::optional<int64_t> countQuacksByHashtag(const std::string& pattern) = 0;
+
+  /**
+   * @brief Counts the rows `streamQuacksByWord` would yield, without reading them.
+   */
+  virtual std::optional<int64_t> countQuacksByWord(const std::string& keyword) = 0;
+
+  /**
+   * @brief Appends a `(ts, term)` pair for every hashtag of every quack posted at or
+   *        after `since`, oldest first, for seeding the trending counters.
+   */
+  virtual bool hashtagMentionsSince(int64_t since, std::vector<std::pair<int64_t, std::string>>& out) = 0;
+
+  /**
+   * @brief Appends a `(tid, term)` pair for every hashtag linked to a quack ID at or above
+   *        `first_tid`, in ascending ID order, for filling the hashtag index.
+   */
+  virtual bool hashtagMentionsFrom(int32_t first_tid, std::vector<std::pair<int32_t, std::string>>& out) = 0;
+
+  /**
+   * @brief Appends the lower-cased hashtags linked to one quack.
+   */
+  virtual bool hashtagsOf(int32_t tid, std::vector<std::string>& out) = 0;
+
+  // Hashtag rollups: mentions per lower-cased hashtag per hour, counted from the Unix
+  // epoch, kept up to date as quacks and hashtags are inserted
+
+  /**
+   * @brief Appends `(hour, mentions)` for each hour in `[from_hour, to_hour)` in which
+   *        `term` (in any case) was mentioned, oldest first.
+   */
+  virtual bool hashtagHours(const std::string& term, int64_t from_hour, int64_t to_hour,
+                            std::vector<std::pair<int64_t, int64_t>>& out) = 0;
+
+  /**
+   * @brief Appends the `limit` hashtags mentioned most over `[from_hour, to_hour)` with
+   *        their mentions, most first, then alphabetically.
+   */
+  virtual bool topHashtagsBetween(int64_t from_hour, int64_t to_hour, size_t limit,
+                                  std::vector<std::pair<std::string, int64_t>>& out) = 0;
+
+  /**
+   * @brief Recomputes every rollup from the stored quacks and hashtags.
+   */
+  virtual bool rebuildHashtagRollups() = 0;
+
+  // Requacks
+
+  /**
+   * @brief Records a requack of `tid` by `retweeter_id`, or marks an existing one as spam,
+   *        in a single write that takes the writer from the quack.
+   *
+   * The `spam` column says why a requack is hidden from feeds: 0 for not spam, 1 for a
+   * repeat of the same quack, 2 for a user requacking faster than a person would, 4 for
+   * a near copy of a quack the user already requacked. 3 is never stored, as the flag is
+   * also addRequack's status, where 3 is an error.
+   *
+   * @param spam The flag a new requack is stored with, 0, 2 or 4; a repeat is set to 1.
+   * @return The requack's spam flag after the write, so 1 for a repeat; -1 if the quack
+   *         does not exist; std::nullopt on failure.
+   */
+  virtual std::optional<int32_t> upsertRequack(int32_t tid, int32_t retweeter_id, int32_t spam,
+                                               const Clock::Stamp& now) = 0;
+
+  /**
+   * @brief Applies upsertRequack to each requack in order, all or none.
+   *
+   * @param out Receives one result per requack, as upsertRequack returns them; a requack
+   *        repeated within the batch is a repeat the second time.
+   */
+  virtual bool upsertRequacks(const std::vector<RequackWrite>& requacks, const Clock::Stamp& now,
+                              std::vector<int32_t>& out) = 0;
+  virtual std::optional<int32_t> requackCount(int32_t tid) = 0;
+
+  /**
+   * @brief Returns true if `retweeter_id` has requacked any of `tids`.
+   */
+  virtual std::optional<bool> requackedAny(int32_t retweeter_id, const std::vector<int32_t>& tids) = 0;
+
+  /**
+   * @brief Links a hashtag to a quack unless it already has that hashtag in any case.
+   *
+   * @return true if a new link was stored, false if the quack already had the hashtag,
+   *         or nullopt if the backend failed.
+   */
+  virtual std::optional<bool> insertHashtag(int32_t tid, const std::string& term) = 0;
+
+  // Lists
+  virtual bool insertList(int32_t owner_id, const std::string& lname) = 0;
+  virtual bool insertListEntry(int32_t owner_id, const std::string& lname, int32_t tid) = 0;
+  virtual bool listExists(int32_t owner_id, const std::string& lname) = 0;
+
+  /**
+   * @brief Appends the owner's lists by name, each with its number of quacks.
+   */
+  virtual bool lists(int32_t owner_id, std::vector<Pond::ListSummary>& out) = 0;
+
+  /**
+   * @brief Appends up to `limit` quacks of a list, most recent first, starting after
+   *        `after` if set.
+   *
+   * Pages are read by seeking to the cursor, so every page costs the same however far
+   * into the list it is.
+   */
+  virtual bool listQuacks(int32_t owner_id, const std::string& lname, const std::optional<Pond::ListCursor>& after,
+                          size_t limit, Pond::QuackResults& out) = 0;
+
+  // Ranks
+
+  /**
+   * @brief Appends every stored `(usr, score)` influence score; `searchUsers` lists
+   *        users with higher scores first.
+   */
+  virtual bool userRanks(std::vector<std::pair<int32_t, double>>& out) = 0;
+
+  /**
+   * @brief Replaces every stored influence score with `ranks`, skipping IDs with no user.
+   */
+  virtual bool replaceUserRanks(const std::vector<std::pair<int32_t, double>>& ranks) = 0;
+
+  /**
+   * @brief Writes a consistent copy of everything stored to `filename`, replacing it.
+   */
+  virtual bool snapshot(const std::string& filename) = 0;
+
+  /**
+   * @brief Describes the most recent failure, for error messages.
+   */
+  virtual std::string lastError() const = 0;
+
+protected:
+
+  /**
+   * @brief Returns true, and marks the read as interrupted, once the deadline has
+   *        expired or been cancelled.
+   */
+  bool _deadlinePassed() const {
+    if (!this->_interrupted && this->_deadline && this->_deadline->expired()) {
+      this->_interrupted = true;
+    }
+    return this->_interrupted;
+  }
+
+private:
+  const Deadline* _deadline = nullptr;
+  mutable bool _interrupted = false;
+};
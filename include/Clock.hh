@@ -0,0 +1,47 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+
+/**
+ * @class Clock
+ * @brief Allocation-free source of the timestamps Pond writes with every quack, reply,
+ *        requack and follow.
+ *
+ * The formatted GMT date and time strings are cached per thread and only re-rendered
+ * (with the thread-safe `gmtime_r`) when the wall-clock second changes, so taking a
+ * timestamp is a clock read and two small copies.
+ */
+class Clock
+{
+public:
+
+  /**
+   * @brief A snapshot of the current time in every form Pond stores.
+   *
+   * The strings live inside the struct, so they stay valid for as long as the stamp
+   * itself and can be bound to statements with `SQLITE_STATIC`.
+   */
+  struct Stamp {
+    char date[11];  // YYYY-MM-DD (GMT)
+    char time[9];   // HH:MM:SS (GMT)
+    int64_t ts;     // microseconds since the Unix epoch
+  };
+
+  /**
+   * @brief Takes a timestamp without touching the heap.
+   *
+   * `ts` is strictly increasing across all threads of the process, even if the wall
+   * clock steps backwards or two calls land in the same microsecond, so it can be used
+   * directly for ordering.
+   *
+   * @return The current time as a `Stamp`.
+   */
+  static Stamp now();
+
+private:
+  static std::atomic<int64_t> _last_ts;
+};
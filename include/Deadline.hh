@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+/**
+ * @class Deadline
+ * @brief A time limit for a Pond call, which can also be cancelled early from another
+ *        thread.
+ *
+ * Reads made under a deadline check it as they go and stop once it has expired or been
+ * cancelled, keeping the rows found so far. A deadline is only read while a call runs,
+ * so one can bound several calls in turn.
+ */
+class Deadline
+{
+public:
+
+  /**
+   * @brief A deadline that never expires on its own, only when cancelled.
+   */
+  Deadline();
+
+  /**
+   * @brief A deadline that expires `budget` from now.
+   */
+  explicit Deadline(std::chrono::microseconds budget);
+
+  Deadline(const Deadline&) = delete;
+  Deadline& operator=(const Deadline&) = delete;
+
+  /**
+   * @brief Expires the deadline now; safe to call from any thread.
+   */
+  void cancel();
+
+  /**
+   * @brief Returns true once the time is up or the deadline was cancelled.
+   */
+  bool expired() const;
+
+  /**
+   * @brief Returns the time left, zero once expired, or -1 for a deadline without a
+   *        time limit that has not been cancelled.
+   */
+  std::chrono::microseconds remaining() const;
+
+private:
+  std::chrono::steady_clock::time_point _at;  // time_point::max() for no time limit
+  std::atomic<bool> _cancelled{false};
+};
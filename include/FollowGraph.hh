@@ -0,0 +1,224 @@
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class ThreadPool;
+
+/**
+ * @class FollowGraph
+ * @brief An in-process index of who follows whom, kept in compressed sparse row form.
+ *
+ * Each direction (followees by follower, followers by followee) stores every user's
+ * neighbors as one sorted, delta-encoded varint run in a shared byte array, addressed
+ * by a per-user offset. A typical edge costs one or two bytes per direction.
+ *
+ * The compressed arrays are immutable; `add` and `remove` copy the affected users'
+ * neighbor lists into a small overlay that reads consult first, and the overlay is
+ * folded back in once it grows past an eighth of the graph.
+ *
+ * The graph is not synchronized; each `Pond` owns one alongside its connection.
+ */
+class FollowGraph
+{
+public:
+
+  /**
+   * @brief A directed edge from follower to followee.
+   */
+  using Edge = std::pair<int32_t, int32_t>;
+
+  /**
+   * @brief An account to suggest and the number of the user's followees who follow it.
+   */
+  struct Suggestion {
+    int32_t usr;
+    uint32_t mutuals;
+    float influence;   // the account's score from `setInfluence`, which breaks ties
+  };
+
+  /**
+   * @brief The result of `pageRank`.
+   */
+  struct Ranking {
+    std::vector<double> scores;  // indexed by user ID; sums to 1
+    int32_t iterations;
+    double residual;             // L1 distance between the last two iterates
+  };
+
+  /**
+   * @class PathSearch
+   * @brief Scratch space for `shortestPath`, kept between calls so a search allocates
+   *        nothing once it has grown to the size of the graph.
+   *
+   * Holds a visited bitset, a parent array and a frontier for each search direction.
+   */
+  class PathSearch
+  {
+  private:
+    friend class FollowGraph;
+
+    struct Side {
+      std::vector<uint64_t> seen;      // one bit per user ID
+      std::vector<int32_t> parent;     // valid where `seen` is set
+      std::vector<int32_t> frontier;
+      std::vector<int32_t> visited;    // every ID set in `seen`, to clear it afterwards
+    };
+
+    Side _sides[2];                    // 0 searches forward from the source, 1 backward from the target
+    std::vector<int32_t> _next;
+    std::vector<int32_t> _neighbors;
+  };
+
+  FollowGraph() = default;
+
+  /**
+   * @brief Replaces the whole graph.
+   *
+   * @param edges Every `(flwer, flwee)` pair, in any order and free of duplicates.
+   */
+  void build(std::vector<Edge> edges);
+
+  /**
+   * @brief Adds `flwer -> flwee`; adding an existing edge changes nothing.
+   */
+  void add(int32_t flwer, int32_t flwee);
+
+  /**
+   * @brief Removes `flwer -> flwee`; removing a missing edge changes nothing.
+   */
+  void remove(int32_t flwer, int32_t flwee);
+
+  /**
+   * @brief Returns true if `flwer` follows `flwee`.
+   */
+  bool contains(int32_t flwer, int32_t flwee) const;
+
+  /**
+   * @brief Appends the users `usr` follows, in ascending ID order.
+   */
+  void follows(int32_t usr, std::vector<int32_t>& out) const { _out.neighbors(usr, out); }
+
+  /**
+   * @brief Appends the users following `usr`, in ascending ID order.
+   */
+  void followers(int32_t usr, std::vector<int32_t>& out) const { _in.neighbors(usr, out); }
+
+  /**
+   * @brief Ranks the accounts followed by the users `usr` follows.
+   *
+   * Each candidate scores one point per followee of `usr` who follows it. `usr`
+   * itself, accounts it already follows and negative IDs are never suggested.
+   *
+   * @param k The number of suggestions to return.
+   * @param pool When given, large neighborhoods are counted on its threads, each into
+   *             its own sparse counter, and the counters merged.
+   * @return Up to `k` suggestions, most mutual connections first, then highest
+   *         influence, then lowest ID.
+   */
+  std::vector<Suggestion> suggest(int32_t usr, size_t k, ThreadPool* pool = nullptr) const;
+
+  /**
+   * @brief Computes `suggest(usr, k)` for every user, spreading users over `pool`.
+   *
+   * @return Suggestions indexed by user ID, for IDs up to the largest in the graph.
+   */
+  std::vector<std::vector<Suggestion>> suggestAll(size_t k, ThreadPool& pool) const;
+
+  /**
+   * @brief Finds a shortest chain of follows from `from` to `to`.
+   *
+   * Runs a bidirectional breadth-first search: followees outward from `from` and
+   * followers outward from `to`, always expanding the smaller frontier, until the
+   * two meet.
+   *
+   * @param max_depth The longest chain to look for, in follows.
+   * @param search Scratch space reused across calls.
+   * @return The users on the chain, starting with `from` and ending with `to`; just
+   *         `from` if the two are the same user; empty if no chain is short enough.
+   */
+  std::vector<int32_t> shortestPath(int32_t from, int32_t to, int32_t max_depth, PathSearch& search) const;
+
+  /**
+   * @brief Computes PageRank over the follow edges by power iteration on `pool`.
+   *
+   * Every user ID from 0 up to the largest in the graph is a vertex, and each follow
+   * passes a share of the follower's score to the followee. Scores of users who follow
+   * nobody are spread evenly over all vertices. Negative IDs are left out.
+   *
+   * @param start Scores to start from, indexed by user ID, such as the previous run's;
+   *              empty for uniform scores.
+   * @param damping The probability of following an edge rather than jumping anywhere.
+   * @param tolerance Stop once an iteration moves the scores by less than this, in L1.
+   * @param max_iterations Stop after this many iterations regardless.
+   */
+  Ranking pageRank(ThreadPool& pool, const std::vector<double>& start, double damping,
+                   double tolerance, int32_t max_iterations) const;
+
+  /**
+   * @brief Sets the influence scores, indexed by user ID, that break ties between
+   *        suggestions with the same number of mutual connections.
+   *
+   * The scores are kept across `build`; users past the end score 0.
+   */
+  void setInfluence(std::vector<float> influence) { _influence = std::move(influence); }
+
+  /**
+   * @brief Returns the number of edges.
+   */
+  size_t edges() const { return _out.edges(); }
+
+  /**
+   * @brief Returns the heap memory held by both directions, in bytes.
+   */
+  size_t bytes() const { return _out.bytes() + _in.bytes(); }
+
+private:
+
+  /**
+   * @brief The neighbor lists of one direction.
+   */
+  class Adjacency
+  {
+  public:
+    /**
+     * @brief Rebuilds the compressed arrays from `edges`, which are sorted by `(from, to)`.
+     */
+    void build(const std::vector<Edge>& edges);
+
+    void neighbors(int32_t from, std::vector<int32_t>& out) const;
+    void insert(int32_t from, int32_t to);
+    void erase(int32_t from, int32_t to);
+
+    size_t edges() const { return _edges; }
+    size_t bytes() const;
+    int32_t limit() const;
+
+  private:
+    std::vector<uint32_t> _offsets;  // from -> start of its run in _data; one extra end offset
+    std::vector<uint8_t> _data;      // runs of varint deltas between sorted neighbor IDs
+    std::unordered_map<int32_t, std::vector<int32_t>> _overlay;  // from -> full sorted list
+    size_t _edges = 0;
+    size_t _overlay_edges = 0;
+
+    std::vector<int32_t>& _overlayFor(int32_t from);
+    void _compact();
+  };
+
+  Adjacency _out;  // follower -> followees
+  Adjacency _in;   // followee -> followers
+  std::vector<float> _influence;
+
+  float _influenceOf(int32_t usr) const {
+    return usr >= 0 && static_cast<size_t>(usr) < _influence.size() ? _influence[usr] : 0.0f;
+  }
+
+  /**
+   * @brief Returns one past the largest non-negative user ID in the graph.
+   */
+  int32_t _limit() const { return std::max(_out.limit(), _in.limit()); }
+};
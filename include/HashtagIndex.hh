@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class HashtagIndex
+ * @brief An in-process inverted index from each hashtag to the quacks that mention it.
+ *
+ * Every hashtag has a posting list of its quack IDs in ascending order, stored as
+ * blocks of up to 128 IDs: the first ID of each block is kept uncompressed as a skip
+ * entry and the rest as varint gaps. A typical posting costs one or two bytes.
+ * Intersections probe the longer lists through their skip entries and decode only the
+ * blocks a candidate can fall in.
+ *
+ * New quacks take the next ID, so adding their hashtags appends to the end of each list;
+ * a list that receives an older ID is decoded and re-encoded.
+ *
+ * Hashtags are matched case-insensitively. The index is not synchronized; each `Pond`
+ * owns one.
+ */
+class HashtagIndex
+{
+public:
+
+  /**
+   * @brief A boolean search over hashtags, in conjunctive form.
+   */
+  struct Query {
+    std::vector<std::vector<std::string>> all;  // each group must match one of its hashtags
+    std::vector<std::string> none;              // no match may mention any of these
+  };
+
+  /**
+   * @brief Parses a query such as `#cats|#dogs #cute -#sad`.
+   *
+   * Space-separated terms must all match, `|` joins hashtags of which any may match, and
+   * a leading `-` excludes a hashtag. The '#' may be left out.
+   */
+  static Query parse(const std::string& text);
+
+  /**
+   * @brief Records that quack `tid` mentions `hashtag`; recording it again changes nothing.
+   *
+   * @return true if the mention was new.
+   */
+  bool add(int32_t tid, const std::string& hashtag);
+
+  /**
+   * @brief Returns the IDs of the quacks matching `query`, in ascending order.
+   *
+   * A query without any `all` group matches nothing.
+   */
+  std::vector<int32_t> match(const Query& query) const;
+
+  /**
+   * @brief Returns the largest quack ID indexed, or `INT32_MIN` if the index is empty.
+   */
+  int32_t lastTid() const { return _last_tid; }
+
+  /**
+   * @brief Forgets every posting.
+   */
+  void clear();
+
+private:
+
+  /**
+   * @brief One hashtag's quack IDs, ascending, in skip-indexed varint blocks.
+   */
+  class Postings
+  {
+  public:
+    /**
+     * @brief Adds `tid`; returns false if it is already present.
+     */
+    bool insert(int32_t tid);
+
+    /**
+     * @brief Appends every ID, ascending.
+     */
+    void decode(std::vector<int32_t>& out) const;
+
+    /**
+     * @brief Appends the `candidates` (ascending) that are in the list if `keep` is set,
+     *        or that are not if it is unset.
+     */
+    void filter(const std::vector<int32_t>& candidates, bool keep, std::vector<int32_t>& out) const;
+
+    size_t size() const { return _size; }
+
+  private:
+    static constexpr size_t BLOCK = 128;
+
+    std::vector<int32_t> _firsts;    // first ID of each block
+    std::vector<uint32_t> _offsets;  // start of each block's gaps in _data
+    std::vector<uint8_t> _data;      // varint gaps between the IDs after each block's first
+    size_t _size = 0;
+    int32_t _last = 0;
+
+    void _append(int32_t tid);
+    void _decodeBlock(size_t block, std::vector<int32_t>& out) const;
+  };
+
+  std::unordered_map<std::string, Postings> _postings;  // lower(hashtag) -> quacks
+  int32_t _last_tid = INT32_MIN;
+
+  const Postings* _find(const std::string& folded) const;
+};
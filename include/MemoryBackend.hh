@@ -0,0 +1,204 @@
+#pragma once
+
+#include <cstdio>
+#include <map>
+#include <shared_mutex>
+#include <sqlite3.h>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Backend.hh"
+
+/**
+ * @class MemoryBackend
+ * @brief Keeps all of Pond's data in process memory, for read replicas and for measuring
+ *        how much of a call's latency SQLite itself accounts for.
+ *
+ * Rows live in hash maps keyed by their primary key. Every access path Pond uses has a
+ * secondary index: per-writer and per-requacker vectors sorted by `(ts, tid)` and
+ * hashtag postings indexed by interned term ID; follow adjacency is Pond's
+ * `FollowGraph`. Results match `SqliteBackend` row for row, including its LIKE-based
+ * search semantics.
+ *
+ * The engine can be seeded from a Quacker database file and written to, or reloaded
+ * from, a binary snapshot. Reads take a shared lock and writes an exclusive one, so a
+ * single engine may be used from several threads.
+ */
+class MemoryBackend : public Backend
+{
+public:
+
+  MemoryBackend() = default;
+
+  /**
+   * @brief Loads a Quacker database file or a snapshot written by `snapshot`.
+   *
+   * The file type is detected from its header. Databases must already be on the
+   * current schema (open them once with `Pond::loadDatabase` to migrate).
+   *
+   * @param filename The file to load; an empty name starts an empty engine.
+   * @return true if the file was loaded.
+   */
+  bool open(const std::string& filename);
+
+  bool insertUser(int32_t usr, const std::string& name, const std::string& email,
+                  int64_t phone, const std::string& pwd) override;
+  std::optional<int32_t> maxUserID() override;
+  std::optional<int32_t> checkLogin(int32_t usr, const std::string& pwd) override;
+  bool searchUsers(const std::string& search_terms, std::vector<Pond::User>& out) override;
+  std::unique_ptr<RowStream<std::vector<Pond::User>>> streamUsers(const std::string& search_terms) override;
+  std::optional<int64_t> countUsers(const std::string& search_terms) override;
+  std::optional<std::string> username(int32_t usr) override;
+  bool usersByID(const std::vector<int32_t>& usrs, std::vector<Pond::User>& out) override;
+  bool usersFrom(int32_t first_usr, std::vector<Pond::User>& out) override;
+
+  bool insertFollow(int32_t flwer, int32_t flwee, const char* start_date) override;
+  bool deleteFollow(int32_t flwer, int32_t flwee) override;
+  bool followEdges(std::vector<std::pair<int32_t, int32_t>>& out) override;
+  std::optional<int64_t> followsVersion() override;
+
+  bool insertQuack(int32_t tid, int32_t writer_id, const std::string& text, uint64_t simhash,
+                   const Clock::Stamp& now, std::optional<int32_t> replyto_tid) override;
+  std::optional<int32_t> maxQuackID() override;
+  bool quackByID(int32_t tid, Pond::QuackResults& out) override;
+  bool quacksByID(const std::vector<int32_t>& tids, Pond::QuackResults& out) override;
+  bool quacksFrom(int32_t first_tid, size_t limit, Pond::QuackResults& out) override;
+  bool simhashesFrom(int32_t first_tid, size_t limit, std::vector<std::pair<int32_t, uint64_t>>& out) override;
+  bool quacksByWriter(int32_t writer_id, Pond::QuackResults& out) override;
+  bool replies(int32_t tid, std::vector<int32_t>& out) override;
+  bool thread(int32_t root_tid, int32_t max_depth, size_t limit, Pond::QuackResults& out,
+              std::vector<int32_t>& depths) override;
+  bool feed(const std::vector<int32_t>& followees, std::vector<FeedEntry>& out) override;
+  bool searchQuacksByHashtag(const std::string& pattern, Pond::QuackResults& out,
+                             const std::unordered_set<int32_t>& seen) override;
+  bool searchQuacksByWord(const std::string& keyword, Pond::QuackResults& out,
+                          std::unordered_set<int32_t>& seen) override;
+  std::unique_ptr<RowStream<Pond::QuackResults>> streamQuacksByHashtag(const std::string& pattern) override;
+  std::unique_ptr<RowStream<Pond::QuackResults>> streamQuacksByWord(const std::string& keyword) override;
+  std::optional<int64_t> countQuacksByHashtag(const std::string& pattern) override;
+  std::optional<int64_t> countQuacksByWord(const std::string& keyword) override;
+  bool hashtagMentionsSince(int64_t since, std::vector<std::pair<int64_t, std::string>>& out) override;
+  bool hashtagMentionsFrom(int32_t first_tid, std::vector<std::pair<int32_t, std::string>>& out) override;
+  bool hashtagsOf(int32_t tid, std::vector<std::string>& out) override;
+  bool hashtagHours(const std::string& term, int64_t from_hour, int64_t to_hour,
+                    std::vector<std::pair<int64_t, int64_t>>& out) override;
+  bool topHashtagsBetween(int64_t from_hour, int64_t to_hour, size_t limit,
+                          std::vector<std::pair<std::string, int64_t>>& out) override;
+  bool rebuildHashtagRollups() override;
+
+  std::optional<int32_t> upsertRequack(int32_t tid, int32_t retweeter_id, int32_t spam,
+                                       const Clock::Stamp& now) override;
+  bool upsertRequacks(const std::vector<RequackWrite>& requacks, const Clock::Stamp& now,
+                      std::vector<int32_t>& out) override;
+  std::optional<int32_t> requackCount(int32_t tid) override;
+  std::optional<bool> requackedAny(int32_t retweeter_id, const std::vector<int32_t>& tids) override;
+
+  std::optional<bool> insertHashtag(int32_t tid, const std::string& term) override;
+
+  bool insertList(int32_t owner_id, const std::string& lname) override;
+  bool insertListEntry(int32_t owner_id, const std::string& lname, int32_t tid) override;
+  bool listExists(int32_t owner_id, const std::string& lname) override;
+  bool lists(int32_t owner_id, std::vector<Pond::ListSummary>& out) override;
+  bool listQuacks(int32_t owner_id, const std::string& lname, const std::optional<Pond::ListCursor>& after,
+                  size_t limit, Pond::QuackResults& out) override;
+
+  bool userRanks(std::vector<std::pair<int32_t, double>>& out) override;
+  bool replaceUserRanks(const std::vector<std::pair<int32_t, double>>& ranks) override;
+
+  /**
+   * @brief Writes every row to a binary snapshot that `open` can reload.
+   *
+   * The snapshot is written to a temporary file and renamed over `filename`, so a
+   * crash never leaves a truncated snapshot behind.
+   */
+  bool snapshot(const std::string& filename) override;
+
+  std::string lastError() const override;
+
+private:
+  struct UserRow {
+    std::string name;
+    std::string email;
+    int64_t phone;
+    std::string pwd;
+  };
+
+  struct RequackRow {
+    int32_t tid;
+    int32_t retweeter_id;
+    int32_t writer_id;
+    int32_t spam;  // as in the retweets table: 0, 1 for a repeat, 2 for a fast writer, 4 for a near copy
+    std::string rdate;
+    int64_t ts;
+  };
+
+  /**
+   * @brief A list owner's list names, each with its `(ts, tid)` entries, oldest first.
+   *        Entries of quacks that do not exist are dated 0, as in the database.
+   */
+  using ListEntry = std::pair<int64_t, int32_t>;
+  using Lists = std::unordered_map<std::string, std::vector<ListEntry>>;
+
+  mutable std::shared_mutex _mutex;
+  std::string _error;
+
+  std::unordered_map<int32_t, UserRow> _users;
+  std::unordered_map<uint64_t, std::string> _follow_dates;        // (flwer, flwee) -> start_date
+
+  std::unordered_map<int32_t, Pond::Quack> _quacks;
+  std::unordered_map<int32_t, std::string> _text_lower;           // tid -> lower(text), for word search
+  std::unordered_map<int32_t, uint64_t> _simhashes;               // tid -> SimHash of text
+  std::unordered_map<int32_t, std::vector<int32_t>> _by_writer;   // writer -> tids by (ts, tid)
+  std::vector<int32_t> _timeline;                                 // all tids by (ts, tid)
+  std::unordered_map<int32_t, std::vector<int32_t>> _replies;     // replyto -> sorted tids
+
+  std::unordered_map<uint64_t, RequackRow> _requacks;             // (tid, retweeter)
+  std::unordered_map<int32_t, std::vector<uint64_t>> _by_requacker; // retweeter -> keys by (ts, tid)
+  std::unordered_map<int32_t, int32_t> _requack_counts;           // tid -> requacks
+
+  std::unordered_map<std::string, int32_t> _term_ids;            // lower(term) -> term ID
+  std::vector<std::string> _terms;                                // term ID -> lower(term)
+  std::unordered_map<int32_t, std::vector<int32_t>> _quack_hashtags; // tid -> term IDs
+  std::vector<std::vector<int32_t>> _hashtags;                    // term ID -> tids
+  std::vector<std::map<int64_t, int64_t>> _hashtag_hours;         // term ID -> hour -> mentions
+
+  std::unordered_map<int32_t, Lists> _lists;                      // owner -> lists
+  std::unordered_map<int32_t, double> _ranks;                     // usr -> influence score
+
+  int32_t _max_usr = 0;
+  int32_t _max_tid = 0;
+  int64_t _follows_version = 0;
+
+  // The _insert helpers expect the exclusive lock to be held. With `sorted` unset they
+  // append to the secondary indexes and leave ordering to a final `_sortIndexes`, so a
+  // bulk load sorts each index once instead of inserting every row in place.
+  bool _insertUser(int32_t usr, UserRow row);
+  bool _insertFollow(int32_t flwer, int32_t flwee, const std::string& start_date);
+  bool _insertQuack(Pond::Quack quack, uint64_t simhash, bool sorted);
+  bool _insertRequack(RequackRow row, bool sorted);
+  int32_t _upsertRequack(int32_t tid, int32_t retweeter_id, int32_t spam, const Clock::Stamp& now);
+  bool _insertHashtag(int32_t tid, const std::string& term);  // false if already linked
+  bool _insertListEntry(int32_t owner_id, const std::string& lname, int32_t tid, bool sorted);
+  int32_t _internTerm(const std::string& folded);
+  void _countHashtag(int32_t term_id, int64_t ts);
+  bool _fail(const std::string& error);
+
+  bool _import(sqlite3* db);
+  bool _loadSnapshot(std::FILE* file);
+  void _clear();
+  void _sortIndexes();
+  bool _olderQuack(int32_t a, int32_t b) const;
+  ListEntry _listEntry(int32_t tid) const;
+
+  // The _match helpers expect the shared lock to be held
+  void _matchUsers(const std::string& search_terms, std::vector<int32_t>& usrs) const;
+  void _matchHashtag(const std::string& folded, std::vector<int32_t>& tids) const;
+
+  // Streams over search results, defined alongside the searches
+  class QuackIDStream;
+  class UserIDStream;
+  class WordStream;
+  bool _olderRequack(uint64_t a, uint64_t b) const;
+};
@@ -1,16 +1,38 @@
 #pragma once
 
 #include <iostream>
+#include <list>
 #include <sqlite3.h>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <chrono>
 #include <ctime>
+#include <map>
+#include <unordered_map>
 #include <unordered_set>
 #include <sstream>
 #include <algorithm>
+#include <optional>
+#include <memory>
 
 #include "definitions.hh"
+#include "Arena.hh"
+#include "Clock.hh"
+#include "Deadline.hh"
+#include "FollowGraph.hh"
+#include "HashtagIndex.hh"
+#include "PrefixIndex.hh"
+#include "Query.hh"
+#include "Recorder.hh"
+#include "SearchIndex.hh"
+#include "SimHashIndex.hh"
+#include "SpamDetector.hh"
+#include "Trending.hh"
+
+class Backend;
+class ThreadPool;
+template <typename Container> class RowStream;
 
 /**
  * @class Pond
@@ -37,8 +59,8 @@ public:
   /**
    * @brief Constructs a new Pond object.
    *
-   * Initializes the database connection pointer to `nullptr` to ensure a safe 
-   * and uninitialized state before the database is loaded.
+   * Starts on a SQLite backend with no open connection, a safe and uninitialized
+   * state in which every call fails until a database is loaded.
    *
    * @note The database connection is not established in the constructor. 
    *       Use the `loadDatabase` method to open a database connection.
@@ -48,11 +70,8 @@ public:
   /**
    * @brief Destructs the Pond object and releases resources.
    *
-   * Closes the SQLite database connection if it was opened, ensuring proper 
-   * cleanup of resources when the Pond object goes out of scope.
-   *
-   * @note If the database connection was never opened (i.e., `_db` is `nullptr`),
-   *       this method safely does nothing.
+   * Destroys the storage backend, which closes the SQLite database connection if
+   * one was opened.
    */
   ~Pond();
 
@@ -61,6 +80,8 @@ public:
    *
    * This struct holds data related to an individual quack, including the quack ID,
    * author ID, text content, timestamp (date and time), and any quack it replies to.
+   * `ts` is the authoritative creation time used for ordering; `date` and `time` are
+   * the display form.
    */
   struct Quack {
     int32_t tid;
@@ -69,6 +90,71 @@ public:
     std::string date;
     std::string time;
     int32_t replyto_tid;
+    int64_t ts;         // microseconds since the Unix epoch (UTC)
+  };
+
+  /**
+   * @brief A read-only view of a quack row whose text lives in a `QuackResults` arena.
+   *
+   * Views are only valid while the `QuackResults` that produced them is alive; use
+   * `toQuack()` to keep a row beyond that.
+   */
+  struct QuackView {
+    int32_t tid;
+    int32_t writer_id;
+    std::string_view text;
+    std::string_view date;
+    std::string_view time;
+    int32_t replyto_tid;
+    int64_t ts;
+
+    /**
+     * @brief Copies the viewed row into an owning `Quack`.
+     */
+    Quack toQuack() const;
+  };
+
+  /**
+   * @class QuackResults
+   * @brief The rows of one quack query, stored in a per-query arena.
+   *
+   * All column text is copied into a single arena as the statement is stepped, so a
+   * result page costs a few block allocations instead of three strings per row. The
+   * arena, and therefore every `QuackView`, lives exactly as long as this object.
+   */
+  class QuackResults
+  {
+  public:
+    QuackResults() = default;
+    QuackResults(QuackResults&&) = default;
+    QuackResults& operator=(QuackResults&&) = default;
+
+    std::vector<QuackView>::const_iterator begin() const { return _rows.begin(); }
+    std::vector<QuackView>::const_iterator end() const { return _rows.end(); }
+    const QuackView& operator[](size_t i) const { return _rows[i]; }
+    size_t size() const { return _rows.size(); }
+    bool empty() const { return _rows.empty(); }
+    void reserve(size_t rows) { _rows.reserve(rows); }
+
+    /**
+     * @brief Appends the current row of a statement selecting
+     *        `tid, writer_id, text, tdate, ttime, replyto_tid, ts`.
+     */
+    void appendRow(sqlite3_stmt* stmt);
+
+    /**
+     * @brief Appends a copy of a row held elsewhere, e.g. by an in-memory backend.
+     */
+    void append(const QuackView& row);
+
+    /**
+     * @brief Copies every row into owning `Quack` structs.
+     */
+    std::vector<Quack> toQuacks() const;
+
+  private:
+    Arena _arena;
+    std::vector<QuackView> _rows;
   };
 
   /**
@@ -81,6 +167,175 @@ public:
     std::string name;
   };
 
+  /**
+   * @brief An account suggested to follow, with how many of the user's followees
+   *        already follow it.
+   */
+  struct Suggestion {
+    int32_t usr;
+    std::string name;
+    uint32_t mutuals;
+  };
+
+  /**
+   * @brief How a `rankUsers` run went.
+   */
+  struct RankReport {
+    size_t users;        // user IDs ranked, up to the largest in the follow graph
+    size_t edges;
+    int32_t iterations;
+    double residual;     // L1 change in the scores over the last iteration
+    bool converged;      // residual fell below the tolerance before the iteration cap
+    bool warm_start;     // started from the stored scores rather than uniform ones
+    double seconds;      // spent iterating, excluding reading and storing scores
+  };
+
+  /**
+   * @brief What a `duplicateReport` run found.
+   */
+  struct DuplicateReport {
+    size_t quacks;        // quacks compared
+    size_t fingerprints;  // distinct fingerprints among them
+    int max_distance;     // the distance used, after clamping
+    std::vector<std::vector<int32_t>> groups;  // near copies, largest group first, IDs ascending
+    double seconds;       // spent comparing, excluding reading fingerprints
+  };
+
+  /**
+   * @brief The mentions of a hashtag within one hour.
+   */
+  struct HourlyCount {
+    int64_t hour_ts;     // start of the hour, in microseconds since the Unix epoch
+    int64_t mentions;
+  };
+
+  /**
+   * @brief One page of a ranked search.
+   */
+  struct RankedResults {
+    QuackResults quacks;                       // best first
+    std::vector<double> scores;                // by row of `quacks`
+    std::optional<SearchIndex::Cursor> next;   // set when there may be a further page
+  };
+
+  /**
+   * @brief The results of a call made under a `Deadline`.
+   */
+  template <typename T>
+  struct Timed {
+    T results;
+    bool truncated = false;  // the deadline ran out first; `results` holds what was found
+  };
+
+  /**
+   * @brief Where a page of a list ends: the last quack on it. The next page starts
+   *        with the quack listed after it.
+   */
+  struct ListCursor {
+    int64_t ts;
+    int32_t tid;
+  };
+
+  /**
+   * @brief One page of a list's quacks.
+   */
+  struct ListPage {
+    QuackResults quacks;              // most recent first
+    std::optional<ListCursor> next;   // set when there may be a further page
+  };
+
+  /**
+   * @brief A list and the number of quacks in it.
+   */
+  struct ListSummary {
+    std::string name;
+    int64_t quacks;
+  };
+
+  /**
+   * @brief A quack and the replies under it, in the order a conversation is shown.
+   */
+  struct Thread {
+    QuackResults quacks;          // the root first; each reply after its parent and its older siblings' replies
+    std::vector<int32_t> depths;  // by row of `quacks`; the root is 0, its replies 1, and so on
+  };
+
+  /**
+   * @class QuackCursor
+   * @brief The results of a quack search, pulled a batch at a time with `next`.
+   *
+   * Each keyword's query is only read as far as the batches taken so far need, and is
+   * released once it runs out of rows or the cursor is destroyed. A cursor must not
+   * outlive its Pond or be used after `loadDatabase` or `loadMemory`.
+   */
+  class QuackCursor
+  {
+  public:
+    QuackCursor();
+    QuackCursor(QuackCursor&&) noexcept;
+    QuackCursor& operator=(QuackCursor&&) noexcept;
+    ~QuackCursor();
+
+    /**
+     * @brief Returns up to `n` more matching quacks, in the order `searchQuackViews`
+     *        lists them; fewer only once the results run out.
+     */
+    QuackResults next(size_t n);
+
+    /**
+     * @brief Returns true once the results are known to have run out.
+     *
+     * A batch that ends exactly at the last result leaves this false until the next
+     * call to `next`, which comes back empty.
+     */
+    bool done() const;
+
+  private:
+    friend class Pond;
+
+    struct Source {
+      std::unique_ptr<RowStream<QuackResults>> stream;
+      bool remember;  // keep the IDs returned, so later keywords skip them
+    };
+
+    std::vector<Source> _sources;  // one per keyword, read in turn
+    size_t _current = 0;
+    std::unordered_set<int32_t> _seen;
+  };
+
+  /**
+   * @class UserCursor
+   * @brief The results of a user search, pulled a batch at a time with `next`.
+   *
+   * The query is released once it runs out of rows or the cursor is destroyed. A cursor
+   * must not outlive its Pond or be used after `loadDatabase` or `loadMemory`.
+   */
+  class UserCursor
+  {
+  public:
+    UserCursor();
+    UserCursor(UserCursor&&) noexcept;
+    UserCursor& operator=(UserCursor&&) noexcept;
+    ~UserCursor();
+
+    /**
+     * @brief Returns up to `n` more matching users, in the order `searchForUsers` lists
+     *        them; fewer only once the results run out.
+     */
+    std::vector<User> next(size_t n);
+
+    /**
+     * @brief Returns true once the results are known to have run out, as for
+     *        `QuackCursor::done`.
+     */
+    bool done() const;
+
+  private:
+    friend class Pond;
+
+    std::unique_ptr<RowStream<std::vector<User>>> _stream;
+  };
+
   /**
   * @brief Opens a connection to the SQLite database specified by the filename.
   *
@@ -90,6 +345,46 @@ public:
   */
   int loadDatabase(const std::string& db_filename);
 
+  /**
+   * @brief Switches Pond to the in-memory storage engine.
+   *
+   * The engine is seeded from a Quacker database file or from a snapshot written by
+   * `saveSnapshot`. Nothing is written back to the source file; call `saveSnapshot`
+   * to persist changes. A database file must already be on the current schema; open it
+   * once with `loadDatabase` to migrate it.
+   *
+   * @param filename The database or snapshot to load, or "" to start empty.
+   * @return true if the engine was loaded.
+   */
+  bool loadMemory(const std::string& filename);
+
+  /**
+   * @brief Writes a consistent copy of everything stored to a file.
+   *
+   * With the SQLite backend the copy is a compacted database file; with the in-memory
+   * engine it is a snapshot that `loadMemory` can reload.
+   *
+   * @param filename The file to write; an existing file is replaced.
+   * @return true if the copy was written.
+   */
+  bool saveSnapshot(const std::string& filename);
+
+  /**
+   * @brief Starts appending every public Pond call to a binary log.
+   *
+   * Each record holds the method, its arguments, the start timestamp, the duration and
+   * the result size, so the traffic can be re-executed later with `quacker-replay`.
+   *
+   * @param log_filename The log file to create; an existing file is replaced.
+   * @return true if the log was opened; false otherwise.
+   */
+  bool startRecording(const std::string& log_filename);
+
+  /**
+   * @brief Stops recording calls and flushes the log.
+   */
+  void stopRecording();
+
   /**
   * @brief Adds a new user to the users table in the database.
   *
@@ -98,9 +393,9 @@ public:
   * @param email The email of the user.
   * @param phone The phone number of the user.
   * @param password The password for the user's account.
-  * @return true if the user was successfully added; false otherwise.
+  * @return The new user's ID if the user was successfully added; std::nullopt otherwise.
   */
-  int32_t* addUser(
+  std::optional<int32_t> addUser(
     const std::string& name,
     const std::string& email,
     const int64_t& phone,
@@ -118,6 +413,8 @@ public:
    * @return true if the hashtag was successfully added; false if an error occurred or 
    *         the hashtag already exists for the quack.
    *
+   * @note The mention counts towards trending hashtags once the quack itself is stored.
+   *
    * @note Ensures case-insensitive uniqueness of hashtags for the specified quack.
    */
   bool addHashtag(
@@ -149,9 +446,9 @@ public:
    *
    * @param user_id The ID of the user who is posting the quack.
    * @param text The text of the quack.
-   * @return A pointer to the unique ID of the quack if it was successfully added; nullptr otherwise.
+   * @return The unique ID of the quack if it was successfully added; std::nullopt otherwise.
    */
-  int32_t* addQuack(
+  std::optional<int32_t> addQuack(
     const int32_t& user_id,
     const std::string& text
   );
@@ -162,9 +459,9 @@ public:
   * @param user_id The ID of the user creating the reply.
   * @param reply_quack_id The ID of the quack being replied to.
   * @param text The text content of the reply.
-  * @return true if the reply was successfully added; false otherwise.
+  * @return The unique ID of the reply if it was successfully added; std::nullopt otherwise.
   */
-  int32_t* addReply(
+  std::optional<int32_t> addReply(
     const int32_t& user_id,
     const int32_t& reply_quack_id,
     const std::string& text
@@ -173,16 +470,21 @@ public:
   /**
    * @brief Adds a requack (retweet) for a specific quack by a user.
    *
-   * This method checks if the user has already requacked the given quack. If the requack 
-   * already exists, it updates the entry to mark it as spam. Otherwise, it adds a new 
-   * requack entry to the database.
+   * A single upsert adds the requack, taking the writer from the quack, or marks an
+   * existing requack by the same user as spam. A new requack by a user writing faster
+   * than the spam limits allow, or of a near copy of a quack the user already requacked,
+   * is stored already flagged, so it stays out of feeds.
    *
    * @param user_id The unique ID of the user performing the requack.
    * @param quack_id The unique ID of the quack being requacked.
    * @return An integer status code:
    *         - 0: A new requack was successfully added.
    *         - 1: The requack already exists and was marked as spam.
-   *         - 3: An error occurred during the process.
+   *         - 2: A new requack was added but flagged as spam, as the user is writing
+   *              too fast.
+   *         - 3: An error occurred, or the quack does not exist.
+   *         - 4: A new requack was added but flagged as spam, as the user already
+   *              requacked a near copy of the quack.
    *
    * @note The method uses parameterized SQL queries to prevent SQL injection and ensures
    *       proper database interaction. Dates for new requacks are recorded using the current
@@ -199,6 +501,35 @@ public:
       const int32_t &quack_id
     );
 
+  /**
+   * @brief Adds many requacks at once for batch ingest, in one transaction.
+   *
+   * @param requacks `(user_id, quack_id)` pairs, applied in order; a pair repeated in the
+   *        batch is marked as spam the second time, as with repeated addRequack calls.
+   * @return One addRequack status code per pair. If the batch fails, nothing is written
+   *         and every code is 3.
+   */
+  std::vector<int32_t> addRequacks(const std::vector<std::pair<int32_t, int32_t>>& requacks);
+
+  /**
+   * @brief Returns the write rates past which a user is treated as a spammer.
+   */
+  SpamDetector::Limits spamLimits() const;
+
+  /**
+   * @brief Sets the write rates past which a user's new requacks are flagged as spam.
+   *
+   * Quacks, replies, requacks and follows are counted per user over the last minute.
+   * Once any count is over its limit, the user's new requacks are stored flagged as
+   * spam and left out of feeds until the rate drops.
+   */
+  void setSpamLimits(const SpamDetector::Limits& limits);
+
+  /**
+   * @brief Returns true if the user is writing faster than the spam limits allow.
+   */
+  bool isWritingTooFast(const int32_t& user_id) const;
+
   /**
    * @brief Adds a quack to a list in the database.
    *
@@ -225,14 +556,43 @@ public:
     const std::string& list_name
   );
 
+  /**
+   * @brief Retrieves a user's lists by name, each with its number of quacks.
+   *
+   * @param owner_id The ID of the user who owns the lists.
+   * @return The lists, or an empty vector if the user has none.
+   */
+  std::vector<Pond::ListSummary> getLists(
+    const int32_t& owner_id
+  );
+
+  /**
+   * @brief Retrieves one page of the quacks in a list, most recent first.
+   *
+   * Pass the `next` cursor of a page to read the page after it; each page costs the
+   * same however far into the list it is.
+   *
+   * @param owner_id The ID of the user who owns the list.
+   * @param list_name The name of the list.
+   * @param after Where the previous page ended, or nullopt for the first page.
+   * @param limit The page size.
+   * @return The page, empty once the list runs out or if the list does not exist.
+   */
+  Pond::ListPage getListQuacks(
+    const int32_t& owner_id,
+    const std::string& list_name,
+    const std::optional<Pond::ListCursor>& after,
+    const size_t& limit
+  );
+
   /**
   * @brief Checks if the provided user ID and password are valid for login.
   *
   * @param user_id The user ID to check in the database.
   * @param password The password corresponding to the user ID.
-  * @return true if the login credentials are valid; false otherwise.
+  * @return The user's ID if the login credentials are valid; std::nullopt otherwise.
   */
-  int32_t* checkLogin(
+  std::optional<int32_t> checkLogin(
     const int32_t& user_id,
     const std::string& password
   );
@@ -271,17 +631,169 @@ public:
     const std::string& search_terms
   );
 
+  /**
+   * @brief `searchForUsers`, stopped early if `deadline` expires or is cancelled.
+   *
+   * Matches are ranked before any is returned, so a truncated search may find none.
+   */
+  Pond::Timed<std::vector<Pond::User>> searchForUsers(
+    const std::string& search_terms,
+    const Deadline& deadline
+  );
+
+  /**
+   * @brief Lazily searches for users whose names contain the specified search terms.
+   *
+   * @param search_terms The terms to search for in user names.
+   * @return A cursor over the users `searchForUsers` would return, in the same order.
+   */
+  Pond::UserCursor openUserSearch(
+    const std::string& search_terms
+  );
+
+  /**
+   * @brief Counts the users `searchForUsers` would return, without reading them.
+   *
+   * @return The count, or std::nullopt if the backend failed.
+   */
+  std::optional<int64_t> countUserMatches(
+    const std::string& search_terms
+  );
+
+  /**
+   * @brief Completes the start of a user name to the names of the most active users.
+   *
+   * Names are completed from an in-memory prefix index kept up to date as users and
+   * quacks are added, without querying the database, so this is cheap enough to call
+   * on every keystroke.
+   *
+   * @param prefix The start of a name, in any case.
+   * @param count The number of completions wanted; at most `PrefixIndex::TOP`.
+   * @return Names starting with `prefix`, with the quacks their users have written, most
+   *         first.
+   */
+  std::vector<PrefixIndex::Completion> completeUsername(
+    const std::string& prefix,
+    const size_t& count
+  );
+
   /**
    * @brief search for quacks containing specific keywords or hashtags.
    *
    * @param search_terms A string of keywords or hashtags to search for in quacks.
-   * @return A vector of quacks that contain the specified keywords or hashtags, ordered by date and time.
+   * @return A vector of quacks that contain the specified keywords or hashtags, most recent first.
    *
    * @note case insensitive search, space seperated keywoards
    */
   std::vector<Pond::Quack> searchForQuacks(
     const std::string& search_terms
   );
+
+  /**
+   * @brief Zero-copy variant of `searchForQuacks`.
+   *
+   * @param search_terms A string of keywords or hashtags to search for in quacks.
+   * @return The matching quacks as views into a per-query arena, most recent first
+   *         within each keyword.
+   */
+  Pond::QuackResults searchQuackViews(
+    const std::string& search_terms
+  );
+
+  /**
+   * @brief `searchForQuacks`, stopped early if `deadline` expires or is cancelled.
+   *
+   * A truncated search holds the matches found in time: the newest matches of the
+   * keyword being read when time ran out, after all matches of the keywords before it.
+   */
+  Pond::Timed<std::vector<Pond::Quack>> searchForQuacks(
+    const std::string& search_terms,
+    const Deadline& deadline
+  );
+
+  /**
+   * @brief `searchQuackViews`, stopped early if `deadline` expires or is cancelled.
+   *
+   * A truncated search holds the matches found in time, as for `searchForQuacks`.
+   */
+  Pond::Timed<Pond::QuackResults> searchQuackViews(
+    const std::string& search_terms,
+    const Deadline& deadline
+  );
+
+  /**
+   * @brief Lazily searches for quacks containing specific keywords or hashtags.
+   *
+   * Nothing is read until the cursor's `next` is called, and then only as many rows as
+   * it asks for.
+   *
+   * @param search_terms Comma-separated keywords or hashtags, as for `searchQuackViews`.
+   * @return A cursor over the quacks `searchQuackViews` would return, in the same order.
+   */
+  Pond::QuackCursor openQuackSearch(
+    const std::string& search_terms
+  );
+
+  /**
+   * @brief Counts the quacks `searchQuackViews` would return, without reading them.
+   *
+   * The count is exact for one keyword. With several, a quack matching more than one is
+   * counted once per keyword, so the count is an upper bound.
+   *
+   * @return The count, or std::nullopt if the backend failed.
+   */
+  std::optional<int64_t> countQuackMatches(
+    const std::string& search_terms
+  );
+
+  /**
+   * @brief Searches for quacks by a combination of hashtags, using the in-process
+   *        hashtag index.
+   *
+   * Space-separated hashtags must all be present, `|` joins hashtags of which any may
+   * be present, and a leading `-` excludes a hashtag, as in `#cats|#dogs #cute -#sad`.
+   * Hashtags linked by other connections are picked up before each search.
+   *
+   * @param query The hashtags to combine, in any case, with or without their '#'.
+   * @return The matching quacks as views into a per-query arena, most recent first.
+   */
+  Pond::QuackResults searchHashtags(
+    const std::string& query
+  );
+
+  /**
+   * @brief Completes the start of a hashtag to the most mentioned hashtags.
+   *
+   * Hashtags are completed from an in-memory prefix index kept up to date as hashtags
+   * are added, without querying the database, so this is cheap enough to call on every
+   * keystroke.
+   *
+   * @param prefix The start of a hashtag, in any case; the '#' may be left out.
+   * @param count The number of completions wanted; at most `PrefixIndex::TOP`.
+   * @return Lower-cased hashtags starting with `prefix`, with their mentions, most first.
+   */
+  std::vector<PrefixIndex::Completion> completeHashtag(
+    const std::string& prefix,
+    const size_t& count
+  );
+
+  /**
+   * @brief Searches quack text for any of the words in `query`, best match first.
+   *
+   * Matches are ranked by BM25 over the words' frequency in each quack and the quack's
+   * length, boosted for recent quacks. Only the requested page is kept while ranking,
+   * so a common word costs about as much as a rare one.
+   *
+   * @param query Words to search for, in any case; a hashtag also matches its bare word.
+   * @param count The number of matches per page.
+   * @param after The `next` cursor of the previous page, or std::nullopt for the first.
+   * @return The page, with each quack's score and the cursor for the page after it.
+   */
+  Pond::RankedResults searchRanked(
+    const std::string& query,
+    const size_t& count,
+    const std::optional<SearchIndex::Cursor>& after = std::nullopt
+  );
   
   /**
    * @brief Retrieves a feed of quacks and requacks for a given user.
@@ -293,9 +805,45 @@ public:
     const int32_t& user_id
   );
 
+  /**
+   * @brief `getFeed`, stopped early if `deadline` expires or is cancelled.
+   *
+   * The SQLite backend orders the whole feed before returning any of it, so a truncated
+   * feed there is usually empty.
+   */
+  Pond::Timed<std::vector<std::string>> getFeed(
+    const int32_t& user_id,
+    const Deadline& deadline
+  );
+
+  /**
+   * @brief Counts the calls cut short by their deadline, per kind of call.
+   *
+   * @return `(call, timeouts)` for every kind of call that has timed out, by call name.
+   */
+  std::vector<std::pair<std::string, uint64_t>> timeouts() const;
+
   uint32_t getRequackCount(const int32_t& quack_id);
   
   std::vector<int32_t> getReplies(const int32_t& quack_id);
+
+  /**
+   * @brief Retrieves the conversation under a quack in one query.
+   *
+   * Replies to one quack are listed oldest first, each followed by its own replies.
+   * Recently read threads are kept in memory until a reply is added to any quack in
+   * them, through this Pond or another connection.
+   *
+   * @param root_tid The quack the conversation starts at.
+   * @param max_depth How many levels of replies to include; 0 for the root alone.
+   * @param limit The maximum number of quacks, including the root.
+   * @return The thread, or an empty one if the root does not exist.
+   */
+  Pond::Thread getThread(
+    const int32_t& root_tid,
+    const int32_t& max_depth,
+    const size_t& limit
+  );
   
   /**
    * @brief Retrieves the username associated with a given user ID from the database.
@@ -317,11 +865,21 @@ public:
     const int32_t& quack_id
   );
 
+  /**
+   * @brief Zero-copy variant of `getQuackFromID`.
+   *
+   * @param quack_id The unique ID of the quack to retrieve.
+   * @return A result set with the quack, or an empty one if it does not exist.
+   */
+  Pond::QuackResults getQuackViewFromID(
+    const int32_t& quack_id
+  );
+
   /**
    * @brief Retrieves the list of followers for a specified user.
    *
-   * This method queries the database to find all users who follow the specified user
-   * and returns their IDs and names.
+   * This method looks up the followers in the follow graph and reads their names from
+   * the database, returning them in ascending ID order.
    *
    * @param user_id The unique ID of the user whose followers are to be retrieved.
    * @return A vector of `Pond::User` objects, where each object contains:
@@ -342,8 +900,8 @@ public:
   /**
    * @brief Retrieves a list of users that a specified user is following.
    *
-   * This method queries the database to find all user IDs of the users whom the 
-   * specified user has chosen to follow.
+   * This method reads the IDs of the users whom the specified user has chosen to follow
+   * from the in-memory follow graph, in ascending ID order.
    *
    * @param user_id The unique ID of the user whose following list is to be retrieved.
    * @return A vector of integers where each integer represents the unique ID of a user 
@@ -359,7 +917,7 @@ public:
    * @brief Retrieves all quacks created by a specified user.
    *
    * This method queries the database to fetch all quacks (tweets) authored by the given 
-   * user, sorted by date and time in descending order (most recent first).
+   * user, sorted by timestamp in descending order (most recent first).
    *
    * @param user_id The unique ID of the user whose quacks are to be retrieved.
    * @return A vector of `Pond::Quack` objects, where each object contains:
@@ -378,8 +936,324 @@ public:
     const int32_t &user_id
   );
 
+  /**
+   * @brief Zero-copy variant of `getQuacks`.
+   *
+   * @param user_id The unique ID of the user whose quacks are to be retrieved.
+   * @return The user's quacks as views into a per-query arena, most recent first.
+   */
+  Pond::QuackResults getQuackViews(
+    const int32_t &user_id
+  );
+
+  /**
+   * @brief Suggests accounts to follow from the user's friends of friends.
+   *
+   * Every account followed by someone the user follows is scored by how many of the
+   * user's followees follow it; the user and accounts they already follow are left
+   * out. Results come from `precomputeSuggestions` while its follow graph is still
+   * current, and are computed on the spot otherwise.
+   *
+   * @param user_id The unique ID of the user to suggest accounts to.
+   * @param count The maximum number of suggestions.
+   * @return The suggestions, most mutual connections first, then highest influence
+   *         score from `rankUsers`, then lowest user ID.
+   */
+  std::vector<Pond::Suggestion> suggestFollows(
+    const int32_t& user_id,
+    const size_t& count
+  );
+
+  /**
+   * @brief Finds the shortest chain of follows leading from one user to another.
+   *
+   * @param user_id The user the chain starts from.
+   * @param target_id The user the chain leads to.
+   * @param max_depth The longest chain to look for, in follows.
+   * @return The user IDs along the chain, from `user_id` to `target_id`; its size minus
+   *         one is the degree of separation. Empty if no chain of at most `max_depth`
+   *         follows exists.
+   */
+  std::vector<int32_t> followDistance(
+    const int32_t& user_id,
+    const int32_t& target_id,
+    const int32_t& max_depth
+  );
+
+  /**
+   * @brief Computes follow suggestions for every user at once on a thread pool.
+   *
+   * The results serve `suggestFollows` calls for up to `count` suggestions until the
+   * follow graph next changes.
+   *
+   * @param count The number of suggestions to keep per user.
+   * @return The number of users who received at least one suggestion.
+   */
+  size_t precomputeSuggestions(
+    const size_t& count
+  );
+
+  /**
+   * @brief Scores every user's influence with PageRank over the follow graph and
+   *        stores the scores, replacing the previous run's.
+   *
+   * `searchForUsers` lists higher-scored users first and `suggestFollows` uses the
+   * scores to order accounts with the same number of mutual connections. The scores
+   * are not updated as follows change; rerun this as a periodic batch job.
+   *
+   * @param warm_start Start from the stored scores instead of uniform ones. After a
+   *                   modest number of follow changes this converges in fewer
+   *                   iterations.
+   * @return What the run did, or `nullopt` if the follows could not be read or the
+   *         scores could not be stored.
+   */
+  std::optional<Pond::RankReport> rankUsers(
+    const bool& warm_start
+  );
+
+  /**
+   * @brief Lists the quacks whose text is a near copy of `text`.
+   *
+   * Every quack is stored with a SimHash fingerprint of its text, and near copies are
+   * those whose fingerprints differ in at most `max_distance` of their 64 bits. Changes
+   * of case, punctuation or numbers leave the fingerprint as is; a one-word edit to a
+   * short quack usually moves it no more than `SimHashIndex::DEFAULT_DISTANCE` bits.
+   *
+   * @param text The text to look for, e.g. a quack about to be posted.
+   * @param max_distance At most `SimHashIndex::MAX_DISTANCE`.
+   * @param limit The maximum number of quacks.
+   * @return The quacks found, nearest first, then newest first.
+   */
+  std::vector<SimHashIndex::Match> findNearDuplicates(
+    const std::string& text,
+    const int& max_distance,
+    const size_t& limit
+  );
+
+  /**
+   * @brief Groups every quack in the database with its near copies, comparing in
+   *        parallel across cores.
+   *
+   * Quacks within `max_distance` fingerprint bits of each other, directly or through a
+   * chain of other quacks, end up in one group. Meant as a batch job over the whole
+   * table, e.g. to find spam campaigns after the fact.
+   *
+   * @param max_distance At most `SimHashIndex::MAX_DISTANCE`.
+   * @return The groups found, or `nullopt` if the fingerprints could not be read.
+   */
+  std::optional<Pond::DuplicateReport> duplicateReport(
+    const int& max_distance
+  );
+
+  /**
+   * @brief Lists the hashtags mentioned most over the last hour or day.
+   *
+   * Counts come from the hashtags of quacks posted within the day before the database
+   * was loaded plus those added through this Pond since; quacks posted through other
+   * connections show up after the next load.
+   *
+   * @param window The span of time to count mentions over.
+   * @param count The maximum number of hashtags.
+   * @return The hashtags, lower-cased, most mentions first, then alphabetically.
+   */
+  std::vector<Trending::Trend> trendingHashtags(
+    const Trending::Window& window,
+    const size_t& count
+  );
+
+  /**
+   * @brief Counts a hashtag's mentions per hour over a period.
+   *
+   * Reads only the hourly rollups, never the quacks themselves, so it stays cheap
+   * however long the period. Every hour that overlaps `[from_ts, to_ts)` is counted
+   * in full.
+   *
+   * @param hashtag The hashtag, in any case, with or without its '#'.
+   * @param from_ts The start of the period, in microseconds since the Unix epoch.
+   * @param to_ts The end of the period, exclusive.
+   * @return One count per hour with at least one mention, oldest first.
+   */
+  std::vector<Pond::HourlyCount> hashtagSeries(
+    const std::string& hashtag,
+    const int64_t& from_ts,
+    const int64_t& to_ts
+  );
+
+  /**
+   * @brief Lists the hashtags mentioned most over a period, from the hourly rollups.
+   *
+   * @param from_ts The start of the period, in microseconds since the Unix epoch;
+   *                every hour that overlaps the period is counted in full.
+   * @param to_ts The end of the period, exclusive.
+   * @param count The maximum number of hashtags.
+   * @return The hashtags, lower-cased, most mentions first, then alphabetically.
+   */
+  std::vector<Trending::Trend> topHashtags(
+    const int64_t& from_ts,
+    const int64_t& to_ts,
+    const size_t& count
+  );
+
+  /**
+   * @brief Recomputes the hourly hashtag rollups from every stored quack.
+   *
+   * The rollups are kept current as quacks are posted, and databases are backfilled
+   * when they are upgraded to the schema that adds them; this is for repairing them,
+   * e.g. after quacks were deleted.
+   *
+   * @return true if the rollups were rebuilt.
+   */
+  bool backfillHashtagRollups();
+
 private:
-  sqlite3* _db;
+  std::unique_ptr<Backend> _backend;
+  Recorder _recorder;
+  FollowGraph _graph;
+  std::optional<int64_t> _graph_version;  // the backend's followsVersion the graph reflects
+  std::unique_ptr<ThreadPool> _pool;      // started on first use
+  FollowGraph::PathSearch _path_search;
+  Trending _trending;
+  HashtagIndex _hashtag_index;
+  SearchIndex _search_index;
+  PrefixIndex _hashtag_completions;                   // weighted by mentions
+  PrefixIndex _name_completions;                      // weighted by quacks written
+  std::unordered_map<int32_t, std::string> _user_names;  // users in _name_completions
+  int32_t _last_usr = INT32_MIN;                      // the largest ID in _user_names
+  std::map<Recorder::Op, uint64_t> _timeouts;         // calls cut short by their deadline
+  SpamDetector _spam;                                 // write rates of recently active users
+  SimHashIndex _duplicates;                           // quack fingerprints, for near copies
+
+  struct CachedThread {
+    int32_t max_depth;
+    size_t limit;
+    Pond::Thread thread;
+    std::list<int32_t>::iterator recent;  // the root's place in _thread_lru
+  };
+  std::unordered_map<int32_t, CachedThread> _thread_cache;        // by root ID
+  std::list<int32_t> _thread_lru;                                 // cached roots, most recently read first
+  std::unordered_map<int32_t, std::vector<int32_t>> _thread_roots;  // quack ID -> cached roots showing it
+  std::optional<int32_t> _thread_last_tid;  // the largest quack ID the cache has seen replies up to
+
+  std::vector<std::vector<FollowGraph::Suggestion>> _suggestions;  // by user ID
+  size_t _suggestions_count = 0;
+  std::optional<int64_t> _suggestions_version;  // the graph version _suggestions were built from
+
+  /**
+   * @brief Returns the thread pool for graph computations, starting it on first use.
+   */
+  ThreadPool& _threads();
+
+  /**
+   * @brief Drops everything Pond derived from the previous backend and rebuilds it from
+   *        the current one, after a loader has switched backends.
+   */
+  void _resetIndexes();
+
+  /**
+   * @brief Brings the follow graph up to date with the backend.
+   *
+   * The graph is rebuilt from the backend's follow edges whenever its follow counter
+   * has moved past the version the graph was built or last updated at, e.g. because
+   * another connection followed or unfollowed someone.
+   *
+   * @return true if the graph is current; false if the backend could not be read.
+   */
+  bool _syncGraph();
+
+  /**
+   * @brief Passes the stored influence scores to the follow graph for ordering
+   *        suggestions.
+   */
+  void _loadInfluence();
+
+  /**
+   * @brief Refills the trending counters with the hashtags of the last day's quacks.
+   */
+  void _seedTrending();
+
+  /**
+   * @brief Counts the hashtags linked to a newly stored quack towards trending.
+   */
+  void _countMentions(int32_t tid, int64_t ts);
+
+  /**
+   * @brief Adds the hashtags linked since the index was last brought up to date.
+   */
+  void _syncHashtagIndex();
+
+  /**
+   * @brief Indexes the text of quacks posted since the search index was last brought
+   *        up to date.
+   */
+  void _syncSearchIndex();
+
+  /**
+   * @brief Adds the names of users created since the name completions were last
+   *        brought up to date.
+   */
+  void _syncUserNames();
+
+  /**
+   * @brief Adds the fingerprints of quacks posted since the near-duplicate index was last
+   *        brought up to date.
+   *
+   * @return false if the fingerprints could not be read.
+   */
+  bool _syncDuplicates();
+
+  /**
+   * @brief Returns true if the user has already requacked a near copy of the quack.
+   */
+  bool _requackedNearCopy(int32_t user_id, int32_t quack_id);
+
+  /**
+   * @brief Indexes a quack's text and, if it is new to the index, counts it towards its
+   *        writer's name completion.
+   */
+  void _indexQuack(int32_t tid, int32_t writer_id, int64_t ts, const std::string& text);
+
+  /**
+   * @brief Applies this Pond's own follow or unfollow to the graph.
+   *
+   * The change is applied in place when the backend's follow counter moved by exactly
+   * `expected_changes` since the graph was last current; otherwise another connection
+   * changed follows too, and the graph is left to be rebuilt on the next read.
+   */
+  void _updateGraph(int32_t flwer, int32_t flwee, bool following, int64_t expected_changes);
+
+  /**
+   * @brief Appends the matches of each keyword of a quack search in turn, stopping at
+   *        a keyword whose read the backend's deadline cut short.
+   */
+  void _searchQuackViews(const std::string& search_terms, Pond::QuackResults& results);
+
+  /**
+   * @brief Reads and formats a user's feed, bounding the feed read by `deadline` if set.
+   *
+   * @param truncated Set to whether the deadline cut the read short.
+   */
+  std::vector<std::string> _getFeed(int32_t user_id, const Deadline* deadline, bool& truncated);
+
+  /**
+   * @brief Drops the cached threads that show a quack, because it was replied to.
+   */
+  void _evictThreads(int32_t tid);
+
+  /**
+   * @brief Drops one cached thread by its root ID.
+   */
+  void _dropThread(int32_t root_tid);
+
+  /**
+   * @brief Drops the cached threads that quacks posted through other connections since
+   *        the last call replied to.
+   */
+  void _syncThreadCache();
+
+  /**
+   * @brief Empties the thread cache.
+   */
+  void _clearThreads();
 
 /**
  * @brief Generates a unique ID for a new user by determining the maximum existing user ID.
@@ -419,20 +1293,6 @@ private:
     int32_t& unique_id
   );
   
-  /**
-  * @brief Retrieves the current time in GMT as a formatted string (HH:MM:SS).
-  *
-  * @return A string representing the current time in "HH:MM:SS" format.
-  */
-  char* _getTime();
-  
-  /**
-  * @brief Retrieves the current date in GMT as a formatted string (YYYY-MM-DD).
-  *
-  * @return A string representing the current date in "YYYY-MM-DD" format.
-  */
-  char* _getDate();
-
   /**
    * @brief Checks if a list exists for a given user in the database.
    *
@@ -441,8 +1301,7 @@ private:
    * @param user_id The ID of the user who owns the list.
    * @return True if the list exists for the specified user, false otherwise.
    *
-   * @note If there is an error preparing the SQL statement, the function will
-   *       finalize the statement and return false.
+   * @note If the storage backend fails, the function returns false.
    */
   bool _listExists(
     const std::string& list_name,
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @class PrefixIndex
+ * @brief An in-process autocomplete index that completes a prefix to the most used
+ *        matching texts.
+ *
+ * Texts are keyed by their ASCII lower-case form in a compressed (radix) trie: each edge
+ * carries a run of bytes, and a node only branches where two keys diverge. Children are
+ * kept sorted by their first byte. Every node caches the `TOP` best entries of its
+ * subtree by weight, so completing a prefix walks the prefix once and copies out the
+ * cached list, however many texts share it.
+ *
+ * Weights only ever grow, which keeps the cached lists exact: an entry whose weight
+ * rises can only move up in the lists along its own path.
+ *
+ * The index is not synchronized; each `Pond` owns its own.
+ */
+class PrefixIndex
+{
+public:
+
+  /**
+   * @brief The number of completions cached per node, and so the most `complete` returns.
+   */
+  static constexpr size_t TOP = 8;
+
+  /**
+   * @brief A completion and how often it is used.
+   */
+  struct Completion {
+    std::string text;
+    int64_t weight;
+  };
+
+  /**
+   * @brief Adds `weight` uses to `text`, adding it with that weight if it is new.
+   *
+   * Texts that differ only in ASCII case share one entry, shown as first added.
+   *
+   * @param weight Zero to add a text without uses; negative weights are ignored.
+   */
+  void add(const std::string& text, int64_t weight);
+
+  /**
+   * @brief Returns the most used texts starting with `prefix` (in any case).
+   *
+   * @param count The number of completions wanted; at most `TOP` are returned.
+   * @return Up to `count` completions, most used first, then alphabetically.
+   */
+  std::vector<Completion> complete(const std::string& prefix, size_t count) const;
+
+  /**
+   * @brief Returns the number of distinct texts indexed.
+   */
+  size_t size() const { return _entries.size(); }
+
+  /**
+   * @brief Forgets every text.
+   */
+  void clear();
+
+private:
+
+  struct Entry {
+    std::string text;
+    std::string key;    // lower-cased text, for breaking weight ties
+    int64_t weight;
+  };
+
+  struct Node {
+    std::string label;                // the bytes on the edge from the parent
+    std::vector<uint32_t> children;   // by first byte of their label
+    int32_t entry = -1;               // the entry whose key ends here
+    std::vector<uint32_t> top;        // best entries in the subtree, best first
+  };
+
+  std::vector<Node> _nodes;     // _nodes[0] is the root
+  std::vector<Entry> _entries;
+
+  bool _better(uint32_t a, uint32_t b) const;
+  void _promote(Node& node, uint32_t entry);
+  int64_t _child(const Node& node, char first) const;
+};
@@ -3,6 +3,8 @@
 #include <cstdlib>
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <cctype>
 #include <regex>
 #include <vector>
 #include <sstream>
@@ -49,17 +51,18 @@ public:
    * a status code of ERROR_SQL.
    *
    * @param db_filename The name of the database file to load.
+   * @param record_filename Optional log file; when non-empty every Pond call made during
+   *        the session is recorded to it for later replay.
    *
    * @note Ensure that the provided `db_filename` points to a valid and
    * accessible database file to prevent the program from terminating.
    */
-  Quacker(const std::string& db_filename);
+  Quacker(const std::string& db_filename, const std::string& record_filename = "");
 
   /**
    * @brief Destructor for the Quacker class.
    *
-   * This destructor clears the console by executing the `clear` system command 
-   * and releases the memory allocated for the `_user_id` member variable.
+   * This destructor clears the console by executing the `clear` system command.
    */
   ~Quacker();
 
@@ -78,7 +81,7 @@ private:
    * @brief Displays the main start page for the Quacker application and prompts user actions.
    *
    * This function continually displays the main start page menu until the user logs in or exits.
-   * While `_user_id` remains `nullptr`, the menu provides options to log in, sign up, or exit the program.
+   * While `_user_id` remains empty, the menu provides options to log in, sign up, or exit the program.
    * Each option triggers the corresponding page or action.
    *
    * The menu options include:
@@ -139,6 +142,8 @@ private:
    * - Validates the input to ensure it is not empty before attempting to post.
    * - Attempts to post the Quack using the database. If successful, the user is notified.
    * - Handles errors during posting, such as issues with duplicate hashtags, and provides feedback.
+   * - A line ending in the start of a hashtag and a Tab lists the most mentioned hashtags
+   *   it could be; the chosen one completes it and the text is kept for further typing.
    */
   void postingPage();
 
@@ -152,6 +157,8 @@ private:
    * - Retrieves and displays search results based on the input query.
    * - Allows users to interact with search results by selecting a user to view or follow.
    * - Handles navigation through paginated search results.
+   * - A line ending in a Tab lists the names of the most active users starting with it
+   *   and searches for the one chosen.
    */
   void searchUsersPage();
 
@@ -171,6 +178,16 @@ private:
    */
   void searchQuacksPage();
 
+  /**
+   * @brief Shows the quacks best matching the words of `query`, one ranked page at a time.
+   *
+   * @details
+   * - Fetches each page from the search index by the cursor the previous page ended at.
+   * - Entering N shows the next page and P the previous one.
+   * - Selecting a quack (1,2,3,...) opens it to reply or requack.
+   */
+  void rankedSearchPage(const std::string& query);
+
   /**
    * @brief Displays a detailed user profile and allows interactions with the user's content.
    *
@@ -215,6 +232,12 @@ private:
    */
   void quackPage(const Pond::Quack& reply);
 
+  /**
+   * @brief Shows the conversation under a quack, each reply indented below the quack
+   *        it answers, a page at a time.
+   */
+  void threadPage(const Pond::Quack& root);
+
   /**
    * @brief Displays the list of followers and allows interaction with the follower profiles.
    *
@@ -229,6 +252,50 @@ private:
    * - Handles cases where there are no followers gracefully by displaying an appropriate message.
    */
   void followersPage();
+
+  /**
+   * @brief Suggests accounts to follow and lets the user open their profiles.
+   *
+   * This method lists the accounts most followed by the people the user follows, along
+   * with how many of them follow each account, and opens the profile of a selected
+   * account so it can be followed.
+   *
+   * @details
+   * - Retrieves the top suggestions for the logged-in user from the follow graph.
+   * - Displays each suggestion's user ID, name and number of mutual connections.
+   * - Validates the selection before opening the chosen profile.
+   */
+  void suggestionsPage();
+
+  /**
+   * @brief Shows the hashtags mentioned most over the last hour or the last day.
+   *
+   * @details
+   * - Starts on the last hour; entering H or D switches between the two windows.
+   * - Lists each hashtag with its number of mentions, most mentioned first.
+   */
+  void trendingPage();
+
+  /**
+   * @brief Shows the user's lists with their sizes, creates new ones and opens them.
+   *
+   * @details
+   * - Entering C asks for the name of a new list.
+   * - Selecting a list (1,2,3,...) opens its quacks.
+   */
+  void listsPage();
+
+  /**
+   * @brief Shows the quacks in one of the user's lists, most recent first, a page at
+   *        a time.
+   *
+   * @details
+   * - Fetches each page by the cursor the previous page ended at, so paging stays fast
+   *   in lists of any size.
+   * - Entering N shows the next page and P the previous one.
+   * - Selecting a quack (1,2,3,...) opens it to reply or requack.
+   */
+  void listPage(const std::string& list_name);
   
   /**
  * @brief Processes and formats the current user's feed for display.
@@ -325,6 +392,30 @@ private:
     const std::string& str
   );
 
+  /**
+   * @brief Checks whether a search combines hashtags (`#a #b`, `#a|#b`, `-#c`) rather
+   *        than listing comma-separated keywords.
+   *
+   * @param search_term The trimmed search input.
+   * @return true if every space-separated term is a hashtag, optionally prefixed with '-',
+   *         and the terms are combined with spaces, '|' or '-'.
+   */
+  bool isHashtagQuery(
+    const std::string& search_term
+  );
+
+  /**
+   * @brief Lists completions numbered from 1 and asks the user to pick one.
+   *
+   * @param completions The completions to list, best first.
+   * @param unit What each completion's weight counts, e.g. "mentions".
+   * @return The text of the chosen completion, or std::nullopt if the user pressed Enter.
+   */
+  std::optional<std::string> pickCompletion(
+    const std::vector<PrefixIndex::Completion>& completions,
+    const std::string& unit
+  );
+
   /**
    * @brief Formats a given text to wrap lines at a specified width.
    *
@@ -337,7 +428,7 @@ private:
    * @return A formatted string with line breaks added as necessary.
    */
   std::string formatTweetText(
-    const std::string& text, int line_width
+    std::string_view text, int line_width
     );
 
   /**
@@ -355,7 +446,7 @@ private:
   );
 
   Pond pond;
-  int32_t* _user_id = nullptr;
+  std::optional<int32_t> _user_id;
   bool logged_in = false;
   std::vector<int32_t> feed_quack_ids;
 
@@ -0,0 +1,424 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <sqlite3.h>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+/**
+ * Typed wrappers around the prepare/bind/step/finalize sequence every Pond query uses.
+ *
+ * A query is declared once as a type, with its SQL as a `constexpr char[]`:
+ *
+ * @code
+ * constexpr char SELECT_QUACKS_BY_WRITER[] = "SELECT ... WHERE writer_id = ?";
+ * using QuacksByWriter = sql::Query<SELECT_QUACKS_BY_WRITER, sql::Out<Pond::Quack>, sql::In<int32_t>>;
+ *
+ * std::vector<Pond::Quack> quacks;
+ * QuacksByWriter::all(db, quacks, user_id);
+ * @endcode
+ *
+ * The number of placeholders in the SQL is checked against `In<...>` at compile time, the
+ * `sqlite3_bind_*` calls are generated from the `In` types and rows are mapped by `Row<T>`,
+ * which callers specialize for their own structs.
+ */
+namespace sql {
+
+/**
+ * @brief The row type a query produces; `Out<void>` for statements that return no rows.
+ */
+template <typename T>
+struct Out {};
+
+/**
+ * @brief The types bound to the query's placeholders, in order.
+ */
+template <typename... Args>
+struct In {};
+
+/**
+ * @brief Counts the parameters a statement takes, the way SQLite numbers them.
+ *
+ * A bare `?` takes the number after the largest one seen so far and `?N` takes N, so
+ * `?1 ... ?1 ... ?2` counts as 2. Placeholders inside string literals are ignored.
+ */
+constexpr int countPlaceholders(const char* sql) {
+  int largest = 0;
+  bool in_literal = false;
+  for (const char* c = sql; *c; ++c) {
+    if (*c == '\'') {
+      in_literal = !in_literal;
+    } else if (*c == '?' && !in_literal) {
+      if (c[1] >= '0' && c[1] <= '9') {
+        int n = 0;
+        while (c[1] >= '0' && c[1] <= '9') {
+          n = n * 10 + (*++c - '0');
+        }
+        largest = n > largest ? n : largest;
+      } else {
+        ++largest;
+      }
+    }
+  }
+  return largest;
+}
+
+/**
+ * @brief Reads a text column without a `strlen`; NULL becomes an empty string.
+ */
+inline std::string columnText(sqlite3_stmt* stmt, int column) {
+  const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, column));
+  return text ? std::string(text, sqlite3_column_bytes(stmt, column)) : std::string();
+}
+
+/**
+ * @brief Binds one parameter; specialized per C++ type.
+ *
+ * Text is bound with `SQLITE_STATIC`: arguments outlive the statement, which is finalized
+ * before the query call returns, or which a `Cursor` keeps alongside its own copy of them.
+ */
+template <typename T>
+struct Bind;
+
+template <>
+struct Bind<int32_t> {
+  static int to(sqlite3_stmt* stmt, int index, int32_t value) {
+    return sqlite3_bind_int(stmt, index, value);
+  }
+};
+
+template <>
+struct Bind<int64_t> {
+  static int to(sqlite3_stmt* stmt, int index, int64_t value) {
+    return sqlite3_bind_int64(stmt, index, value);
+  }
+};
+
+template <>
+struct Bind<std::string> {
+  static int to(sqlite3_stmt* stmt, int index, const std::string& value) {
+    return sqlite3_bind_text(stmt, index, value.data(), static_cast<int>(value.size()), SQLITE_STATIC);
+  }
+};
+
+template <>
+struct Bind<std::optional<int32_t>> {
+  static int to(sqlite3_stmt* stmt, int index, const std::optional<int32_t>& value) {
+    return value ? sqlite3_bind_int(stmt, index, *value) : sqlite3_bind_null(stmt, index);
+  }
+};
+
+/**
+ * A list of IDs is bound as a JSON array, for statements that expand it with
+ * `IN (SELECT value FROM json_each(?))`. The text is built per call, so SQLite copies it.
+ */
+template <>
+struct Bind<std::vector<int32_t>> {
+  static int to(sqlite3_stmt* stmt, int index, const std::vector<int32_t>& values) {
+    std::string json(1, '[');
+    for (size_t i = 0; i < values.size(); ++i) {
+      if (i) {
+        json.push_back(',');
+      }
+      json += std::to_string(values[i]);
+    }
+    json.push_back(']');
+    return sqlite3_bind_text(stmt, index, json.data(), static_cast<int>(json.size()), SQLITE_TRANSIENT);
+  }
+};
+
+/**
+ * `(ID, value)` pairs are bound the same way, as a JSON array of two-element arrays for
+ * `json_each(?)`; values are written with enough digits to read back exactly.
+ */
+template <>
+struct Bind<std::vector<std::pair<int32_t, double>>> {
+  static int to(sqlite3_stmt* stmt, int index, const std::vector<std::pair<int32_t, double>>& values) {
+    std::string json(1, '[');
+    char number[32];
+    for (size_t i = 0; i < values.size(); ++i) {
+      std::snprintf(number, sizeof(number), "%s[%d,%.17g]", i ? "," : "", values[i].first, values[i].second);
+      json += number;
+    }
+    json.push_back(']');
+    return sqlite3_bind_text(stmt, index, json.data(), static_cast<int>(json.size()), SQLITE_TRANSIENT);
+  }
+};
+
+template <>
+struct Bind<const char*> {
+  static int to(sqlite3_stmt* stmt, int index, const char* value) {
+    return sqlite3_bind_text(stmt, index, value, -1, SQLITE_STATIC);
+  }
+};
+
+/**
+ * @brief Maps a result row to `T`; specialized per row type.
+ *
+ * Specializations provide `columns`, the number of leading columns they read, and
+ * `static T read(sqlite3_stmt*)`.
+ */
+template <typename T>
+struct Row;
+
+template <>
+struct Row<int32_t> {
+  static constexpr int columns = 1;
+  static int32_t read(sqlite3_stmt* stmt) { return sqlite3_column_int(stmt, 0); }
+};
+
+template <>
+struct Row<int64_t> {
+  static constexpr int columns = 1;
+  static int64_t read(sqlite3_stmt* stmt) { return sqlite3_column_int64(stmt, 0); }
+};
+
+template <>
+struct Row<std::string> {
+  static constexpr int columns = 1;
+  static std::string read(sqlite3_stmt* stmt) { return columnText(stmt, 0); }
+};
+
+/**
+ * @brief Appends rows of type `T` to a container; the default handles `std::vector<T>`.
+ *
+ * Specialize it for containers that take rows straight from the statement, such as
+ * arena-backed result sets.
+ */
+template <typename Container, typename T>
+struct Append {
+  static void reserve(Container& out, size_t rows) { out.reserve(out.size() + rows); }
+  static void row(Container& out, sqlite3_stmt* stmt) { out.push_back(Row<T>::read(stmt)); }
+};
+
+/**
+ * @brief An open statement whose rows are read a batch at a time, for results too large
+ *        to read at once.
+ *
+ * The statement stays prepared, holding a read on the database, until every row has
+ * been read, reading fails or the cursor is destroyed. A default-constructed cursor has
+ * no rows. Cursors must not outlive their connection.
+ */
+template <typename T>
+class Cursor
+{
+public:
+  Cursor() = default;
+
+  /**
+   * @brief Takes ownership of a prepared statement and of the arguments bound to it.
+   */
+  Cursor(sqlite3_stmt* stmt, std::shared_ptr<const void> args) : _stmt(stmt), _args(std::move(args)) {}
+
+  Cursor(Cursor&& other) noexcept
+    : _stmt(std::exchange(other._stmt, nullptr)), _args(std::move(other._args)), _failed(other._failed) {}
+
+  Cursor& operator=(Cursor&& other) noexcept {
+    if (this != &other) {
+      sqlite3_finalize(_stmt);
+      _stmt = std::exchange(other._stmt, nullptr);
+      _args = std::move(other._args);
+      _failed = other._failed;
+    }
+    return *this;
+  }
+
+  Cursor(const Cursor&) = delete;
+  Cursor& operator=(const Cursor&) = delete;
+
+  ~Cursor() { sqlite3_finalize(_stmt); }
+
+  /**
+   * @brief Steps the statement for up to `n` more rows and appends them to `out`.
+   *
+   * The statement is finalized as soon as it runs out of rows.
+   *
+   * @return false if stepping failed; the cursor is then done.
+   */
+  template <typename Container>
+  bool next(size_t n, Container& out) {
+    for (size_t rows = 0; rows < n && _stmt; ++rows) {
+      int rc = sqlite3_step(_stmt);
+      if (rc == SQLITE_ROW) {
+        Append<Container, T>::row(out, _stmt);
+        continue;
+      }
+      _failed = rc != SQLITE_DONE;
+      sqlite3_finalize(_stmt);
+      _stmt = nullptr;
+      _args.reset();
+    }
+    return !_failed;
+  }
+
+  /**
+   * @brief Returns true once there are no more rows to read.
+   *
+   * A cursor whose last batch ended exactly at the last row only becomes done on the
+   * next call to `next`.
+   */
+  bool done() const { return !_stmt; }
+
+private:
+  sqlite3_stmt* _stmt = nullptr;
+  std::shared_ptr<const void> _args;  // bound with SQLITE_STATIC, so kept until finalized
+  bool _failed = false;
+};
+
+template <const char* Sql, typename Output, typename Input = In<>>
+class Query;
+
+/**
+ * @brief A statement whose SQL, parameter types and row type are all fixed at compile time.
+ *
+ * Every call prepares, binds, steps and finalizes, so a `Query` holds no state beyond a
+ * row-count hint used to pre-size result vectors. All calls return false (or `nullopt`)
+ * if the statement cannot be prepared, a parameter cannot be bound, or stepping fails.
+ */
+template <const char* Sql, typename T, typename... Args>
+class Query<Sql, Out<T>, In<Args...>>
+{
+  static_assert(countPlaceholders(Sql) == sizeof...(Args),
+                "number of In<...> types does not match the placeholders in the SQL");
+
+public:
+
+  /**
+   * @brief Runs a statement that returns no rows.
+   *
+   * @return true if the statement ran to completion.
+   */
+  static bool exec(sqlite3* db, const Args&... args) {
+    static_assert(std::is_void<T>::value, "exec() is for Out<void> queries; use one/all/each");
+    sqlite3_stmt* stmt = _prepare(db, args...);
+    if (!stmt) {
+      return false;
+    }
+    bool done = sqlite3_step(stmt) == SQLITE_DONE;
+    sqlite3_finalize(stmt);
+    return done;
+  }
+
+  /**
+   * @brief Runs a query and maps its first row.
+   *
+   * @return The first row, or `nullopt` if there is none or the query failed.
+   */
+  static std::optional<T> one(sqlite3* db, const Args&... args) {
+    std::optional<T> result;
+    sqlite3_stmt* stmt = _prepare(db, args...);
+    if (!stmt) {
+      return result;
+    }
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+      result.emplace(Row<T>::read(stmt));
+    }
+    sqlite3_finalize(stmt);
+    return result;
+  }
+
+  /**
+   * @brief Runs a query and appends every row to `out`.
+   *
+   * `out` is reserved up front for as many rows as this query returned last time.
+   *
+   * @return true if every row was read.
+   */
+  template <typename Container>
+  static bool all(sqlite3* db, Container& out, const Args&... args) {
+    sqlite3_stmt* stmt = _prepare(db, args...);
+    if (!stmt) {
+      return false;
+    }
+    Append<Container, T>::reserve(out, _rows_hint.load(std::memory_order_relaxed));
+
+    size_t rows = 0;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+      Append<Container, T>::row(out, stmt);
+      ++rows;
+    }
+    sqlite3_finalize(stmt);
+    _rows_hint.store(rows, std::memory_order_relaxed);
+    return rc == SQLITE_DONE;
+  }
+
+  /**
+   * @brief Runs a query and passes every mapped row to `f`, for callers that consume
+   *        rows without keeping them.
+   *
+   * @return true if every row was read.
+   */
+  template <typename F>
+  static bool each(sqlite3* db, F&& f, const Args&... args) {
+    sqlite3_stmt* stmt = _prepare(db, args...);
+    if (!stmt) {
+      return false;
+    }
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+      f(Row<T>::read(stmt));
+    }
+    sqlite3_finalize(stmt);
+    return rc == SQLITE_DONE;
+  }
+
+  /**
+   * @brief Prepares and binds a query without stepping it, for reading its rows a
+   *        batch at a time.
+   *
+   * The arguments are copied into the cursor so they stay valid while it is open.
+   *
+   * @return The open cursor, or nullopt if the statement could not be prepared or bound.
+   */
+  static std::optional<Cursor<T>> open(sqlite3* db, const Args&... args) {
+    static_assert(!std::is_void<T>::value, "open() is for queries that return rows");
+    auto kept = std::make_shared<const std::tuple<Args...>>(args...);
+    sqlite3_stmt* stmt = std::apply([db](const Args&... bound) { return _prepare(db, bound...); }, *kept);
+    if (!stmt) {
+      return std::nullopt;
+    }
+    return Cursor<T>(stmt, std::move(kept));
+  }
+
+private:
+
+  /**
+   * @brief Prepares the statement, checks it yields enough columns for `Row<T>` and binds
+   *        `args` to ?1..?N.
+   *
+   * @return The statement, or nullptr (with nothing left to finalize) on failure.
+   */
+  static sqlite3_stmt* _prepare(sqlite3* db, const Args&... args) {
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, Sql, -1, &stmt, nullptr) != SQLITE_OK) {
+      sqlite3_finalize(stmt);
+      return nullptr;
+    }
+
+    bool ok = true;
+    if constexpr (!std::is_void<T>::value) {
+      ok = sqlite3_column_count(stmt) >= Row<T>::columns;
+    }
+    int index = 0;
+    ok = ok && (... && (Bind<Args>::to(stmt, ++index, args) == SQLITE_OK));
+    (void)index;
+
+    if (!ok) {
+      sqlite3_finalize(stmt);
+      return nullptr;
+    }
+    return stmt;
+  }
+
+  inline static std::atomic<size_t> _rows_hint{0};
+};
+
+} // namespace sql
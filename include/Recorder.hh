@@ -0,0 +1,226 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @class Recorder
+ * @brief Captures every public Pond call into a compact binary log for later replay.
+ *
+ * The log starts with the 4 byte magic `QKLG` followed by a one byte format version.
+ * Every call is then appended as one record:
+ *
+ * - `op`          (1 byte)  which Pond method was called
+ * - `delta_us`    (varint)  microseconds since the previous record started
+ * - `duration_us` (varint)  how long the call took
+ * - `result_size` (varint)  rows returned, or 1/0 for success/failure of writes
+ * - `arg_count`   (1 byte)  followed by each argument as a tag byte and its payload
+ *
+ * Integers are zigzag varints and strings are a varint length followed by the raw bytes,
+ * so a typical call costs a couple dozen bytes. Only the outermost call is recorded:
+ * methods Pond calls internally (e.g. `addHashtag` from `addQuack`) are replayed implicitly.
+ *
+ * Passwords are never written. They are recorded as a `Secret`, a run of `SECRET_CHAR`
+ * of the same length, so a log captured in production can be shared and replayed
+ * without the credentials it was captured with.
+ */
+class Recorder
+{
+public:
+
+  /**
+   * @brief Identifies the Pond method a record belongs to.
+   *
+   * @note Values are written to disk; append new methods at the end and never renumber.
+   */
+  enum class Op : uint8_t {
+    AddUser = 1,
+    AddHashtag,
+    ValidateQuack,
+    AddQuack,
+    AddReply,
+    AddRequack,
+    AddToList,
+    CreateList,
+    CheckLogin,
+    Follow,
+    Unfollow,
+    SearchForUsers,
+    SearchForQuacks,
+    GetFeed,
+    GetRequackCount,
+    GetReplies,
+    GetUsername,
+    GetQuackFromID,
+    GetFollowers,
+    GetFollows,
+    GetQuacks,
+    SearchQuackViews,
+    GetQuackViews,
+    GetQuackViewFromID,
+    SuggestFollows,
+    PrecomputeSuggestions,
+    FollowDistance,
+    RankUsers,
+    TrendingHashtags,
+    HashtagSeries,
+    TopHashtags,
+    BackfillHashtagRollups,
+    SearchHashtags,
+    SearchRanked,
+    OpenQuackSearch,
+    OpenUserSearch,
+    CountQuackMatches,
+    CountUserMatches,
+    CompleteHashtag,
+    CompleteUsername,
+    SearchForUsersWithin,
+    SearchForQuacksWithin,
+    SearchQuackViewsWithin,
+    GetFeedWithin,
+    GetThread,
+    GetLists,
+    GetListQuacks,
+    AddRequacks,
+    FindNearDuplicates,
+    DuplicateReport
+  };
+
+  /**
+   * @brief Stands in for every character of a `Secret` argument in the log.
+   */
+  static constexpr char SECRET_CHAR = '*';
+
+  /**
+   * @brief Wraps a `Call` argument whose value must not reach the log, e.g. a password.
+   *        It is recorded as text of the same length made of `SECRET_CHAR`.
+   */
+  struct Secret {
+    const std::string& value;
+  };
+
+  /**
+   * @brief A single recorded argument, either an integer or a text value.
+   */
+  struct Arg {
+    bool is_text;
+    int64_t number;
+    std::string text;
+  };
+
+  /**
+   * @brief A decoded log record.
+   */
+  struct Entry {
+    Op op;
+    int64_t offset_us;     // microseconds since the first record of the log
+    uint32_t duration_us;
+    uint32_t result_size;
+    std::vector<Arg> args;
+  };
+
+  /**
+   * @class Call
+   * @brief Scoped guard that times one Pond call and appends it to the log when it ends.
+   *
+   * Arguments are only encoded when a log is open, so a disabled recorder costs a
+   * pointer check per call.
+   */
+  class Call
+  {
+  public:
+    template <typename... Args>
+    Call(Recorder* recorder, Op op, const Args&... args)
+      : _owner(recorder),
+        _recorder(recorder && recorder->isOpen() && recorder->_depth == 0 ? recorder : nullptr) {
+      if (_owner) {
+        ++_owner->_depth;
+      }
+      if (_recorder) {
+        _op = op;
+        _start = std::chrono::steady_clock::now();
+        _started_at = Recorder::_wallMicros();
+        _arg_count = sizeof...(Args);
+        (_encode(args), ...);
+      }
+    }
+
+    ~Call();
+
+    Call(const Call&) = delete;
+    Call& operator=(const Call&) = delete;
+
+    /**
+     * @brief Sets the result size written for this call (defaults to 0).
+     */
+    void result(size_t size) { _result_size = static_cast<uint32_t>(size); }
+
+  private:
+    void _encode(int64_t value);
+    void _encode(const std::string& value);
+    void _encode(const Secret& secret);  // text of SECRET_CHAR, as long as the secret
+    void _encode(const std::vector<std::pair<int32_t, int32_t>>& pairs);  // text "a:b,c:d"
+
+    Recorder* _owner;
+    Recorder* _recorder;
+    Op _op = Op::AddUser;
+    std::chrono::steady_clock::time_point _start;
+    int64_t _started_at = 0;
+    uint8_t _arg_count = 0;
+    uint32_t _result_size = 0;
+    std::string _args;
+  };
+
+  Recorder();
+  ~Recorder();
+
+  Recorder(const Recorder&) = delete;
+  Recorder& operator=(const Recorder&) = delete;
+
+  /**
+   * @brief Creates the log file at the given path, replacing any existing log.
+   *
+   * @param path The log file to write.
+   * @return true if the log was opened; false otherwise.
+   */
+  bool open(const std::string& path);
+
+  /**
+   * @brief Flushes and closes the log, if one is open.
+   */
+  void close();
+
+  /**
+   * @brief Returns whether calls are currently being recorded.
+   */
+  bool isOpen() const { return _file != nullptr; }
+
+  /**
+   * @brief Reads every record of a log file.
+   *
+   * @param path The log file to read.
+   * @param[out] entries The decoded records, in recording order.
+   * @return true if the file was a valid log; false otherwise. A truncated final
+   *         record (e.g. from a crash) is ignored rather than treated as an error.
+   */
+  static bool readLog(const std::string& path, std::vector<Entry>& entries);
+
+  /**
+   * @brief Returns the Pond method name for an op, for reports.
+   */
+  static const char* opName(Op op);
+
+private:
+  static int64_t _wallMicros();
+  void _write(Op op, int64_t started_at, uint32_t duration_us, uint32_t result_size,
+              uint8_t arg_count, const std::string& args);
+
+  std::FILE* _file;
+  int64_t _last_started_at;
+  int _depth;
+};
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class SearchIndex
+ * @brief An in-process full-text index over quack text that ranks matches by BM25 with a
+ *        boost for recent quacks.
+ *
+ * Text is split into lower-cased words, so a hashtag also matches its bare word. Every
+ * word has a posting list of `(quack ID, term frequency)` in ascending ID order, stored
+ * as blocks of up to 128 postings in varint form. Each block records the largest term
+ * frequency, the shortest quack and the newest timestamp among its postings, which
+ * bound the score of anything inside it.
+ *
+ * A search walks the query's posting lists together from the newest quack backwards and
+ * keeps only the best `k` matches in a bounded heap. Once the heap is full, any stretch
+ * where the blocks' bounds cannot beat the worst match kept is skipped without decoding,
+ * so work and memory stay close to flat however common a word is.
+ *
+ * The index is not synchronized; each `Pond` owns one.
+ */
+class SearchIndex
+{
+public:
+
+  /**
+   * @brief A ranked match.
+   */
+  struct Hit {
+    int32_t tid;
+    double score;
+  };
+
+  /**
+   * @brief Where a page of results ended, for fetching the page after it.
+   */
+  struct Cursor {
+    double score;  // the last hit of the page
+    int32_t tid;
+    int64_t now;   // the time the page was scored at, so later pages score the same way
+  };
+
+  /**
+   * @brief Splits text into the lower-cased words the index is built from.
+   *
+   * Words are runs of ASCII letters and digits and of non-ASCII bytes.
+   */
+  static void tokenize(const std::string& text, std::vector<std::string>& out);
+
+  /**
+   * @brief Indexes a quack; indexing the same ID again changes nothing.
+   *
+   * @param ts The quack's timestamp, in microseconds since the Unix epoch.
+   * @return true if the quack was new to the index.
+   */
+  bool add(int32_t tid, int64_t ts, const std::string& text);
+
+  /**
+   * @brief Returns the best matches for any of the words in `query`.
+   *
+   * @param k The number of matches to return.
+   * @param now Microseconds since the Unix epoch that recency is measured from.
+   * @param after When set, only matches ranked below this cursor are considered, and
+   *              its `now` is used in place of `now`.
+   * @return Up to `k` matches, highest score first, then newest ID.
+   */
+  std::vector<Hit> search(const std::string& query, size_t k, int64_t now, const Cursor* after = nullptr) const;
+
+  /**
+   * @brief Returns the largest quack ID indexed, or `INT32_MIN` if the index is empty.
+   */
+  int32_t lastTid() const { return _last_tid; }
+
+  /**
+   * @brief Forgets every quack.
+   */
+  void clear();
+
+private:
+
+  struct Document {
+    int64_t ts = 0;
+    uint32_t length = 0;   // words
+    bool indexed = false;
+  };
+
+  /**
+   * @brief One posting: a quack and how often it uses the word.
+   */
+  struct Entry {
+    int32_t tid;
+    uint32_t tf;
+  };
+
+  /**
+   * @brief One word's postings, ascending by quack ID, in blocks with score bounds.
+   */
+  class Postings
+  {
+  public:
+    struct Block {
+      int32_t first;        // quack ID of the first posting
+      uint32_t offset;      // start of the block in _data
+      uint32_t max_tf;
+      uint32_t min_length;
+      int64_t max_ts;
+    };
+
+    /**
+     * @brief Appends a posting for an ID larger than any in the list.
+     */
+    void append(int32_t tid, uint32_t tf, const Document& document);
+
+    /**
+     * @brief Appends the postings of one block, ascending.
+     */
+    void decodeBlock(size_t block, std::vector<Entry>& out) const;
+
+    /**
+     * @brief Appends every posting, ascending.
+     */
+    void decode(std::vector<Entry>& out) const;
+
+    void clear();
+
+    const std::vector<Block>& blocks() const { return _blocks; }
+    size_t size() const { return _size; }
+    int32_t last() const { return _last; }
+
+  private:
+    static constexpr size_t BLOCK = 128;
+
+    std::vector<Block> _blocks;
+    std::vector<uint8_t> _data;  // per posting: varint gap from the previous ID (none for a
+                                 // block's first) and varint term frequency
+    size_t _size = 0;
+    int32_t _last = 0;
+  };
+
+  std::unordered_map<std::string, Postings> _postings;  // word -> quacks using it
+  std::vector<Document> _documents;                     // by quack ID
+  size_t _document_count = 0;
+  uint64_t _total_length = 0;
+  int32_t _last_tid = INT32_MIN;
+};
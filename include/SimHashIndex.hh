@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class ThreadPool;
+
+/**
+ * @class SimHashIndex
+ * @brief Finds quacks whose text is a near copy of another's, by the Hamming distance
+ *        between 64-bit SimHash fingerprints.
+ *
+ * A fingerprint sums a hash of every word of the text into 64 signed counters and keeps
+ * the sign of each, so texts sharing most of their words share most of their bits. Words
+ * are lower-cased as for search, and any word containing a digit counts as the same
+ * placeholder, so copies that only differ in numbers fingerprint the same.
+ *
+ * Distinct fingerprints are split into four 16-bit bands, with a bucket of fingerprints
+ * per band value. Two fingerprints at most `MAX_DISTANCE` bits apart differ in at most
+ * `PROBE_BITS` bits of at least one band, so a lookup compares against the buckets of
+ * every value within `PROBE_BITS` bits of each of the query's bands, 137 per band, and
+ * still finds every match within that distance. Quacks sharing a fingerprint share one
+ * entry, so a flood of identical copies does not grow the buckets. The buckets of all
+ * 65536 values of every band are allocated with the first quack, about 6 MB.
+ *
+ * The index is not synchronized; each `Pond` owns one.
+ */
+class SimHashIndex
+{
+public:
+
+  static constexpr int BANDS = 4;
+  static constexpr int BAND_BITS = 64 / BANDS;
+  static constexpr int PROBE_BITS = 2;                               // band bits a lookup flips
+  static constexpr int MAX_DISTANCE = BANDS * (PROBE_BITS + 1) - 1;  // the furthest lookups are exact for
+
+  /**
+   * @brief The default distance for near copies. A one-word edit to a short quack moves
+   *        its fingerprint 9 bits at the median and within this distance about 70% of
+   *        the time, while unrelated quacks are around 32 bits apart and rarely under 14.
+   */
+  static constexpr int DEFAULT_DISTANCE = 10;
+
+  /**
+   * @brief A quack near the one looked up.
+   */
+  struct Match {
+    int32_t tid;
+    int distance;  // differing fingerprint bits
+  };
+
+  /**
+   * @brief Computes the SimHash fingerprint of a quack's text.
+   */
+  static uint64_t fingerprint(const std::string& text);
+
+  /**
+   * @brief Returns the number of bits two fingerprints differ in.
+   */
+  static int distance(uint64_t a, uint64_t b) { return __builtin_popcountll(a ^ b); }
+
+  /**
+   * @brief Indexes a quack; indexing the same ID again changes nothing.
+   *
+   * @return true if the quack was new to the index.
+   */
+  bool add(int32_t tid, uint64_t fingerprint);
+
+  /**
+   * @brief Looks up the fingerprint of an indexed quack.
+   *
+   * @return false if the quack is not indexed.
+   */
+  bool fingerprintOf(int32_t tid, uint64_t& fingerprint) const;
+
+  /**
+   * @brief Appends the quacks within `max_distance` bits of `fingerprint`, nearest
+   *        first and newest first among equals.
+   *
+   * @param max_distance Clamped to `MAX_DISTANCE`.
+   * @param limit The most matches to append.
+   */
+  void near(uint64_t fingerprint, int max_distance, size_t limit, std::vector<Match>& out) const;
+
+  /**
+   * @brief Groups every indexed quack with its near copies, comparing buckets on `pool`.
+   *
+   * Quacks within `max_distance` bits of each other are linked, and a group is everything
+   * linked directly or through other quacks, so a chain of small edits ends up in one
+   * group.
+   *
+   * @param max_distance Clamped to `MAX_DISTANCE`.
+   * @return The groups of two or more quacks, largest first, each in ascending ID order.
+   */
+  std::vector<std::vector<int32_t>> clusters(int max_distance, ThreadPool& pool) const;
+
+  /**
+   * @brief Returns the largest quack ID indexed, or INT32_MIN if none.
+   */
+  int32_t lastTid() const { return _last_tid; }
+
+  /**
+   * @brief Returns the number of quacks indexed.
+   */
+  size_t size() const { return _fingerprints.size(); }
+
+  /**
+   * @brief Returns the number of distinct fingerprints indexed.
+   */
+  size_t fingerprints() const { return _quacks.size(); }
+
+  /**
+   * @brief Forgets every quack.
+   */
+  void clear();
+
+private:
+  std::unordered_map<int32_t, uint64_t> _fingerprints;         // tid -> fingerprint
+  std::unordered_map<uint64_t, std::vector<int32_t>> _quacks;  // fingerprint -> tids
+  std::vector<std::vector<uint64_t>> _buckets[BANDS];          // distinct fingerprints by band value
+  int32_t _last_tid = INT32_MIN;
+
+  static uint16_t _band(uint64_t fingerprint, int band) {
+    return static_cast<uint16_t>(fingerprint >> (BAND_BITS * band));
+  }
+  static bool _probedEarlierBand(uint64_t a, uint64_t b, int band);
+};
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @class SpamDetector
+ * @brief Tracks how fast each user quacks, requacks and follows, to flag users writing
+ *        faster than a person would.
+ *
+ * Rates are per minute over a sliding window, estimated the usual way from two
+ * one-minute counters: the current minute's count plus the previous minute's, weighted
+ * by how much of it still falls within the last sixty seconds.
+ *
+ * Users live in a fixed-size, open-addressed table of atomic counters, so memory is
+ * constant and recording a write is a hash, a few probes and an atomic add, without
+ * locks or allocation. A user whose slot has been idle for two minutes has no rate
+ * left, so that slot can go to someone else. When every nearby slot is taken by an
+ * active user, the new user is not tracked. Concurrent writes are all counted, but the
+ * previous minute's count is only stored just after its counter rolls over, so a check
+ * racing the rollover can briefly read low.
+ */
+class SpamDetector
+{
+public:
+
+  /**
+   * @brief The kinds of writes counted separately.
+   */
+  enum class Write {
+    Quack,    // quacks and replies
+    Requack,
+    Follow
+  };
+
+  /**
+   * @brief The most writes of each kind per minute before a user is flagged.
+   */
+  struct Limits {
+    uint32_t quacks = 20;
+    uint32_t requacks = 30;
+    uint32_t follows = 50;
+  };
+
+  /**
+   * @brief A detector tracking up to `capacity` active users, rounded up to a power of
+   *        two of at least eight.
+   */
+  explicit SpamDetector(size_t capacity = 4096);
+
+  SpamDetector(const SpamDetector&) = delete;
+  SpamDetector& operator=(const SpamDetector&) = delete;
+
+  /**
+   * @brief Counts one write by `user_id` at `ts`.
+   *
+   * @param ts Microseconds since the Unix epoch, as in `Clock::Stamp::ts`.
+   * @return true if the user is now over the limit for any kind of write.
+   */
+  bool record(int32_t user_id, Write write, int64_t ts);
+
+  /**
+   * @brief Returns true if `user_id` is over the limit for any kind of write at `ts`,
+   *        without counting a write.
+   */
+  bool flagged(int32_t user_id, int64_t ts) const;
+
+  /**
+   * @brief Returns the current limits.
+   */
+  Limits limits() const;
+
+  /**
+   * @brief Replaces the limits; safe while other threads record writes.
+   */
+  void setLimits(const Limits& limits);
+
+  /**
+   * @brief Forgets every user. Not safe while other threads record writes.
+   */
+  void clear();
+
+private:
+  static constexpr int32_t EMPTY = INT32_MIN;  // never a user ID
+  static constexpr size_t KINDS = 3;
+  static constexpr size_t PROBES = 8;          // slots tried per user before giving up
+
+  // One user's counters, on its own cache line so users written from different threads
+  // do not contend
+  struct alignas(64) Slot {
+    std::atomic<int32_t> user{EMPTY};
+    std::atomic<uint64_t> current[KINDS];   // minute << 32 | writes within that minute
+    std::atomic<uint32_t> previous[KINDS];  // writes within the minute before it
+  };
+
+  std::unique_ptr<Slot[]> _slots;
+  size_t _mask;
+  unsigned _shift;  // 64 - log2(slots), for Fibonacci hashing
+  std::atomic<uint32_t> _limits[KINDS];
+
+  const Slot* _find(int32_t user_id) const;
+  Slot* _claim(int32_t user_id, uint32_t minute);
+  uint32_t _rate(const Slot& slot, size_t kind, int64_t ts) const;
+  bool _over(const Slot& slot, int64_t ts) const;
+};
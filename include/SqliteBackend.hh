@@ -0,0 +1,154 @@
+#pragma once
+
+#include <cstdio>
+#include <iostream>
+#include <sqlite3.h>
+#include <string>
+#include <unordered_map>
+
+#include "Backend.hh"
+#include "Query.hh"
+
+/**
+ * @class SqliteBackend
+ * @brief Stores Pond's data in a Quacker SQLite database file (see `schema.sql`).
+ *
+ * Every operation is one typed `sql::Query`, except the follow counter Pond reads before
+ * every follow graph access, which stays prepared. Opening a file brings its schema up to
+ * date with the migrations in `SqliteBackend.cc`.
+ *
+ * Hashtags are stored as integer IDs into a dictionary of lower-cased terms. The backend
+ * caches every ID it has read, so adding or searching a known hashtag never consults
+ * the dictionary table.
+ */
+class SqliteBackend : public Backend
+{
+public:
+
+  /**
+   * @brief Constructs a backend with no open connection; every operation fails until
+   *        `open` succeeds.
+   */
+  SqliteBackend();
+
+  /**
+   * @brief Closes the connection if one was opened.
+   */
+  ~SqliteBackend() override;
+
+  SqliteBackend(const SqliteBackend&) = delete;
+  SqliteBackend& operator=(const SqliteBackend&) = delete;
+
+  /**
+   * @brief Opens a connection to the SQLite database specified by the filename and runs
+   *        any pending schema migrations.
+   *
+   * @param db_filename The name of the database file to open.
+   * @return int Returns SQLITE_OK (0) if the database was successfully opened,
+   *         or a non-zero SQLite error code if it failed.
+   */
+  int open(const std::string& db_filename);
+
+  /**
+   * @brief Bounds the reads that follow by `deadline` through a progress handler that
+   *        interrupts the running statement once it has expired.
+   */
+  void setDeadline(const Deadline* deadline) override;
+
+  bool insertUser(int32_t usr, const std::string& name, const std::string& email,
+                  int64_t phone, const std::string& pwd) override;
+  std::optional<int32_t> maxUserID() override;
+  std::optional<int32_t> checkLogin(int32_t usr, const std::string& pwd) override;
+  bool searchUsers(const std::string& search_terms, std::vector<Pond::User>& out) override;
+  std::unique_ptr<RowStream<std::vector<Pond::User>>> streamUsers(const std::string& search_terms) override;
+  std::optional<int64_t> countUsers(const std::string& search_terms) override;
+  std::optional<std::string> username(int32_t usr) override;
+  bool usersByID(const std::vector<int32_t>& usrs, std::vector<Pond::User>& out) override;
+  bool usersFrom(int32_t first_usr, std::vector<Pond::User>& out) override;
+
+  bool insertFollow(int32_t flwer, int32_t flwee, const char* start_date) override;
+  bool deleteFollow(int32_t flwer, int32_t flwee) override;
+  bool followEdges(std::vector<std::pair<int32_t, int32_t>>& out) override;
+  std::optional<int64_t> followsVersion() override;
+
+  bool insertQuack(int32_t tid, int32_t writer_id, const std::string& text, uint64_t simhash,
+                   const Clock::Stamp& now, std::optional<int32_t> replyto_tid) override;
+  std::optional<int32_t> maxQuackID() override;
+  bool quackByID(int32_t tid, Pond::QuackResults& out) override;
+  bool quacksByID(const std::vector<int32_t>& tids, Pond::QuackResults& out) override;
+  bool quacksFrom(int32_t first_tid, size_t limit, Pond::QuackResults& out) override;
+  bool simhashesFrom(int32_t first_tid, size_t limit, std::vector<std::pair<int32_t, uint64_t>>& out) override;
+  bool quacksByWriter(int32_t writer_id, Pond::QuackResults& out) override;
+  bool replies(int32_t tid, std::vector<int32_t>& out) override;
+  bool thread(int32_t root_tid, int32_t max_depth, size_t limit, Pond::QuackResults& out,
+              std::vector<int32_t>& depths) override;
+  bool feed(const std::vector<int32_t>& followees, std::vector<FeedEntry>& out) override;
+  bool searchQuacksByHashtag(const std::string& pattern, Pond::QuackResults& out,
+                             const std::unordered_set<int32_t>& seen) override;
+  bool searchQuacksByWord(const std::string& keyword, Pond::QuackResults& out,
+                          std::unordered_set<int32_t>& seen) override;
+  std::unique_ptr<RowStream<Pond::QuackResults>> streamQuacksByHashtag(const std::string& pattern) override;
+  std::unique_ptr<RowStream<Pond::QuackResults>> streamQuacksByWord(const std::string& keyword) override;
+  std::optional<int64_t> countQuacksByHashtag(const std::string& pattern) override;
+  std::optional<int64_t> countQuacksByWord(const std::string& keyword) override;
+  bool hashtagMentionsSince(int64_t since, std::vector<std::pair<int64_t, std::string>>& out) override;
+  bool hashtagMentionsFrom(int32_t first_tid, std::vector<std::pair<int32_t, std::string>>& out) override;
+  bool hashtagsOf(int32_t tid, std::vector<std::string>& out) override;
+  bool hashtagHours(const std::string& term, int64_t from_hour, int64_t to_hour,
+                    std::vector<std::pair<int64_t, int64_t>>& out) override;
+  bool topHashtagsBetween(int64_t from_hour, int64_t to_hour, size_t limit,
+                          std::vector<std::pair<std::string, int64_t>>& out) override;
+  bool rebuildHashtagRollups() override;
+
+  std::optional<int32_t> upsertRequack(int32_t tid, int32_t retweeter_id, int32_t spam,
+                                       const Clock::Stamp& now) override;
+  bool upsertRequacks(const std::vector<RequackWrite>& requacks, const Clock::Stamp& now,
+                      std::vector<int32_t>& out) override;
+  std::optional<int32_t> requackCount(int32_t tid) override;
+  std::optional<bool> requackedAny(int32_t retweeter_id, const std::vector<int32_t>& tids) override;
+
+  std::optional<bool> insertHashtag(int32_t tid, const std::string& term) override;
+
+  bool insertList(int32_t owner_id, const std::string& lname) override;
+  bool insertListEntry(int32_t owner_id, const std::string& lname, int32_t tid) override;
+  bool listExists(int32_t owner_id, const std::string& lname) override;
+  bool lists(int32_t owner_id, std::vector<Pond::ListSummary>& out) override;
+  bool listQuacks(int32_t owner_id, const std::string& lname, const std::optional<Pond::ListCursor>& after,
+                  size_t limit, Pond::QuackResults& out) override;
+
+  bool userRanks(std::vector<std::pair<int32_t, double>>& out) override;
+  bool replaceUserRanks(const std::vector<std::pair<int32_t, double>>& ranks) override;
+
+  /**
+   * @brief Writes a compacted copy of the database to `filename` with `VACUUM INTO`,
+   *        through a temporary file renamed over it, and refuses the open database's
+   *        own file.
+   */
+  bool snapshot(const std::string& filename) override;
+
+  std::string lastError() const override;
+
+private:
+  sqlite3* _db;
+  sqlite3_stmt* _follows_version;  // kept prepared; see followsVersion
+  std::unordered_map<std::string, int64_t> _term_ids;  // lower(term) -> hashtags.term_id
+
+  /**
+   * @brief Brings the database schema up to date by running any pending migrations.
+   *
+   * Migrations are tracked with `PRAGMA user_version`; each one runs in its own
+   * transaction together with the version bump.
+   *
+   * @return true if the schema is current; false if a migration failed.
+   */
+  bool _migrate();
+
+  /**
+   * @brief Resolves a lower-cased hashtag to its dictionary ID, caching the answer.
+   *
+   * @param create Add the hashtag to the dictionary if it is missing.
+   * @param term_id Set to the ID; left empty if the hashtag is missing and `create` is unset.
+   * @return false if the database failed.
+   */
+  bool _termID(const std::string& folded, bool create, std::optional<int64_t>& term_id);
+};
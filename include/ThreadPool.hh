@@ -0,0 +1,64 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class ThreadPool
+ * @brief A fixed set of worker threads for splitting one computation across cores.
+ *
+ * The pool exposes a single blocking primitive, `parallelFor`, which hands out chunks
+ * of an index range to the workers and to the calling thread. Because the caller
+ * always works through the range itself, a `parallelFor` issued from inside another
+ * one cannot deadlock, and a pool with no workers simply runs everything inline.
+ */
+class ThreadPool
+{
+public:
+
+  /**
+   * @brief Starts the worker threads.
+   *
+   * @param threads The total number of threads to use, counting the caller of
+   *                `parallelFor`; 0 means one per hardware thread.
+   */
+  explicit ThreadPool(size_t threads = 0);
+
+  /**
+   * @brief Finishes queued work and joins the workers.
+   */
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /**
+   * @brief Returns the number of threads `parallelFor` spreads work over, including
+   *        the caller.
+   */
+  size_t size() const { return _workers.size() + 1; }
+
+  /**
+   * @brief Calls `body(begin, end)` over disjoint chunks covering `[0, n)` and waits
+   *        for all of them to finish.
+   *
+   * @param n The size of the index range.
+   * @param chunk The number of indexes per chunk; 0 picks about four chunks per thread.
+   * @param body The work for one chunk; called concurrently from several threads.
+   */
+  void parallelFor(size_t n, size_t chunk, const std::function<void(size_t, size_t)>& body);
+
+private:
+  std::vector<std::thread> _workers;
+  std::deque<std::function<void()>> _tasks;
+  std::mutex _mutex;
+  std::condition_variable _ready;
+  bool _stopping = false;
+
+  void _work();
+};
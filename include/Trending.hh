@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class Trending
+ * @brief Counts hashtag mentions over sliding windows of the last hour and the last day.
+ *
+ * Each window is a ring of time buckets (sixty one-minute buckets for the hour,
+ * twenty-four one-hour buckets for the day) holding per-hashtag counts, plus a running
+ * total per hashtag across the ring. A mention adds to the current bucket and the
+ * totals; when time moves past a bucket its counts are subtracted from the totals and
+ * the bucket is reused, so the totals always cover the whole buckets that make up the
+ * window. Memory is bounded by the distinct hashtags mentioned within a day.
+ *
+ * Hashtags are counted case-insensitively. The counter is not synchronized; each `Pond`
+ * owns one.
+ */
+class Trending
+{
+public:
+
+  /**
+   * @brief The span of time mentions are counted over.
+   */
+  enum class Window {
+    Hour,
+    Day
+  };
+
+  /**
+   * @brief A hashtag and how often it was mentioned within the window.
+   */
+  struct Trend {
+    std::string hashtag;  // lower-cased, with its '#'
+    uint32_t mentions;
+  };
+
+  /**
+   * @brief Counts one mention of `hashtag` at `ts`.
+   *
+   * Mentions may arrive slightly out of order; those older than the window are ignored.
+   *
+   * @param ts Microseconds since the Unix epoch, as in `Clock::Stamp::ts`.
+   */
+  void add(const std::string& hashtag, int64_t ts);
+
+  /**
+   * @brief Returns the most mentioned hashtags within `window` up to `now`.
+   *
+   * @param k The number of hashtags to return.
+   * @param now Microseconds since the Unix epoch; buckets before the window are dropped.
+   * @return Up to `k` hashtags, most mentions first, then alphabetically.
+   */
+  std::vector<Trend> top(Window window, size_t k, int64_t now);
+
+  /**
+   * @brief Forgets every mention.
+   */
+  void clear();
+
+private:
+
+  /**
+   * @brief One sliding window: a ring of buckets and the totals across them.
+   */
+  class Ring
+  {
+  public:
+    Ring(int64_t bucket_us, size_t buckets);
+
+    void add(const std::string& hashtag, int64_t ts);
+    void advance(int64_t ts);
+    void clear();
+
+    const std::unordered_map<std::string, uint32_t>& totals() const { return _totals; }
+
+  private:
+    int64_t _bucket_us;
+    std::vector<std::unordered_map<std::string, uint32_t>> _buckets;
+    std::unordered_map<std::string, uint32_t> _totals;
+    int64_t _head = INT64_MIN;  // index of the newest bucket, counted from the epoch
+
+    void _expire(int64_t bucket);
+  };
+
+  Ring _hour{60 * 1000000LL, 60};
+  Ring _day{3600 * 1000000LL, 24};
+};
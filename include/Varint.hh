@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+
+/**
+ * LEB128 varints, shared by the call log, the memory engine's snapshots and the in-memory
+ * posting and adjacency lists.
+ *
+ * A value is written 7 bits at a time, least significant group first, with the high bit
+ * of every byte but the last set. Signed values are zigzag-encoded first, so small
+ * negative numbers stay short too.
+ */
+namespace varint {
+
+/**
+ * @brief Appends `value` to a `std::string` or `std::vector<uint8_t>`.
+ */
+template <typename Buffer>
+inline void put(Buffer& out, uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<typename Buffer::value_type>(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<typename Buffer::value_type>(value));
+}
+
+/**
+ * @brief Decodes a value of at most 32 bits at `cursor` and moves past it.
+ *
+ * Meant for buffers the caller encoded itself, so the end is not checked.
+ */
+inline uint32_t get(const uint8_t*& cursor) {
+  uint32_t value = 0;
+  for (int shift = 0; ; shift += 7) {
+    uint8_t byte = *cursor++;
+    value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      return value;
+    }
+  }
+}
+
+/**
+ * @brief Reads a value from `file`.
+ *
+ * @return false at the end of the file or if the value runs past 64 bits.
+ */
+inline bool read(std::FILE* file, uint64_t& value) {
+  value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    int byte = std::fgetc(file);
+    if (byte == EOF) {
+      return false;
+    }
+    value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Maps signed to unsigned values so that small magnitudes stay small:
+ *        0, -1, 1, -2, ... become 0, 1, 2, 3, ...
+ */
+inline uint64_t zigzag(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+/**
+ * @brief Undoes `zigzag`.
+ */
+inline int64_t unzigzag(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+} // namespace varint
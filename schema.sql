@@ -1,10 +1,14 @@
 drop table if exists users;
 drop table if exists follows;
+drop table if exists follows_version;
 drop table if exists lists;
 drop table if exists include;
 drop table if exists tweets;
 drop table if exists retweets;
 drop table if exists hashtag_mentions;
+drop table if exists hashtags;
+drop table if exists user_rank;
+drop table if exists hashtag_hourly;
 
 CREATE TABLE users (
     usr         int,
@@ -12,6 +16,7 @@ CREATE TABLE users (
     email       text,
     phone       int,
     pwd         text,
+    name_lower  text,
     primary key (usr)
 );
 
@@ -27,6 +32,7 @@ CREATE TABLE follows (
 CREATE TABLE lists (
     owner_id    int,
     lname       text,
+    quacks      INTEGER NOT NULL DEFAULT 0,
     PRIMARY KEY (owner_id, lname),
     FOREIGN KEY (owner_id) REFERENCES users(usr) ON DELETE CASCADE
 );
@@ -35,6 +41,7 @@ CREATE TABLE include (
     owner_id    int,
     lname       text,
     tid         int,
+    ts          INTEGER,
     PRIMARY KEY (owner_id, lname, tid),
     FOREIGN KEY (owner_id, lname) REFERENCES lists(owner_id, lname) ON DELETE CASCADE,
     FOREIGN KEY (tid) REFERENCES tweets(tid) ON DELETE CASCADE
@@ -47,6 +54,9 @@ CREATE TABLE tweets (
     tdate       date, 
     ttime       time,
     replyto_tid int,
+    ts          integer,
+    text_lower  text,
+    simhash     integer,        -- SimHash of text, for finding near copies
     PRIMARY KEY (tid),
     FOREIGN KEY (writer_id) REFERENCES users(usr) ON DELETE CASCADE,
     FOREIGN KEY (replyto_tid) REFERENCES tweets(tid) ON DELETE CASCADE
@@ -56,17 +66,100 @@ CREATE TABLE retweets (
     tid         int,
     retweeter_id   int, 
     writer_id      int, 
-    spam        int,
+    spam        int,            -- 0, 1 for a repeat requack, 2 for requacking too fast, 4 for a near copy of one already requacked
     rdate       date,
+    ts          integer,
     PRIMARY KEY (tid, retweeter_id),
     FOREIGN KEY (tid) REFERENCES tweets(tid) ON DELETE CASCADE,
     FOREIGN KEY (retweeter_id) REFERENCES users(usr) ON DELETE CASCADE,
     FOREIGN KEY (writer_id) REFERENCES users(usr) ON DELETE CASCADE
 );
 
+-- Every hashtag once, lower-cased; mentions refer to it by term_id
+CREATE TABLE hashtags (
+    term_id     INTEGER PRIMARY KEY,
+    term_lower  TEXT NOT NULL UNIQUE
+);
+
 CREATE TABLE hashtag_mentions (
-    tid         int,
-    term        text,
-    primary key (tid, term),
-    FOREIGN KEY (tid) REFERENCES tweets(tid) ON DELETE CASCADE
-);
\ No newline at end of file
+    tid         INTEGER NOT NULL,
+    term_id     INTEGER NOT NULL,
+    PRIMARY KEY (tid, term_id),
+    FOREIGN KEY (tid) REFERENCES tweets(tid) ON DELETE CASCADE,
+    FOREIGN KEY (term_id) REFERENCES hashtags(term_id)
+) WITHOUT ROWID;
+
+CREATE INDEX tweets_writer_ts ON tweets (writer_id, ts DESC, tid DESC);
+CREATE INDEX tweets_ts ON tweets (ts DESC, tid DESC);
+CREATE INDEX retweets_retweeter_ts ON retweets (retweeter_id, ts DESC, tid DESC, spam);
+CREATE INDEX hashtag_mentions_term ON hashtag_mentions (term_id, tid);
+CREATE INDEX users_name_lower ON users (name_lower, usr);
+CREATE INDEX tweets_replyto ON tweets (replyto_tid, tid);
+CREATE INDEX include_list_ts ON include (owner_id, lname, ts DESC, tid DESC);
+
+-- Lower-cased copies of names and quack text for case-insensitive search. Pond fills
+-- them on insert; the triggers cover rows written without them and later edits.
+CREATE TRIGGER users_name_folded AFTER INSERT ON users WHEN NEW.name_lower IS NULL
+BEGIN UPDATE users SET name_lower = LOWER(NEW.name) WHERE usr = NEW.usr; END;
+CREATE TRIGGER users_name_refolded AFTER UPDATE OF name ON users
+BEGIN UPDATE users SET name_lower = LOWER(NEW.name) WHERE usr = NEW.usr; END;
+CREATE TRIGGER tweets_text_folded AFTER INSERT ON tweets WHEN NEW.text_lower IS NULL
+BEGIN UPDATE tweets SET text_lower = LOWER(NEW.text) WHERE tid = NEW.tid; END;
+CREATE TRIGGER tweets_text_refolded AFTER UPDATE OF text ON tweets
+BEGIN UPDATE tweets SET text_lower = LOWER(NEW.text) WHERE tid = NEW.tid; END;
+
+-- List entries carry their quack's timestamp for paging in time order, and lists count
+-- their entries. Pond fills the timestamp on insert; the trigger covers other writers.
+CREATE TRIGGER include_dated AFTER INSERT ON include WHEN NEW.ts IS NULL
+BEGIN UPDATE include SET ts = COALESCE((SELECT ts FROM tweets WHERE tid = NEW.tid), 0)
+WHERE owner_id = NEW.owner_id AND lname = NEW.lname AND tid = NEW.tid; END;
+CREATE TRIGGER include_added AFTER INSERT ON include
+BEGIN UPDATE lists SET quacks = quacks + 1 WHERE owner_id = NEW.owner_id AND lname = NEW.lname; END;
+CREATE TRIGGER include_removed AFTER DELETE ON include
+BEGIN UPDATE lists SET quacks = quacks - 1 WHERE owner_id = OLD.owner_id AND lname = OLD.lname; END;
+
+CREATE TABLE follows_version (
+    id          INTEGER PRIMARY KEY CHECK (id = 0),
+    version     INTEGER NOT NULL
+);
+INSERT INTO follows_version (id, version) VALUES (0, 0);
+
+CREATE TRIGGER follows_inserted AFTER INSERT ON follows
+BEGIN UPDATE follows_version SET version = version + 1; END;
+CREATE TRIGGER follows_deleted AFTER DELETE ON follows
+BEGIN UPDATE follows_version SET version = version + 1; END;
+CREATE TRIGGER follows_updated AFTER UPDATE OF flwer, flwee ON follows
+BEGIN UPDATE follows_version SET version = version + 2; END;
+
+CREATE TABLE user_rank (
+    usr         INTEGER PRIMARY KEY,
+    score       REAL NOT NULL,
+    FOREIGN KEY (usr) REFERENCES users(usr) ON DELETE CASCADE
+);
+
+-- Hashtag mentions per lower-cased term per hour since the epoch. Hashtags are
+-- inserted before their quack, so both sides of the join keep the counts current.
+CREATE TABLE hashtag_hourly (
+    term        TEXT NOT NULL,
+    hour        INTEGER NOT NULL,
+    mentions    INTEGER NOT NULL,
+    PRIMARY KEY (term, hour)
+) WITHOUT ROWID;
+CREATE INDEX hashtag_hourly_hour ON hashtag_hourly (hour, term, mentions);
+
+CREATE TRIGGER hashtag_mention_rollup AFTER INSERT ON hashtag_mentions
+BEGIN
+  INSERT INTO hashtag_hourly (term, hour, mentions)
+  SELECT h.term_lower, t.ts / 3600000000, 1 FROM tweets t, hashtags h
+  WHERE t.tid = NEW.tid AND t.ts IS NOT NULL AND h.term_id = NEW.term_id
+  ON CONFLICT (term, hour) DO UPDATE SET mentions = mentions + 1;
+END;
+CREATE TRIGGER quack_hashtags_rollup AFTER INSERT ON tweets WHEN NEW.ts IS NOT NULL
+BEGIN
+  INSERT INTO hashtag_hourly (term, hour, mentions)
+  SELECT h.term_lower, NEW.ts / 3600000000, 1 FROM hashtag_mentions ht, hashtags h
+  WHERE ht.tid = NEW.tid AND h.term_id = ht.term_id
+  ON CONFLICT (term, hour) DO UPDATE SET mentions = mentions + excluded.mentions;
+END;
+
+PRAGMA user_version = 9;
@@ -0,0 +1,78 @@
+#include "Arena.hh"
+
+/**
+ * @brief Constructs an empty arena.
+ *
+ * No memory is allocated until the first string is copied in.
+ *
+ * @param block_size The size of each block; strings over a quarter of this get a block of their own.
+ */
+Arena::Arena(size_t block_size)
+  : _block_size(block_size), _cursor(nullptr), _remaining(0), _used(0) {
+}
+
+/**
+ * @brief Takes over another arena's blocks, leaving it empty.
+ *
+ * The source forgets its cursor as well as its blocks, so strings copied into it
+ * afterwards go to a new block of its own rather than the one it gave away.
+ */
+Arena::Arena(Arena&& other) noexcept
+  : _blocks(std::move(other._blocks)), _block_size(other._block_size), _cursor(other._cursor),
+    _remaining(other._remaining), _used(other._used) {
+  other._blocks.clear();
+  other._cursor = nullptr;
+  other._remaining = 0;
+  other._used = 0;
+}
+
+/**
+ * @brief Frees this arena's blocks and takes over another's, leaving it empty.
+ */
+Arena& Arena::operator=(Arena&& other) noexcept {
+  if (this != &other) {
+    _blocks = std::move(other._blocks);
+    _block_size = other._block_size;
+    _cursor = other._cursor;
+    _remaining = other._remaining;
+    _used = other._used;
+    other._blocks.clear();
+    other._cursor = nullptr;
+    other._remaining = 0;
+    other._used = 0;
+  }
+  return *this;
+}
+
+/**
+ * @brief Copies a string into the arena.
+ *
+ * @param data The bytes to copy; may be `nullptr` when `size` is 0.
+ * @param size The number of bytes to copy.
+ * @return A view of the copy, valid for the lifetime of the arena.
+ */
+std::string_view Arena::copy(const char* data, size_t size) {
+  if (size == 0) {
+    return std::string_view();
+  }
+
+  if (size > _remaining) {
+    if (size > _block_size / 4) {
+      // Oversized strings get a dedicated block so the current one keeps its free space
+      _blocks.emplace_back(new char[size]);
+      std::memcpy(_blocks.back().get(), data, size);
+      _used += size;
+      return std::string_view(_blocks.back().get(), size);
+    }
+    _blocks.emplace_back(new char[_block_size]);
+    _cursor = _blocks.back().get();
+    _remaining = _block_size;
+  }
+
+  char* dest = _cursor;
+  std::memcpy(dest, data, size);
+  _cursor += size;
+  _remaining -= size;
+  _used += size;
+  return std::string_view(dest, size);
+}
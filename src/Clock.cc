@@ -0,0 +1,54 @@
+#include "Clock.hh"
+
+std::atomic<int64_t> Clock::_last_ts{0};
+
+namespace {
+
+/**
+ * @brief The formatted strings for the most recent second seen by this thread.
+ */
+struct SecondCache {
+  std::time_t second = -1;
+  char date[11];
+  char time[9];
+};
+
+thread_local SecondCache cache;
+
+} // namespace
+
+/**
+ * @brief Takes a timestamp without touching the heap.
+ *
+ * `ts` is strictly increasing across all threads of the process, even if the wall
+ * clock steps backwards or two calls land in the same microsecond, so it can be used
+ * directly for ordering.
+ *
+ * @return The current time as a `Stamp`.
+ */
+Clock::Stamp Clock::now() {
+  int64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+
+  // Hand out max(wall clock, previous + 1) so ordering never goes backwards
+  int64_t last = _last_ts.load(std::memory_order_relaxed);
+  int64_t ts;
+  do {
+    ts = micros > last ? micros : last + 1;
+  } while (!_last_ts.compare_exchange_weak(last, ts, std::memory_order_relaxed));
+
+  std::time_t second = static_cast<std::time_t>(micros / 1000000);
+  if (second != cache.second) {
+    std::tm gmt;
+    gmtime_r(&second, &gmt);
+    std::strftime(cache.date, sizeof(cache.date), "%F", &gmt);        // yyyy-mm-dd
+    std::strftime(cache.time, sizeof(cache.time), "%H:%M:%S", &gmt);
+    cache.second = second;
+  }
+
+  Stamp stamp;
+  std::copy(cache.date, cache.date + sizeof(cache.date), stamp.date);
+  std::copy(cache.time, cache.time + sizeof(cache.time), stamp.time);
+  stamp.ts = ts;
+  return stamp;
+}
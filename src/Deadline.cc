@@ -0,0 +1,46 @@
+#include "Deadline.hh"
+
+#include <algorithm>
+
+// =============================================================================
+// Public Methods
+// =============================================================================
+
+Deadline::Deadline() : _at(std::chrono::steady_clock::time_point::max()) {}
+
+Deadline::Deadline(std::chrono::microseconds budget) : _at(std::chrono::steady_clock::now() + budget) {}
+
+/**
+ * @brief Expires the deadline now; safe to call from any thread.
+ */
+void Deadline::cancel() {
+  this->_cancelled.store(true, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Returns true once the time is up or the deadline was cancelled.
+ *
+ * Reads call this every few thousand rows or SQLite instructions, so it is a flag load
+ * and, for a deadline with a time limit, a monotonic clock read.
+ */
+bool Deadline::expired() const {
+  if (this->_cancelled.load(std::memory_order_relaxed)) {
+    return true;
+  }
+  return this->_at != std::chrono::steady_clock::time_point::max() && std::chrono::steady_clock::now() >= this->_at;
+}
+
+/**
+ * @brief Returns the time left, zero once expired, or -1 for a deadline without a time
+ *        limit that has not been cancelled.
+ */
+std::chrono::microseconds Deadline::remaining() const {
+  if (this->_cancelled.load(std::memory_order_relaxed)) {
+    return std::chrono::microseconds(0);
+  }
+  if (this->_at == std::chrono::steady_clock::time_point::max()) {
+    return std::chrono::microseconds(-1);
+  }
+  const auto left = std::chrono::duration_cast<std::chrono::microseconds>(this->_at - std::chrono::steady_clock::now());
+  return std::max(left, std::chrono::microseconds(0));
+}
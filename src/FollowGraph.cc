@@ -0,0 +1,621 @@
+#include "FollowGraph.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+#include "ThreadPool.hh"
+#include "Varint.hh"
+
+namespace {
+
+using Suggestion = FollowGraph::Suggestion;
+
+/**
+ * @brief Orders suggestions best first: most mutual connections, then highest
+ *        influence, then lowest ID.
+ */
+bool better(const Suggestion& a, const Suggestion& b) {
+  if (a.mutuals != b.mutuals) {
+    return a.mutuals > b.mutuals;
+  }
+  return a.influence != b.influence ? a.influence > b.influence : a.usr < b.usr;
+}
+
+/**
+ * @brief Offers a candidate to a bounded heap whose front is its worst entry.
+ */
+void offer(std::vector<Suggestion>& heap, size_t k, Suggestion candidate) {
+  if (heap.size() < k) {
+    heap.push_back(candidate);
+    std::push_heap(heap.begin(), heap.end(), better);
+  } else if (better(candidate, heap.front())) {
+    std::pop_heap(heap.begin(), heap.end(), better);
+    heap.back() = candidate;
+    std::push_heap(heap.begin(), heap.end(), better);
+  }
+}
+
+} // namespace
+
+// =============================================================================
+// Public Methods
+// =============================================================================
+
+/**
+ * @brief Replaces the whole graph.
+ *
+ * @param edges Every `(flwer, flwee)` pair, in any order and free of duplicates.
+ */
+void FollowGraph::build(std::vector<Edge> edges) {
+  std::sort(edges.begin(), edges.end());
+  this->_out.build(edges);
+
+  for (Edge& edge : edges) {
+    std::swap(edge.first, edge.second);
+  }
+  std::sort(edges.begin(), edges.end());
+  this->_in.build(edges);
+}
+
+/**
+ * @brief Adds `flwer -> flwee`; adding an existing edge changes nothing.
+ */
+void FollowGraph::add(int32_t flwer, int32_t flwee) {
+  this->_out.insert(flwer, flwee);
+  this->_in.insert(flwee, flwer);
+}
+
+/**
+ * @brief Removes `flwer -> flwee`; removing a missing edge changes nothing.
+ */
+void FollowGraph::remove(int32_t flwer, int32_t flwee) {
+  this->_out.erase(flwer, flwee);
+  this->_in.erase(flwee, flwer);
+}
+
+/**
+ * @brief Returns true if `flwer` follows `flwee`.
+ */
+bool FollowGraph::contains(int32_t flwer, int32_t flwee) const {
+  std::vector<int32_t> following;
+  this->_out.neighbors(flwer, following);
+  return std::binary_search(following.begin(), following.end(), flwee);
+}
+
+/**
+ * @brief Ranks the accounts followed by the users `usr` follows.
+ *
+ * The walk touches few of the graph's users, so mutual counts go into a hash map
+ * rather than an array indexed by user ID. With a pool and enough followees, the
+ * followees are split into chunks that each count into their own map.
+ *
+ * @param k The number of suggestions to return.
+ * @param pool When given, large neighborhoods are counted on its threads.
+ * @return Up to `k` suggestions, most mutual connections first, then highest
+ *         influence, then lowest ID.
+ */
+std::vector<Suggestion> FollowGraph::suggest(int32_t usr, size_t k, ThreadPool* pool) const {
+  std::vector<Suggestion> heap;
+  if (k == 0) {
+    return heap;
+  }
+
+  std::vector<int32_t> followees;
+  this->_out.neighbors(usr, followees);
+
+  using Counts = std::unordered_map<int32_t, uint32_t>;
+  auto count = [&](size_t begin, size_t end, Counts& counts) {
+    std::vector<int32_t> second;
+    for (size_t i = begin; i < end; ++i) {
+      second.clear();
+      this->_out.neighbors(followees[i], second);
+      for (int32_t candidate : second) {
+        if (candidate >= 0 && candidate != usr) {
+          ++counts[candidate];
+        }
+      }
+    }
+  };
+
+  // Below this many followees the threads cost more than they save
+  const size_t parallel_threshold = 256;
+  Counts counts;
+  if (pool && pool->size() > 1 && followees.size() >= parallel_threshold) {
+    const size_t chunk = std::max<size_t>(64, followees.size() / (pool->size() * 4));
+    std::vector<Counts> partials((followees.size() + chunk - 1) / chunk);
+    pool->parallelFor(followees.size(), chunk, [&](size_t begin, size_t end) {
+      count(begin, end, partials[begin / chunk]);
+    });
+    counts = std::move(partials[0]);
+    for (size_t i = 1; i < partials.size(); ++i) {
+      for (const auto& [candidate, mutuals] : partials[i]) {
+        counts[candidate] += mutuals;
+      }
+    }
+  } else {
+    count(0, followees.size(), counts);
+  }
+
+  for (const auto& [candidate, mutuals] : counts) {
+    if (!std::binary_search(followees.begin(), followees.end(), candidate)) {
+      offer(heap, k, Suggestion{candidate, mutuals, this->_influenceOf(candidate)});
+    }
+  }
+  std::sort_heap(heap.begin(), heap.end(), better);
+  return heap;
+}
+
+/**
+ * @brief Computes `suggest(usr, k)` for every user, spreading users over `pool`.
+ *
+ * Each chunk of users reuses one dense counter array indexed by user ID, plus the list
+ * of entries it touched so only those are scanned and reset per user.
+ *
+ * @return Suggestions indexed by user ID, for IDs up to the largest in the graph.
+ */
+std::vector<std::vector<Suggestion>> FollowGraph::suggestAll(size_t k, ThreadPool& pool) const {
+  const int32_t limit = this->_limit();
+  std::vector<std::vector<Suggestion>> suggestions(limit);
+  if (k == 0) {
+    return suggestions;
+  }
+
+  pool.parallelFor(limit, 0, [&](size_t begin, size_t end) {
+    std::vector<uint32_t> counts(limit, 0);
+    std::vector<int32_t> touched;
+    std::vector<int32_t> followees;
+    std::vector<int32_t> second;
+
+    for (size_t i = begin; i < end; ++i) {
+      const int32_t usr = static_cast<int32_t>(i);
+      followees.clear();
+      this->_out.neighbors(usr, followees);
+
+      for (int32_t followee : followees) {
+        second.clear();
+        this->_out.neighbors(followee, second);
+        for (int32_t candidate : second) {
+          if (candidate >= 0 && candidate != usr && counts[candidate]++ == 0) {
+            touched.push_back(candidate);
+          }
+        }
+      }
+
+      std::vector<Suggestion>& heap = suggestions[i];
+      for (int32_t candidate : touched) {
+        if (!std::binary_search(followees.begin(), followees.end(), candidate)) {
+          offer(heap, k, Suggestion{candidate, counts[candidate], this->_influenceOf(candidate)});
+        }
+        counts[candidate] = 0;
+      }
+      touched.clear();
+      std::sort_heap(heap.begin(), heap.end(), better);
+    }
+  });
+  return suggestions;
+}
+
+/**
+ * @brief Finds a shortest chain of follows from `from` to `to`.
+ *
+ * Each round expands every user in the smaller of the two frontiers by one level. The
+ * first user reached that the other direction has already visited closes a shortest
+ * chain: a shorter one would have met in an earlier round.
+ *
+ * @param max_depth The longest chain to look for, in follows.
+ * @param search Scratch space reused across calls.
+ * @return The users on the chain, starting with `from` and ending with `to`; just
+ *         `from` if the two are the same user; empty if no chain is short enough.
+ */
+std::vector<int32_t> FollowGraph::shortestPath(int32_t from, int32_t to, int32_t max_depth,
+                                               PathSearch& search) const {
+  std::vector<int32_t> path;
+  if (from == to) {
+    path.push_back(from);
+    return path;
+  }
+  const int32_t limit = this->_limit();
+  if (from < 0 || to < 0 || from >= limit || to >= limit || max_depth < 1) {
+    return path;
+  }
+
+  // Grow the scratch space to the graph; it is only ever cleared bit by bit
+  const size_t words = (static_cast<size_t>(limit) + 63) / 64;
+  for (PathSearch::Side& side : search._sides) {
+    if (side.seen.size() < words) {
+      side.seen.resize(words, 0);
+      side.parent.resize(words * 64);
+    }
+  }
+
+  auto seen = [](const PathSearch::Side& side, int32_t usr) {
+    return (side.seen[usr >> 6] >> (usr & 63)) & 1;
+  };
+  auto visit = [](PathSearch::Side& side, int32_t usr, int32_t parent) {
+    side.seen[usr >> 6] |= uint64_t(1) << (usr & 63);
+    side.parent[usr] = parent;
+    side.visited.push_back(usr);
+  };
+
+  PathSearch::Side& forward = search._sides[0];
+  PathSearch::Side& backward = search._sides[1];
+  visit(forward, from, from);
+  forward.frontier.push_back(from);
+  visit(backward, to, to);
+  backward.frontier.push_back(to);
+
+  int32_t meet = -1;
+  for (int32_t depth = 0; depth < max_depth && meet < 0; ++depth) {
+    if (forward.frontier.empty() || backward.frontier.empty()) {
+      break;
+    }
+    const int side_index = forward.frontier.size() <= backward.frontier.size() ? 0 : 1;
+    PathSearch::Side& side = search._sides[side_index];
+    const PathSearch::Side& other = search._sides[1 - side_index];
+    const Adjacency& edges = side_index == 0 ? this->_out : this->_in;
+
+    search._next.clear();
+    for (int32_t usr : side.frontier) {
+      search._neighbors.clear();
+      edges.neighbors(usr, search._neighbors);
+      for (int32_t neighbor : search._neighbors) {
+        if (neighbor < 0 || seen(side, neighbor)) {
+          continue;
+        }
+        visit(side, neighbor, usr);
+        if (seen(other, neighbor)) {
+          meet = neighbor;
+          break;
+        }
+        search._next.push_back(neighbor);
+      }
+      if (meet >= 0) {
+        break;
+      }
+    }
+    side.frontier.swap(search._next);
+  }
+
+  if (meet >= 0) {
+    for (int32_t usr = meet; usr != from; usr = forward.parent[usr]) {
+      path.push_back(usr);
+    }
+    path.push_back(from);
+    std::reverse(path.begin(), path.end());
+    for (int32_t usr = meet; usr != to; ) {
+      usr = backward.parent[usr];
+      path.push_back(usr);
+    }
+  }
+
+  for (PathSearch::Side& side : search._sides) {
+    for (int32_t usr : side.visited) {
+      side.seen[usr >> 6] = 0;
+    }
+    side.visited.clear();
+    side.frontier.clear();
+  }
+  return path;
+}
+
+/**
+ * @brief Computes PageRank over the follow edges by power iteration on `pool`.
+ *
+ * Each iteration pulls: a user's next score is the sum of the shares sent by its
+ * followers. Before iterating, users are renumbered by descending follower count and
+ * the follower lists are copied out of the compressed runs into a plain CSR array in
+ * the new numbering. The shares read most often then sit together at the front of the
+ * share array instead of being spread across it by ID.
+ *
+ * Both passes of an iteration split the users into fixed chunks, and each chunk sums
+ * into its own slot, so the result does not depend on the number of threads.
+ *
+ * @param start Scores to start from, indexed by user ID, such as the previous run's;
+ *              users it has no positive score for start at its lowest score.
+ * @param damping The probability of following an edge rather than jumping anywhere.
+ * @param tolerance Stop once an iteration moves the scores by less than this, in L1.
+ * @param max_iterations Stop after this many iterations regardless.
+ */
+FollowGraph::Ranking FollowGraph::pageRank(ThreadPool& pool, const std::vector<double>& start,
+                                           double damping, double tolerance,
+                                           int32_t max_iterations) const {
+  Ranking ranking{{}, 0, std::numeric_limits<double>::infinity()};
+  const size_t n = static_cast<size_t>(this->_limit());
+  if (n == 0) {
+    return ranking;
+  }
+  const size_t chunk = std::max<size_t>(1024, n / (pool.size() * 8));
+  const size_t chunks = (n + chunk - 1) / chunk;
+
+  // Lists are sorted, so the negative IDs left out of the ranking come first
+  auto nonNegative = [](const std::vector<int32_t>& list) {
+    return std::lower_bound(list.begin(), list.end(), 0);
+  };
+
+  std::vector<uint32_t> out_degree(n);
+  std::vector<uint32_t> in_degree(n);
+  pool.parallelFor(n, chunk, [&](size_t begin, size_t end) {
+    std::vector<int32_t> neighbors;
+    for (size_t usr = begin; usr < end; ++usr) {
+      neighbors.clear();
+      this->_out.neighbors(static_cast<int32_t>(usr), neighbors);
+      out_degree[usr] = static_cast<uint32_t>(neighbors.end() - nonNegative(neighbors));
+      neighbors.clear();
+      this->_in.neighbors(static_cast<int32_t>(usr), neighbors);
+      in_degree[usr] = static_cast<uint32_t>(neighbors.end() - nonNegative(neighbors));
+    }
+  });
+
+  // Counting sort by descending follower count, ties in ID order
+  const uint32_t max_in_degree = *std::max_element(in_degree.begin(), in_degree.end());
+  std::vector<size_t> bucket(max_in_degree + 2, 0);
+  for (uint32_t degree : in_degree) {
+    ++bucket[max_in_degree - degree + 1];
+  }
+  std::partial_sum(bucket.begin(), bucket.end(), bucket.begin());
+  std::vector<int32_t> order(n);      // position -> user ID
+  std::vector<uint32_t> position(n);  // user ID -> position
+  for (size_t usr = 0; usr < n; ++usr) {
+    const size_t v = bucket[max_in_degree - in_degree[usr]]++;
+    order[v] = static_cast<int32_t>(usr);
+    position[usr] = static_cast<uint32_t>(v);
+  }
+
+  std::vector<size_t> offsets(n + 1, 0);
+  std::vector<double> inverse_degree(n);
+  for (size_t v = 0; v < n; ++v) {
+    offsets[v + 1] = offsets[v] + in_degree[order[v]];
+    inverse_degree[v] = out_degree[order[v]] ? 1.0 / out_degree[order[v]] : 0.0;
+  }
+
+  // Decoded in ID order, which walks the compressed runs front to back
+  std::vector<uint32_t> sources(offsets[n]);
+  pool.parallelFor(n, chunk, [&](size_t begin, size_t end) {
+    std::vector<int32_t> followers;
+    for (size_t usr = begin; usr < end; ++usr) {
+      followers.clear();
+      this->_in.neighbors(static_cast<int32_t>(usr), followers);
+      uint32_t* source = sources.data() + offsets[position[usr]];
+      for (auto follower = nonNegative(followers); follower != followers.end(); ++follower) {
+        *source++ = position[*follower];
+      }
+    }
+  });
+
+  // Users missing from a warm start are most likely new, with no followers yet. Every
+  // user nobody follows has the same, lowest score, so they start at that.
+  const double uniform = 1.0 / static_cast<double>(n);
+  double unranked = std::numeric_limits<double>::infinity();
+  for (double value : start) {
+    if (value > 0.0) {
+      unranked = std::min(unranked, value);
+    }
+  }
+  if (std::isinf(unranked)) {
+    unranked = uniform;
+  }
+  std::vector<double> score(n);
+  double total = 0.0;
+  for (size_t v = 0; v < n; ++v) {
+    const size_t usr = static_cast<size_t>(order[v]);
+    score[v] = usr < start.size() && start[usr] > 0.0 ? start[usr] : unranked;
+    total += score[v];
+  }
+  for (double& value : score) {
+    value /= total;
+  }
+
+  std::vector<double> share(n);
+  std::vector<double> next(n);
+  std::vector<double> partials(chunks);
+  auto sum = [&partials]() { return std::accumulate(partials.begin(), partials.end(), 0.0); };
+
+  while (ranking.iterations < max_iterations) {
+    // Users who follow nobody hand their score to everyone
+    pool.parallelFor(n, chunk, [&](size_t begin, size_t end) {
+      double dangling = 0.0;
+      for (size_t v = begin; v < end; ++v) {
+        share[v] = score[v] * inverse_degree[v];
+        if (inverse_degree[v] == 0.0) {
+          dangling += score[v];
+        }
+      }
+      partials[begin / chunk] = dangling;
+    });
+    const double base = (1.0 - damping) * uniform + damping * sum() * uniform;
+
+    pool.parallelFor(n, chunk, [&](size_t begin, size_t end) {
+      double moved = 0.0;
+      for (size_t v = begin; v < end; ++v) {
+        double incoming = 0.0;
+        for (size_t e = offsets[v]; e < offsets[v + 1]; ++e) {
+          incoming += share[sources[e]];
+        }
+        next[v] = base + damping * incoming;
+        moved += std::fabs(next[v] - score[v]);
+      }
+      partials[begin / chunk] = moved;
+    });
+
+    score.swap(next);
+    ++ranking.iterations;
+    ranking.residual = sum();
+    if (ranking.residual < tolerance) {
+      break;
+    }
+  }
+
+  ranking.scores.resize(n);
+  for (size_t v = 0; v < n; ++v) {
+    ranking.scores[order[v]] = score[v];
+  }
+  return ranking;
+}
+
+// =============================================================================
+// Adjacency
+// =============================================================================
+
+/**
+ * @brief Rebuilds the compressed arrays from `edges`, which are sorted by `(from, to)`.
+ *
+ * Users with negative IDs have no slot in the offset array and are kept in the overlay.
+ */
+void FollowGraph::Adjacency::build(const std::vector<Edge>& edges) {
+  this->_offsets.clear();
+  this->_data.clear();
+  this->_overlay.clear();
+  this->_edges = edges.size();
+  this->_overlay_edges = 0;
+
+  int32_t last_from = edges.empty() ? -1 : std::max(edges.back().first, -1);
+  this->_offsets.reserve(static_cast<size_t>(last_from) + 2);
+  this->_data.reserve(edges.size() * 2);
+
+  auto edge = edges.begin();
+  for (; edge != edges.end() && edge->first < 0; ++edge) {
+    this->_overlay[edge->first].push_back(edge->second);
+    ++this->_overlay_edges;
+  }
+
+  for (int32_t from = 0; from <= last_from; ++from) {
+    this->_offsets.push_back(static_cast<uint32_t>(this->_data.size()));
+    bool first = true;
+    int32_t previous = 0;
+    for (; edge != edges.end() && edge->first == from; ++edge) {
+      // Neighbors are strictly increasing, so every delta after the first is positive;
+      // the first is zigzag-encoded so negative IDs stay short
+      varint::put(this->_data, first ? varint::zigzag(edge->second)
+                                     : static_cast<uint32_t>(edge->second) - static_cast<uint32_t>(previous));
+      previous = edge->second;
+      first = false;
+    }
+  }
+  this->_offsets.push_back(static_cast<uint32_t>(this->_data.size()));
+  this->_data.shrink_to_fit();
+}
+
+/**
+ * @brief Appends the neighbors of `from`, in ascending ID order.
+ */
+void FollowGraph::Adjacency::neighbors(int32_t from, std::vector<int32_t>& out) const {
+  if (!this->_overlay.empty()) {
+    auto changed = this->_overlay.find(from);
+    if (changed != this->_overlay.end()) {
+      out.insert(out.end(), changed->second.begin(), changed->second.end());
+      return;
+    }
+  }
+
+  if (from < 0 || static_cast<size_t>(from) + 1 >= this->_offsets.size()) {
+    return;
+  }
+  const uint8_t* cursor = this->_data.data() + this->_offsets[from];
+  const uint8_t* end = this->_data.data() + this->_offsets[from + 1];
+  if (cursor == end) {
+    return;
+  }
+  int32_t neighbor = static_cast<int32_t>(varint::unzigzag(varint::get(cursor)));
+  out.push_back(neighbor);
+  while (cursor != end) {
+    neighbor = static_cast<int32_t>(static_cast<uint32_t>(neighbor) + varint::get(cursor));
+    out.push_back(neighbor);
+  }
+}
+
+void FollowGraph::Adjacency::insert(int32_t from, int32_t to) {
+  std::vector<int32_t>& list = this->_overlayFor(from);
+  auto position = std::lower_bound(list.begin(), list.end(), to);
+  if (position != list.end() && *position == to) {
+    return;
+  }
+  list.insert(position, to);
+  ++this->_edges;
+  ++this->_overlay_edges;
+
+  if (this->_overlay_edges > std::max<size_t>(1024, this->_edges / 8)) {
+    this->_compact();
+  }
+}
+
+void FollowGraph::Adjacency::erase(int32_t from, int32_t to) {
+  std::vector<int32_t>& list = this->_overlayFor(from);
+  auto position = std::lower_bound(list.begin(), list.end(), to);
+  if (position == list.end() || *position != to) {
+    return;
+  }
+  list.erase(position);
+  --this->_edges;
+  --this->_overlay_edges;
+}
+
+/**
+ * @brief Returns the heap memory held by this direction, in bytes.
+ *
+ * Overlay entries are counted at their vector capacity plus an estimate of the hash
+ * node around them.
+ */
+size_t FollowGraph::Adjacency::bytes() const {
+  size_t total = this->_offsets.capacity() * sizeof(uint32_t) + this->_data.capacity();
+  for (const auto& [from, list] : this->_overlay) {
+    total += list.capacity() * sizeof(int32_t) + sizeof(*this->_overlay.begin()) + sizeof(void*);
+  }
+  return total;
+}
+
+/**
+ * @brief Returns one past the largest non-negative user ID with neighbors here.
+ */
+int32_t FollowGraph::Adjacency::limit() const {
+  int32_t limit = this->_offsets.empty() ? 0 : static_cast<int32_t>(this->_offsets.size() - 1);
+  for (const auto& [from, list] : this->_overlay) {
+    if (from >= limit && !list.empty()) {
+      limit = from + 1;
+    }
+  }
+  return limit;
+}
+
+/**
+ * @brief Returns the overlay list of `from`, decoding its compressed run into the
+ *        overlay first if it has not been changed since the last compaction.
+ */
+std::vector<int32_t>& FollowGraph::Adjacency::_overlayFor(int32_t from) {
+  auto changed = this->_overlay.find(from);
+  if (changed != this->_overlay.end()) {
+    return changed->second;
+  }
+  std::vector<int32_t> list;
+  this->neighbors(from, list);
+  this->_overlay_edges += list.size();
+  return this->_overlay.emplace(from, std::move(list)).first->second;
+}
+
+/**
+ * @brief Folds the overlay back into freshly built compressed arrays.
+ */
+void FollowGraph::Adjacency::_compact() {
+  std::vector<Edge> edges;
+  edges.reserve(this->_edges);
+  std::vector<int32_t> list;
+  for (size_t from = 0; from + 1 < this->_offsets.size(); ++from) {
+    if (this->_overlay.count(static_cast<int32_t>(from))) {
+      continue;
+    }
+    list.clear();
+    this->neighbors(static_cast<int32_t>(from), list);
+    for (int32_t to : list) {
+      edges.emplace_back(static_cast<int32_t>(from), to);
+    }
+  }
+  for (const auto& [from, changed] : this->_overlay) {
+    for (int32_t to : changed) {
+      edges.emplace_back(from, to);
+    }
+  }
+  std::sort(edges.begin(), edges.end());
+  this->build(edges);
+}
@@ -0,0 +1,267 @@
+#include "HashtagIndex.hh"
+#include "Varint.hh"
+
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <sstream>
+
+namespace {
+
+
+/**
+ * @brief Lower-cases a hashtag and gives it its '#' if it has none.
+ */
+std::string normalize(const std::string& hashtag) {
+  std::string folded = hashtag[0] == '#' ? hashtag : "#" + hashtag;
+  std::transform(folded.begin(), folded.end(), folded.begin(), [](unsigned char c) {
+    return static_cast<char>(std::tolower(c));
+  });
+  return folded;
+}
+
+} // namespace
+
+// =============================================================================
+// Public Methods
+// =============================================================================
+
+/**
+ * @brief Parses a query such as `#cats|#dogs #cute -#sad`.
+ *
+ * Space-separated terms must all match, `|` joins hashtags of which any may match, and
+ * a leading `-` excludes a hashtag (or each of several joined by `|`). The '#' may be
+ * left out; empty alternatives are ignored.
+ */
+HashtagIndex::Query HashtagIndex::parse(const std::string& text) {
+  Query query;
+  std::istringstream terms(text);
+  std::string term;
+  while (terms >> term) {
+    const bool excluded = term[0] == '-';
+    std::istringstream alternatives(excluded ? term.substr(1) : term);
+    std::vector<std::string> group;
+    std::string hashtag;
+    while (std::getline(alternatives, hashtag, '|')) {
+      if (!hashtag.empty() && hashtag != "#") {
+        group.push_back(normalize(hashtag));
+      }
+    }
+    if (group.empty()) {
+      continue;
+    }
+    if (excluded) {
+      query.none.insert(query.none.end(), group.begin(), group.end());
+    } else {
+      query.all.push_back(std::move(group));
+    }
+  }
+  return query;
+}
+
+/**
+ * @brief Records that quack `tid` mentions `hashtag`; recording it again changes nothing.
+ */
+bool HashtagIndex::add(int32_t tid, const std::string& hashtag) {
+  if (hashtag.empty()) {
+    return false;
+  }
+  this->_last_tid = std::max(this->_last_tid, tid);
+  return this->_postings[normalize(hashtag)].insert(tid);
+}
+
+/**
+ * @brief Returns the IDs of the quacks matching `query`, in ascending order.
+ *
+ * Each group is resolved to one hashtag's postings or, for alternatives, to their
+ * merged IDs. The smallest group is decoded as the candidates, and every other group,
+ * smallest first, narrows them: postings are probed block by block through their skip
+ * entries, merged groups are intersected directly. Excluded hashtags then remove the
+ * candidates they contain the same way.
+ */
+std::vector<int32_t> HashtagIndex::match(const Query& query) const {
+  // One `all` group resolved against the index: a single hashtag's postings, or the
+  // merged IDs of several alternatives
+  struct Clause {
+    const Postings* postings;
+    std::vector<int32_t> tids;
+    size_t size;
+  };
+
+  std::vector<int32_t> candidates;
+  if (query.all.empty()) {
+    return candidates;
+  }
+
+  std::vector<Clause> clauses;
+  for (const std::vector<std::string>& group : query.all) {
+    std::vector<const Postings*> found;
+    for (const std::string& hashtag : group) {
+      const Postings* postings = this->_find(normalize(hashtag));
+      if (postings && std::find(found.begin(), found.end(), postings) == found.end()) {
+        found.push_back(postings);
+      }
+    }
+    if (found.empty()) {
+      return candidates;
+    }
+    if (found.size() == 1) {
+      clauses.push_back(Clause{found.front(), {}, found.front()->size()});
+      continue;
+    }
+    Clause merged{nullptr, {}, 0};
+    for (const Postings* postings : found) {
+      postings->decode(merged.tids);
+    }
+    std::sort(merged.tids.begin(), merged.tids.end());
+    merged.tids.erase(std::unique(merged.tids.begin(), merged.tids.end()), merged.tids.end());
+    merged.size = merged.tids.size();
+    clauses.push_back(std::move(merged));
+  }
+  std::sort(clauses.begin(), clauses.end(), [](const Clause& a, const Clause& b) { return a.size < b.size; });
+
+  if (clauses.front().postings) {
+    clauses.front().postings->decode(candidates);
+  } else {
+    candidates = std::move(clauses.front().tids);
+  }
+
+  std::vector<int32_t> narrowed;
+  for (size_t i = 1; i < clauses.size() && !candidates.empty(); ++i) {
+    narrowed.clear();
+    if (clauses[i].postings) {
+      clauses[i].postings->filter(candidates, true, narrowed);
+    } else {
+      std::set_intersection(candidates.begin(), candidates.end(), clauses[i].tids.begin(),
+                            clauses[i].tids.end(), std::back_inserter(narrowed));
+    }
+    candidates.swap(narrowed);
+  }
+
+  for (const std::string& hashtag : query.none) {
+    const Postings* postings = this->_find(normalize(hashtag));
+    if (postings && !candidates.empty()) {
+      narrowed.clear();
+      postings->filter(candidates, false, narrowed);
+      candidates.swap(narrowed);
+    }
+  }
+  return candidates;
+}
+
+/**
+ * @brief Forgets every posting.
+ */
+void HashtagIndex::clear() {
+  this->_postings.clear();
+  this->_last_tid = INT32_MIN;
+}
+
+// =============================================================================
+// Private Methods
+// =============================================================================
+
+const HashtagIndex::Postings* HashtagIndex::_find(const std::string& folded) const {
+  auto postings = this->_postings.find(folded);
+  return postings == this->_postings.end() ? nullptr : &postings->second;
+}
+
+/**
+ * @brief Adds `tid`; returns false if it is already present.
+ *
+ * IDs past the end are appended. An older ID is spliced in by decoding the whole list
+ * and encoding it again, which only happens when quacks are indexed out of order.
+ */
+bool HashtagIndex::Postings::insert(int32_t tid) {
+  if (this->_size == 0 || tid > this->_last) {
+    this->_append(tid);
+    return true;
+  }
+  if (tid == this->_last) {
+    return false;
+  }
+
+  std::vector<int32_t> tids;
+  this->decode(tids);
+  auto position = std::lower_bound(tids.begin(), tids.end(), tid);
+  if (*position == tid) {
+    return false;
+  }
+  tids.insert(position, tid);
+
+  this->_firsts.clear();
+  this->_offsets.clear();
+  this->_data.clear();
+  this->_size = 0;
+  for (int32_t id : tids) {
+    this->_append(id);
+  }
+  return true;
+}
+
+/**
+ * @brief Appends every ID, ascending.
+ */
+void HashtagIndex::Postings::decode(std::vector<int32_t>& out) const {
+  out.reserve(out.size() + this->_size);
+  for (size_t block = 0; block < this->_firsts.size(); ++block) {
+    this->_decodeBlock(block, out);
+  }
+}
+
+/**
+ * @brief Appends the `candidates` (ascending) that are in the list if `keep` is set,
+ *        or that are not if it is unset.
+ *
+ * Candidates only move forward, so each one is located by a binary search of the skip
+ * entries from the current block onwards, and each block is decoded at most once.
+ */
+void HashtagIndex::Postings::filter(const std::vector<int32_t>& candidates, bool keep,
+                                    std::vector<int32_t>& out) const {
+  std::vector<int32_t> decoded;
+  size_t decoded_block = this->_firsts.size();
+  size_t block = 0;
+  size_t position = 0;
+
+  for (int32_t tid : candidates) {
+    bool found = false;
+    auto next = std::upper_bound(this->_firsts.begin() + block, this->_firsts.end(), tid);
+    if (next != this->_firsts.begin()) {
+      block = static_cast<size_t>(next - this->_firsts.begin()) - 1;
+      if (block != decoded_block) {
+        decoded.clear();
+        this->_decodeBlock(block, decoded);
+        decoded_block = block;
+        position = 0;
+      }
+      position = static_cast<size_t>(std::lower_bound(decoded.begin() + position, decoded.end(), tid) -
+                                     decoded.begin());
+      found = position < decoded.size() && decoded[position] == tid;
+    }
+    if (found == keep) {
+      out.push_back(tid);
+    }
+  }
+}
+
+void HashtagIndex::Postings::_append(int32_t tid) {
+  if (this->_size % BLOCK == 0) {
+    this->_firsts.push_back(tid);
+    this->_offsets.push_back(static_cast<uint32_t>(this->_data.size()));
+  } else {
+    varint::put(this->_data, static_cast<uint32_t>(tid) - static_cast<uint32_t>(this->_last));
+  }
+  this->_last = tid;
+  ++this->_size;
+}
+
+void HashtagIndex::Postings::_decodeBlock(size_t block, std::vector<int32_t>& out) const {
+  const size_t count = std::min(BLOCK, this->_size - block * BLOCK);
+  const uint8_t* cursor = this->_data.data() + this->_offsets[block];
+  int32_t tid = this->_firsts[block];
+  out.push_back(tid);
+  for (size_t i = 1; i < count; ++i) {
+    tid = static_cast<int32_t>(static_cast<uint32_t>(tid) + varint::get(cursor));
+    out.push_back(tid);
+  }
+}
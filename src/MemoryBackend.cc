@@ -0,0 +1,1484 @@
+#include "MemoryBackend.hh"
+#include "SimHashIndex.hh"
+#include "Varint.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+namespace {
+
+const char SNAPSHOT_MAGIC[4] = {'Q', 'K', 'S', 'N'};
+const uint8_t SNAPSHOT_VERSION = 2;  // 2 added user ranks; version 1 snapshots still load
+const char SQLITE_MAGIC[16] = "SQLite format 3";
+const int64_t HOUR_US = 3600000000LL;
+
+uint64_t pairKey(int32_t a, int32_t b) {
+  return (static_cast<uint64_t>(static_cast<uint32_t>(a)) << 32) | static_cast<uint32_t>(b);
+}
+
+// Scans over every user or quack check their deadline once per this many rows
+const size_t DEADLINE_CHECK_ROWS = 256;
+
+char lowerChar(char c) {
+  return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+/**
+ * @brief ASCII lower-casing, the same folding SQLite's `LOWER()` applies.
+ */
+std::string lower(const std::string& text) {
+  std::string folded(text);
+  std::transform(folded.begin(), folded.end(), folded.begin(), lowerChar);
+  return folded;
+}
+
+/**
+ * @brief Matches `text` against a SQL LIKE pattern (`%` any run, `_` one character),
+ *        ignoring ASCII case like SQLite's default LIKE.
+ */
+bool like(const char* pattern, const char* text) {
+  // Iterative matcher that backtracks to the most recent '%'
+  const char* star = nullptr;
+  const char* resume = nullptr;
+  while (*text) {
+    if (*pattern == '%') {
+      star = pattern++;
+      resume = text;
+    } else if (*pattern && (*pattern == '_' || lowerChar(*pattern) == lowerChar(*text))) {
+      ++pattern;
+      ++text;
+    } else if (star) {
+      pattern = star + 1;
+      text = ++resume;
+    } else {
+      return false;
+    }
+  }
+  while (*pattern == '%') {
+    ++pattern;
+  }
+  return *pattern == '\0';
+}
+
+/**
+ * @brief Character count of a UTF-8 string, as SQLite's `LENGTH()` reports it.
+ */
+size_t utf8Length(const std::string& text) {
+  return std::count_if(text.begin(), text.end(), [](char c) { return (c & 0xC0) != 0x80; });
+}
+
+/**
+ * @brief Matches lower-cased quack text (`_text_lower`, like the `text_lower` column) the
+ *        way SEARCH_QUACKS_BY_WORD does: the keyword or its hashtag as a whole
+ *        space-separated word.
+ */
+class WordMatcher
+{
+public:
+  explicit WordMatcher(const std::string& keyword)
+    : _word(lower(keyword)), _tag(lower("#" + keyword)),
+      _patterns{"% " + _word + " %", "% " + _tag + " %", "% " + _word, "% " + _tag, _word + " %", _tag + " %"} {}
+
+  bool matches(const std::string& text) const {
+    bool match = text == this->_word || text == this->_tag;
+    for (const std::string& pattern : this->_patterns) {
+      match = match || like(pattern.c_str(), text.c_str());
+    }
+    return match;
+  }
+
+private:
+  std::string _word;
+  std::string _tag;
+  std::string _patterns[6];
+};
+
+void appendQuack(Pond::QuackResults& out, const Pond::Quack& quack) {
+  Pond::QuackView view;
+  view.tid = quack.tid;
+  view.writer_id = quack.writer_id;
+  view.text = quack.text;
+  view.date = quack.date;
+  view.time = quack.time;
+  view.replyto_tid = quack.replyto_tid;
+  view.ts = quack.ts;
+  out.append(view);
+}
+
+// -----------------------------------------------------------------------------
+// Snapshot encoding: zigzag varints and length-prefixed strings, as in the call log
+// -----------------------------------------------------------------------------
+
+void putInt(std::string& buffer, int64_t value) {
+  varint::put(buffer, varint::zigzag(value));
+}
+
+void putDouble(std::string& buffer, double value) {
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  varint::put(buffer, bits);
+}
+
+void putText(std::string& buffer, const std::string& text) {
+  varint::put(buffer, text.size());
+  buffer.append(text);
+}
+
+template <typename T>
+bool getInt(std::FILE* file, T& value) {
+  uint64_t raw;
+  if (!varint::read(file, raw)) {
+    return false;
+  }
+  value = static_cast<T>(varint::unzigzag(raw));
+  return true;
+}
+
+bool getDouble(std::FILE* file, double& value) {
+  uint64_t bits;
+  if (!varint::read(file, bits)) {
+    return false;
+  }
+  std::memcpy(&value, &bits, sizeof(value));
+  return true;
+}
+
+bool getText(std::FILE* file, std::string& text) {
+  uint64_t size;
+  if (!varint::read(file, size)) {
+    return false;
+  }
+  text.resize(size);
+  return size == 0 || std::fread(&text[0], 1, size, file) == size;
+}
+
+/**
+ * @brief Runs a query without parameters and hands every row to `f`.
+ */
+template <typename F>
+bool eachRow(sqlite3* db, const char* query, F&& f) {
+  sqlite3_stmt* stmt;
+  if (sqlite3_prepare_v2(db, query, -1, &stmt, nullptr) != SQLITE_OK) {
+    sqlite3_finalize(stmt);
+    return false;
+  }
+  int rc;
+  bool ok = true;
+  while (ok && (rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+    ok = f(stmt);
+  }
+  sqlite3_finalize(stmt);
+  return ok && rc == SQLITE_DONE;
+}
+
+} // namespace
+
+// =============================================================================
+// Public Methods
+// =============================================================================
+
+/**
+ * @brief Loads a Quacker database file or a snapshot written by `snapshot`.
+ *
+ * Anything already in the engine is discarded first.
+ *
+ * @param filename The file to load; an empty name starts an empty engine.
+ * @return true if the file was loaded.
+ */
+bool MemoryBackend::open(const std::string& filename) {
+  std::unique_lock<std::shared_mutex> lock(this->_mutex);
+  this->_clear();
+  if (filename.empty()) {
+    return true;
+  }
+
+  std::FILE* file = std::fopen(filename.c_str(), "rb");
+  if (!file) {
+    return this->_fail("cannot open " + filename);
+  }
+  char header[16] = {};
+  size_t header_size = std::fread(header, 1, sizeof(header), file);
+
+  bool loaded;
+  if (header_size >= sizeof(SNAPSHOT_MAGIC) &&
+      std::memcmp(header, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) == 0) {
+    std::fseek(file, sizeof(SNAPSHOT_MAGIC), SEEK_SET);
+    loaded = this->_loadSnapshot(file);
+    std::fclose(file);
+  } else if (header_size == sizeof(header) && std::memcmp(header, SQLITE_MAGIC, sizeof(SQLITE_MAGIC)) == 0) {
+    std::fclose(file);
+    sqlite3* db = nullptr;
+    loaded = sqlite3_open_v2(filename.c_str(), &db, SQLITE_OPEN_READONLY, nullptr) == SQLITE_OK &&
+             this->_import(db);
+    if (!loaded && this->_error.empty()) {
+      this->_error = sqlite3_errmsg(db);
+    }
+    sqlite3_close(db);
+  } else {
+    std::fclose(file);
+    return this->_fail(filename + " is neither a Quacker database nor a snapshot");
+  }
+
+  if (!loaded) {
+    std::string error = this->_error;
+    this->_clear();
+    return this->_fail(error);
+  }
+  this->_sortIndexes();
+  return true;
+}
+
+bool MemoryBackend::insertUser(int32_t usr, const std::string& name, const std::string& email,
+                               int64_t phone, const std::string& pwd) {
+  std::unique_lock<std::shared_mutex> lock(this->_mutex);
+  return this->_insertUser(usr, UserRow{name, email, phone, pwd});
+}
+
+std::optional<int32_t> MemoryBackend::maxUserID() {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  return this->_max_usr;
+}
+
+std::optional<int32_t> MemoryBackend::checkLogin(int32_t usr, const std::string& pwd) {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  auto user = this->_users.find(usr);
+  if (user == this->_users.end() || user->second.pwd != pwd) {
+    return std::nullopt;
+  }
+  return usr;
+}
+
+/**
+ * @brief Appends users whose name contains `search_terms` (case-insensitively), shortest
+ *        name first.
+ */
+bool MemoryBackend::searchUsers(const std::string& search_terms, std::vector<Pond::User>& out) {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  std::vector<int32_t> usrs;
+  this->_matchUsers(search_terms, usrs);
+  out.reserve(out.size() + usrs.size());
+  for (int32_t usr : usrs) {
+    out.push_back(Pond::User{usr, this->_users.at(usr).name});
+  }
+  return !this->interrupted();
+}
+
+/**
+ * @brief Streams users picked up front by ID, copying their names out a batch at a time;
+ *        users removed in between are skipped.
+ */
+class MemoryBackend::UserIDStream : public RowStream<std::vector<Pond::User>>
+{
+public:
+  UserIDStream(const MemoryBackend* backend, std::vector<int32_t> usrs)
+    : _backend(backend), _usrs(std::move(usrs)) {}
+
+  bool next(size_t n, std::vector<Pond::User>& out) override {
+    std::shared_lock<std::shared_mutex> lock(this->_backend->_mutex);
+    for (size_t end = std::min(this->_usrs.size(), this->_position + n); this->_position < end; ++this->_position) {
+      auto user = this->_backend->_users.find(this->_usrs[this->_position]);
+      if (user != this->_backend->_users.end()) {
+        out.push_back(Pond::User{user->first, user->second.name});
+      }
+    }
+    return true;
+  }
+
+  bool done() const override { return this->_position == this->_usrs.size(); }
+
+private:
+  const MemoryBackend* _backend;
+  std::vector<int32_t> _usrs;
+  size_t _position = 0;
+};
+
+std::unique_ptr<RowStream<std::vector<Pond::User>>> MemoryBackend::streamUsers(const std::string& search_terms) {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  std::vector<int32_t> usrs;
+  this->_matchUsers(search_terms, usrs);
+  return std::make_unique<UserIDStream>(this, std::move(usrs));
+}
+
+std::optional<int64_t> MemoryBackend::countUsers(const std::string& search_terms) {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  const std::string pattern = "%" + lower(search_terms) + "%";
+  int64_t count = 0;
+  for (const auto& [usr, row] : this->_users) {
+    count += like(pattern.c_str(), row.name.c_str());
+  }
+  return count;
+}
+
+std::optional<std::string> MemoryBackend::username(int32_t usr) {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  auto user = this->_users.find(usr);
+  if (user == this->_users.end()) {
+    return std::nullopt;
+  }
+  return user->second.name;
+}
+
+bool MemoryBackend::usersByID(const std::vector<int32_t>& usrs, std::vector<Pond::User>& out) {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  for (int32_t usr : usrs) {
+    auto user = this->_users.find(usr);
+    if (user != this->_users.end()) {
+      out.push_back(Pond::User{usr, user->second.name});
+    }
+  }
+  return true;
+}
+
+bool MemoryBackend::usersFrom(int32_t first_usr, std::vector<Pond::User>& out) {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  const size_t start = out.size();
+  for (const auto& [usr, row] : this->_users) {
+    if (usr >= first_usr) {
+      out.push_back(Pond::User{usr, row.name});
+    }
+  }
+  std::sort(out.begin() + static_cast<ptrdiff_t>(start), out.end(),
+            [](const Pond::User& a, const Pond::User& b) { return a.usr < b.usr; });
+  return true;
+}
+
+bool MemoryBackend::insertFollow(int32_t flwer, int32_t flwee, const char* start_date) {
+  std::unique_lock<std::shared_mutex> lock(this->_mutex);
+  return this->_insertFollow(flwer, flwee, start_date);
+}
+
+bool MemoryBackend::deleteFollow(int32_t flwer, int32_t flwee) {
+  std::unique_lock<std::shared_mutex> lock(this->_mutex);
+  if (this->_follow_dates.erase(pairKey(flwer, flwee)) > 0) {
+    ++this->_follows_version;
+  }
+  return true;  // deleting nothing is not an error, as in SQL
+}
+
+bool MemoryBackend::followEdges(std::vector<std::pair<int32_t, int32_t>>& out) {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  out.reserve(out.size() + this->_follow_dates.size());
+  for (const auto& [key, start_date] : this->_follow_dates) {
+    out.emplace_back(static_cast<int32_t>(key >> 32), static_cast<int32_t>(key & 0xFFFFFFFF));
+  }
+  return true;
+}
+
+std::optional<int64_t> MemoryBackend::followsVersion() {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  return this->_follows_version;
+}
+
+bool MemoryBackend::insertQuack(int32_t tid, int32_t writer_id, const std::string& text, uint64_t simhash,
+                                const Clock::Stamp& now, std::optional<int32_t> replyto_tid) {
+  std::unique_lock<std::shared_mutex> lock(this->_mutex);
+  return this->_insertQuack(Pond::Quack{tid, writer_id, text, now.date, now.time,
+                                        replyto_tid.value_or(0), now.ts}, simhash, true);
+}
+
+std::optional<int32_t> MemoryBackend::maxQuackID() {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  return this->_max_tid;
+}
+
+bool MemoryBackend::simhashesFrom(int32_t first_tid, size_t limit,
+                                  std::vector<std::pair<int32_t, uint64_t>>& out) {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  if (first_tid > this->_max_tid) {
+    return true;
+  }
+  std::vector<std::pair<int32_t, uint64_t>> found;
+  for (const auto& [tid, simhash] : this->_simhashes) {
+    if (tid >= first_tid) {
+      found.emplace_back(tid, simhash);
+    }
+  }
+  if (found.size() > limit) {
+    std::nth_element(found.begin(), found.begin() + limit, found.end());
+    found.resize(limit);
+  }
+  std::sort(found.begin(), found.end());
+  out.insert(out.end(), found.begin(), found.end());
+  return true;
+}
+
+bool MemoryBackend::quackByID(int32_t tid, Pond::QuackResults& out) {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  auto quack = this->_quacks.find(tid);
+  if (quack != this->_quacks.end()) {
+    appendQuack(out, quack->second);
+  }
+  return true;
+}
+
+bool MemoryBackend::quacksByID(const std::vector<int32_t>& tids, Pond::QuackResults& out) {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  std::vector<int32_t> found;
+  for (int32_t tid : tids) {
+    if (this->_quacks.count(tid)) {
+      found.push_back(tid);
+    }
+  }
+  std::sort(found.begin(), found.end());
+  found.erase(std::unique(found.begin(), found.end()), found.end());
+  std::sort(found.begin(), found.end(), [this](int32_t a, int32_t b) { return this->_olderQuack(b, a); });
+  out.reserve(out.size() + found.size());
+  for (int32_t tid : found) {
+    appendQuack(out, this->_quacks.at(tid));
+  }
+  return true;
+}
+
+bool MemoryBackend::quacksFrom(int32_t first_tid, size_t limit, Pond::QuackResults& out) {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  std::vector<int32_t> found;
+  for (const auto& [tid, quack] : this->_quacks) {
+    if (tid >= first_tid) {
+      found.push_back(tid);
+    }
+  }
+  if (found.size() > limit) {
+    std::nth_element(found.begin(), found.begin() + limit, found.end());
+    found.resize(limit);
+  }
+  std::sort(found.begin(), found.end());
+  out.reserve(out.size() + found.size());
+  for (int32_t tid : found) {
+    appendQuack(out, this->_quacks.at(tid));
+  }
+  return true;
+}
+
+bool MemoryBackend::quacksByWriter(int32_t writer_id, Pond::QuackResults& out) {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  auto quacks = this->_by_writer.find(writer_id);
+  if (quacks == this->_by_writer.end()) {
+    return true;
+  }
+  out.reserve(out.size() + quacks->second.size());
+  for (auto tid = quacks->second.rbegin(); tid != quacks->second.rend(); ++tid) {
+    appendQuack(out, this->_quacks.at(*tid));
+  }
+  return true;
+}
+
+bool MemoryBackend::replies(int32_t tid, std::vector<int32_t>& out) {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  auto replies = this->_replies.find(tid);
+  if (replies != this->_replies.end()) {
+    out.insert(out.end(), replies->second.begin(), replies->second.end());
+  }
+  return true;
+}
+
+/**
+ * @brief Walks the conversation depth first from its root, replies in ID order.
+ */
+bool MemoryBackend::thread(int32_t root_tid, int32_t max_depth, size_t limit, Pond::QuackResults& out,
+                           std::vector<int32_t>& depths) {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  if (this->_quacks.find(root_tid) == this->_quacks.end()) {
+    return true;
+  }
+  std::vector<std::pair<int32_t, int32_t>> stack{{root_tid, 0}};  // (tid, depth), next on top
+  for (size_t rows = 0; rows < limit && !stack.empty(); ++rows) {
+    const auto [tid, depth] = stack.back();
+    stack.pop_back();
+    appendQuack(out, this->_quacks.at(tid));
+    depths.push_back(depth);
+
+    auto replies = this->_replies.find(tid);
+    if (depth < max_depth && replies != this->_replies.end()) {
+      for (auto reply = replies->second.rbegin(); reply != replies->second.rend(); ++reply) {
+        stack.emplace_back(*reply, depth + 1);
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Appends the quacks and non-spam requacks of the given users, most recent first.
+ */
+bool MemoryBackend::feed(const std::vector<int32_t>& followees, std::vector<FeedEntry>& out) {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+
+  // Each followee's quacks and requacks are read newest first from their sorted lists
+  // and merged, so the rows appended before the deadline passes are the newest of the feed
+  struct Source {
+    const std::string* name;
+    const std::vector<int32_t>* quacks;     // set for a followee's quacks
+    const std::vector<uint64_t>* requacks;  // set for a followee's requacks
+    size_t at;                              // the list index of the next row
+    int64_t ts;                             // the next row's
+    int32_t tid;
+  };
+  auto advance = [this](Source& source) {
+    while (source.at > 0) {
+      --source.at;
+      if (source.quacks) {
+        source.tid = (*source.quacks)[source.at];
+        source.ts = this->_quacks.at(source.tid).ts;
+        return true;
+      }
+      const RequackRow& requack = this->_requacks.at((*source.requacks)[source.at]);
+      if (!requack.spam && this->_quacks.count(requack.tid)) {
+        source.tid = requack.tid;
+        source.ts = requack.ts;
+        return true;
+      }
+    }
+    return false;
+  };
+
+  std::vector<Source> sources;
+  for (int32_t flwee : followees) {
+    auto user = this->_users.find(flwee);
+    if (user == this->_users.end()) {
+      continue;
+    }
+    auto quacks = this->_by_writer.find(flwee);
+    if (quacks != this->_by_writer.end()) {
+      sources.push_back(Source{&user->second.name, &quacks->second, nullptr, quacks->second.size(), 0, 0});
+    }
+    auto requacks = this->_by_requacker.find(flwee);
+    if (requacks != this->_by_requacker.end()) {
+      sources.push_back(Source{&user->second.name, nullptr, &requacks->second, requacks->second.size(), 0, 0});
+    }
+  }
+
+  // The sources with rows left to merge, newest next row on top
+  std::vector<size_t> heap;
+  auto newer = [&sources](size_t a, size_t b) {
+    const Source& x = sources[a];
+    const Source& y = sources[b];
+    return x.ts != y.ts ? x.ts < y.ts : x.tid < y.tid;
+  };
+  auto push = [&](size_t i) {
+    heap.push_back(i);
+    std::push_heap(heap.begin(), heap.end(), newer);
+  };
+  for (size_t i = 0; i < sources.size(); ++i) {
+    if (advance(sources[i])) {
+      push(i);
+    }
+  }
+
+  size_t merged = 0;
+  while (!heap.empty()) {
+    if (++merged % DEADLINE_CHECK_ROWS == 0 && this->_deadlinePassed()) {
+      return false;
+    }
+    std::pop_heap(heap.begin(), heap.end(), newer);
+    const size_t i = heap.back();
+    heap.pop_back();
+    Source& source = sources[i];
+    if (source.quacks) {
+      const Pond::Quack& quack = this->_quacks.at(source.tid);
+      out.push_back(FeedEntry{source.tid, *source.name, quack.date, quack.time, quack.text, quack.ts});
+    } else {
+      const RequackRow& requack = this->_requacks.at((*source.requacks)[source.at]);
+      const Pond::Quack& quack = this->_quacks.at(requack.tid);
+      out.push_back(FeedEntry{requack.tid, *source.name, requack.rdate, quack.time, quack.text, requack.ts});
+    }
+    if (advance(source)) {
+      push(i);
+    }
+  }
+  return true;
+}
+
+bool MemoryBackend::searchQuacksByHashtag(const std::string& pattern, Pond::QuackResults& out,
+                                          const std::unordered_set<int32_t>& seen) {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  std::vector<int32_t> tids;
+  this->_matchHashtag(lower(pattern), tids);
+  out.reserve(out.size() + tids.size());
+  for (int32_t tid : tids) {
+    if (!seen.count(tid)) {
+      appendQuack(out, this->_quacks.at(tid));
+    }
+  }
+  return true;
+}
+
+bool MemoryBackend::searchQuacksByWord(const std::string& keyword, Pond::QuackResults& out,
+                                       std::unordered_set<int32_t>& seen) {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  const WordMatcher matcher(keyword);
+  size_t visited = 0;
+  for (auto tid = this->_timeline.rbegin(); tid != this->_timeline.rend(); ++tid) {
+    if (++visited % DEADLINE_CHECK_ROWS == 0 && this->_deadlinePassed()) {
+      return false;
+    }
+    if (seen.count(*tid)) {
+      continue;
+    }
+    const Pond::Quack& quack = this->_quacks.at(*tid);
+    if (matcher.matches(this->_text_lower.at(*tid))) {
+      appendQuack(out, quack);
+      seen.insert(*tid);
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Streams quacks picked up front by ID, copying them out a batch at a time;
+ *        quacks removed in between are skipped.
+ */
+class MemoryBackend::QuackIDStream : public RowStream<Pond::QuackResults>
+{
+public:
+  QuackIDStream(const MemoryBackend* backend, std::vector<int32_t> tids)
+    : _backend(backend), _tids(std::move(tids)) {}
+
+  bool next(size_t n, Pond::QuackResults& out) override {
+    std::shared_lock<std::shared_mutex> lock(this->_backend->_mutex);
+    for (size_t end = std::min(this->_tids.size(), this->_position + n); this->_position < end; ++this->_position) {
+      auto quack = this->_backend->_quacks.find(this->_tids[this->_position]);
+      if (quack != this->_backend->_quacks.end()) {
+        appendQuack(out, quack->second);
+      }
+    }
+    return true;
+  }
+
+  bool done() const override { return this->_position == this->_tids.size(); }
+
+private:
+  const MemoryBackend* _backend;
+  std::vector<int32_t> _tids;
+  size_t _position = 0;
+};
+
+/**
+ * @brief Streams the quacks matching a keyword, scanning the timeline from the newest
+ *        quack only as far as each batch needs.
+ *
+ * The scan resumes below the last quack it looked at, found again by `(ts, tid)`, so
+ * quacks inserted between batches neither shift nor repeat the results.
+ */
+class MemoryBackend::WordStream : public RowStream<Pond::QuackResults>
+{
+public:
+  WordStream(const MemoryBackend* backend, const std::string& keyword)
+    : _backend(backend), _matcher(keyword) {}
+
+  bool next(size_t n, Pond::QuackResults& out) override {
+    std::shared_lock<std::shared_mutex> lock(this->_backend->_mutex);
+    const std::vector<int32_t>& timeline = this->_backend->_timeline;
+    auto resume = timeline.end();
+    if (this->_last) {
+      resume = std::lower_bound(timeline.begin(), timeline.end(), *this->_last,
+                                [this](int32_t tid, int32_t) { return this->_olderThanLast(tid); });
+    }
+    size_t found = 0;
+    for (auto tid = std::make_reverse_iterator(resume); tid != timeline.rend() && found < n; ++tid) {
+      const Pond::Quack& quack = this->_backend->_quacks.at(*tid);
+      this->_last = *tid;
+      this->_last_ts = quack.ts;
+      if (this->_matcher.matches(this->_backend->_text_lower.at(*tid))) {
+        appendQuack(out, quack);
+        ++found;
+      }
+    }
+    if (found < n) {
+      this->_done = true;
+    }
+    return true;
+  }
+
+  bool done() const override { return this->_done; }
+
+private:
+  const MemoryBackend* _backend;
+  WordMatcher _matcher;
+  std::optional<int32_t> _last;  // the oldest quack looked at so far
+  int64_t _last_ts = 0;
+  bool _done = false;
+
+  /**
+   * @brief Returns true if `tid` is older than the last quack looked at.
+   */
+  bool _olderThanLast(int32_t tid) const {
+    const int64_t ts = this->_backend->_quacks.at(tid).ts;
+    return ts != this->_last_ts ? ts < this->_last_ts : tid < *this->_last;
+  }
+};
+
+std::unique_ptr<RowStream<Pond::QuackResults>> MemoryBackend::streamQuacksByHashtag(const std::string& pattern) {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  std::vector<int32_t> tids;
+  this->_matchHashtag(lower(pattern), tids);
+  return std::make_unique<QuackIDStream>(this, std::move(tids));
+}
+
+std::unique_ptr<RowStream<Pond::QuackResults>> MemoryBackend::streamQuacksByWord(const std::string& keyword) {
+  return std::make_unique<WordStream>(this, keyword);
+}
+
+std::optional<int64_t> MemoryBackend::countQuacksByHashtag(const std::string& pattern) {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  const std::string folded = lower(pattern);
+  int64_t count = 0;
+  auto add = [&](const std::vector<int32_t>& postings) {
+    for (int32_t tid : postings) {
+      count += this->_quacks.count(tid);
+    }
+  };
+  if (folded.find_first_of("%_") == std::string::npos) {
+    auto term_id = this->_term_ids.find(folded);
+    if (term_id != this->_term_ids.end()) {
+      add(this->_hashtags[term_id->second]);
+    }
+  } else {
+    for (size_t term_id = 0; term_id < this->_terms.size(); ++term_id) {
+      if (like(folded.c_str(), this->_terms[term_id].c_str())) {
+        add(this->_hashtags[term_id]);
+      }
+    }
+  }
+  return count;
+}
+
+std::optional<int64_t> MemoryBackend::countQuacksByWord(const std::string& keyword) {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  const WordMatcher matcher(keyword);
+  int64_t count = 0;
+  for (int32_t tid : this->_timeline) {
+    count += matcher.matches(this->_text_lower.at(tid));
+  }
+  return count;
+}
+
+bool MemoryBackend::hashtagMentionsSince(int64_t since, std::vector<std::pair<int64_t, std::string>>& out) {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  auto first = std::lower_bound(this->_timeline.begin(), this->_timeline.end(), since,
+                                [this](int32_t tid, int64_t ts) { return this->_quacks.at(tid).ts < ts; });
+  for (auto tid = first; tid != this->_timeline.end(); ++tid) {
+    auto terms = this->_quack_hashtags.find(*tid);
+    if (terms == this->_quack_hashtags.end()) {
+      continue;
+    }
+    const int64_t ts = this->_quacks.at(*tid).ts;
+    for (int32_t term_id : terms->second) {
+      out.emplace_back(ts, this->_terms[term_id]);
+    }
+  }
+  return true;
+}
+
+bool MemoryBackend::hashtagMentionsFrom(int32_t first_tid, std::vector<std::pair<int32_t, std::string>>& out) {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  size_t first = out.size();
+  for (const auto& [tid, terms] : this->_quack_hashtags) {
+    if (tid >= first_tid) {
+      for (int32_t term_id : terms) {
+        out.emplace_back(tid, this->_terms[term_id]);
+      }
+    }
+  }
+  // Stable, so each quack's hashtags keep the order they were linked in
+  std::stable_sort(out.begin() + first, out.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+  return true;
+}
+
+bool MemoryBackend::hashtagsOf(int32_t tid, std::vector<std::string>& out) {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  auto terms = this->_quack_hashtags.find(tid);
+  if (terms != this->_quack_hashtags.end()) {
+    for (int32_t term_id : terms->second) {
+      out.push_back(this->_terms[term_id]);
+    }
+  }
+  return true;
+}
+
+bool MemoryBackend::hashtagHours(const std::string& term, int64_t from_hour, int64_t to_hour,
+                                 std::vector<std::pair<int64_t, int64_t>>& out) {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  auto term_id = this->_term_ids.find(lower(term));
+  if (term_id == this->_term_ids.end() || from_hour >= to_hour) {
+    return true;
+  }
+  const std::map<int64_t, int64_t>& hours = this->_hashtag_hours[term_id->second];
+  auto end = hours.lower_bound(to_hour);
+  for (auto hour = hours.lower_bound(from_hour); hour != end; ++hour) {
+    out.emplace_back(hour->first, hour->second);
+  }
+  return true;
+}
+
+bool MemoryBackend::topHashtagsBetween(int64_t from_hour, int64_t to_hour, size_t limit,
+                                       std::vector<std::pair<std::string, int64_t>>& out) {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  std::vector<std::pair<std::string, int64_t>> totals;
+  if (from_hour < to_hour) {
+    for (size_t term_id = 0; term_id < this->_terms.size(); ++term_id) {
+      const std::map<int64_t, int64_t>& hours = this->_hashtag_hours[term_id];
+      int64_t total = 0;
+      auto end = hours.lower_bound(to_hour);
+      for (auto hour = hours.lower_bound(from_hour); hour != end; ++hour) {
+        total += hour->second;
+      }
+      if (total > 0) {
+        totals.emplace_back(this->_terms[term_id], total);
+      }
+    }
+  }
+
+  auto more = [](const auto& a, const auto& b) {
+    return a.second != b.second ? a.second > b.second : a.first < b.first;
+  };
+  const size_t kept = std::min(limit, totals.size());
+  std::partial_sort(totals.begin(), totals.begin() + kept, totals.end(), more);
+  out.insert(out.end(), std::make_move_iterator(totals.begin()), std::make_move_iterator(totals.begin() + kept));
+  return true;
+}
+
+bool MemoryBackend::rebuildHashtagRollups() {
+  std::unique_lock<std::shared_mutex> lock(this->_mutex);
+  this->_hashtag_hours.assign(this->_terms.size(), {});
+  for (const auto& [tid, terms] : this->_quack_hashtags) {
+    auto quack = this->_quacks.find(tid);
+    if (quack == this->_quacks.end()) {
+      continue;
+    }
+    for (int32_t term_id : terms) {
+      this->_countHashtag(term_id, quack->second.ts);
+    }
+  }
+  return true;
+}
+
+std::optional<int32_t> MemoryBackend::upsertRequack(int32_t tid, int32_t retweeter_id, int32_t spam,
+                                                    const Clock::Stamp& now) {
+  std::unique_lock<std::shared_mutex> lock(this->_mutex);
+  return this->_upsertRequack(tid, retweeter_id, spam, now);
+}
+
+bool MemoryBackend::upsertRequacks(const std::vector<RequackWrite>& requacks, const Clock::Stamp& now,
+                                   std::vector<int32_t>& out) {
+  std::unique_lock<std::shared_mutex> lock(this->_mutex);
+  out.reserve(out.size() + requacks.size());
+  for (const RequackWrite& requack : requacks) {
+    out.push_back(this->_upsertRequack(requack.tid, requack.retweeter_id, requack.spam, now));
+  }
+  return true;
+}
+
+std::optional<int32_t> MemoryBackend::requackCount(int32_t tid) {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  auto count = this->_requack_counts.find(tid);
+  return count == this->_requack_counts.end() ? 0 : count->second;
+}
+
+std::optional<bool> MemoryBackend::requackedAny(int32_t retweeter_id, const std::vector<int32_t>& tids) {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  return std::any_of(tids.begin(), tids.end(), [&](int32_t tid) {
+    return this->_requacks.count(pairKey(tid, retweeter_id)) > 0;
+  });
+}
+
+std::optional<bool> MemoryBackend::insertHashtag(int32_t tid, const std::string& term) {
+  std::unique_lock<std::shared_mutex> lock(this->_mutex);
+  return this->_insertHashtag(tid, term);
+}
+
+bool MemoryBackend::insertList(int32_t owner_id, const std::string& lname) {
+  std::unique_lock<std::shared_mutex> lock(this->_mutex);
+  if (!this->_lists[owner_id].emplace(lname, std::vector<ListEntry>()).second) {
+    return this->_fail("UNIQUE constraint failed: lists.owner_id, lists.lname");
+  }
+  return true;
+}
+
+bool MemoryBackend::insertListEntry(int32_t owner_id, const std::string& lname, int32_t tid) {
+  std::unique_lock<std::shared_mutex> lock(this->_mutex);
+  return this->_insertListEntry(owner_id, lname, tid, true);
+}
+
+bool MemoryBackend::listExists(int32_t owner_id, const std::string& lname) {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  auto lists = this->_lists.find(owner_id);
+  return lists != this->_lists.end() && lists->second.count(lname);
+}
+
+bool MemoryBackend::lists(int32_t owner_id, std::vector<Pond::ListSummary>& out) {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  auto lists = this->_lists.find(owner_id);
+  if (lists == this->_lists.end()) {
+    return true;
+  }
+  size_t first = out.size();
+  for (const auto& [lname, entries] : lists->second) {
+    out.push_back(Pond::ListSummary{lname, static_cast<int64_t>(entries.size())});
+  }
+  std::sort(out.begin() + first, out.end(),
+            [](const Pond::ListSummary& a, const Pond::ListSummary& b) { return a.name < b.name; });
+  return true;
+}
+
+/**
+ * @brief Walks a list back in time from just before the cursor, skipping entries whose
+ *        quack does not exist, like the database's join.
+ */
+bool MemoryBackend::listQuacks(int32_t owner_id, const std::string& lname, const std::optional<Pond::ListCursor>& after,
+                               size_t limit, Pond::QuackResults& out) {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  auto lists = this->_lists.find(owner_id);
+  if (lists == this->_lists.end()) {
+    return true;
+  }
+  auto list = lists->second.find(lname);
+  if (list == lists->second.end()) {
+    return true;
+  }
+  const std::vector<ListEntry>& entries = list->second;
+  auto end = after ? std::lower_bound(entries.begin(), entries.end(), ListEntry{after->ts, after->tid}) : entries.end();
+  for (size_t rows = 0; rows < limit && end != entries.begin();) {
+    --end;
+    auto quack = this->_quacks.find(end->second);
+    if (quack != this->_quacks.end()) {
+      appendQuack(out, quack->second);
+      ++rows;
+    }
+  }
+  return true;
+}
+
+bool MemoryBackend::userRanks(std::vector<std::pair<int32_t, double>>& out) {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  out.insert(out.end(), this->_ranks.begin(), this->_ranks.end());
+  return true;
+}
+
+bool MemoryBackend::replaceUserRanks(const std::vector<std::pair<int32_t, double>>& ranks) {
+  std::unique_lock<std::shared_mutex> lock(this->_mutex);
+  this->_ranks.clear();
+  for (const auto& [usr, score] : ranks) {
+    if (this->_users.count(usr)) {
+      this->_ranks[usr] = score;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Writes every row to a binary snapshot that `open` can reload.
+ *
+ * After the `QKSN` magic and a version byte the file holds one section per table, each a
+ * row count followed by the rows' columns as zigzag varints and length-prefixed strings.
+ *
+ * @param filename The snapshot to write; an existing file is replaced.
+ * @return true if the snapshot was written.
+ */
+bool MemoryBackend::snapshot(const std::string& filename) {
+  std::string buffer(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+  {
+    std::shared_lock<std::shared_mutex> lock(this->_mutex);
+    buffer.push_back(static_cast<char>(SNAPSHOT_VERSION));
+
+    varint::put(buffer, this->_users.size());
+    for (const auto& [usr, row] : this->_users) {
+      putInt(buffer, usr);
+      putText(buffer, row.name);
+      putText(buffer, row.email);
+      putInt(buffer, row.phone);
+      putText(buffer, row.pwd);
+    }
+
+    varint::put(buffer, this->_follow_dates.size());
+    for (const auto& [key, start_date] : this->_follow_dates) {
+      putInt(buffer, static_cast<int32_t>(key >> 32));
+      putInt(buffer, static_cast<int32_t>(key & 0xFFFFFFFF));
+      putText(buffer, start_date);
+    }
+
+    varint::put(buffer, this->_timeline.size());
+    for (int32_t tid : this->_timeline) {
+      const Pond::Quack& quack = this->_quacks.at(tid);
+      putInt(buffer, quack.tid);
+      putInt(buffer, quack.writer_id);
+      putText(buffer, quack.text);
+      putText(buffer, quack.date);
+      putText(buffer, quack.time);
+      putInt(buffer, quack.replyto_tid);
+      putInt(buffer, quack.ts);
+    }
+
+    varint::put(buffer, this->_requacks.size());
+    for (const auto& [key, row] : this->_requacks) {
+      putInt(buffer, row.tid);
+      putInt(buffer, row.retweeter_id);
+      putInt(buffer, row.writer_id);
+      putInt(buffer, row.spam);
+      putText(buffer, row.rdate);
+      putInt(buffer, row.ts);
+    }
+
+    size_t hashtag_count = 0;
+    for (const auto& [tid, terms] : this->_quack_hashtags) {
+      hashtag_count += terms.size();
+    }
+    varint::put(buffer, hashtag_count);
+    for (const auto& [tid, terms] : this->_quack_hashtags) {
+      for (int32_t term_id : terms) {
+        putInt(buffer, tid);
+        putText(buffer, this->_terms[term_id]);
+      }
+    }
+
+    size_t list_count = 0;
+    for (const auto& [owner_id, lists] : this->_lists) {
+      list_count += lists.size();
+    }
+    varint::put(buffer, list_count);
+    for (const auto& [owner_id, lists] : this->_lists) {
+      for (const auto& [lname, entries] : lists) {
+        putInt(buffer, owner_id);
+        putText(buffer, lname);
+        varint::put(buffer, entries.size());
+        for (const ListEntry& entry : entries) {
+          putInt(buffer, entry.second);
+        }
+      }
+    }
+
+    varint::put(buffer, this->_ranks.size());
+    for (const auto& [usr, score] : this->_ranks) {
+      putInt(buffer, usr);
+      putDouble(buffer, score);
+    }
+  }
+
+  const std::string temp_filename = filename + ".tmp";
+  std::FILE* file = std::fopen(temp_filename.c_str(), "wb");
+  if (!file) {
+    std::unique_lock<std::shared_mutex> lock(this->_mutex);
+    return this->_fail("cannot create " + temp_filename);
+  }
+  bool written = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+  written = std::fclose(file) == 0 && written;
+  if (!written || std::rename(temp_filename.c_str(), filename.c_str()) != 0) {
+    std::remove(temp_filename.c_str());
+    std::unique_lock<std::shared_mutex> lock(this->_mutex);
+    return this->_fail("cannot write " + filename);
+  }
+  return true;
+}
+
+std::string MemoryBackend::lastError() const {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+  return this->_error;
+}
+
+// =============================================================================
+// Private Methods
+// =============================================================================
+
+bool MemoryBackend::_insertUser(int32_t usr, UserRow row) {
+  if (!this->_users.emplace(usr, std::move(row)).second) {
+    return this->_fail("UNIQUE constraint failed: users.usr");
+  }
+  this->_max_usr = std::max(this->_max_usr, usr);
+  return true;
+}
+
+bool MemoryBackend::_insertFollow(int32_t flwer, int32_t flwee, const std::string& start_date) {
+  if (!this->_follow_dates.emplace(pairKey(flwer, flwee), start_date).second) {
+    return this->_fail("UNIQUE constraint failed: follows.flwer, follows.flwee");
+  }
+  ++this->_follows_version;
+  return true;
+}
+
+bool MemoryBackend::_insertQuack(Pond::Quack quack, uint64_t simhash, bool sorted) {
+  const int32_t tid = quack.tid;
+  const int32_t writer_id = quack.writer_id;
+  const int32_t replyto_tid = quack.replyto_tid;
+  const int64_t ts = quack.ts;
+  std::string text_lower = lower(quack.text);
+  if (!this->_quacks.emplace(tid, std::move(quack)).second) {
+    return this->_fail("UNIQUE constraint failed: tweets.tid");
+  }
+  this->_text_lower.emplace(tid, std::move(text_lower));
+  this->_simhashes.emplace(tid, simhash);
+  this->_max_tid = std::max(this->_max_tid, tid);
+
+  auto terms = this->_quack_hashtags.find(tid);
+  if (terms != this->_quack_hashtags.end()) {
+    for (int32_t term_id : terms->second) {
+      this->_countHashtag(term_id, ts);
+    }
+  }
+
+  std::vector<int32_t>& by_writer = this->_by_writer[writer_id];
+  if (sorted) {
+    // New quacks almost always carry the newest ts, so this lands at the end
+    auto older = [this](int32_t a, int32_t b) { return this->_olderQuack(a, b); };
+    by_writer.insert(std::upper_bound(by_writer.begin(), by_writer.end(), tid, older), tid);
+    this->_timeline.insert(std::upper_bound(this->_timeline.begin(), this->_timeline.end(), tid, older), tid);
+  } else {
+    by_writer.push_back(tid);
+    this->_timeline.push_back(tid);
+  }
+  if (replyto_tid != 0) {
+    std::vector<int32_t>& replies = this->_replies[replyto_tid];
+    replies.insert(sorted ? std::upper_bound(replies.begin(), replies.end(), tid) : replies.end(), tid);
+  }
+  return true;
+}
+
+/**
+ * @brief Inserts a new requack or marks an existing one as spam; the caller holds the
+ *        write lock.
+ *
+ * @return The requack's spam flag, or -1 if the quack does not exist.
+ */
+int32_t MemoryBackend::_upsertRequack(int32_t tid, int32_t retweeter_id, int32_t spam, const Clock::Stamp& now) {
+  auto requack = this->_requacks.find(pairKey(tid, retweeter_id));
+  if (requack != this->_requacks.end()) {
+    requack->second.spam = 1;
+    return 1;
+  }
+  auto quack = this->_quacks.find(tid);
+  if (quack == this->_quacks.end()) {
+    return -1;
+  }
+  this->_insertRequack(RequackRow{tid, retweeter_id, quack->second.writer_id, spam, now.date, now.ts}, true);
+  return spam;
+}
+
+bool MemoryBackend::_insertRequack(RequackRow row, bool sorted) {
+  const uint64_t key = pairKey(row.tid, row.retweeter_id);
+  const int32_t tid = row.tid;
+  const int32_t retweeter_id = row.retweeter_id;
+  if (!this->_requacks.emplace(key, std::move(row)).second) {
+    return this->_fail("UNIQUE constraint failed: retweets.tid, retweets.retweeter_id");
+  }
+  ++this->_requack_counts[tid];
+
+  std::vector<uint64_t>& by_requacker = this->_by_requacker[retweeter_id];
+  if (sorted) {
+    auto older = [this](uint64_t a, uint64_t b) { return this->_olderRequack(a, b); };
+    by_requacker.insert(std::upper_bound(by_requacker.begin(), by_requacker.end(), key, older), key);
+  } else {
+    by_requacker.push_back(key);
+  }
+  return true;
+}
+
+bool MemoryBackend::_insertHashtag(int32_t tid, const std::string& term) {
+  const int32_t term_id = this->_internTerm(lower(term));
+  std::vector<int32_t>& terms = this->_quack_hashtags[tid];
+  if (std::find(terms.begin(), terms.end(), term_id) != terms.end()) {
+    return false;  // already linked in some case; skipped like the SQL ON CONFLICT
+  }
+  terms.push_back(term_id);
+  this->_hashtags[term_id].push_back(tid);
+
+  // Hashtags usually arrive before their quack, which counts them when it is inserted
+  auto quack = this->_quacks.find(tid);
+  if (quack != this->_quacks.end()) {
+    this->_countHashtag(term_id, quack->second.ts);
+  }
+  return true;
+}
+
+/**
+ * @brief Returns the ID of a lower-cased hashtag, assigning the next one if it is new.
+ */
+int32_t MemoryBackend::_internTerm(const std::string& folded) {
+  auto [entry, added] = this->_term_ids.emplace(folded, static_cast<int32_t>(this->_terms.size()));
+  if (added) {
+    this->_terms.push_back(folded);
+    this->_hashtags.emplace_back();
+    this->_hashtag_hours.emplace_back();
+  }
+  return entry->second;
+}
+
+void MemoryBackend::_countHashtag(int32_t term_id, int64_t ts) {
+  ++this->_hashtag_hours[term_id][ts / HOUR_US];
+}
+
+bool MemoryBackend::_insertListEntry(int32_t owner_id, const std::string& lname, int32_t tid, bool sorted) {
+  auto lists = this->_lists.find(owner_id);
+  if (lists == this->_lists.end() || !lists->second.count(lname)) {
+    return this->_fail("no such list: " + lname);
+  }
+  std::vector<ListEntry>& entries = lists->second[lname];
+  const ListEntry entry = this->_listEntry(tid);
+  if (!sorted) {
+    entries.push_back(entry);
+    return true;
+  }
+  auto position = std::lower_bound(entries.begin(), entries.end(), entry);
+  if (position != entries.end() && *position == entry) {
+    return this->_fail("UNIQUE constraint failed: include.owner_id, include.lname, include.tid");
+  }
+  entries.insert(position, entry);
+  return true;
+}
+
+bool MemoryBackend::_fail(const std::string& error) {
+  this->_error = error;
+  return false;
+}
+
+/**
+ * @brief Copies every table of an open Quacker database into the engine.
+ */
+bool MemoryBackend::_import(sqlite3* db) {
+  return
+    eachRow(db, "SELECT usr, name, email, phone, pwd FROM users", [&](sqlite3_stmt* stmt) {
+      return this->_insertUser(sqlite3_column_int(stmt, 0),
+                               UserRow{sql::columnText(stmt, 1), sql::columnText(stmt, 2),
+                                       sqlite3_column_int64(stmt, 3), sql::columnText(stmt, 4)});
+    }) &&
+    eachRow(db, "SELECT flwer, flwee, start_date FROM follows", [&](sqlite3_stmt* stmt) {
+      return this->_insertFollow(sqlite3_column_int(stmt, 0), sqlite3_column_int(stmt, 1),
+                                 sql::columnText(stmt, 2));
+    }) &&
+    eachRow(db, "SELECT tid, writer_id, text, tdate, ttime, replyto_tid, ts FROM tweets", [&](sqlite3_stmt* stmt) {
+      Pond::Quack quack{sqlite3_column_int(stmt, 0), sqlite3_column_int(stmt, 1), sql::columnText(stmt, 2),
+                        sql::columnText(stmt, 3), sql::columnText(stmt, 4), sqlite3_column_int(stmt, 5),
+                        sqlite3_column_int64(stmt, 6)};
+      const uint64_t simhash = SimHashIndex::fingerprint(quack.text);
+      return this->_insertQuack(std::move(quack), simhash, false);
+    }) &&
+    eachRow(db, "SELECT tid, retweeter_id, writer_id, spam, rdate, ts FROM retweets", [&](sqlite3_stmt* stmt) {
+      return this->_insertRequack(RequackRow{sqlite3_column_int(stmt, 0), sqlite3_column_int(stmt, 1),
+                                             sqlite3_column_int(stmt, 2), sqlite3_column_int(stmt, 3),
+                                             sql::columnText(stmt, 4), sqlite3_column_int64(stmt, 5)}, false);
+    }) &&
+    eachRow(db, "SELECT ht.tid, h.term_lower FROM hashtag_mentions ht JOIN hashtags h ON h.term_id = ht.term_id",
+            [&](sqlite3_stmt* stmt) {
+      this->_insertHashtag(sqlite3_column_int(stmt, 0), sql::columnText(stmt, 1));
+      return true;
+    }) &&
+    eachRow(db, "SELECT owner_id, lname FROM lists", [&](sqlite3_stmt* stmt) {
+      this->_lists[sqlite3_column_int(stmt, 0)].emplace(sql::columnText(stmt, 1), std::vector<ListEntry>());
+      return true;
+    }) &&
+    eachRow(db, "SELECT owner_id, lname, tid FROM include", [&](sqlite3_stmt* stmt) {
+      // Entries of lists that no longer exist are dropped rather than failing the import
+      this->_insertListEntry(sqlite3_column_int(stmt, 0), sql::columnText(stmt, 1),
+                             sqlite3_column_int(stmt, 2), false);
+      return true;
+    }) &&
+    eachRow(db, "SELECT usr, score FROM user_rank", [&](sqlite3_stmt* stmt) {
+      this->_ranks[sqlite3_column_int(stmt, 0)] = sqlite3_column_double(stmt, 1);
+      return true;
+    });
+}
+
+/**
+ * @brief Reads the sections of a snapshot, positioned just past its magic.
+ */
+bool MemoryBackend::_loadSnapshot(std::FILE* file) {
+  const int version = std::fgetc(file);
+  if (version < 1 || version > SNAPSHOT_VERSION) {
+    return this->_fail("unsupported snapshot version");
+  }
+  auto truncated = [this]() { return this->_fail("truncated snapshot"); };
+
+  uint64_t count;
+  if (!varint::read(file, count)) return truncated();
+  for (uint64_t i = 0; i < count; ++i) {
+    int32_t usr;
+    UserRow row;
+    if (!getInt(file, usr) || !getText(file, row.name) || !getText(file, row.email) ||
+        !getInt(file, row.phone) || !getText(file, row.pwd)) {
+      return truncated();
+    }
+    if (!this->_insertUser(usr, std::move(row))) return false;
+  }
+
+  if (!varint::read(file, count)) return truncated();
+  for (uint64_t i = 0; i < count; ++i) {
+    int32_t flwer, flwee;
+    std::string start_date;
+    if (!getInt(file, flwer) || !getInt(file, flwee) || !getText(file, start_date)) return truncated();
+    if (!this->_insertFollow(flwer, flwee, start_date)) return false;
+  }
+
+  if (!varint::read(file, count)) return truncated();
+  for (uint64_t i = 0; i < count; ++i) {
+    Pond::Quack quack;
+    if (!getInt(file, quack.tid) || !getInt(file, quack.writer_id) || !getText(file, quack.text) ||
+        !getText(file, quack.date) || !getText(file, quack.time) || !getInt(file, quack.replyto_tid) ||
+        !getInt(file, quack.ts)) {
+      return truncated();
+    }
+    const uint64_t simhash = SimHashIndex::fingerprint(quack.text);
+    if (!this->_insertQuack(std::move(quack), simhash, false)) return false;
+  }
+
+  if (!varint::read(file, count)) return truncated();
+  for (uint64_t i = 0; i < count; ++i) {
+    RequackRow row;
+    if (!getInt(file, row.tid) || !getInt(file, row.retweeter_id) || !getInt(file, row.writer_id) ||
+        !getInt(file, row.spam) || !getText(file, row.rdate) || !getInt(file, row.ts)) {
+      return truncated();
+    }
+    if (!this->_insertRequack(std::move(row), false)) return false;
+  }
+
+  if (!varint::read(file, count)) return truncated();
+  for (uint64_t i = 0; i < count; ++i) {
+    int32_t tid;
+    std::string term;
+    if (!getInt(file, tid) || !getText(file, term)) return truncated();
+    this->_insertHashtag(tid, term);
+  }
+
+  if (!varint::read(file, count)) return truncated();
+  for (uint64_t i = 0; i < count; ++i) {
+    int32_t owner_id;
+    std::string lname;
+    uint64_t entries;
+    if (!getInt(file, owner_id) || !getText(file, lname) || !varint::read(file, entries)) return truncated();
+    std::vector<ListEntry>& list = this->_lists[owner_id][lname];
+    for (uint64_t e = 0; e < entries; ++e) {
+      int32_t tid;
+      if (!getInt(file, tid)) return truncated();
+      list.push_back(this->_listEntry(tid));
+    }
+  }
+
+  if (version < 2) {
+    return true;
+  }
+  if (!varint::read(file, count)) return truncated();
+  for (uint64_t i = 0; i < count; ++i) {
+    int32_t usr;
+    double score;
+    if (!getInt(file, usr) || !getDouble(file, score)) return truncated();
+    this->_ranks[usr] = score;
+  }
+  return true;
+}
+
+void MemoryBackend::_clear() {
+  this->_error.clear();
+  this->_users.clear();
+  this->_follow_dates.clear();
+  this->_quacks.clear();
+  this->_text_lower.clear();
+  this->_simhashes.clear();
+  this->_by_writer.clear();
+  this->_timeline.clear();
+  this->_replies.clear();
+  this->_requacks.clear();
+  this->_by_requacker.clear();
+  this->_requack_counts.clear();
+  this->_term_ids.clear();
+  this->_terms.clear();
+  this->_quack_hashtags.clear();
+  this->_hashtags.clear();
+  this->_hashtag_hours.clear();
+  this->_lists.clear();
+  this->_ranks.clear();
+  this->_max_usr = 0;
+  this->_max_tid = 0;
+  this->_follows_version = 0;
+}
+
+/**
+ * @brief Restores the ordering of every secondary index after a bulk load.
+ */
+void MemoryBackend::_sortIndexes() {
+  auto older_quack = [this](int32_t a, int32_t b) { return this->_olderQuack(a, b); };
+  auto older_requack = [this](uint64_t a, uint64_t b) { return this->_olderRequack(a, b); };
+
+  for (auto& [writer_id, tids] : this->_by_writer) std::sort(tids.begin(), tids.end(), older_quack);
+  std::sort(this->_timeline.begin(), this->_timeline.end(), older_quack);
+  for (auto& [replyto_tid, tids] : this->_replies) std::sort(tids.begin(), tids.end());
+  for (auto& [retweeter_id, keys] : this->_by_requacker) std::sort(keys.begin(), keys.end(), older_requack);
+  for (auto& [owner_id, lists] : this->_lists) {
+    for (auto& [lname, entries] : lists) std::sort(entries.begin(), entries.end());
+  }
+}
+
+/**
+ * @brief Collects the users whose name contains `search_terms`, most influential first,
+ *        then shortest name, like the SQL ORDER BY.
+ */
+void MemoryBackend::_matchUsers(const std::string& search_terms, std::vector<int32_t>& usrs) const {
+  const std::string pattern = "%" + lower(search_terms) + "%";
+  struct Match {
+    double score;
+    size_t length;
+    int32_t usr;
+  };
+  std::vector<Match> matches;
+  size_t visited = 0;
+  for (const auto& [usr, row] : this->_users) {
+    if (++visited % DEADLINE_CHECK_ROWS == 0 && this->_deadlinePassed()) {
+      break;
+    }
+    if (like(pattern.c_str(), row.name.c_str())) {
+      auto rank = this->_ranks.find(usr);
+      matches.push_back({rank == this->_ranks.end() ? 0.0 : rank->second, utf8Length(row.name), usr});
+    }
+  }
+  std::sort(matches.begin(), matches.end(), [](const Match& a, const Match& b) {
+    if (a.score != b.score) {
+      return a.score > b.score;
+    }
+    return a.length != b.length ? a.length < b.length : a.usr < b.usr;
+  });
+  usrs.reserve(usrs.size() + matches.size());
+  for (const Match& match : matches) {
+    usrs.push_back(match.usr);
+  }
+}
+
+/**
+ * @brief Collects the quacks with a hashtag matching `folded` (a lower-cased LIKE
+ *        pattern), most recent first, with one entry per matching (quack, hashtag) pair
+ *        as the SQL join produces.
+ */
+void MemoryBackend::_matchHashtag(const std::string& folded, std::vector<int32_t>& tids) const {
+  auto collect = [&](const std::vector<int32_t>& postings) {
+    for (int32_t tid : postings) {
+      if (this->_quacks.count(tid)) {
+        tids.push_back(tid);
+      }
+    }
+  };
+  if (folded.find_first_of("%_") == std::string::npos) {
+    auto term_id = this->_term_ids.find(folded);
+    if (term_id != this->_term_ids.end()) {
+      collect(this->_hashtags[term_id->second]);
+    }
+  } else {
+    for (size_t term_id = 0; term_id < this->_terms.size(); ++term_id) {
+      if (like(folded.c_str(), this->_terms[term_id].c_str())) {
+        collect(this->_hashtags[term_id]);
+      }
+    }
+  }
+  std::stable_sort(tids.begin(), tids.end(), [this](int32_t a, int32_t b) { return this->_olderQuack(b, a); });
+}
+
+bool MemoryBackend::_olderQuack(int32_t a, int32_t b) const {
+  int64_t ts_a = this->_quacks.at(a).ts;
+  int64_t ts_b = this->_quacks.at(b).ts;
+  return ts_a != ts_b ? ts_a < ts_b : a < b;
+}
+
+MemoryBackend::ListEntry MemoryBackend::_listEntry(int32_t tid) const {
+  auto quack = this->_quacks.find(tid);
+  return {quack == this->_quacks.end() ? 0 : quack->second.ts, tid};
+}
+
+bool MemoryBackend::_olderRequack(uint64_t a, uint64_t b) const {
+  const RequackRow& row_a = this->_requacks.at(a);
+  const RequackRow& row_b = this->_requacks.at(b);
+  return row_a.ts != row_b.ts ? row_a.ts < row_b.ts : row_a.tid < row_b.tid;
+}
@@ -1,4 +1,69 @@
 #include "Pond.hh"
+#include "MemoryBackend.hh"
+#include "SqliteBackend.hh"
+#include "ThreadPool.hh"
+
+#include <cstring>
+#include <unordered_map>
+
+namespace {
+
+// PageRank parameters for rankUsers
+constexpr double RANK_DAMPING = 0.85;
+constexpr double RANK_TOLERANCE = 1e-9;
+constexpr int32_t RANK_MAX_ITERATIONS = 200;
+
+// The width of a hashtag rollup bucket
+constexpr int64_t HOUR_US = 3600000000LL;
+
+// Threads kept by getThread, and the most new quacks read to find the ones replied to
+constexpr size_t THREAD_CACHE_SIZE = 64;
+constexpr size_t THREAD_SYNC_BATCH = 1000;
+
+// The most near copies of a quack checked against a user's earlier requacks
+constexpr size_t NEAR_COPY_LIMIT = 100;
+
+/**
+ * @brief The rollup hours overlapping `[from_ts, to_ts)`, as a half-open range.
+ */
+std::pair<int64_t, int64_t> overlappingHours(int64_t from_ts, int64_t to_ts) {
+  auto floorHour = [](int64_t ts) { return ts / HOUR_US - (ts % HOUR_US < 0 ? 1 : 0); };
+  return {floorHour(from_ts), floorHour(to_ts - 1) + 1};
+}
+
+/**
+ * @brief Splits quack search input into its comma-separated keywords.
+ */
+std::vector<std::string> splitKeywords(const std::string& search_terms) {
+  std::istringstream iss(search_terms);
+  std::vector<std::string> keywords;
+  std::string keyword;
+  while (std::getline(iss, keyword, ',')) {
+    keywords.push_back(keyword);
+  }
+  return keywords;
+}
+
+/**
+ * @brief Bounds a backend's reads by a deadline, if one is given, for as long as it lives.
+ */
+class DeadlineScope
+{
+public:
+  DeadlineScope(Backend& backend, const Deadline* deadline) : _backend(backend) {
+    backend.setDeadline(deadline);
+  }
+
+  ~DeadlineScope() { this->_backend.setDeadline(nullptr); }
+
+  DeadlineScope(const DeadlineScope&) = delete;
+  DeadlineScope& operator=(const DeadlineScope&) = delete;
+
+private:
+  Backend& _backend;
+};
+
+} // namespace
 
 // =============================================================================
 // Public Methods
@@ -7,30 +72,23 @@
 /**
  * @brief Constructs a new Pond object.
  *
- * Initializes the database connection pointer to `nullptr` to ensure a safe 
- * and uninitialized state before the database is loaded.
+ * Starts on a SQLite backend with no open connection, a safe and uninitialized
+ * state in which every call fails until a database is loaded.
  *
  * @note The database connection is not established in the constructor. 
  *       Use the `loadDatabase` method to open a database connection.
  */
 Pond::Pond()
-  : _db(nullptr) {
+  : _backend(std::make_unique<SqliteBackend>()) {
 }
 
 /**
  * @brief Destructs the Pond object and releases resources.
  *
- * Closes the SQLite database connection if it was opened, ensuring proper 
- * cleanup of resources when the Pond object goes out of scope.
- *
- * @note If the database connection was never opened (i.e., `_db` is `nullptr`),
- *       this method safely does nothing.
+ * Destroys the storage backend, which closes the SQLite database connection if
+ * one was opened.
  */
-Pond::~Pond() {
-  if (_db) {
-    sqlite3_close(_db);
-  }
-}
+Pond::~Pond() = default;
 
 /**
  * @brief Opens a connection to the SQLite database specified by the filename.
@@ -40,14 +98,67 @@ Pond::~Pond() {
  *         or a non-zero SQLite error code if it failed.
  */
 int Pond::loadDatabase(const std::string& db_filename) {
-  int exit_code = sqlite3_open(db_filename.c_str(), &this->_db);
+  auto backend = std::make_unique<SqliteBackend>();
+  int exit_code = backend->open(db_filename);
   if (exit_code) {
-    std::cerr << "Can't open database: " << sqlite3_errmsg(this->_db) << std::endl;
     return exit_code;
   }
+  this->_backend = std::move(backend);
+  this->_resetIndexes();
   return 0;
 }
 
+/**
+ * @brief Switches Pond to the in-memory storage engine.
+ *
+ * The engine is seeded from a Quacker database file or from a snapshot written by
+ * `saveSnapshot`. Nothing is written back to the source file; call `saveSnapshot`
+ * to persist changes.
+ *
+ * @param filename The database or snapshot to load, or "" to start empty.
+ * @return true if the engine was loaded.
+ */
+bool Pond::loadMemory(const std::string& filename) {
+  auto backend = std::make_unique<MemoryBackend>();
+  if (!backend->open(filename)) {
+    std::cerr << "Can't load database into memory: " << backend->lastError() << std::endl;
+    return false;
+  }
+  this->_backend = std::move(backend);
+  this->_resetIndexes();
+  return true;
+}
+
+/**
+ * @brief Writes a consistent copy of everything stored to a file.
+ *
+ * With the SQLite backend the copy is a compacted database file; with the in-memory
+ * engine it is a snapshot that `loadMemory` can reload.
+ *
+ * @param filename The file to write; an existing file is replaced.
+ * @return true if the copy was written.
+ */
+bool Pond::saveSnapshot(const std::string& filename) {
+  return this->_backend->snapshot(filename);
+}
+
+/**
+ * @brief Starts appending every public Pond call to a binary log.
+ *
+ * @param log_filename The log file to create; an existing file is replaced.
+ * @return true if the log was opened; false otherwise.
+ */
+bool Pond::startRecording(const std::string& log_filename) {
+  return this->_recorder.open(log_filename);
+}
+
+/**
+ * @brief Stops recording calls and flushes the log.
+ */
+void Pond::stopRecording() {
+  this->_recorder.close();
+}
+
 /**
  * @brief Adds a new user to the users table in the database.
  *
@@ -56,41 +167,25 @@ int Pond::loadDatabase(const std::string& db_filename) {
  * @param email The email of the user.
  * @param phone The phone number of the user.
  * @param password The password for the user's account.
- * @return true if the user was successfully added; false otherwise.
+ * @return The new user's ID if the user was successfully added; std::nullopt otherwise.
  */
-int32_t* Pond::addUser(const std::string& name, const std::string& email, const int64_t& phone, const std::string& password) {
+std::optional<int32_t> Pond::addUser(const std::string& name, const std::string& email, const int64_t& phone, const std::string& password) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::AddUser, name, email, phone,
+                      Recorder::Secret{password});
   int32_t user_id;
 
   // Get a unique user ID
   if (!_getUniqueUserID(user_id)) {
-    return nullptr;  // Return nullptr if we couldn't get a unique ID
-  }
-
-  const char* query =
-    "INSERT INTO users (usr, name, email, phone, pwd) "
-    "VALUES (?, ?, ?, ?, ?)";
-
-  sqlite3_stmt* stmt;
-  if (sqlite3_prepare_v2(this->_db, query, -1, &stmt, nullptr) != SQLITE_OK) {
-    sqlite3_finalize(stmt);
-    return nullptr;
+    return std::nullopt;  // Return nullopt if we couldn't get a unique ID
   }
 
-  // Bind parameters to prevent SQL injection.
-  sqlite3_bind_int(stmt, 1, user_id);                              // usr
-  sqlite3_bind_text(stmt, 2, name.c_str(), -1, SQLITE_STATIC);      // name
-  sqlite3_bind_text(stmt, 3, email.c_str(), -1, SQLITE_STATIC);     // email
-  sqlite3_bind_int(stmt, 4, phone);                                // phone
-  sqlite3_bind_text(stmt, 5, password.c_str(), -1, SQLITE_STATIC);  // pwd
-
-  // Execute the query.
-  int32_t* result = nullptr;
-  if (sqlite3_step(stmt) == SQLITE_DONE) {
-    result = new int32_t(user_id);  // Allocate a new int32_t if user was added successfully
+  if (!this->_backend->insertUser(user_id, name, email, phone, password)) {
+    return std::nullopt;
   }
+  this->_syncUserNames();
 
-  sqlite3_finalize(stmt);
-  return result;  // Return either the pointer to user_id or nullptr
+  call.result(1);
+  return user_id;
 }
 
 /**
@@ -107,27 +202,22 @@ int32_t* Pond::addUser(const std::string& name, const std::string& email, const
  * @note Ensures case-insensitive uniqueness of hashtags for the specified quack.
  */
 bool Pond::addHashtag(const int32_t& quack_id, const std::string& hashtag) {
-  const char *query =
-      "INSERT INTO hashtag_mentions (tid, term) "
-      "SELECT ?, ? "
-      "WHERE NOT EXISTS ("
-      "  SELECT 1 FROM hashtag_mentions "
-      "  WHERE tid = ? AND term = ? COLLATE NOCASE"
-      ")";
-  sqlite3_stmt* stmt;
-  if (sqlite3_prepare_v2(this->_db, query, -1, &stmt, nullptr) != SQLITE_OK) {
-    sqlite3_finalize(stmt);
-    return false;
+  Recorder::Call call(&this->_recorder, Recorder::Op::AddHashtag, quack_id, hashtag);
+  std::optional<bool> inserted = this->_backend->insertHashtag(quack_id, hashtag);
+  const bool added = inserted.value_or(false);
+  if (added) {
+    // Hashtags of a quack not stored yet are counted once the quack is, by addQuack
+    Pond::QuackResults quack;
+    if (this->_backend->quackByID(quack_id, quack) && !quack.empty()) {
+      this->_trending.add(hashtag, quack[0].ts);
+    }
+    if (this->_hashtag_index.add(quack_id, hashtag)) {
+      std::string term = hashtag;
+      std::transform(term.begin(), term.end(), term.begin(), ::tolower);
+      this->_hashtag_completions.add(term, 1);
+    }
   }
-
-  // Bind parameters to prevent SQL injection
-  sqlite3_bind_int(stmt, 1, quack_id);                          // tid
-  sqlite3_bind_text(stmt, 2, hashtag.c_str(), -1, SQLITE_STATIC); // term
-
-  // Execute the query.
-  bool added = sqlite3_step(stmt) == SQLITE_DONE;
-  sqlite3_finalize(stmt);
-
+  call.result(added);
   return added;
 }
 
@@ -148,13 +238,17 @@ bool Pond::addHashtag(const int32_t& quack_id, const std::string& hashtag) {
  *       It uses the `addHashtag` method to store valid hashtags in the database.
  */
 bool Pond::validateQuack(const int32_t& quack_id, const std::string& text) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::ValidateQuack, quack_id, text);
+
   // Check if the text is empty
   if (text.empty()) {
     return false;
   }
 
-  // One tweet can have multiple hashtags but not multiple instances of the same hashtag
-  std::unordered_set<std::string> hashtags;
+  // One tweet can have multiple hashtags but not multiple instances of the same hashtag.
+  // All are checked before any is stored, so a rejected quack leaves none behind.
+  std::unordered_set<std::string> seen;
+  std::vector<std::string> hashtags;
   std::istringstream iss(text);
   std::string word;
   while (iss >> word) {
@@ -163,14 +257,17 @@ bool Pond::validateQuack(const int32_t& quack_id, const std::string& text) {
       std::string hashtag = word;
       std::transform(hashtag.begin(), hashtag.end(), hashtag.begin(), ::tolower);
 
-      if (hashtags.find(hashtag) != hashtags.end()) {
+      if (!seen.insert(hashtag).second) {
         return false;
       }
-      hashtags.insert(hashtag);
-      this->addHashtag(quack_id, hashtag);
+      hashtags.push_back(std::move(hashtag));
     }
   }
+  for (const std::string& hashtag : hashtags) {
+    this->addHashtag(quack_id, hashtag);
+  }
 
+  call.result(1);
   return true;
 }
 
@@ -179,45 +276,32 @@ bool Pond::validateQuack(const int32_t& quack_id, const std::string& text) {
  *
  * @param user_id The ID of the user who is posting the quack.
  * @param text The text of the quack.
- * @return A pointer to the unique ID of the quack if it was successfully added; nullptr otherwise.
+ * @return The unique ID of the quack if it was successfully added; std::nullopt otherwise.
  */
-int32_t* Pond::addQuack(const int32_t& user_id, const std::string& text) {
-  int32_t* result = nullptr;
+std::optional<int32_t> Pond::addQuack(const int32_t& user_id, const std::string& text) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::AddQuack, user_id, text);
 
   int32_t quack_id;
   if (!this->_getUniqueQuackID(quack_id)) {
-    return result;
+    return std::nullopt;
   }
 
   if (!validateQuack(quack_id, text)) {
-    return result;
-  }
-
-  const char* query =
-    "INSERT INTO tweets (tid, writer_id, text, tdate, ttime) "
-    "VALUES (?, ?, ?, ?, ?)";
-
-  // Prepare the SQL statement.
-  sqlite3_stmt* stmt;
-  if (sqlite3_prepare_v2(this->_db, query, -1, &stmt, nullptr) != SQLITE_OK) {
-    sqlite3_finalize(stmt);
-    return result;
+    return std::nullopt;
   }
 
-  // Bind parameters to prevent SQL injection.
-  sqlite3_bind_int(stmt, 1, quack_id);                               // tid
-  sqlite3_bind_int(stmt, 2, user_id);                                // writer_id
-  sqlite3_bind_text(stmt, 3, text.c_str(), -1, SQLITE_STATIC);       // text
-  sqlite3_bind_text(stmt, 4, this->_getDate(), -1, SQLITE_STATIC);   // tdate
-  sqlite3_bind_text(stmt, 5, this->_getTime(), -1, SQLITE_STATIC);   // ttime
-
-  // Execute the query.
-  if (sqlite3_step(stmt) == SQLITE_DONE) {
-    result = new int32_t(quack_id);
+  const Clock::Stamp now = Clock::now();
+  const uint64_t simhash = SimHashIndex::fingerprint(text);
+  if (!this->_backend->insertQuack(quack_id, user_id, text, simhash, now, std::nullopt)) {
+    return std::nullopt;
   }
-  sqlite3_finalize(stmt);
+  this->_indexQuack(quack_id, user_id, now.ts, text);
+  this->_duplicates.add(quack_id, simhash);
+  this->_countMentions(quack_id, now.ts);
+  this->_spam.record(user_id, SpamDetector::Write::Quack, now.ts);
 
-  return result;
+  call.result(1);
+  return quack_id;
 }
 
 /**
@@ -226,159 +310,127 @@ int32_t* Pond::addQuack(const int32_t& user_id, const std::string& text) {
 * @param user_id The ID of the user creating the reply.
 * @param reply_quack_id The ID of the quack being replied to.
 * @param text The text content of the reply.
-* @return true if the reply was successfully added; false otherwise.
+* @return The unique ID of the reply if it was successfully added; std::nullopt otherwise.
 */
-int32_t* Pond::addReply(const int32_t& user_id, const int32_t& reply_quack_id, const std::string& text) {
-  int32_t* result = nullptr;
-
-  const char* query =
-    "INSERT INTO tweets (tid, writer_id, text, tdate, ttime, replyto_tid) "
-    "VALUES (?, ?, ?, ?, ?, ?)";
-
-  // Prepare the SQL statement.
-  sqlite3_stmt* stmt;
-  if (sqlite3_prepare_v2(this->_db, query, -1, &stmt, nullptr) != SQLITE_OK) {
-    sqlite3_finalize(stmt);
-    return result;
-  }
+std::optional<int32_t> Pond::addReply(const int32_t& user_id, const int32_t& reply_quack_id, const std::string& text) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::AddReply, user_id, reply_quack_id, text);
 
   int32_t reply_tid;
   if (!_getUniqueQuackID(reply_tid)) {
-    return result;  // Return nullptr if we couldn't get a unique ID
+    return std::nullopt;  // Return nullopt if we couldn't get a unique ID
   }
 
-  // Bind parameters to prevent SQL injection
-  sqlite3_bind_int(stmt, 1, reply_tid);                              // tid;
-  sqlite3_bind_int(stmt, 2, user_id);                                // writer_id
-  sqlite3_bind_text(stmt, 3, text.c_str(), -1, SQLITE_STATIC);       // text
-  sqlite3_bind_text(stmt, 4, this->_getDate(), -1, SQLITE_STATIC);   // tdate
-  sqlite3_bind_text(stmt, 5, this->_getTime(), -1, SQLITE_STATIC);   // ttime
-  sqlite3_bind_int(stmt, 6, reply_quack_id);                         // replyto_tid
-
-  // Execute the query.
-  if (sqlite3_step(stmt) == SQLITE_DONE) {
-    result = new int32_t(reply_tid);
+  const Clock::Stamp now = Clock::now();
+  const uint64_t simhash = SimHashIndex::fingerprint(text);
+  if (!this->_backend->insertQuack(reply_tid, user_id, text, simhash, now, reply_quack_id)) {
+    return std::nullopt;
   }
-  sqlite3_finalize(stmt);
+  this->_indexQuack(reply_tid, user_id, now.ts, text);
+  this->_duplicates.add(reply_tid, simhash);
+  this->_evictThreads(reply_quack_id);
+  this->_spam.record(user_id, SpamDetector::Write::Quack, now.ts);
 
-  return result;
+  call.result(1);
+  return reply_tid;
 }
 
 /**
  * @brief Adds a requack (retweet) for a specific quack by a user.
  *
- * This method checks if the user has already requacked the given quack. If the requack 
- * already exists, it updates the entry to mark it as spam. Otherwise, it adds a new 
- * requack entry to the database.
+ * A single upsert adds the requack, taking the writer from the quack, or marks an
+ * existing requack by the same user as spam. A new requack of a near copy of a quack the
+ * user already requacked is stored already flagged, so a campaign of slightly varied
+ * copies is caught, and so is a new requack by a user writing faster than the spam
+ * limits allow; flagged requacks stay out of feeds.
  *
  * @param user_id The unique ID of the user performing the requack.
  * @param quack_id The unique ID of the quack being requacked.
  * @return An integer status code:
  *         - 0: A new requack was successfully added.
  *         - 1: The requack already exists and was marked as spam.
- *         - 3: An error occurred during the process.
+ *         - 2: A new requack was added but flagged as spam, as the user is writing
+ *              too fast.
+ *         - 3: An error occurred, or the quack does not exist.
+ *         - 4: A new requack was added but flagged as spam, as the user already
+ *              requacked a near copy of the quack.
  *
  * @note The method uses parameterized SQL queries to prevent SQL injection and ensures
  *       proper database interaction. Dates for new requacks are recorded using the current
  *       date.
- *
- * @details 
- * - **Spam Handling**: If a requack already exists for the user and quack, the method updates
- *   the existing record, setting the `spam` flag to `1`.
- * - **New Requack**: If no requack exists, a new entry is added to the `retweets` table,
- *   linking the `quack_id` to the `user_id` and recording the `writer_id` and current date.
  */
 int32_t Pond::addRequack(const int32_t &user_id, const int32_t &quack_id) {
-  int32_t requack_status = -1;
-
-  // Check if the user has already requacked this quack
-  const char *check_query =
-      "SELECT COUNT(*) FROM retweets WHERE tid = ? AND retweeter_id = ?";
-
-  sqlite3_stmt *check_stmt;
-  if (sqlite3_prepare_v2(this->_db, check_query, -1, &check_stmt, nullptr) != SQLITE_OK) {
-    std::cerr << "SQL Error (prepare check): " << sqlite3_errmsg(this->_db) << std::endl;
+  Recorder::Call call(&this->_recorder, Recorder::Op::AddRequack, user_id, quack_id);
+
+  const Clock::Stamp now = Clock::now();
+  const bool too_fast = this->_spam.record(user_id, SpamDetector::Write::Requack, now.ts);
+  const int32_t flag = too_fast ? 2 : this->_requackedNearCopy(user_id, quack_id) ? 4 : 0;
+  std::optional<int32_t> spam = this->_backend->upsertRequack(quack_id, user_id, flag, now);
+  if (!spam) {
+    std::cerr << "SQL Error (upsert): " << this->_backend->lastError() << std::endl;
     return 3;
   }
-
-  if (sqlite3_bind_int(check_stmt, 1, quack_id) != SQLITE_OK ||
-      sqlite3_bind_int(check_stmt, 2, user_id) != SQLITE_OK) {
-    std::cerr << "SQL Error (bind check): " << sqlite3_errmsg(this->_db) << std::endl;
-    sqlite3_finalize(check_stmt);
+  if (*spam < 0) {
     return 3;
   }
+  call.result(1);
+  return *spam;
+}
 
-  int already_requacked = 0;
-  if (sqlite3_step(check_stmt) == SQLITE_ROW) {
-    already_requacked = sqlite3_column_int(check_stmt, 0);
-  }
-  else {
-    std::cerr << "SQL Error (step check): " << sqlite3_errmsg(this->_db) << std::endl;
-    sqlite3_finalize(check_stmt);
-    return 3;
+/**
+ * @brief Adds many requacks at once for batch ingest, in one transaction.
+ *
+ * Each requack counts towards its user's spam limits and is checked for near copies
+ * already requacked as a single addRequack would; near copies within the same batch are
+ * not compared with each other.
+ *
+ * @param requacks `(user_id, quack_id)` pairs, applied in order.
+ * @return One addRequack status code per pair, or all 3 if the batch failed.
+ */
+std::vector<int32_t> Pond::addRequacks(const std::vector<std::pair<int32_t, int32_t>>& requacks) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::AddRequacks, requacks);
+
+  const Clock::Stamp now = Clock::now();
+  std::vector<Backend::RequackWrite> writes;
+  writes.reserve(requacks.size());
+  for (const auto& [user_id, quack_id] : requacks) {
+    const bool too_fast = this->_spam.record(user_id, SpamDetector::Write::Requack, now.ts);
+    const int32_t flag = too_fast ? 2 : this->_requackedNearCopy(user_id, quack_id) ? 4 : 0;
+    writes.push_back(Backend::RequackWrite{quack_id, user_id, flag});
   }
 
-  sqlite3_finalize(check_stmt);
-
-  if (already_requacked > 0) {
-    // User has already requacked; update the existing entry to mark as spam
-    const char *update_query =
-        "UPDATE retweets SET spam = 1 WHERE tid = ? AND retweeter_id = ?";
-
-    sqlite3_stmt *update_stmt;
-    if (sqlite3_prepare_v2(this->_db, update_query, -1, &update_stmt, nullptr) != SQLITE_OK) {
-      std::cerr << "SQL Error (prepare update): " << sqlite3_errmsg(this->_db) << std::endl;
-      return 3;
-    }
-
-    if (sqlite3_bind_int(update_stmt, 1, quack_id) != SQLITE_OK ||
-        sqlite3_bind_int(update_stmt, 2, user_id) != SQLITE_OK) {
-      std::cerr << "SQL Error (bind update): " << sqlite3_errmsg(this->_db) << std::endl;
-      sqlite3_finalize(update_stmt);
-      return 3;
-    }
-
-    if (sqlite3_step(update_stmt) != SQLITE_DONE) {
-      std::cerr << "SQL Error (step update): " << sqlite3_errmsg(this->_db) << std::endl;
-    }
-    else {
-      requack_status = 1; // Status indicating spam update
-    }
-
-    sqlite3_finalize(update_stmt);
-    return requack_status;
+  std::vector<int32_t> statuses;
+  if (!this->_backend->upsertRequacks(writes, now, statuses)) {
+    std::cerr << "SQL Error (upsert): " << this->_backend->lastError() << std::endl;
+    return std::vector<int32_t>(requacks.size(), 3);
   }
-
-  // Proceed to insert the requack as a new entry
-  const char *insert_query =
-      "INSERT INTO retweets (tid, retweeter_id, writer_id, rdate, spam) "
-      "VALUES (?, ?, ?, ?, ?)";
-
-  sqlite3_stmt *insert_stmt;
-  if (sqlite3_prepare_v2(this->_db, insert_query, -1, &insert_stmt, nullptr) != SQLITE_OK) {
-    std::cerr << "SQL Error (prepare insert): " << sqlite3_errmsg(this->_db) << std::endl;
-    return 3;
+  for (int32_t& status : statuses) {
+    if (status < 0) {
+      status = 3;
+    }
   }
+  call.result(statuses.size());
+  return statuses;
+}
 
-  if (sqlite3_bind_int(insert_stmt, 1, quack_id) != SQLITE_OK ||
-      sqlite3_bind_int(insert_stmt, 2, user_id) != SQLITE_OK ||
-      sqlite3_bind_int(insert_stmt, 3, this->getQuackFromID(quack_id).writer_id) != SQLITE_OK ||
-      sqlite3_bind_text(insert_stmt, 4, this->_getDate(), -1, SQLITE_STATIC) != SQLITE_OK ||
-      sqlite3_bind_int(insert_stmt, 5, 0) != SQLITE_OK) { // No spam for new requack
-    std::cerr << "SQL Error (bind insert): " << sqlite3_errmsg(this->_db) << std::endl;
-    sqlite3_finalize(insert_stmt);
-    return 3;
-  }
+/**
+ * @brief Returns the write rates past which a user is treated as a spammer.
+ */
+SpamDetector::Limits Pond::spamLimits() const {
+  return this->_spam.limits();
+}
 
-  if (sqlite3_step(insert_stmt) != SQLITE_DONE) {
-    std::cerr << "SQL Error (step insert): " << sqlite3_errmsg(this->_db) << std::endl;
-  }
-  else {
-    requack_status = 0; // Status indicating new requack added
-  }
+/**
+ * @brief Sets the write rates past which a user's new requacks are flagged as spam.
+ */
+void Pond::setSpamLimits(const SpamDetector::Limits& limits) {
+  this->_spam.setLimits(limits);
+}
 
-  sqlite3_finalize(insert_stmt);
-  return requack_status;
+/**
+ * @brief Returns true if the user is writing faster than the spam limits allow.
+ */
+bool Pond::isWritingTooFast(const int32_t& user_id) const {
+  return this->_spam.flagged(user_id, Clock::now().ts);
 }
 
 /**
@@ -390,36 +442,19 @@ int32_t Pond::addRequack(const int32_t &user_id, const int32_t &quack_id) {
  * @return true if the quack was successfully added to the list; false otherwise.
  */
 bool Pond::addToList(const std::string& list_name, const int32_t& quack_id, const int32_t& user_id) {
-  bool added_to_list = false;
+  Recorder::Call call(&this->_recorder, Recorder::Op::AddToList, list_name, quack_id, user_id);
 
   // check for existence first
   if (!this->_listExists(list_name, user_id)) {
-    return added_to_list;
-  }
-
-  const char* query =
-    "INSERT INTO include (owner_id, lname, tid) "
-    "VALUES (?, ?, ?)";
-
-  // Prepare the SQL statement.
-  sqlite3_stmt* stmt;
-  if (sqlite3_prepare_v2(this->_db, query, -1, &stmt, nullptr) != SQLITE_OK) {
-    sqlite3_finalize(stmt);
     return false;
   }
 
-  // Bind parameters to prevent SQL injection.
-  sqlite3_bind_int(stmt, 1, user_id);                          // owner_id
-  sqlite3_bind_text(stmt, 2, list_name.c_str(), -1, SQLITE_STATIC); // lname
-  sqlite3_bind_int(stmt, 3, quack_id);                         // tid
-
-  // Execute the query.
-  if (sqlite3_step(stmt) == SQLITE_DONE) {
-    added_to_list = true;
+  if (!this->_backend->insertListEntry(user_id, list_name, quack_id)) {
+    return false;
   }
 
-  sqlite3_finalize(stmt);
-  return added_to_list;
+  call.result(1);
+  return true;
 }
 
 /**
@@ -430,30 +465,53 @@ bool Pond::addToList(const std::string& list_name, const int32_t& quack_id, cons
  * @return true if the list was successfully created; false otherwise.
  */
 bool Pond::createList(const int32_t& user_id, const std::string& list_name) {
-  bool list_created = false;
-
-  const char* query =
-    "INSERT INTO lists (owner_id, lname) "
-    "VALUES (?, ?)";
-
-  // Prepare the SQL statement.
-  sqlite3_stmt* stmt;
-  if (sqlite3_prepare_v2(this->_db, query, -1, &stmt, nullptr) != SQLITE_OK) {
-    sqlite3_finalize(stmt);
+  Recorder::Call call(&this->_recorder, Recorder::Op::CreateList, user_id, list_name);
+  if (!this->_backend->insertList(user_id, list_name)) {
     return false;
   }
 
-  // Bind parameters to prevent SQL injection.
-  sqlite3_bind_int(stmt, 1, user_id);                            // owner_id
-  sqlite3_bind_text(stmt, 2, list_name.c_str(), -1, SQLITE_STATIC); // lname
+  call.result(1);
+  return true;
+}
 
-  // Execute the query.
-  if (sqlite3_step(stmt) == SQLITE_DONE) {
-    list_created = true;
-  }
+/**
+ * @brief Retrieves a user's lists by name, each with its number of quacks.
+ *
+ * @param owner_id The ID of the user who owns the lists.
+ * @return The lists, or an empty vector if the user has none.
+ */
+std::vector<Pond::ListSummary> Pond::getLists(const int32_t& owner_id) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::GetLists, owner_id);
+  std::vector<Pond::ListSummary> results;
+  this->_backend->lists(owner_id, results);
+  call.result(results.size());
+  return results;
+}
 
-  sqlite3_finalize(stmt);
-  return list_created;
+/**
+ * @brief Retrieves one page of the quacks in a list, most recent first.
+ *
+ * @param owner_id The ID of the user who owns the list.
+ * @param list_name The name of the list.
+ * @param after Where the previous page ended, or nullopt for the first page.
+ * @param limit The page size.
+ * @return The page; `next` is set when the page is full, so there may be more.
+ */
+Pond::ListPage Pond::getListQuacks(const int32_t& owner_id, const std::string& list_name,
+                                   const std::optional<Pond::ListCursor>& after, const size_t& limit) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::GetListQuacks, owner_id, list_name,
+                      static_cast<int64_t>(after.has_value()), after ? after->ts : 0,
+                      after ? after->tid : 0, static_cast<int64_t>(limit));
+  Pond::ListPage page;
+  if (limit == 0 || !this->_backend->listQuacks(owner_id, list_name, after, limit, page.quacks)) {
+    return page;
+  }
+  if (page.quacks.size() == limit) {
+    const Pond::QuackView& last = page.quacks[page.quacks.size() - 1];
+    page.next = Pond::ListCursor{last.ts, last.tid};
+  }
+  call.result(page.quacks.size());
+  return page;
 }
 
 /**
@@ -461,37 +519,13 @@ bool Pond::createList(const int32_t& user_id, const std::string& list_name) {
  *
  * @param user_id The user ID to check in the database.
  * @param password The password corresponding to the user ID.
- * @return true if the login credentials are valid; false otherwise.
+ * @return The user's ID if the login credentials are valid; std::nullopt otherwise.
  */
-int32_t* Pond::checkLogin(const int32_t& user_id, const std::string& password) {
-  int32_t* user_id_ptr = nullptr;
-
-  const char* query =
-    "SELECT * "
-    "FROM users "
-    "WHERE usr = ? "
-    "AND pwd = ?";
-
-  // Prepare the SQL statement.
-  sqlite3_stmt* stmt;
-  if (sqlite3_prepare_v2(this->_db, query, -1, &stmt, nullptr) != SQLITE_OK) {
-    sqlite3_finalize(stmt);
-    return nullptr;
-  }
-
-  // Bind parameters to prevent SQL injection.
-  sqlite3_bind_int(stmt, 1, user_id);                               // usr
-  sqlite3_bind_text(stmt, 2, password.c_str(), -1, SQLITE_STATIC);  // pwd
-
-
-  // Execute the query.
-  if (sqlite3_step(stmt) == SQLITE_ROW) {
-    int32_t retrieved_id = sqlite3_column_int(stmt, 0);
-    user_id_ptr = new int32_t(retrieved_id);
-  }
-  sqlite3_finalize(stmt);
-
-  return user_id_ptr;
+std::optional<int32_t> Pond::checkLogin(const int32_t& user_id, const std::string& password) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::CheckLogin, user_id, Recorder::Secret{password});
+  std::optional<int32_t> logged_in_id = this->_backend->checkLogin(user_id, password);
+  call.result(logged_in_id.has_value());
+  return logged_in_id;
 }
 
 /**
@@ -502,31 +536,16 @@ int32_t* Pond::checkLogin(const int32_t& user_id, const std::string& password) {
  * @return true if the follow was successfully added, false otherwise.
  */
 bool Pond::follow(const int32_t& user_id, const int32_t& follow_id) {
-  bool follow_added = false;
-
-  const char* query =
-    "INSERT INTO follows (flwer, flwee, start_date) "
-    "VALUES (?, ?, ?)";
-
-  // Prepare the SQL statement.
-  sqlite3_stmt* stmt;
-  if (sqlite3_prepare_v2(this->_db, query, -1, &stmt, nullptr) != SQLITE_OK) {
-    sqlite3_finalize(stmt);
+  Recorder::Call call(&this->_recorder, Recorder::Op::Follow, user_id, follow_id);
+  const Clock::Stamp now = Clock::now();
+  if (!this->_backend->insertFollow(user_id, follow_id, now.date)) {
     return false;
   }
+  this->_updateGraph(user_id, follow_id, true, 1);
+  this->_spam.record(user_id, SpamDetector::Write::Follow, now.ts);
 
-  // Bind parameters to prevent SQL injection.
-  sqlite3_bind_int(stmt, 1, user_id);                               // follower_id
-  sqlite3_bind_int(stmt, 2, follow_id);                             // followee_id
-  sqlite3_bind_text(stmt, 3, this->_getDate(), -1, SQLITE_STATIC);  // start_date
-
-  // Execute the query.
-  if (sqlite3_step(stmt) == SQLITE_DONE) {
-    follow_added = true;
-  }
-  sqlite3_finalize(stmt);
-
-  return follow_added;
+  call.result(1);
+  return true;
 }
 
 /**
@@ -537,31 +556,16 @@ bool Pond::follow(const int32_t& user_id, const int32_t& follow_id) {
  * @return true if the unfollow was successful, false otherwise.
  */
 bool Pond::unfollow(const int32_t& user_id, const int32_t& follow_id) {
-  bool unfollowed = false;
-
-  const char* query =
-    "DELETE FROM follows "
-    "WHERE flwer = ? "
-    "AND flwee = ?";
-
-  // Prepare the SQL statement.
-  sqlite3_stmt* stmt;
-  if (sqlite3_prepare_v2(this->_db, query, -1, &stmt, nullptr) != SQLITE_OK) {
-    sqlite3_finalize(stmt);
+  Recorder::Call call(&this->_recorder, Recorder::Op::Unfollow, user_id, follow_id);
+  // Only a follow the graph knows about can have been deleted by this call
+  const bool was_following = this->_graph_version && this->_graph.contains(user_id, follow_id);
+  if (!this->_backend->deleteFollow(user_id, follow_id)) {
     return false;
   }
+  this->_updateGraph(user_id, follow_id, false, was_following ? 1 : 0);
 
-  // Bind parameters to prevent SQL injection.
-  sqlite3_bind_int(stmt, 1, user_id);   // follower_id
-  sqlite3_bind_int(stmt, 2, follow_id); // followee_id
-
-  // Execute the query.
-  if (sqlite3_step(stmt) == SQLITE_DONE) {
-    unfollowed = true;
-  }
-  sqlite3_finalize(stmt);
-
-  return unfollowed;
+  call.result(1);
+  return true;
 }
 
 /**
@@ -571,34 +575,81 @@ bool Pond::unfollow(const int32_t& user_id, const int32_t& follow_id) {
  * @return A vector of pairs containing user IDs and names that match the search terms.
  */
 std::vector<Pond::User> Pond::searchForUsers(const std::string& search_terms) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::SearchForUsers, search_terms);
   std::vector<Pond::User> results;
+  this->_backend->searchUsers(search_terms, results);
+  call.result(results.size());
+  return results;
+}
 
-  const char* query =
-    "SELECT usr, name "
-    "FROM users "
-    // lower for case insensitive search
-    "WHERE LOWER(name) LIKE '%' || LOWER(?) || '%' "
-    "ORDER BY LENGTH(name)";
-
-  sqlite3_stmt* stmt;
-  if (sqlite3_prepare_v2(this->_db, query, -1, &stmt, nullptr) != SQLITE_OK) {
-    sqlite3_finalize(stmt);
-    return results;
+/**
+ * @brief Searches for users whose names contain the search terms, stopping early if
+ *        `deadline` expires or is cancelled.
+ *
+ * @param search_terms The terms to search for in user names.
+ * @param deadline Bounds the search; it must outlive the call.
+ * @return The matches found in time, and whether the search was cut short.
+ */
+Pond::Timed<std::vector<Pond::User>> Pond::searchForUsers(const std::string& search_terms, const Deadline& deadline) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::SearchForUsersWithin, search_terms,
+                      static_cast<int64_t>(deadline.remaining().count()));
+  Pond::Timed<std::vector<Pond::User>> timed;
+  {
+    DeadlineScope scope(*this->_backend, &deadline);
+    this->_backend->searchUsers(search_terms, timed.results);
+    timed.truncated = this->_backend->interrupted();
   }
+  if (timed.truncated) {
+    ++this->_timeouts[Recorder::Op::SearchForUsers];
+  }
+  call.result(timed.results.size());
+  return timed;
+}
 
-  // Bind parameters to prevent SQL injection.
-  sqlite3_bind_text(stmt, 1, search_terms.c_str(), -1, SQLITE_STATIC); // name
+/**
+ * @brief Lazily searches for users whose names contain the specified search terms.
+ *
+ * @param search_terms The terms to search for in user names.
+ * @return A cursor over the users `searchForUsers` would return, in the same order; it
+ *         has no results if the backend failed.
+ */
+Pond::UserCursor Pond::openUserSearch(const std::string& search_terms) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::OpenUserSearch, search_terms);
+  Pond::UserCursor cursor;
+  cursor._stream = this->_backend->streamUsers(search_terms);
+  return cursor;
+}
 
-  // Execute the query.
-  while (sqlite3_step(stmt) == SQLITE_ROW) {
-    Pond::User user;
-    user.usr = sqlite3_column_int(stmt, 0);
-    user.name = (const char*)sqlite3_column_text(stmt, 1);
-    results.push_back(user);
-  }
+/**
+ * @brief Counts the users `searchForUsers` would return, without reading them.
+ *
+ * @return The count, or std::nullopt if the backend failed.
+ */
+std::optional<int64_t> Pond::countUserMatches(const std::string& search_terms) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::CountUserMatches, search_terms);
+  std::optional<int64_t> count = this->_backend->countUsers(search_terms);
+  call.result(count.value_or(0));
+  return count;
+}
 
-  sqlite3_finalize(stmt);
-  return results;
+/**
+ * @brief Completes the start of a user name to the names of the most active users.
+ *
+ * The completions come from the in-memory prefix index alone. It holds the users and
+ * quacks seen when the database was loaded and those added through this Pond since,
+ * and picks up other connections' additions whenever the search index is brought up
+ * to date.
+ *
+ * @param prefix The start of a name, in any case.
+ * @param count The number of completions wanted; at most `PrefixIndex::TOP`.
+ * @return Names starting with `prefix`, with the quacks their users have written, most
+ *         first.
+ */
+std::vector<PrefixIndex::Completion> Pond::completeUsername(const std::string& prefix, const size_t& count) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::CompleteUsername, prefix, static_cast<int64_t>(count));
+  std::vector<PrefixIndex::Completion> completions = this->_name_completions.complete(prefix, count);
+  call.result(completions.size());
+  return completions;
 }
 
 
@@ -606,257 +657,379 @@ std::vector<Pond::User> Pond::searchForUsers(const std::string& search_terms) {
  * @brief search for quacks containing specific keywords or hashtags.
  *
  * @param search_terms A string of keywords or hashtags to search for in quacks.
- * @return A vector of quacks that contain the specified keywords or hashtags, ordered by date and time.
+ * @return A vector of quacks that contain the specified keywords or hashtags, most recent first.
  *
- * @note case insensitive search, space seperated keywoards
+ * @note case insensitive search, space seperated keywoards. Copies every row out of
+ *       `searchQuackViews`; callers that only display the results should use that instead.
  */
 std::vector<Pond::Quack> Pond::searchForQuacks(const std::string& search_terms) {
-  std::vector<Pond::Quack> results;
-  std::unordered_set<int32_t> quack_ids; // keep track of unique quack ids across searches
-
-  // Split the keyword input into individual keywords, using commas as delimiters
-  std::istringstream iss(search_terms);
-  std::vector<std::string> keywords;
-  std::string keyword;
-  while (std::getline(iss, keyword, ',')) { // specify comma as delimiter
-    keywords.push_back(keyword);
-  }
-
-  const char* hashtag_query =
-    "SELECT t.tid, t.writer_id, t.text, t.tdate, t.ttime, t.replyto_tid "
-    "FROM tweets t "
-    "JOIN hashtag_mentions ht ON t.tid = ht.tid "
-    "WHERE LOWER(ht.term) LIKE LOWER(?)"
-    "ORDER BY t.tdate DESC, t.ttime DESC";
-
-
-  // Prepare to query 
-  sqlite3_stmt* stmt;
-  for (const std::string& kw : keywords) {
-    if (kw[0] == '#') {
-      // std::string hashtag = kw.substr(1);  // remove # prefix
-
-      if (sqlite3_prepare_v2(this->_db, hashtag_query, -1, &stmt, nullptr) != SQLITE_OK) {
-        sqlite3_finalize(stmt);
-        continue;
-      }
-
-      sqlite3_bind_text(stmt, 1, kw.c_str(), -1, SQLITE_STATIC);
-
-      // Retrieve results
-      while (sqlite3_step(stmt) == SQLITE_ROW) {
-        int32_t quack_id = sqlite3_column_int(stmt, 0);
-        if (quack_ids.find(quack_id) == quack_ids.end()) {
-          Pond::Quack quack;
-          quack.tid = quack_id;
-          quack.writer_id = sqlite3_column_int(stmt, 1);
-          quack.text = (const char*)(sqlite3_column_text(stmt, 2));
-          quack.date = (const char*)(sqlite3_column_text(stmt, 3));
-          quack.time = (const char*)(sqlite3_column_text(stmt, 4));
-          quack.replyto_tid = sqlite3_column_int(stmt, 5);
-
-          results.push_back(quack);
-          // quack_ids.insert(quack_id);
-        }
-      }
-      sqlite3_finalize(stmt);
-    }
-
-    else { // text keyword
-      const char *text_query =
-        "SELECT tid, writer_id, text, tdate, ttime, replyto_tid "
-        "FROM tweets "
-        "WHERE LOWER(text) LIKE '% ' || LOWER(?) || ' %' "
-        "OR LOWER(text) LIKE '% ' || LOWER(?) || ' %' "
-        "OR LOWER(text) LIKE '% ' || LOWER(?) "
-        "OR LOWER(text) LIKE '% ' || LOWER(?) "
-        "OR LOWER(text) LIKE LOWER(?) || ' %' "
-        "OR LOWER(text) LIKE LOWER(?) || ' %' "
-        "OR LOWER(text) = LOWER(?)"
-        "OR LOWER(text) = LOWER(?)"
-        "ORDER BY tdate DESC, ttime DESC";
-
-      if (sqlite3_prepare_v2(this->_db, text_query, -1, &stmt, nullptr) != SQLITE_OK) {
-        sqlite3_finalize(stmt);
-        continue;
-      }
-
-      // std::string kw_ht = "#"+kw;
-      sqlite3_bind_text(stmt, 1, kw.c_str(), -1, SQLITE_STATIC);
-      sqlite3_bind_text(stmt, 2, ("#"+kw).c_str(), -1, SQLITE_STATIC);
-      sqlite3_bind_text(stmt, 3, kw.c_str(), -1, SQLITE_STATIC);
-      sqlite3_bind_text(stmt, 4, ("#"+kw).c_str(), -1, SQLITE_STATIC);
-      sqlite3_bind_text(stmt, 5, kw.c_str(), -1, SQLITE_STATIC);
-      sqlite3_bind_text(stmt, 6, ("#"+kw).c_str(), -1, SQLITE_STATIC);
-      sqlite3_bind_text(stmt, 7, kw.c_str(), -1, SQLITE_STATIC);
-      sqlite3_bind_text(stmt, 8, ("#" + kw).c_str(), -1, SQLITE_STATIC);
-
-      // Retrieve results
-      while (sqlite3_step(stmt) == SQLITE_ROW) {
-        int32_t quack_id = sqlite3_column_int(stmt, 0);
-        if (quack_ids.find(quack_id) == quack_ids.end()) {
-          Quack quack;
-          quack.tid = quack_id;
-          quack.writer_id = sqlite3_column_int(stmt, 1);
-          quack.text = (const char*)(sqlite3_column_text(stmt, 2));
-          quack.date = (const char*)(sqlite3_column_text(stmt, 3));
-          quack.time = (const char*)(sqlite3_column_text(stmt, 4));
-          quack.replyto_tid = sqlite3_column_int(stmt, 5);
-
-          results.push_back(quack);
-          quack_ids.insert(quack_id);
-        }
-      }
-      sqlite3_finalize(stmt);
-    }
-  }
-
+  Recorder::Call call(&this->_recorder, Recorder::Op::SearchForQuacks, search_terms);
+  std::vector<Pond::Quack> results = this->searchQuackViews(search_terms).toQuacks();
+  call.result(results.size());
   return results;
 }
 
 /**
- * @brief Retrieves a feed of quacks and requacks for a given user.
+ * @brief Zero-copy variant of `searchForQuacks`: search for quacks containing specific keywords or hashtags.
  *
- * @param user_id The unique identifier of the user for whom the feed is generated.
- * @return A vector of strings where each string represents a formatted entry in the feed.
+ * @param search_terms A string of keywords or hashtags to search for in quacks.
+ * @return The matching quacks as views into a per-query arena, most recent first
+ *         within each keyword.
+ *
+ * @note case insensitive search, space seperated keywoards
  */
-std::vector<std::string> Pond::getFeed(const int32_t& user_id) {
-    std::vector<std::string> feed;
-
-    const char* query = 
-        "SELECT 'tweet' AS type, t1.tid, u1.name, t1.writer_id, t1.tdate AS date, t1.ttime AS time, t1.text "
-        "FROM tweets t1 "
-        "JOIN follows f1 ON t1.writer_id = f1.flwee "
-        "JOIN users u1 ON t1.writer_id = u1.usr "
-        "WHERE f1.flwer = ? "
-        "UNION "
-        "SELECT 'retweet' AS type, t2.tid, u2.name, r.retweeter_id AS writer_id, r.rdate AS date, t2.ttime AS time, t2.text "
-        "FROM retweets r "
-        "JOIN tweets t2 ON t2.tid = r.tid "
-        "JOIN follows f2 ON r.retweeter_id = f2.flwee "
-        "JOIN users u2 ON r.retweeter_id = u2.usr "
-        "WHERE f2.flwer = ? AND r.spam = 0 "
-        "ORDER BY date DESC, time DESC";
-
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(this->_db, query, -1, &stmt, nullptr) != SQLITE_OK) {
-        sqlite3_finalize(stmt);
-        return feed;
-    }
-
-    sqlite3_bind_int(stmt, 1, user_id);
-    sqlite3_bind_int(stmt, 2, user_id);
-    
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        const unsigned char* tweet_id = sqlite3_column_text(stmt, 1);  // Id of quack 
-        const unsigned char* username = sqlite3_column_text(stmt, 2);  // Username of the quack author
-        const unsigned char* date = sqlite3_column_text(stmt, 4);      // Date of quack/requack
-        const unsigned char* time = sqlite3_column_text(stmt, 5);      // Time of quack/requack
-        const unsigned char* text = sqlite3_column_text(stmt, 6);      // Text of quack/requack
-
-        std::ostringstream oss;
-        oss << "Quack Id: " << reinterpret_cast<const char*>(tweet_id);
-        oss << ", Author: " << (username ? reinterpret_cast<const char*>(username) : "Unknown");
-        oss << std::string(66 - oss.str().length(), ' '); 
-        oss << "Date and Time: " <<(date ? reinterpret_cast<const char*>(date) : "Unknown")
-            << " " << (time ? reinterpret_cast<const char*>(time) : "Unknown") << "\n\n";
-        oss << "Text: " <<(text ? formatTweetText(reinterpret_cast<const char*>(text), 94) : "") << "\n";
-
-        feed.push_back(oss.str());
-    }
-
-    sqlite3_finalize(stmt);
-
-    return feed;
+Pond::QuackResults Pond::searchQuackViews(const std::string& search_terms) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::SearchQuackViews, search_terms);
+  Pond::QuackResults results;
+  this->_searchQuackViews(search_terms, results);
+  call.result(results.size());
+  return results;
 }
 
-uint32_t Pond::getRequackCount(const int32_t& quack_id) {
-  uint32_t requack_count = 0;
-
-  const char *query =
-    "SELECT COUNT(tid) "
-    "FROM retweets "
-    "WHERE tid = ?";
-
-  sqlite3_stmt *stmt;
-  if (sqlite3_prepare_v2(this->_db, query, -1, &stmt, nullptr) != SQLITE_OK) {
-    sqlite3_finalize(stmt);
-    return requack_count;
+/**
+ * @brief Searches for quacks containing specific keywords or hashtags, stopping early if
+ *        `deadline` expires or is cancelled.
+ *
+ * @param search_terms A string of keywords or hashtags to search for in quacks.
+ * @param deadline Bounds the search; it must outlive the call.
+ * @return The matches found in time, and whether the search was cut short.
+ */
+Pond::Timed<std::vector<Pond::Quack>> Pond::searchForQuacks(const std::string& search_terms,
+                                                            const Deadline& deadline) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::SearchForQuacksWithin, search_terms,
+                      static_cast<int64_t>(deadline.remaining().count()));
+  Pond::Timed<std::vector<Pond::Quack>> timed;
+  Pond::QuackResults results;
+  {
+    DeadlineScope scope(*this->_backend, &deadline);
+    this->_searchQuackViews(search_terms, results);
+    timed.truncated = this->_backend->interrupted();
   }
-
-  sqlite3_bind_int(stmt, 1, quack_id);
-
-  if (sqlite3_step(stmt) == SQLITE_ROW) {
-    requack_count = sqlite3_column_int(stmt, 0);
+  if (timed.truncated) {
+    ++this->_timeouts[Recorder::Op::SearchForQuacks];
   }
-
-  sqlite3_finalize(stmt);
-
-  return requack_count;
+  timed.results = results.toQuacks();
+  call.result(timed.results.size());
+  return timed;
 }
 
-std::vector<int32_t> Pond::getReplies(const int32_t& quack_id) {
-  std::vector<int32_t> results;
-
-  const char* query =
-    "SELECT tid "
-    "FROM tweets "
-    "WHERE replyto_tid = ?";
-
-  sqlite3_stmt* stmt;
-  if (sqlite3_prepare_v2(this->_db, query, -1, &stmt, nullptr) != SQLITE_OK) {
-    sqlite3_finalize(stmt);
-    return results;
+/**
+ * @brief Zero-copy variant of `searchForQuacks` with a deadline.
+ *
+ * @param search_terms A string of keywords or hashtags to search for in quacks.
+ * @param deadline Bounds the search; it must outlive the call.
+ * @return The matches found in time, and whether the search was cut short.
+ */
+Pond::Timed<Pond::QuackResults> Pond::searchQuackViews(const std::string& search_terms, const Deadline& deadline) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::SearchQuackViewsWithin, search_terms,
+                      static_cast<int64_t>(deadline.remaining().count()));
+  Pond::Timed<Pond::QuackResults> timed;
+  {
+    DeadlineScope scope(*this->_backend, &deadline);
+    this->_searchQuackViews(search_terms, timed.results);
+    timed.truncated = this->_backend->interrupted();
   }
-
-  sqlite3_bind_int(stmt, 1, quack_id);
-
-  while (sqlite3_step(stmt) == SQLITE_ROW) {
-    results.push_back(sqlite3_column_int(stmt, 0));
+  if (timed.truncated) {
+    ++this->_timeouts[Recorder::Op::SearchQuackViews];
   }
-
-  sqlite3_finalize(stmt);
-  
-  return results;
+  call.result(timed.results.size());
+  return timed;
 }
 
 /**
- * @brief Retrieves the username associated with a given user ID from the database.
+ * @brief Lazily searches for quacks containing specific keywords or hashtags.
  *
- * This function prepares an SQL statement to query the username of a specific user
- * from the `users` table using the provided user ID. If a matching user ID is found,
- * it retrieves the `name` column as the username. If no match is found or an error occurs,
- * it returns an empty string.
+ * Each keyword's query is opened up front but only read as the cursor's `next` asks
+ * for rows, so a search matching a million quacks costs what the pages shown cost.
  *
- * @param user_id The unique identifier of the user whose username is being retrieved.
- * @return A std::string containing the username if found, otherwise an empty string.
+ * @param search_terms Comma-separated keywords or hashtags, as for `searchQuackViews`.
+ * @return A cursor over the quacks `searchQuackViews` would return, in the same order.
+ *         Keywords whose query could not be opened contribute no results.
  */
-std::string Pond::getUsername(const int32_t& user_id) {
-  std::string username;
-  
-  const char* query =
-    "SELECT name "
-    "FROM users "
-    "WHERE usr = ?";
+Pond::QuackCursor Pond::openQuackSearch(const std::string& search_terms) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::OpenQuackSearch, search_terms);
+  Pond::QuackCursor cursor;
+  for (const std::string& kw : splitKeywords(search_terms)) {
+    // Hashtag matches are not remembered, as in searchQuackViews
+    const bool hashtag = kw[0] == '#';
+    std::unique_ptr<RowStream<Pond::QuackResults>> stream =
+      hashtag ? this->_backend->streamQuacksByHashtag(kw) : this->_backend->streamQuacksByWord(kw);
+    if (stream) {
+      cursor._sources.push_back(Pond::QuackCursor::Source{std::move(stream), !hashtag});
+    }
+  }
+  return cursor;
+}
 
-  sqlite3_stmt* stmt;
-  if (sqlite3_prepare_v2(this->_db, query, -1, &stmt, nullptr) != SQLITE_OK) {
-    sqlite3_finalize(stmt);
-    return "";
+/**
+ * @brief Counts the quacks `searchQuackViews` would return, without reading them.
+ *
+ * Each keyword is counted on its own: exact for one keyword, an upper bound for several.
+ *
+ * @return The count, or std::nullopt if the backend failed.
+ */
+std::optional<int64_t> Pond::countQuackMatches(const std::string& search_terms) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::CountQuackMatches, search_terms);
+  int64_t total = 0;
+  for (const std::string& kw : splitKeywords(search_terms)) {
+    std::optional<int64_t> count =
+      kw[0] == '#' ? this->_backend->countQuacksByHashtag(kw) : this->_backend->countQuacksByWord(kw);
+    if (!count) {
+      return std::nullopt;
+    }
+    total += *count;
   }
+  call.result(total);
+  return total;
+}
 
-  sqlite3_bind_int(stmt, 1, user_id);
+/**
+ * @brief Searches for quacks by a combination of hashtags, using the in-process
+ *        hashtag index.
+ *
+ * The index yields the matching quack IDs; the quacks themselves are then read in one
+ * query, most recent first.
+ *
+ * @param query The hashtags to combine, e.g. `#cats|#dogs #cute -#sad`; see
+ *              `HashtagIndex::parse`.
+ * @return The matching quacks as views into a per-query arena, most recent first.
+ */
+Pond::QuackResults Pond::searchHashtags(const std::string& query) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::SearchHashtags, query);
+  Pond::QuackResults results;
+  this->_syncHashtagIndex();
+  std::vector<int32_t> quack_ids = this->_hashtag_index.match(HashtagIndex::parse(query));
+  if (!quack_ids.empty()) {
+    this->_backend->quacksByID(quack_ids, results);
+  }
+  call.result(results.size());
+  return results;
+}
 
-  if (sqlite3_step(stmt) == SQLITE_ROW) {
-    const unsigned char* retrieved_username = sqlite3_column_text(stmt, 0);
-    if (retrieved_username != nullptr) {
-      username = reinterpret_cast<const char*>(retrieved_username);
+/**
+ * @brief Completes the start of a hashtag to the most mentioned hashtags.
+ *
+ * The completions come from the in-memory prefix index alone, which is filled from the
+ * hashtag index as mentions are added to it.
+ *
+ * @param prefix The start of a hashtag, in any case; the '#' may be left out.
+ * @param count The number of completions wanted; at most `PrefixIndex::TOP`.
+ * @return Lower-cased hashtags starting with `prefix`, with their mentions, most first.
+ */
+std::vector<PrefixIndex::Completion> Pond::completeHashtag(const std::string& prefix, const size_t& count) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::CompleteHashtag, prefix, static_cast<int64_t>(count));
+  std::vector<PrefixIndex::Completion> completions =
+    this->_hashtag_completions.complete(!prefix.empty() && prefix[0] == '#' ? prefix : "#" + prefix, count);
+  call.result(completions.size());
+  return completions;
+}
+
+/**
+ * @brief Searches quack text for any of the words in `query`, best match first, using
+ *        the in-process search index.
+ *
+ * The index ranks the page; its quacks are then read in one query and put back into
+ * rank order. A full page gets a `next` cursor holding the last match's score and ID
+ * and the time the page was scored at, so the following page continues exactly where
+ * this one ended even as the recency boost decays.
+ *
+ * @param query Words to search for; see `SearchIndex::tokenize`.
+ * @param count The number of matches per page.
+ * @param after The `next` cursor of the previous page, or std::nullopt for the first.
+ * @return The page, with each quack's score and the cursor for the page after it.
+ */
+Pond::RankedResults Pond::searchRanked(const std::string& query, const size_t& count,
+                                       const std::optional<SearchIndex::Cursor>& after) {
+  int64_t score_bits = 0;
+  if (after) {
+    std::memcpy(&score_bits, &after->score, sizeof(score_bits));
+  }
+  Recorder::Call call(&this->_recorder, Recorder::Op::SearchRanked, query, static_cast<int64_t>(count),
+                      static_cast<int64_t>(after.has_value()), score_bits,
+                      static_cast<int64_t>(after ? after->tid : 0), after ? after->now : 0);
+  Pond::RankedResults results;
+  this->_syncSearchIndex();
+  const int64_t now = after ? after->now : Clock::now().ts;
+  std::vector<SearchIndex::Hit> hits =
+    this->_search_index.search(query, count, now, after ? &*after : nullptr);
+  if (hits.empty()) {
+    return results;
+  }
+
+  std::vector<int32_t> quack_ids;
+  quack_ids.reserve(hits.size());
+  for (const SearchIndex::Hit& hit : hits) {
+    quack_ids.push_back(hit.tid);
+  }
+  Pond::QuackResults rows;
+  this->_backend->quacksByID(quack_ids, rows);
+  std::unordered_map<int32_t, size_t> row_of;
+  for (size_t i = 0; i < rows.size(); ++i) {
+    row_of.emplace(rows[i].tid, i);
+  }
+  results.quacks.reserve(hits.size());
+  for (const SearchIndex::Hit& hit : hits) {
+    auto row = row_of.find(hit.tid);
+    if (row != row_of.end()) {
+      results.quacks.append(rows[row->second]);
+      results.scores.push_back(hit.score);
     }
-    else username = "";
   }
+  if (hits.size() == count) {
+    results.next = SearchIndex::Cursor{hits.back().score, hits.back().tid, now};
+  }
+  call.result(results.quacks.size());
+  return results;
+}
 
-  sqlite3_finalize(stmt);
+/**
+ * @brief Retrieves a feed of quacks and requacks for a given user.
+ *
+ * @param user_id The unique identifier of the user for whom the feed is generated.
+ * @return A vector of strings where each string represents a formatted entry in the feed.
+ */
+std::vector<std::string> Pond::getFeed(const int32_t& user_id) {
+    Recorder::Call call(&this->_recorder, Recorder::Op::GetFeed, user_id);
+    bool truncated = false;
+    std::vector<std::string> feed = this->_getFeed(user_id, nullptr, truncated);
+    call.result(feed.size());
+    return feed;
+}
 
+/**
+ * @brief Retrieves a feed of quacks and requacks for a given user, stopping early if
+ *        `deadline` expires or is cancelled.
+ *
+ * Only the feed read itself is bounded; bringing the follow graph up to date is not,
+ * so an interrupted rebuild never leaves it half loaded.
+ *
+ * @param user_id The unique identifier of the user for whom the feed is generated.
+ * @param deadline Bounds the read; it must outlive the call.
+ * @return The formatted entries read in time, and whether the read was cut short.
+ */
+Pond::Timed<std::vector<std::string>> Pond::getFeed(const int32_t& user_id, const Deadline& deadline) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::GetFeedWithin, user_id,
+                      static_cast<int64_t>(deadline.remaining().count()));
+  Pond::Timed<std::vector<std::string>> timed;
+  timed.results = this->_getFeed(user_id, &deadline, timed.truncated);
+  if (timed.truncated) {
+    ++this->_timeouts[Recorder::Op::GetFeed];
+  }
+  call.result(timed.results.size());
+  return timed;
+}
+
+/**
+ * @brief Counts the calls cut short by their deadline, per kind of call.
+ *
+ * Calls are named as in the call log, e.g. `searchQuackViews`; the variants with and
+ * without a deadline share a name.
+ *
+ * @return `(call, timeouts)` for every kind of call that has timed out, by call name.
+ */
+std::vector<std::pair<std::string, uint64_t>> Pond::timeouts() const {
+  std::vector<std::pair<std::string, uint64_t>> counts;
+  for (const auto& [op, count] : this->_timeouts) {
+    counts.emplace_back(Recorder::opName(op), count);
+  }
+  std::sort(counts.begin(), counts.end());
+  return counts;
+}
+
+uint32_t Pond::getRequackCount(const int32_t& quack_id) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::GetRequackCount, quack_id);
+  std::optional<int32_t> requack_count = this->_backend->requackCount(quack_id);
+  if (!requack_count) {
+    return 0;
+  }
+
+  call.result(1);
+  return *requack_count;
+}
+
+std::vector<int32_t> Pond::getReplies(const int32_t& quack_id) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::GetReplies, quack_id);
+  std::vector<int32_t> results;
+  this->_backend->replies(quack_id, results);
+  call.result(results.size());
+  return results;
+}
+
+/**
+ * @brief Retrieves the conversation under a quack in one query.
+ *
+ * A thread read again with the same depth and limit is copied from the cache, after
+ * dropping the threads replied to since the last call.
+ *
+ * @param root_tid The quack the conversation starts at.
+ * @param max_depth How many levels of replies to include; 0 for the root alone.
+ * @param limit The maximum number of quacks, including the root.
+ * @return The thread, or an empty one if the root does not exist.
+ */
+Pond::Thread Pond::getThread(const int32_t& root_tid, const int32_t& max_depth, const size_t& limit) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::GetThread, root_tid, max_depth, static_cast<int64_t>(limit));
+  Pond::Thread result;
+  this->_syncThreadCache();
+
+  auto cached = this->_thread_cache.find(root_tid);
+  if (cached != this->_thread_cache.end() && cached->second.max_depth == max_depth &&
+      cached->second.limit == limit) {
+    this->_thread_lru.splice(this->_thread_lru.begin(), this->_thread_lru, cached->second.recent);
+    const Pond::Thread& thread = cached->second.thread;
+    result.quacks.reserve(thread.quacks.size());
+    for (const Pond::QuackView& quack : thread.quacks) {
+      result.quacks.append(quack);
+    }
+    result.depths = thread.depths;
+    call.result(result.quacks.size());
+    return result;
+  }
+
+  if (!this->_backend->thread(root_tid, max_depth, limit, result.quacks, result.depths)) {
+    return Pond::Thread{};
+  }
+  call.result(result.quacks.size());
+  if (result.quacks.empty() || !this->_thread_last_tid) {
+    return result;
+  }
+
+  // Replace an entry read with other bounds, and make room by dropping the least
+  // recently read thread
+  if (cached != this->_thread_cache.end()) {
+    this->_dropThread(root_tid);
+  }
+  if (this->_thread_cache.size() >= THREAD_CACHE_SIZE) {
+    this->_dropThread(this->_thread_lru.back());
+  }
+
+  CachedThread entry{max_depth, limit, Pond::Thread{}, {}};
+  entry.thread.quacks.reserve(result.quacks.size());
+  for (const Pond::QuackView& quack : result.quacks) {
+    entry.thread.quacks.append(quack);
+    this->_thread_roots[quack.tid].push_back(root_tid);
+  }
+  entry.thread.depths = result.depths;
+  this->_thread_lru.push_front(root_tid);
+  entry.recent = this->_thread_lru.begin();
+  this->_thread_cache.emplace(root_tid, std::move(entry));
+  return result;
+}
+
+/**
+ * @brief Retrieves the username associated with a given user ID from the database.
+ *
+ * This function prepares an SQL statement to query the username of a specific user
+ * from the `users` table using the provided user ID. If a matching user ID is found,
+ * it retrieves the `name` column as the username. If no match is found or an error occurs,
+ * it returns an empty string.
+ *
+ * @param user_id The unique identifier of the user whose username is being retrieved.
+ * @return A std::string containing the username if found, otherwise an empty string.
+ */
+std::string Pond::getUsername(const int32_t& user_id) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::GetUsername, user_id);
+  std::string username = this->_backend->username(user_id).value_or("");
+  call.result(!username.empty());
   return username;
 }
 
@@ -867,39 +1040,36 @@ std::string Pond::getUsername(const int32_t& user_id) {
  * @return A Pond::Quack struct containing the quack's information.
  */
 Pond::Quack Pond::getQuackFromID(const int32_t& quack_id) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::GetQuackFromID, quack_id);
   Pond::Quack quack;
 
-  const char* query =
-    "SELECT tid, writer_id, text, tdate, ttime, replyto_tid "
-    "FROM tweets "
-    "WHERE tid = ?";
-
-  sqlite3_stmt* stmt;
-  if (sqlite3_prepare_v2(this->_db, query, -1, &stmt, nullptr) != SQLITE_OK) {
-    sqlite3_finalize(stmt);
-    return quack;
+  Pond::QuackResults results = this->getQuackViewFromID(quack_id);
+  if (!results.empty()) {
+    quack = results[0].toQuack();
+    call.result(1);
   }
-
-  sqlite3_bind_int(stmt, 1, quack_id);
-
-  if (sqlite3_step(stmt) == SQLITE_ROW) {
-    quack.tid = sqlite3_column_int(stmt, 0);
-    quack.writer_id = sqlite3_column_int(stmt, 1);
-    quack.text = (const char*)sqlite3_column_text(stmt, 2);
-    quack.date = (const char*)sqlite3_column_text(stmt, 3);
-    quack.time = (const char*)sqlite3_column_text(stmt, 4);
-    quack.replyto_tid = sqlite3_column_int(stmt, 5);
-  }
-
-  sqlite3_finalize(stmt);
   return quack;
 }
 
+/**
+ * @brief Zero-copy variant of `getQuackFromID`.
+ *
+ * @param quack_id The unique ID of the quack to retrieve.
+ * @return A result set with the quack, or an empty one if it does not exist.
+ */
+Pond::QuackResults Pond::getQuackViewFromID(const int32_t& quack_id) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::GetQuackViewFromID, quack_id);
+  Pond::QuackResults results;
+  this->_backend->quackByID(quack_id, results);
+  call.result(results.size());
+  return results;
+}
+
 /**
  * @brief Retrieves the list of followers for a specified user.
  *
- * This method queries the database to find all users who follow the specified user
- * and returns their IDs and names.
+ * This method looks up the followers in the follow graph and reads their names from
+ * the database, returning them in ascending ID order.
  *
  * @param user_id The unique ID of the user whose followers are to be retrieved.
  * @return A vector of `Pond::User` objects, where each object contains:
@@ -910,38 +1080,24 @@ Pond::Quack Pond::getQuackFromID(const int32_t& quack_id) {
  *       returns an empty vector.
  */
 std::vector<Pond::User> Pond::getFollowers(const int32_t& user_id) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::GetFollowers, user_id);
   std::vector<Pond::User> results;
-
-  const char* query =
-    "SELECT u.usr, u.name "
-    "FROM follows f "
-    "JOIN users u ON f.flwer = u.usr "
-    "WHERE f.flwee = ?";
-
-  sqlite3_stmt* stmt;
-  if (sqlite3_prepare_v2(this->_db, query, -1, &stmt, nullptr) != SQLITE_OK) {
-    sqlite3_finalize(stmt);
-    return results;
+  std::vector<int32_t> follower_ids;
+  if (this->_syncGraph()) {
+    this->_graph.followers(user_id, follower_ids);
   }
-
-  sqlite3_bind_int(stmt, 1, user_id);
-
-  while (sqlite3_step(stmt) == SQLITE_ROW) {
-    Pond::User user;
-    user.usr = sqlite3_column_int(stmt, 0); 
-    user.name = (const char*)(sqlite3_column_text(stmt, 1)); 
-    results.push_back(user);
+  if (!follower_ids.empty()) {
+    this->_backend->usersByID(follower_ids, results);
   }
-
-  sqlite3_finalize(stmt);
+  call.result(results.size());
   return results;
 }
 
 /**
  * @brief Retrieves a list of users that a specified user is following.
  *
- * This method queries the database to find all user IDs of the users whom the 
- * specified user has chosen to follow.
+ * This method reads the IDs of the users whom the specified user has chosen to follow
+ * from the in-memory follow graph, in ascending ID order.
  *
  * @param user_id The unique ID of the user whose following list is to be retrieved.
  * @return A vector of integers where each integer represents the unique ID of a user 
@@ -951,27 +1107,12 @@ std::vector<Pond::User> Pond::getFollowers(const int32_t& user_id) {
  *       the method returns an empty vector.
  */
 std::vector<int32_t> Pond::getFollows(const int32_t& user_id) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::GetFollows, user_id);
   std::vector<int32_t> results;
-
-  const char* query =
-  "SELECT flwee "
-  "FROM follows "
-  "WHERE flwer = ?";
-
-  sqlite3_stmt* stmt;
-  if (sqlite3_prepare_v2(this->_db, query, -1, &stmt, nullptr) != SQLITE_OK) {
-    sqlite3_finalize(stmt);
-    return results;
-  }
-
-  sqlite3_bind_int(stmt, 1, user_id);
-
-  while (sqlite3_step(stmt) == SQLITE_ROW) {
-    results.push_back(sqlite3_column_int(stmt, 0));
+  if (this->_syncGraph()) {
+    this->_graph.follows(user_id, results);
   }
-
-  sqlite3_finalize(stmt);
-
+  call.result(results.size());
   return results;
 }
 
@@ -979,7 +1120,7 @@ std::vector<int32_t> Pond::getFollows(const int32_t& user_id) {
  * @brief Retrieves all quacks created by a specified user.
  *
  * This method queries the database to fetch all quacks (tweets) authored by the given 
- * user, sorted by date and time in descending order (most recent first).
+ * user, sorted by timestamp in descending order (most recent first).
  *
  * @param user_id The unique ID of the user whose quacks are to be retrieved.
  * @return A vector of `Pond::Quack` objects, where each object contains:
@@ -995,38 +1136,425 @@ std::vector<int32_t> Pond::getFollows(const int32_t& user_id) {
  *       the method returns an empty vector.
  */
 std::vector<Pond::Quack> Pond::getQuacks(const int32_t& user_id) {
-  std::vector<Pond::Quack> results;
+  Recorder::Call call(&this->_recorder, Recorder::Op::GetQuacks, user_id);
+  std::vector<Pond::Quack> results = this->getQuackViews(user_id).toQuacks();
+  call.result(results.size());
+  return results;
+}
 
-  const char* query =
-    "SELECT tid, writer_id, text, tdate, ttime, replyto_tid "
-    "FROM tweets "
-    "WHERE writer_id = ? "
-    "ORDER BY tdate DESC, ttime DESC";
+/**
+ * @brief Zero-copy variant of `getQuacks`.
+ *
+ * @param user_id The unique ID of the user whose quacks are to be retrieved.
+ * @return The user's quacks as views into a per-query arena, most recent first.
+ */
+Pond::QuackResults Pond::getQuackViews(const int32_t& user_id) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::GetQuackViews, user_id);
+  Pond::QuackResults results;
+  this->_backend->quacksByWriter(user_id, results);
+  call.result(results.size());
+  return results;
+}
+
+/**
+ * @brief Suggests accounts to follow from the user's friends of friends.
+ *
+ * @param user_id The unique ID of the user to suggest accounts to.
+ * @param count The maximum number of suggestions.
+ * @return The suggestions, most mutual connections first, then lowest user ID.
+ */
+std::vector<Pond::Suggestion> Pond::suggestFollows(const int32_t& user_id, const size_t& count) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::SuggestFollows, user_id, static_cast<int64_t>(count));
+  std::vector<Pond::Suggestion> results;
+  if (!this->_syncGraph()) {
+    return results;
+  }
 
-  sqlite3_stmt* stmt;
-  if (sqlite3_prepare_v2(this->_db, query, -1, &stmt, nullptr) != SQLITE_OK) {
-    sqlite3_finalize(stmt);
+  std::vector<FollowGraph::Suggestion> ranked;
+  if (this->_suggestions_version == this->_graph_version && count <= this->_suggestions_count) {
+    if (user_id >= 0 && static_cast<size_t>(user_id) < this->_suggestions.size()) {
+      const std::vector<FollowGraph::Suggestion>& cached = this->_suggestions[user_id];
+      ranked.assign(cached.begin(), cached.begin() + std::min(count, cached.size()));
+    }
+  } else {
+    ranked = this->_graph.suggest(user_id, count, &this->_threads());
+  }
+  if (ranked.empty()) {
     return results;
   }
 
-  sqlite3_bind_int(stmt, 1, user_id);
+  std::vector<int32_t> ids;
+  ids.reserve(ranked.size());
+  for (const FollowGraph::Suggestion& suggestion : ranked) {
+    ids.push_back(suggestion.usr);
+  }
+  std::vector<Pond::User> users;
+  this->_backend->usersByID(ids, users);
+
+  // usersByID keeps the ranked order and only skips IDs without a user
+  results.reserve(users.size());
+  auto suggestion = ranked.begin();
+  for (Pond::User& user : users) {
+    while (suggestion != ranked.end() && suggestion->usr != user.usr) {
+      ++suggestion;
+    }
+    if (suggestion == ranked.end()) {
+      break;
+    }
+    results.push_back(Pond::Suggestion{user.usr, std::move(user.name), suggestion->mutuals});
+  }
+
+  call.result(results.size());
+  return results;
+}
+
+/**
+ * @brief Finds the shortest chain of follows leading from one user to another.
+ *
+ * @param user_id The user the chain starts from.
+ * @param target_id The user the chain leads to.
+ * @param max_depth The longest chain to look for, in follows.
+ * @return The user IDs along the chain, from `user_id` to `target_id`, or an empty
+ *         vector if no chain of at most `max_depth` follows exists.
+ */
+std::vector<int32_t> Pond::followDistance(const int32_t& user_id, const int32_t& target_id, const int32_t& max_depth) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::FollowDistance, user_id, target_id, max_depth);
+  std::vector<int32_t> path;
+  if (this->_syncGraph()) {
+    path = this->_graph.shortestPath(user_id, target_id, max_depth, this->_path_search);
+  }
+  call.result(path.size());
+  return path;
+}
+
+/**
+ * @brief Computes follow suggestions for every user at once on a thread pool.
+ *
+ * @param count The number of suggestions to keep per user.
+ * @return The number of users who received at least one suggestion.
+ */
+size_t Pond::precomputeSuggestions(const size_t& count) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::PrecomputeSuggestions, static_cast<int64_t>(count));
+  if (!this->_syncGraph()) {
+    return 0;
+  }
+
+  this->_suggestions = this->_graph.suggestAll(count, this->_threads());
+  this->_suggestions_count = count;
+  this->_suggestions_version = this->_graph_version;
+
+  size_t users = std::count_if(this->_suggestions.begin(), this->_suggestions.end(),
+                               [](const auto& suggestions) { return !suggestions.empty(); });
+  call.result(users);
+  return users;
+}
+
+/**
+ * @brief Scores every user's influence with PageRank over the follow graph and
+ *        stores the scores, replacing the previous run's.
+ *
+ * @param warm_start Start from the stored scores instead of uniform ones.
+ * @return What the run did, or `nullopt` if the follows could not be read or the
+ *         scores could not be stored.
+ */
+std::optional<Pond::RankReport> Pond::rankUsers(const bool& warm_start) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::RankUsers, static_cast<int64_t>(warm_start));
+  if (!this->_syncGraph()) {
+    return std::nullopt;
+  }
+
+  std::vector<double> start;
+  if (warm_start) {
+    std::vector<std::pair<int32_t, double>> stored;
+    if (!this->_backend->userRanks(stored)) {
+      return std::nullopt;
+    }
+    for (const auto& [usr, score] : stored) {
+      if (usr >= 0) {
+        start.resize(std::max(start.size(), static_cast<size_t>(usr) + 1), 0.0);
+        start[usr] = score;
+      }
+    }
+  }
+
+  auto began = std::chrono::steady_clock::now();
+  FollowGraph::Ranking ranking = this->_graph.pageRank(this->_threads(), start, RANK_DAMPING,
+                                                       RANK_TOLERANCE, RANK_MAX_ITERATIONS);
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - began).count();
+
+  std::vector<std::pair<int32_t, double>> ranks;
+  ranks.reserve(ranking.scores.size());
+  for (size_t usr = 0; usr < ranking.scores.size(); ++usr) {
+    ranks.emplace_back(static_cast<int32_t>(usr), ranking.scores[usr]);
+  }
+  if (!this->_backend->replaceUserRanks(ranks)) {
+    return std::nullopt;
+  }
+  this->_graph.setInfluence(std::vector<float>(ranking.scores.begin(), ranking.scores.end()));
+  this->_suggestions_version.reset();  // precomputed suggestions were ordered by the old scores
+
+  call.result(ranking.iterations);
+  return Pond::RankReport{ranking.scores.size(), this->_graph.edges(), ranking.iterations,
+                          ranking.residual, ranking.residual < RANK_TOLERANCE, warm_start, seconds};
+}
+
+/**
+ * @brief Lists the quacks whose text is a near copy of `text`.
+ *
+ * @param text The text to look for, e.g. a quack about to be posted.
+ * @param max_distance At most `SimHashIndex::MAX_DISTANCE`.
+ * @param limit The maximum number of quacks.
+ * @return The quacks found, nearest first, then newest first.
+ */
+std::vector<SimHashIndex::Match> Pond::findNearDuplicates(const std::string& text, const int& max_distance,
+                                                         const size_t& limit) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::FindNearDuplicates, text,
+                      static_cast<int64_t>(max_distance), static_cast<int64_t>(limit));
+  this->_syncDuplicates();
+
+  std::vector<SimHashIndex::Match> matches;
+  this->_duplicates.near(SimHashIndex::fingerprint(text), max_distance, limit, matches);
+  call.result(matches.size());
+  return matches;
+}
+
+/**
+ * @brief Groups every quack in the database with its near copies, comparing in
+ *        parallel across cores.
+ *
+ * @param max_distance At most `SimHashIndex::MAX_DISTANCE`.
+ * @return The groups found, or `nullopt` if the fingerprints could not be read.
+ */
+std::optional<Pond::DuplicateReport> Pond::duplicateReport(const int& max_distance) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::DuplicateReport, static_cast<int64_t>(max_distance));
+  if (!this->_syncDuplicates()) {
+    return std::nullopt;
+  }
+
+  auto began = std::chrono::steady_clock::now();
+  std::vector<std::vector<int32_t>> groups = this->_duplicates.clusters(max_distance, this->_threads());
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - began).count();
+
+  call.result(groups.size());
+  return Pond::DuplicateReport{this->_duplicates.size(), this->_duplicates.fingerprints(),
+                               std::min(max_distance, SimHashIndex::MAX_DISTANCE), std::move(groups), seconds};
+}
+
+/**
+ * @brief Lists the hashtags mentioned most over the last hour or day.
+ *
+ * @param window The span of time to count mentions over.
+ * @param count The maximum number of hashtags.
+ * @return The hashtags, lower-cased, most mentions first, then alphabetically.
+ */
+std::vector<Trending::Trend> Pond::trendingHashtags(const Trending::Window& window, const size_t& count) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::TrendingHashtags,
+                      static_cast<int64_t>(window), static_cast<int64_t>(count));
+  std::vector<Trending::Trend> trends = this->_trending.top(window, count, Clock::now().ts);
+  call.result(trends.size());
+  return trends;
+}
+
+/**
+ * @brief Counts a hashtag's mentions per hour over a period.
+ *
+ * @param hashtag The hashtag, in any case, with or without its '#'.
+ * @param from_ts The start of the period, in microseconds since the Unix epoch.
+ * @param to_ts The end of the period, exclusive.
+ * @return One count per hour with at least one mention, oldest first.
+ */
+std::vector<Pond::HourlyCount> Pond::hashtagSeries(const std::string& hashtag, const int64_t& from_ts,
+                                                   const int64_t& to_ts) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::HashtagSeries, hashtag, from_ts, to_ts);
+  std::vector<Pond::HourlyCount> series;
+  if (hashtag.empty() || from_ts >= to_ts) {
+    return series;
+  }
+  const std::string term = hashtag[0] == '#' ? hashtag : "#" + hashtag;
+  const auto [from_hour, to_hour] = overlappingHours(from_ts, to_ts);
+
+  std::vector<std::pair<int64_t, int64_t>> hours;
+  if (!this->_backend->hashtagHours(term, from_hour, to_hour, hours)) {
+    return series;
+  }
+  series.reserve(hours.size());
+  for (const auto& [hour, mentions] : hours) {
+    series.push_back(Pond::HourlyCount{hour * HOUR_US, mentions});
+  }
+  call.result(series.size());
+  return series;
+}
+
+/**
+ * @brief Lists the hashtags mentioned most over a period, from the hourly rollups.
+ *
+ * @param from_ts The start of the period, in microseconds since the Unix epoch.
+ * @param to_ts The end of the period, exclusive.
+ * @param count The maximum number of hashtags.
+ * @return The hashtags, lower-cased, most mentions first, then alphabetically.
+ */
+std::vector<Trending::Trend> Pond::topHashtags(const int64_t& from_ts, const int64_t& to_ts, const size_t& count) {
+  Recorder::Call call(&this->_recorder, Recorder::Op::TopHashtags, from_ts, to_ts, static_cast<int64_t>(count));
+  std::vector<Trending::Trend> trends;
+  if (from_ts >= to_ts || count == 0) {
+    return trends;
+  }
+  const auto [from_hour, to_hour] = overlappingHours(from_ts, to_ts);
+
+  std::vector<std::pair<std::string, int64_t>> totals;
+  if (!this->_backend->topHashtagsBetween(from_hour, to_hour, count, totals)) {
+    return trends;
+  }
+  trends.reserve(totals.size());
+  for (auto& [term, mentions] : totals) {
+    trends.push_back(Trending::Trend{std::move(term), static_cast<uint32_t>(mentions)});
+  }
+  call.result(trends.size());
+  return trends;
+}
+
+/**
+ * @brief Recomputes the hourly hashtag rollups from every stored quack.
+ *
+ * @return true if the rollups were rebuilt.
+ */
+bool Pond::backfillHashtagRollups() {
+  Recorder::Call call(&this->_recorder, Recorder::Op::BackfillHashtagRollups);
+  if (!this->_backend->rebuildHashtagRollups()) {
+    std::cerr << "SQL Error (rollups): " << this->_backend->lastError() << std::endl;
+    return false;
+  }
+  call.result(1);
+  return true;
+}
+
+// =============================================================================
+// Result Sets
+// =============================================================================
+
+/**
+ * @brief Copies the viewed row into an owning `Quack`.
+ */
+Pond::Quack Pond::QuackView::toQuack() const {
+  Pond::Quack quack;
+  quack.tid = this->tid;
+  quack.writer_id = this->writer_id;
+  quack.text.assign(this->text.data(), this->text.size());
+  quack.date.assign(this->date.data(), this->date.size());
+  quack.time.assign(this->time.data(), this->time.size());
+  quack.replyto_tid = this->replyto_tid;
+  quack.ts = this->ts;
+  return quack;
+}
 
-  while (sqlite3_step(stmt) == SQLITE_ROW) {
-    Pond::Quack quack;
-    quack.tid =  sqlite3_column_int(stmt, 0);
-    quack.writer_id = sqlite3_column_int(stmt, 1);
-    quack.text = (const char*)(sqlite3_column_text(stmt, 2));
-    quack.date = (const char*)(sqlite3_column_text(stmt, 3));
-    quack.time = (const char*)(sqlite3_column_text(stmt, 4));
-    quack.replyto_tid = sqlite3_column_int(stmt, 5);
+/**
+ * @brief Appends the current row of a statement selecting
+ *        `tid, writer_id, text, tdate, ttime, replyto_tid, ts`.
+ *
+ * The text columns are copied straight out of SQLite's row buffer into the arena,
+ * so no intermediate `std::string` is built. NULL columns become empty views.
+ *
+ * @param stmt A statement positioned on a row (the last step returned `SQLITE_ROW`).
+ */
+void Pond::QuackResults::appendRow(sqlite3_stmt* stmt) {
+  auto column = [&](int i) {
+    const char* text = (const char*)sqlite3_column_text(stmt, i);
+    return this->_arena.copy(text, text ? sqlite3_column_bytes(stmt, i) : 0);
+  };
+
+  Pond::QuackView view;
+  view.tid = sqlite3_column_int(stmt, 0);
+  view.writer_id = sqlite3_column_int(stmt, 1);
+  view.text = column(2);
+  view.date = column(3);
+  view.time = column(4);
+  view.replyto_tid = sqlite3_column_int(stmt, 5);
+  view.ts = sqlite3_column_int64(stmt, 6);
+  this->_rows.push_back(view);
+}
 
-    results.push_back(quack);
+/**
+ * @brief Appends a copy of a row held elsewhere, e.g. by an in-memory backend.
+ *
+ * @param row The row to copy; its text is copied into this result set's arena.
+ */
+void Pond::QuackResults::append(const Pond::QuackView& row) {
+  Pond::QuackView view = row;
+  view.text = this->_arena.copy(row.text.data(), row.text.size());
+  view.date = this->_arena.copy(row.date.data(), row.date.size());
+  view.time = this->_arena.copy(row.time.data(), row.time.size());
+  this->_rows.push_back(view);
+}
+
+/**
+ * @brief Copies every row into owning `Quack` structs.
+ */
+std::vector<Pond::Quack> Pond::QuackResults::toQuacks() const {
+  std::vector<Pond::Quack> quacks;
+  quacks.reserve(this->_rows.size());
+  for (const Pond::QuackView& view : this->_rows) {
+    quacks.push_back(view.toQuack());
   }
+  return quacks;
+}
+
+Pond::QuackCursor::QuackCursor() = default;
+Pond::QuackCursor::QuackCursor(Pond::QuackCursor&&) noexcept = default;
+Pond::QuackCursor& Pond::QuackCursor::operator=(Pond::QuackCursor&&) noexcept = default;
+Pond::QuackCursor::~QuackCursor() = default;
 
-  sqlite3_finalize(stmt);
+/**
+ * @brief Returns up to `n` more matching quacks, reading each keyword's rows in turn.
+ *
+ * Rows already returned for an earlier word keyword are skipped, so a batch may take
+ * more than one read; a keyword whose read fails ends early.
+ */
+Pond::QuackResults Pond::QuackCursor::next(size_t n) {
+  Pond::QuackResults results;
+  Pond::QuackResults batch;
+  while (results.size() < n && this->_current < this->_sources.size()) {
+    Source& source = this->_sources[this->_current];
+    batch = Pond::QuackResults();
+    if (!source.stream->next(n - results.size(), batch) || source.stream->done()) {
+      ++this->_current;
+    }
+    for (const Pond::QuackView& row : batch) {
+      if (this->_seen.count(row.tid)) {
+        continue;
+      }
+      results.append(row);
+      if (source.remember) {
+        this->_seen.insert(row.tid);
+      }
+    }
+  }
   return results;
 }
 
+bool Pond::QuackCursor::done() const {
+  return this->_current == this->_sources.size();
+}
+
+Pond::UserCursor::UserCursor() = default;
+Pond::UserCursor::UserCursor(Pond::UserCursor&&) noexcept = default;
+Pond::UserCursor& Pond::UserCursor::operator=(Pond::UserCursor&&) noexcept = default;
+Pond::UserCursor::~UserCursor() = default;
+
+std::vector<Pond::User> Pond::UserCursor::next(size_t n) {
+  std::vector<Pond::User> users;
+  if (this->_stream && !this->_stream->next(n, users)) {
+    this->_stream.reset();
+  }
+  if (this->_stream && this->_stream->done()) {
+    this->_stream.reset();
+  }
+  return users;
+}
+
+bool Pond::UserCursor::done() const {
+  return !this->_stream;
+}
+
 // =============================================================================
 // Private Methods
 // =============================================================================
@@ -1047,23 +1575,13 @@ std::vector<Pond::Quack> Pond::getQuacks(const int32_t& user_id) {
  * - If an error occurs while preparing or executing the SQL query, the method returns `false`.
  */
 bool Pond::_getUniqueUserID(int32_t& unique_id) {
-  const char* query =
-    "SELECT MAX(usr) FROM users";
-
-  sqlite3_stmt* stmt;
-  if (sqlite3_prepare_v2(this->_db, query, -1, &stmt, nullptr) != SQLITE_OK) {
-    sqlite3_finalize(stmt);
+  std::optional<int32_t> max_id = this->_backend->maxUserID();
+  if (!max_id) {
     return false;
   }
 
-  if (sqlite3_step(stmt) == SQLITE_ROW) {
-    int32_t max_id = sqlite3_column_int(stmt, 0);
-    unique_id = max_id + 1;
-  } else {
-    unique_id = 1;
-  }
-
-  sqlite3_finalize(stmt);
+  // MAX() of an empty table is NULL, which reads as 0
+  unique_id = *max_id + 1;
   return true;
 }
 
@@ -1083,93 +1601,445 @@ bool Pond::_getUniqueUserID(int32_t& unique_id) {
  * - If an error occurs while preparing or executing the SQL query, the method returns `false`.
  */
 bool Pond::_getUniqueQuackID(int32_t& unique_id) {
-  const char* query =
-    "SELECT MAX(tid) FROM tweets";
-
-  sqlite3_stmt* stmt;
-  if (sqlite3_prepare_v2(this->_db, query, -1, &stmt, nullptr) != SQLITE_OK) {
-    sqlite3_finalize(stmt);
+  std::optional<int32_t> max_id = this->_backend->maxQuackID();
+  if (!max_id) {
     return false;
   }
 
-  if (sqlite3_step(stmt) == SQLITE_ROW) {
-    int32_t max_id = sqlite3_column_int(stmt, 0);
-    unique_id = max_id + 1;
-  } else {
-    unique_id = 1;
+  // MAX() of an empty table is NULL, which reads as 0
+  unique_id = *max_id + 1;
+  return true;
+}
+
+/**
+ * @brief Checks if a list exists for a given user in the database.
+ *
+ *
+ * @param list_name The name of the list to check for.
+ * @param user_id The ID of the user who owns the list.
+ * @return True if the list exists for the specified user, false otherwise.
+ *
+ * @note If the storage backend fails, the function returns false.
+ */
+bool Pond::_listExists(const std::string &list_name, const int32_t &user_id) {
+  return this->_backend->listExists(user_id, list_name);
+}
+
+/**
+ * @brief Drops everything Pond derived from the previous backend and rebuilds it from
+ *        the current one, after a loader has switched backends.
+ */
+void Pond::_resetIndexes() {
+  this->_graph_version.reset();
+  this->_syncGraph();
+  this->_loadInfluence();
+  this->_seedTrending();
+  this->_hashtag_index.clear();
+  this->_hashtag_completions.clear();
+  this->_syncHashtagIndex();
+  this->_name_completions.clear();
+  this->_user_names.clear();
+  this->_last_usr = INT32_MIN;
+  this->_syncUserNames();
+  this->_search_index.clear();
+  this->_syncSearchIndex();
+  this->_clearThreads();
+  this->_spam.clear();
+  this->_duplicates.clear();
+  this->_syncDuplicates();
+}
+
+/**
+ * @brief Brings the follow graph up to date with the backend.
+ *
+ * The graph is rebuilt from the backend's follow edges whenever its follow counter
+ * has moved past the version the graph was built or last updated at, e.g. because
+ * another connection followed or unfollowed someone.
+ *
+ * @return true if the graph is current; false if the backend could not be read.
+ */
+bool Pond::_syncGraph() {
+  std::optional<int64_t> version = this->_backend->followsVersion();
+  if (!version) {
+    return false;
+  }
+  if (version == this->_graph_version) {
+    return true;
   }
 
-  sqlite3_finalize(stmt);
+  std::vector<FollowGraph::Edge> edges;
+  if (!this->_backend->followEdges(edges)) {
+    return false;
+  }
+  this->_graph.build(std::move(edges));
+  this->_graph_version = version;
   return true;
 }
 
 /**
- * @brief Retrieves the current time in GMT as a formatted string (HH:MM:SS).
+ * @brief Passes the stored influence scores to the follow graph for ordering
+ *        suggestions.
+ *
+ * Scores of users the follow graph has not seen are kept too, so they apply as soon as
+ * those users gain follows.
+ */
+void Pond::_loadInfluence() {
+  std::vector<std::pair<int32_t, double>> stored;
+  std::vector<float> influence;
+  if (this->_backend->userRanks(stored)) {
+    for (const auto& [usr, score] : stored) {
+      if (usr >= 0) {
+        influence.resize(std::max(influence.size(), static_cast<size_t>(usr) + 1), 0.0f);
+        influence[usr] = static_cast<float>(score);
+      }
+    }
+  }
+  this->_graph.setInfluence(std::move(influence));
+}
+
+/**
+ * @brief Counts the hashtags linked to a newly stored quack towards trending, as the
+ *        hashtag rollups count them when the quack is inserted.
+ */
+void Pond::_countMentions(int32_t tid, int64_t ts) {
+  std::vector<std::string> terms;
+  if (!this->_backend->hashtagsOf(tid, terms)) {
+    return;
+  }
+  for (const std::string& term : terms) {
+    this->_trending.add(term, ts);
+  }
+}
+
+/**
+ * @brief Refills the trending counters with the hashtags of the last day's quacks.
+ */
+void Pond::_seedTrending() {
+  const int64_t day_us = 24 * 3600 * 1000000LL;
+  std::vector<std::pair<int64_t, std::string>> mentions;
+  this->_trending.clear();
+  if (this->_backend->hashtagMentionsSince(Clock::now().ts - day_us, mentions)) {
+    for (const auto& [ts, term] : mentions) {
+      this->_trending.add(term, ts);
+    }
+  }
+}
+
+/**
+ * @brief Adds the hashtags linked since the index was last brought up to date, such as
+ *        those of quacks posted through other connections.
  *
- * @return A string representing the current time in "HH:MM:SS" format.
+ * Quack IDs only grow, so only mentions from the largest indexed ID onwards are read.
+ * That quack itself is read again in case its hashtags were still being added.
  */
-char* Pond::_getTime() {
-  std::time_t rn = std::time(nullptr);
-  std::tm* gmt = std::gmtime(&rn);
+void Pond::_syncHashtagIndex() {
+  std::vector<std::pair<int32_t, std::string>> mentions;
+  if (this->_backend->hashtagMentionsFrom(this->_hashtag_index.lastTid(), mentions)) {
+    for (const auto& [quack_id, term] : mentions) {
+      if (this->_hashtag_index.add(quack_id, term)) {
+        this->_hashtag_completions.add(term, 1);
+      }
+    }
+  }
+}
 
-  char* t = new char[9];
-  std::strftime(t, 9, "%H:%M:%S", gmt);
+/**
+ * @brief Indexes the text of quacks posted since the search index was last brought up
+ *        to date, such as those posted through other connections.
+ *
+ * Quacks are read in ascending ID order in batches, so a large database is indexed
+ * without holding all of its text at once.
+ */
+void Pond::_syncSearchIndex() {
+  const size_t batch = 10000;
+  int32_t first_tid = this->_search_index.lastTid() == INT32_MIN ? INT32_MIN : this->_search_index.lastTid() + 1;
+  while (true) {
+    Pond::QuackResults quacks;
+    if (!this->_backend->quacksFrom(first_tid, batch, quacks) || quacks.empty()) {
+      return;
+    }
+    for (const Pond::QuackView& quack : quacks) {
+      this->_indexQuack(quack.tid, quack.writer_id, quack.ts, std::string(quack.text));
+    }
+    if (quacks.size() < batch || quacks[quacks.size() - 1].tid == INT32_MAX) {
+      return;
+    }
+    first_tid = quacks[quacks.size() - 1].tid + 1;
+  }
+}
 
-  return t;
+/**
+ * @brief Adds the fingerprints of quacks posted since the near-duplicate index was last
+ *        brought up to date, such as those posted through other connections.
+ *
+ * Fingerprints are read in ascending ID order in batches, as for the search index.
+ *
+ * @return false if the fingerprints could not be read.
+ */
+bool Pond::_syncDuplicates() {
+  const size_t batch = 10000;
+  int32_t first_tid = this->_duplicates.lastTid() == INT32_MIN ? INT32_MIN : this->_duplicates.lastTid() + 1;
+  while (true) {
+    std::vector<std::pair<int32_t, uint64_t>> simhashes;
+    if (!this->_backend->simhashesFrom(first_tid, batch, simhashes)) {
+      return false;
+    }
+    for (const auto& [tid, simhash] : simhashes) {
+      this->_duplicates.add(tid, simhash);
+    }
+    if (simhashes.size() < batch || simhashes.back().first == INT32_MAX) {
+      return true;
+    }
+    first_tid = simhashes.back().first + 1;
+  }
 }
 
 /**
- * @brief Retrieves the current date in GMT as a formatted string (YYYY-MM-DD).
+ * @brief Returns true if the user has already requacked a near copy of the quack.
  *
- * @return A string representing the current date in "YYYY-MM-DD" format.
+ * Only the `NEAR_COPY_LIMIT` nearest copies are checked, so a quack copied many times
+ * over is judged by its closest copies. Errors count as no copy.
  */
-char* Pond::_getDate() {
-  std::time_t rn = std::time(nullptr);
-  std::tm* gmt = std::gmtime(&rn);
+bool Pond::_requackedNearCopy(int32_t user_id, int32_t quack_id) {
+  uint64_t simhash;
+  if (!this->_duplicates.fingerprintOf(quack_id, simhash)) {
+    this->_syncDuplicates();
+    if (!this->_duplicates.fingerprintOf(quack_id, simhash)) {
+      return false;
+    }
+  }
 
-  char* t = new char[11];
-  // yyyy-mm-dd
-  std::strftime(t, 11, "%F", gmt);
+  std::vector<SimHashIndex::Match> matches;
+  this->_duplicates.near(simhash, SimHashIndex::DEFAULT_DISTANCE, NEAR_COPY_LIMIT + 1, matches);
+  std::vector<int32_t> copies;
+  copies.reserve(matches.size());
+  for (const SimHashIndex::Match& match : matches) {
+    if (match.tid != quack_id) {
+      copies.push_back(match.tid);
+    }
+  }
+  if (copies.empty()) {
+    return false;
+  }
+  std::optional<bool> requacked = this->_backend->requackedAny(user_id, copies);
+  return requacked.value_or(false);
+}
 
-  return t;
+/**
+ * @brief Adds the names of users created since the name completions were last brought
+ *        up to date, such as those created through other connections.
+ *
+ * User IDs only grow, so only users above the largest ID seen are read. New names start
+ * without weight; they gain one for every quack their user writes.
+ */
+void Pond::_syncUserNames() {
+  std::vector<Pond::User> users;
+  const int32_t first_usr = this->_last_usr == INT32_MIN ? INT32_MIN : this->_last_usr + 1;
+  if (this->_last_usr == INT32_MAX || !this->_backend->usersFrom(first_usr, users)) {
+    return;
+  }
+  for (Pond::User& user : users) {
+    this->_name_completions.add(user.name, 0);
+    this->_last_usr = std::max(this->_last_usr, user.usr);
+    this->_user_names.emplace(user.usr, std::move(user.name));
+  }
 }
 
 /**
- * @brief Checks if a list exists for a given user in the database.
+ * @brief Indexes a quack's text and, if it is new to the index, counts it towards its
+ *        writer's name completion.
  *
+ * A writer not seen yet was created through another connection, so the names are
+ * brought up to date first.
+ */
+void Pond::_indexQuack(int32_t tid, int32_t writer_id, int64_t ts, const std::string& text) {
+  if (!this->_search_index.add(tid, ts, text)) {
+    return;
+  }
+  auto name = this->_user_names.find(writer_id);
+  if (name == this->_user_names.end()) {
+    this->_syncUserNames();
+    name = this->_user_names.find(writer_id);
+  }
+  if (name != this->_user_names.end()) {
+    this->_name_completions.add(name->second, 1);
+  }
+}
+
+/**
+ * @brief Applies this Pond's own follow or unfollow to the graph.
  *
- * @param list_name The name of the list to check for.
- * @param user_id The ID of the user who owns the list.
- * @return True if the list exists for the specified user, false otherwise.
+ * The change is applied in place when the backend's follow counter moved by exactly
+ * `expected_changes` since the graph was last current; otherwise another connection
+ * changed follows too, and the graph is left to be rebuilt on the next read.
  *
- * @note If there is an error preparing the SQL statement, the function will
- *       finalize the statement and return false.
+ * @param flwer The follower.
+ * @param flwee The user followed or unfollowed.
+ * @param following true for a follow, false for an unfollow.
+ * @param expected_changes The number of follow rows this call changed.
  */
-bool Pond::_listExists(const std::string &list_name, const int32_t &user_id) {
-  bool exists = false;
+void Pond::_updateGraph(int32_t flwer, int32_t flwee, bool following, int64_t expected_changes) {
+  std::optional<int64_t> version = this->_backend->followsVersion();
+  if (!version || !this->_graph_version || *version != *this->_graph_version + expected_changes) {
+    this->_graph_version.reset();
+    return;
+  }
 
-  const char* query = "SELECT 1 FROM lists WHERE owner_id = ? AND lname = ?";
+  if (following) {
+    this->_graph.add(flwer, flwee);
+  } else {
+    this->_graph.remove(flwer, flwee);
+  }
+  this->_graph_version = version;
+}
 
-  sqlite3_stmt* stmt;
-  if (sqlite3_prepare_v2(this->_db, query, -1, &stmt, nullptr) != SQLITE_OK) {
-    sqlite3_finalize(stmt);
-    return false;
+/**
+ * @brief Drops the cached threads that show a quack, because it was replied to.
+ *
+ * @param tid The quack replied to.
+ */
+void Pond::_evictThreads(int32_t tid) {
+  auto showing = this->_thread_roots.find(tid);
+  if (showing == this->_thread_roots.end()) {
+    return;
   }
+  const std::vector<int32_t> roots = showing->second;  // shrinks as the threads are dropped
+  for (int32_t root : roots) {
+    this->_dropThread(root);
+  }
+}
 
-  // Bind parameters to prevent SQL injection.
-  sqlite3_bind_int(stmt, 1, user_id);                                     // owner_id
-  sqlite3_bind_text(stmt, 2, list_name.c_str(), -1, SQLITE_STATIC);       // lname
+/**
+ * @brief Drops one cached thread, and unlists it from the quacks it shows.
+ *
+ * @param root_tid The root of the thread to drop.
+ */
+void Pond::_dropThread(int32_t root_tid) {
+  auto cached = this->_thread_cache.find(root_tid);
+  if (cached == this->_thread_cache.end()) {
+    return;
+  }
+  for (const Pond::QuackView& quack : cached->second.thread.quacks) {
+    auto shown = this->_thread_roots.find(quack.tid);
+    if (shown == this->_thread_roots.end()) {
+      continue;
+    }
+    std::vector<int32_t>& roots = shown->second;
+    roots.erase(std::remove(roots.begin(), roots.end(), root_tid), roots.end());
+    if (roots.empty()) {
+      this->_thread_roots.erase(shown);
+    }
+  }
+  this->_thread_lru.erase(cached->second.recent);
+  this->_thread_cache.erase(cached);
+}
 
-  // Execute the query.
-  exists = sqlite3_step(stmt) == SQLITE_ROW;
-  sqlite3_finalize(stmt);
+/**
+ * @brief Drops the cached threads that quacks posted through other connections since
+ *        the last call replied to.
+ *
+ * Quack IDs only grow, so only quacks above the largest ID seen are read. With nothing
+ * cached, or more new quacks than one batch, the cache just starts over from the
+ * newest quack.
+ */
+void Pond::_syncThreadCache() {
+  if (!this->_thread_cache.empty() && this->_thread_last_tid && *this->_thread_last_tid < INT32_MAX) {
+    Pond::QuackResults quacks;
+    if (this->_backend->quacksFrom(*this->_thread_last_tid + 1, THREAD_SYNC_BATCH, quacks) &&
+        quacks.size() < THREAD_SYNC_BATCH) {
+      for (const Pond::QuackView& quack : quacks) {
+        if (quack.replyto_tid != 0) {
+          this->_evictThreads(quack.replyto_tid);
+        }
+        this->_thread_last_tid = std::max(*this->_thread_last_tid, quack.tid);
+      }
+      return;
+    }
+  }
+  this->_clearThreads();
+}
 
-  if (!exists) {
-    return false;
+/**
+ * @brief Empties the thread cache, and notes the newest quack it has seen replies up to.
+ */
+void Pond::_clearThreads() {
+  this->_thread_cache.clear();
+  this->_thread_lru.clear();
+  this->_thread_roots.clear();
+  this->_thread_last_tid = this->_backend ? this->_backend->maxQuackID() : std::nullopt;
+}
+
+/**
+ * @brief Appends the matches of each keyword of a quack search in turn.
+ *
+ * Hashtag matches are not remembered, so a later keyword may list them again. If the
+ * backend's deadline cuts a keyword's read short, the keywords after it are skipped.
+ */
+void Pond::_searchQuackViews(const std::string& search_terms, Pond::QuackResults& results) {
+  std::unordered_set<int32_t> quack_ids; // keep track of unique quack ids across searches
+
+  for (const std::string& kw : splitKeywords(search_terms)) {
+    if (kw[0] == '#') {
+      this->_backend->searchQuacksByHashtag(kw, results, quack_ids);
+    }
+    else { // text keyword
+      this->_backend->searchQuacksByWord(kw, results, quack_ids);
+    }
+    if (this->_backend->interrupted()) {
+      break;
+    }
   }
-  else {
-    return true;
+}
+
+/**
+ * @brief Reads and formats a user's feed, bounding the feed read by `deadline` if set.
+ *
+ * @param user_id The unique identifier of the user for whom the feed is generated.
+ * @param deadline Bounds the feed read, or nullptr for none.
+ * @param truncated Set to whether the deadline cut the read short.
+ * @return A vector of strings where each string represents a formatted entry in the feed.
+ */
+std::vector<std::string> Pond::_getFeed(int32_t user_id, const Deadline* deadline, bool& truncated) {
+    std::vector<std::string> feed;
+    truncated = false;
+
+    std::vector<int32_t> followees;
+    if (this->_syncGraph()) {
+      this->_graph.follows(user_id, followees);
+    }
+    std::vector<Backend::FeedEntry> entries;
+    if (!followees.empty()) {
+      DeadlineScope scope(*this->_backend, deadline);
+      this->_backend->feed(followees, entries);
+      truncated = this->_backend->interrupted();
+    }
+
+    feed.reserve(entries.size());
+    for (const Backend::FeedEntry& entry : entries) {
+        std::ostringstream oss;
+        oss << "Quack Id: " << entry.tid;
+        oss << ", Author: " << (!entry.name.empty() ? entry.name : "Unknown");
+        oss << std::string(66 - oss.str().length(), ' ');
+        oss << "Date and Time: " << (!entry.date.empty() ? entry.date : "Unknown")
+            << " " << (!entry.time.empty() ? entry.time : "Unknown") << "\n\n";
+        oss << "Text: " << formatTweetText(entry.text, 94) << "\n";
+
+        feed.push_back(oss.str());
+    }
+
+    return feed;
+}
+
+/**
+ * @brief Returns the thread pool for graph computations, starting it on first use.
+ *
+ * Most Ponds never run a graph computation, so the workers are not started with Pond.
+ */
+ThreadPool& Pond::_threads() {
+  if (!this->_pool) {
+    this->_pool = std::make_unique<ThreadPool>();
   }
+  return *this->_pool;
 }
 
 /**
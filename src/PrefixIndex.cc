@@ -0,0 +1,189 @@
+#include "PrefixIndex.hh"
+
+#include <algorithm>
+
+namespace {
+
+std::string fold(const std::string& text) {
+  std::string folded = text;
+  for (char& c : folded) {
+    if (c >= 'A' && c <= 'Z') {
+      c = static_cast<char>(c - 'A' + 'a');
+    }
+  }
+  return folded;
+}
+
+} // namespace
+
+// =============================================================================
+// Public Methods
+// =============================================================================
+
+/**
+ * @brief Adds `weight` uses to `text`, adding it with that weight if it is new.
+ *
+ * The key is walked down the trie; where it leaves an edge part way, the edge is split
+ * in two, and whatever is left of the key becomes a new leaf. The entry is then
+ * promoted in the cached lists of every node on its path.
+ */
+void PrefixIndex::add(const std::string& text, int64_t weight) {
+  if (text.empty() || weight < 0) {
+    return;
+  }
+  if (this->_nodes.empty()) {
+    this->_nodes.emplace_back();
+  }
+
+  const std::string key = fold(text);
+  std::vector<uint32_t> path;
+  uint32_t current = 0;
+  size_t position = 0;
+  while (true) {
+    path.push_back(current);
+    if (position == key.size()) {
+      break;
+    }
+
+    const int64_t found = this->_child(this->_nodes[current], key[position]);
+    if (found < 0) {
+      Node leaf;
+      leaf.label = key.substr(position);
+      const uint32_t index = static_cast<uint32_t>(this->_nodes.size());
+      this->_nodes.push_back(std::move(leaf));
+      std::vector<uint32_t>& children = this->_nodes[current].children;
+      auto at = std::lower_bound(children.begin(), children.end(), key[position], [this](uint32_t child, char c) {
+        return static_cast<unsigned char>(this->_nodes[child].label[0]) < static_cast<unsigned char>(c);
+      });
+      children.insert(at, index);
+      current = index;
+      position = key.size();
+      continue;
+    }
+
+    const uint32_t child = static_cast<uint32_t>(found);
+    const std::string& label = this->_nodes[child].label;
+    size_t common = 1;
+    while (common < label.size() && position + common < key.size() && label[common] == key[position + common]) {
+      ++common;
+    }
+    if (common < label.size()) {
+      // The key leaves the edge part way: put a node where it does
+      Node middle;
+      middle.label = label.substr(0, common);
+      middle.children.push_back(child);
+      middle.top = this->_nodes[child].top;
+      this->_nodes[child].label.erase(0, common);
+      const uint32_t index = static_cast<uint32_t>(this->_nodes.size());
+      this->_nodes.push_back(std::move(middle));
+      std::vector<uint32_t>& children = this->_nodes[current].children;
+      *std::find(children.begin(), children.end(), child) = index;
+      current = index;
+    } else {
+      current = child;
+    }
+    position += common;
+  }
+
+  Node& end = this->_nodes[current];
+  if (end.entry < 0) {
+    end.entry = static_cast<int32_t>(this->_entries.size());
+    this->_entries.push_back(Entry{text, key, weight});
+  } else {
+    this->_entries[end.entry].weight += weight;
+  }
+  const uint32_t entry = static_cast<uint32_t>(end.entry);
+  for (uint32_t node : path) {
+    this->_promote(this->_nodes[node], entry);
+  }
+}
+
+/**
+ * @brief Returns the most used texts starting with `prefix` (in any case).
+ *
+ * The prefix is walked down the trie; it may end part way along an edge, in which case
+ * the node below stands for it. That node's cached list is the answer.
+ */
+std::vector<PrefixIndex::Completion> PrefixIndex::complete(const std::string& prefix, size_t count) const {
+  std::vector<Completion> completions;
+  if (this->_nodes.empty()) {
+    return completions;
+  }
+
+  const std::string key = fold(prefix);
+  uint32_t current = 0;
+  size_t position = 0;
+  while (position < key.size()) {
+    const int64_t found = this->_child(this->_nodes[current], key[position]);
+    if (found < 0) {
+      return completions;
+    }
+    current = static_cast<uint32_t>(found);
+    const std::string& label = this->_nodes[current].label;
+    const size_t length = std::min(label.size(), key.size() - position);
+    if (label.compare(0, length, key, position, length) != 0) {
+      return completions;
+    }
+    position += length;
+  }
+
+  const std::vector<uint32_t>& top = this->_nodes[current].top;
+  const size_t n = std::min(count, top.size());
+  completions.reserve(n);
+  for (size_t i = 0; i < n; ++i) {
+    const Entry& entry = this->_entries[top[i]];
+    completions.push_back(Completion{entry.text, entry.weight});
+  }
+  return completions;
+}
+
+/**
+ * @brief Forgets every text.
+ */
+void PrefixIndex::clear() {
+  this->_nodes.clear();
+  this->_entries.clear();
+}
+
+// =============================================================================
+// Private Methods
+// =============================================================================
+
+/**
+ * @brief Orders entries best first: most used, then alphabetically.
+ */
+bool PrefixIndex::_better(uint32_t a, uint32_t b) const {
+  const Entry& first = this->_entries[a];
+  const Entry& second = this->_entries[b];
+  return first.weight != second.weight ? first.weight > second.weight : first.key < second.key;
+}
+
+/**
+ * @brief Moves `entry` to its place in `node`'s cached list after its weight grew,
+ *        keeping at most `TOP`.
+ */
+void PrefixIndex::_promote(Node& node, uint32_t entry) {
+  std::vector<uint32_t>& top = node.top;
+  top.erase(std::remove(top.begin(), top.end(), entry), top.end());
+  auto at = std::lower_bound(top.begin(), top.end(), entry,
+                             [this](uint32_t a, uint32_t b) { return this->_better(a, b); });
+  if (static_cast<size_t>(at - top.begin()) < TOP) {
+    top.insert(at, entry);
+    if (top.size() > TOP) {
+      top.pop_back();
+    }
+  }
+}
+
+/**
+ * @brief Returns the child of `node` whose label starts with `first`, or -1.
+ */
+int64_t PrefixIndex::_child(const Node& node, char first) const {
+  auto at = std::lower_bound(node.children.begin(), node.children.end(), first, [this](uint32_t child, char c) {
+    return static_cast<unsigned char>(this->_nodes[child].label[0]) < static_cast<unsigned char>(c);
+  });
+  if (at == node.children.end() || this->_nodes[*at].label[0] != first) {
+    return -1;
+  }
+  return *at;
+}
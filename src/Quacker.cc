@@ -13,28 +13,30 @@
  * a status code of ERROR_SQL.
  *
  * @param db_filename The name of the database file to load.
+ * @param record_filename Optional log file; when non-empty every Pond call made during
+ *        the session is recorded to it for later replay.
  *
  * @note Ensure that the provided `db_filename` points to a valid and
  * accessible database file to prevent the program from terminating.
  */
-Quacker::Quacker(const std::string& db_filename) {
+Quacker::Quacker(const std::string& db_filename, const std::string& record_filename) {
   if (pond.loadDatabase(db_filename)) {
     std::cerr << "Database Error: Could Not Open" << db_filename << std::endl;
     exit(ERROR_SQL);
   }
+  if (!record_filename.empty() && !pond.startRecording(record_filename)) {
+    std::cerr << "Record Error: Could Not Open " << record_filename << std::endl;
+    exit(ERROR_FILE);
+  }
 }
 
 /**
  * @brief Destructor for the Quacker class.
  *
- * This destructor clears the console by executing the `clear` system command 
- * and releases the memory allocated for the `_user_id` member variable.
+ * This destructor clears the console by executing the `clear` system command.
  */
 Quacker::~Quacker() {
   std::system("clear");
-  if (_user_id) {
-    delete _user_id;
-  }
 }
 
 /**
@@ -56,7 +58,7 @@ void Quacker::run() {
  * @brief Displays the main start page for the Quacker application and prompts user actions.
  *
  * This function continually displays the main start page menu until the user logs in or exits.
- * While `_user_id` remains `nullptr`, the menu provides options to log in, sign up, or exit the program.
+ * While `_user_id` remains empty, the menu provides options to log in, sign up, or exit the program.
  * Each option triggers the corresponding page or action.
  *
  * The menu options include:
@@ -66,7 +68,7 @@ void Quacker::run() {
  */
 void Quacker::startPage() {
   std::string error = "";
-  while (this->_user_id == nullptr) {
+  while (!this->_user_id) {
     std::system("clear");
 
     char select;
@@ -150,7 +152,7 @@ void Quacker::loginPage() {
     this->_user_id = pond.checkLogin(user_id, password);
 
     // If credentials are invalid, prompt the user to try again
-    if (_user_id == nullptr) {
+    if (!_user_id) {
       description = "Invalid credentials, please enter a valid 'User ID' and 'Password', or press Enter to return.";
       continue;
     }
@@ -215,10 +217,10 @@ void Quacker::signupPage() {
     if (password.empty()) return;
 
     // Add user to the database
-    int32_t* new_user_id = pond.addUser(name, email, phone_number, password);
+    std::optional<int32_t> new_user_id = pond.addUser(name, email, phone_number, password);
     
     // If the user is successfully added, assign the new user ID to _user_id and notify the user
-    if (new_user_id != nullptr) {
+    if (new_user_id) {
       this->_user_id = new_user_id;
       std::cout << "Account created! Press Enter to log in... ";
       std::cin.get();
@@ -264,7 +266,10 @@ void Quacker::mainPage() {
                                       "5. Reply/Retweet From Feed\n"
                                       "6. List Followers\n"
                                       "7. CREATE NEW POST\n"
-                                      "8. Log Out\n"
+                                      "8. Who To Follow\n"
+                                      "9. Trending\n"
+                                      "L. My Lists\n"
+                                      "0. Log Out\n"
                                       "Selection: ";
     std::cin >> select;
     if (std::cin.peek() != '\n') select = '0';
@@ -342,16 +347,31 @@ void Quacker::mainPage() {
         break;
 
       case '8':
+        this->suggestionsPage();
+        error = "";
+        break;
+
+      case '9':
+        this->trendingPage();
+        error = "";
+        break;
+
+      case 'L':
+      case 'l':
+        this->listsPage();
+        error = "";
+        break;
+
+      case '0':
         std::system("clear");
         FeedDisplayCount = 5;
         error = "";
         logged_in = false;
-        delete this->_user_id;
-        this->_user_id = nullptr;
+        this->_user_id.reset();
         break;
 
       default:
-        error = "\nInvalid Input Entered [use: 1, 2, 3, ..., 9].\n";
+        error = "\nInvalid Input Entered [use: 0, 1, 2, ..., 9, L].\n";
         break;
     }
   }
@@ -369,21 +389,51 @@ void Quacker::mainPage() {
  * - Validates the input to ensure it is not empty before attempting to post.
  * - Attempts to post the Quack using the database. If successful, the user is notified.
  * - Handles errors during posting, such as issues with duplicate hashtags, and provides feedback.
+ * - A line ending in the start of a hashtag and a Tab lists the most mentioned hashtags
+ *   it could be; the chosen one completes it and the text is kept for further typing.
  */
 void Quacker::postingPage() {
   std::system("clear");
-  std::string description = "Type your new Quack or press Enter to return.";
+  std::string description = "Type your new Quack or press Enter to return. "
+                            "End with the start of a #hashtag and press Tab, Enter to complete it.";
   std::string quack_text;
+  std::string draft;  // text kept from before a completion, shown and continued on the next line
   while (true) {
     std::system("clear");
     std::cout << QUACKER_BANNER << "\n" << description << "\n\n--- New Quack ---\n";
-    std::cout << "Enter your new quack: ";
+    std::cout << "Enter your new quack: " << draft;
     std::getline(std::cin, quack_text);
+    quack_text = draft + quack_text;
+    draft.clear();
+
+    // A line ending in Tab asks to complete the hashtag it ends with
+    if (!quack_text.empty() && quack_text.back() == '\t') {
+      quack_text.pop_back();
+      const size_t start = quack_text.find_last_of(" \t") + 1;
+      const std::string word = quack_text.substr(start);
+      draft = quack_text;
+      if (word.empty() || word[0] != '#') {
+        description = "Only hashtags can be completed; end with the start of one, e.g. #du.";
+        continue;
+      }
+      std::vector<PrefixIndex::Completion> completions = pond.completeHashtag(word, 5);
+      if (completions.empty()) {
+        description = "No hashtags start with " + word + ".";
+        continue;
+      }
+      if (std::optional<std::string> hashtag = pickCompletion(completions, "mentions")) {
+        draft = quack_text.substr(0, start) + *hashtag + " ";
+      }
+      description = "Type your new Quack or press Enter to return. "
+                    "End with the start of a #hashtag and press Tab, Enter to complete it.";
+      continue;
+    }
+
     quack_text = trim(quack_text);
     if (quack_text.empty()) {
       break;
     }
-    if (pond.addQuack(*(this->_user_id), quack_text) != nullptr) {
+    if (pond.addQuack(*(this->_user_id), quack_text)) {
       std::cout << "Quack posted successfully!\n";
       std::cout << "Press Enter to return... ";
       std::string input;
@@ -410,11 +460,14 @@ void Quacker::postingPage() {
  * - Retrieves and displays search results based on the input query.
  * - Allows users to interact with search results by selecting a user to view or follow.
  * - Handles navigation through paginated search results.
+ * - A line ending in a Tab lists the names of the most active users starting with it
+ *   and searches for the one chosen.
  * - Ensures input validation for selection and provides appropriate feedback for invalid inputs.
  * - Allows users to exit the interface by pressing Enter without input.
  */
 void Quacker::searchUsersPage() {
-  std::string description = "Search for a user or press Enter to return.";
+  std::string description = "Search for a user or press Enter to return. "
+                            "Type the start of a name and press Tab, Enter to complete it.";
   while (true) {
     // show search interface
     std::system("clear");
@@ -423,11 +476,38 @@ void Quacker::searchUsersPage() {
     std::string search_term;
     std::cout << "Search for user name: ";
     std::getline(std::cin, search_term);
+
+    // A line ending in Tab asks to complete the name it starts
+    if (!search_term.empty() && search_term.back() == '\t') {
+      search_term = trim(search_term);
+      std::vector<PrefixIndex::Completion> completions = pond.completeUsername(search_term, 5);
+      if (completions.empty()) {
+        description = "No user names start with " + search_term + ".";
+        continue;
+      }
+      std::optional<std::string> name = pickCompletion(completions, "quacks");
+      if (!name) {
+        description = "Search for a user or press Enter to return. "
+                      "Type the start of a name and press Tab, Enter to complete it.";
+        continue;
+      }
+      search_term = *name;
+    }
     search_term = trim(search_term);
     if (search_term.empty()) return;
 
-    // query
-    std::vector<Pond::User> results = pond.searchForUsers(search_term);
+    // query: matches are pulled from a cursor one page ahead of what is shown, and
+    // counted separately
+    Pond::UserCursor cursor = pond.openUserSearch(search_term);
+    const std::optional<int64_t> total = pond.countUserMatches(search_term);
+    std::vector<Pond::User> results;
+    auto load = [&](int32_t shown) {
+      while (!cursor.done() && static_cast<int32_t>(results.size()) < shown + 5) {
+        std::vector<Pond::User> batch = cursor.next(shown + 5 - results.size());
+        results.insert(results.end(), batch.begin(), batch.end());
+      }
+    };
+    load(5);
 
     // display results
     if (results.empty()) {
@@ -447,7 +527,8 @@ void Quacker::searchUsersPage() {
       
       while(true){
         i = 1;
-        std::cout << "Found " << results.size() << " users matching the search term.\n\n";
+        std::cout << "Found " << total.value_or(static_cast<int64_t>(results.size()))
+                  << " users matching the search term.\n\n";
 
         for (const Pond::User& result : results) {
           ++i;
@@ -515,6 +596,7 @@ void Quacker::searchUsersPage() {
           else if (input == "M" || input == "m"){
             if (UserDisplayCount < static_cast<int32_t>(results.size())){
               UserDisplayCount +=5;
+              load(UserDisplayCount);
               if(UserDisplayCount !=5) std::cout << "\033[25A" << "\033[0J";
               else {
                 std::cout << "\033[5A" << "\033[0J";
@@ -616,7 +698,9 @@ void Quacker::searchUsersPage() {
  * - Validates user input for result navigation and Quack interaction to ensure proper behavior.
  */
 void Quacker::searchQuacksPage() {
-  std::string description = "Search for a keyword or hashtag, or press Enter to return... ";
+  std::string description = "Search for keywords or hashtags separated by commas, or combine hashtags\n"
+                            "(#a #b: both, #a|#b: either, -#c: not), start with ? to rank matches\n"
+                            "by relevance (?duck pond), or press Enter to return... ";
   while (true) {
     // show search interface
     std::system("clear");
@@ -627,9 +711,31 @@ void Quacker::searchQuacksPage() {
     std::getline(std::cin, search_term);
     search_term = trim(search_term);
     if (search_term.empty()) return;
+    if (search_term[0] == '?') {
+      this->rankedSearchPage(trim(search_term.substr(1)));
+      continue;
+    }
 
-    // query
-    std::vector<Pond::Quack> results = pond.searchForQuacks(search_term);
+    // query: combined hashtags are matched through the hashtag index; other searches
+    // are pulled from a cursor one page ahead of what is shown, and counted separately
+    Pond::QuackCursor cursor;
+    Pond::QuackResults results;
+    std::optional<int64_t> total;
+    if (isHashtagQuery(search_term)) {
+      results = pond.searchHashtags(search_term);
+      total = results.size();
+    } else {
+      cursor = pond.openQuackSearch(search_term);
+      total = pond.countQuackMatches(search_term);
+    }
+    auto load = [&](int32_t shown) {
+      while (!cursor.done() && static_cast<int32_t>(results.size()) < shown + 5) {
+        for (const Pond::QuackView& row : cursor.next(shown + 5 - results.size())) {
+          results.append(row);
+        }
+      }
+    };
+    load(5);
    
     
     // display results
@@ -649,14 +755,16 @@ void Quacker::searchQuacksPage() {
       int32_t QuackDisplayCount = 5;
       int32_t i = 1;
 
-      std::cout << "Found " << results.size() << " Quacks matching the search term.\n";
+      // Several keywords are counted separately, so quacks matching more than one count twice
+      std::cout << "Found " << (search_term.find(',') != std::string::npos ? "up to " : "")
+                << total.value_or(static_cast<int64_t>(results.size())) << " Quacks matching the search term.\n";
       std::cout << '\n';
       for(int i = 0; i < 100; ++i) std::cout << '-';
       std::cout << '\n';
       while(true){
         i = 1; 
 
-        for (const Pond::Quack& result : results) {
+        for (const Pond::QuackView& result : results) {
           ++i;
 
           if((QuackDisplayCount < i-1 || i <= QuackDisplayCount-4) && QuackDisplayCount < static_cast<int32_t>(results.size())) continue;
@@ -712,7 +820,7 @@ void Quacker::searchQuacksPage() {
               valid_input = true;
             
               if (selection <= static_cast<int32_t>(results.size())) {
-                this->quackPage(results[selection]);
+                this->quackPage(results[selection].toQuack());
               }
               break;
             }
@@ -731,6 +839,7 @@ void Quacker::searchQuacksPage() {
           else if (input == "M" || input == "m"){
             if (QuackDisplayCount < static_cast<int32_t>(results.size())){
               QuackDisplayCount +=5;
+              load(QuackDisplayCount);
               if(QuackDisplayCount !=5) std::cout << "\033[32A" << "\033[0J";
               else {
                 std::cout << "\033[2A" << "\033[0J";
@@ -787,12 +896,12 @@ void Quacker::searchQuacksPage() {
               valid_input = true;
               
               if((selection+1 <= QuackDisplayCount && selection+1 > QuackDisplayCount-5) && QuackDisplayCount < static_cast<int32_t>(results.size())){
-                this->quackPage(results[selection]);
+                this->quackPage(results[selection].toQuack());
                 input = "";
                 valid_input = true;
               }
               else if((selection+1 <= static_cast<int32_t>(results.size()) && (selection+1 > static_cast<int32_t>(results.size()-5)) && QuackDisplayCount >= static_cast<int32_t>(results.size()))){
-                this->quackPage(results[selection]);
+                this->quackPage(results[selection].toQuack());
                 input = "";
                 valid_input = true;
               } else{
@@ -841,22 +950,38 @@ void Quacker::searchQuacksPage() {
     char select;
     std::cout << QUACKER_BANNER;
     std::cout << "\nActions For User:\n\n";
+    Pond::QuackResults users_quacks = pond.getQuackViews(user.usr);
     std::ostringstream oss;
     oss << "----------------------------------------------------------------------------------------------------\n";
     oss << "  User ID: " << std::setw(40) << std::left << user.usr
         << "Name: " << user.name << "\n";
     oss << "  Followers: " << std::setw(38) << std::left << pond.getFollowers(user.usr).size()
-        << "Follows: " << pond.getFollows(user.usr).size() << "\n  Quack Count: " << pond.getQuacks(user.usr).size() << "\n\n";
+        << "Follows: " << pond.getFollows(user.usr).size() << "\n  Quack Count: " << users_quacks.size() << "\n";
+
+    // Degrees of separation, shown as the chain of follows from the logged-in user
+    const int32_t MaxSeparation = 6;
+    std::vector<int32_t> chain = pond.followDistance(user_id, user.usr, MaxSeparation);
+    oss << "  Separation: ";
+    if (chain.empty()) {
+      oss << "More than " << MaxSeparation << " follows away";
+    } else if (chain.size() == 1) {
+      oss << "This is you";
+    } else {
+      oss << chain.size() - 1 << (chain.size() == 2 ? " follow" : " follows") << " (You";
+      for (size_t hop = 1; hop < chain.size(); ++hop) {
+        oss << " -> " << pond.getUsername(chain[hop]);
+      }
+      oss << ")";
+    }
+    oss << "\n\n";
     std::cout << oss.str();
     std::cout << "------------------------------------------- User's Quacks ------------------------------------------\n\n";
-    
-    std::vector<Pond::Quack> users_quacks = pond.getQuacks(user.usr);
 
-    for (const Pond::Quack& result : users_quacks) {
+    for (const Pond::QuackView& result : users_quacks) {
         ++i;
         if(i-1 > hardstop) break;
-        if(hardstop >= static_cast<int32_t>(pond.getQuacks(user.usr).size())) {
-          if((i-1 <= (static_cast<int32_t>(pond.getQuacks(user.usr).size()-3)))) continue;
+        if(hardstop >= static_cast<int32_t>(users_quacks.size())) {
+          if((i-1 <= (static_cast<int32_t>(users_quacks.size()-3)))) continue;
         } else if((i-1 <= (hardstop-3))) continue;
         std::ostringstream oss;
         
@@ -971,7 +1096,7 @@ void Quacker::searchQuacksPage() {
               valid_input = true;
 
               if (valid_input) {
-                this->quackPage(users_quacks[selection]);
+                this->quackPage(users_quacks[selection].toQuack());
               }
               break;
             }
@@ -1086,7 +1211,9 @@ void Quacker::quackPage(const Pond::Quack& reply) {
     std::cout << error <<
       "\n\n1. Reply"
       "\n2. Requack"
-      "\n3. Return"
+      "\n3. View Thread"
+      "\n4. Add To List"
+      "\n5. Return"
       "\n\nSelection: ";
     std::cin >> select;
     if (std::cin.peek() != '\n') select = '0';
@@ -1114,21 +1241,130 @@ void Quacker::quackPage(const Pond::Quack& reply) {
         else if (joebiden == 1) {
           error = "\n\nYou've already requacked this, marked as spam...\n";
         }
+        else if (joebiden == 2) {
+          error = "\n\nYou're requacking too fast, marked as spam...\n";
+        }
+        else if (joebiden == 4) {
+          error = "\n\nYou've already requacked a near copy of this, marked as spam...\n";
+        }
         else{
           error = "\n\nError requacking, please try again.\n";
         }
         break;
     }
       case '3':
+        error = "";
+        this->threadPage(reply);
+        break;
+      case '4': {
+        error = "";
+        std::vector<Pond::ListSummary> lists = pond.getLists(user_id);
+        if (lists.empty()) {
+          error = "\n\nYou have no lists yet, create one from My Lists on the main page.\n";
+          break;
+        }
+        std::cout << "\n\nYour Lists:";
+        for (const Pond::ListSummary& list : lists) {
+          std::cout << " " << list.name;
+        }
+        std::cout << "\nEnter a list name to add this quack to or press Enter to cancel: ";
+        std::string list_name;
+        std::getline(std::cin, list_name);
+        list_name = trim(list_name);
+        if (list_name.empty()) {
+          break;
+        }
+        if (pond.addToList(list_name, reply.tid, user_id)) {
+          error = "\n\nAdded to " + list_name + "!\n";
+        } else {
+          error = "\n\nCould not add to " + list_name + ", it may not exist or already hold this quack.\n";
+        }
+        break;
+      }
+      case '5':
         error = "";
         return;
       default:
-        error = "\n\nInvalid Input Entered [use: 1, 2, 3].\n";
+        error = "\n\nInvalid Input Entered [use: 1, 2, 3, 4, 5].\n";
         break;
     }
   }
 }
 
+/**
+ * @brief Shows the conversation under a quack, each reply indented below the quack it
+ *        answers, a page at a time.
+ *
+ * @details
+ * - Reads the thread in one call, up to `ThreadDepth` levels and `ThreadLimit` quacks;
+ *   threads read again are served from Pond's cache until someone replies in them.
+ * - Entering N shows the next page and P the previous one.
+ * - Selecting a quack (1,2,3,...) opens it to reply or requack.
+ */
+void Quacker::threadPage(const Pond::Quack& root) {
+  const int32_t ThreadDepth = 8;
+  const size_t ThreadLimit = 200;
+  const size_t PageSize = 10;
+  const std::string prompt = "Select a quack (1,2,3,...) to reply/requack, N for the next page, "
+                             "P for the previous page OR press Enter to return... ";
+  std::string description = prompt;
+  size_t first = 0;
+
+  while (true) {
+    std::system("clear");
+    Pond::Thread thread = pond.getThread(root.tid, ThreadDepth, ThreadLimit);
+    first = std::min(first, thread.quacks.empty() ? 0 : (thread.quacks.size() - 1) / PageSize * PageSize);
+    std::cout << QUACKER_BANNER << "\n" << description << "\n\n--- Thread Of Quack " << root.tid
+              << " (" << thread.quacks.size() << (thread.quacks.size() == ThreadLimit ? "+" : "")
+              << " Quacks) ---\n";
+
+    const size_t last = std::min(first + PageSize, thread.quacks.size());
+    for (size_t i = first; i < last; ++i) {
+      const Pond::QuackView& quack = thread.quacks[i];
+      const std::string indent(2 * static_cast<size_t>(std::min(thread.depths[i], ThreadDepth)), ' ');
+      const std::string author = pond.getUsername(quack.writer_id);
+      std::ostringstream oss;
+      oss << indent << i - first + 1 << ". Quack ID: " << quack.tid
+          << ", Author: " << (author.empty() ? "Unknown" : author)
+          << "     " << (quack.date.empty() ? "Unknown" : quack.date)
+          << " " << (quack.time.empty() ? "Unknown" : quack.time) << "\n";
+      std::istringstream lines(formatTweetText(quack.text, 94 - static_cast<int>(indent.size())));
+      for (std::string line; std::getline(lines, line);) {
+        oss << indent << "   " << line << "\n";
+      }
+      std::cout << oss.str() << '\n';
+    }
+    for (int dash = 0; dash < 100; ++dash) std::cout << '-';
+
+    std::cout << "\n\nSelection: ";
+    std::string input;
+    std::getline(std::cin, input);
+    input = trim(input);
+    description = prompt;
+    if (input.empty()) {
+      return;
+    }
+    if (input == "N" || input == "n") {
+      if (last < thread.quacks.size()) {
+        first += PageSize;
+      } else {
+        description = "You Have No More Quacks To Display: " + prompt;
+      }
+    } else if (input == "P" || input == "p") {
+      if (first > 0) {
+        first -= PageSize;
+      } else {
+        description = "You Are On The First Page: " + prompt;
+      }
+    } else if (std::regex_match(input, std::regex("^[1-9]\\d*$")) && input.size() < 9 &&
+               std::stoul(input) <= last - first) {
+      this->quackPage(thread.quacks[first + std::stoul(input) - 1].toQuack());
+    } else {
+      description = "Input Is Invalid: " + prompt;
+    }
+  }
+}
+
 /**
  * @brief Displays the list of followers and allows interaction with the follower profiles.
  *
@@ -1324,6 +1560,325 @@ void Quacker::followersPage() {
   }
 }
 
+/**
+ * @brief Suggests accounts to follow and lets the user open their profiles.
+ *
+ * This method lists the accounts most followed by the people the user follows, along
+ * with how many of them follow each account, and opens the profile of a selected
+ * account so it can be followed.
+ *
+ * @details
+ * - Retrieves the top suggestions for the logged-in user from the follow graph.
+ * - Displays each suggestion's user ID, name and number of mutual connections.
+ * - Validates the selection before opening the chosen profile.
+ */
+void Quacker::suggestionsPage() {
+  const size_t SuggestionCount = 10;
+  std::string description = "Accounts followed by people you follow, or press Enter to return.";
+
+  while (true) {
+    std::system("clear");
+    std::cout << QUACKER_BANNER << "\n" << description << "\n\n--- Who To Follow ---\n";
+
+    std::vector<Pond::Suggestion> results = pond.suggestFollows(*(this->_user_id), SuggestionCount);
+    if (results.empty()) {
+      std::cout << "No Suggestions Yet, Follow Some Users First :)\n\n";
+      std::cout << "Press Enter to return... ";
+      std::string input;
+      std::getline(std::cin, input);
+      return;
+    }
+
+    int32_t i = 1;
+    for (const Pond::Suggestion& result : results) {
+      std::ostringstream oss;
+      oss << "----------------------------------------------------------------------------------------------------\n";
+      oss << i++ << ".\n";
+      oss << "  User ID: " << std::setw(40) << std::left << result.usr
+          << "Name: " << result.name << "\n";
+      oss << "  Followed by " << result.mutuals << (result.mutuals == 1 ? " user" : " users")
+          << " you follow\n\n";
+      std::cout << oss.str();
+    }
+    std::cout << "----------------------------------------------------------------------------------------------------\n\n";
+
+    std::cout << "Select a user (1,2,3,...) to view OR press Enter to return: ";
+    std::string input;
+    std::getline(std::cin, input);
+    if (input.empty()) {
+      return;
+    }
+
+    std::regex positive_integer_regex("^[1-9]\\d*$");
+    if (!std::regex_match(input, positive_integer_regex) || input.size() > 9 ||
+        std::stoul(input) > results.size()) {
+      description = "Input Is Invalid: Select a user (1," + std::to_string(results.size()) + ") or press Enter to return.";
+      continue;
+    }
+    description = "Accounts followed by people you follow, or press Enter to return.";
+    const Pond::Suggestion& selected = results[std::stoul(input) - 1];
+    this->userPage(Pond::User{selected.usr, selected.name});
+  }
+}
+
+/**
+ * @brief Shows the quacks best matching the words of `query`, one ranked page at a time.
+ *
+ * @details
+ * - Fetches each page from the search index by the cursor the previous page ended at,
+ *   so only one page of quacks is held at a time.
+ * - Entering N shows the next page and P the previous one.
+ * - Selecting a quack (1,2,3,...) opens it to reply or requack.
+ */
+void Quacker::rankedSearchPage(const std::string& query) {
+  const size_t PageSize = 5;
+  const std::string prompt = "Select a quack (1,2,3,...) to reply/requack, N for the next page, "
+                             "P for the previous page OR press Enter to return... ";
+  std::vector<std::optional<SearchIndex::Cursor>> pages{std::nullopt};  // where each page seen starts
+  std::string description = prompt;
+
+  while (true) {
+    std::system("clear");
+    std::cout << QUACKER_BANNER << "\n" << description << "\n\n--- Best Matches For \"" << query
+              << "\" (Page " << pages.size() << ") ---\n";
+
+    Pond::RankedResults page = pond.searchRanked(query, PageSize, pages.back());
+    if (page.quacks.empty()) {
+      std::cout << (pages.size() == 1 ? "No Quacks found matching the search term.\n"
+                                      : "No more Quacks match the search term.\n");
+    }
+    for (size_t i = 0; i < page.quacks.size(); ++i) {
+      const Pond::QuackView& result = page.quacks[i];
+      const std::string author = pond.getUsername(result.writer_id);
+      std::ostringstream header;
+      header << "Quack ID: " << result.tid << ", Author: " << (author.empty() ? "Unknown" : author);
+      std::ostringstream oss;
+      for (int dash = 0; dash < 100; ++dash) oss << '-';
+      oss << '\n' << i + 1 << ". (score " << std::fixed << std::setprecision(2) << page.scores[i] << ")\n";
+      oss << header.str() << std::string(std::max<size_t>(1, 69 - std::min<size_t>(69, header.str().length())), ' ');
+      oss << "Date and Time: " << (result.date.empty() ? "Unknown" : result.date);
+      oss << " " << (result.time.empty() ? "Unknown" : result.time) << "\n\n";
+      oss << "Text: " << formatTweetText(result.text, 94) << "\n\n";
+      std::cout << oss.str();
+    }
+    if (!page.quacks.empty()) {
+      for (int dash = 0; dash < 100; ++dash) std::cout << '-';
+      std::cout << '\n';
+    }
+
+    std::cout << "\nSelection: ";
+    std::string input;
+    std::getline(std::cin, input);
+    input = trim(input);
+    description = prompt;
+    if (input.empty()) {
+      return;
+    }
+    if (input == "N" || input == "n") {
+      if (page.next) {
+        pages.push_back(page.next);
+      } else {
+        description = "You Have No More Quacks To Display: " + prompt;
+      }
+    } else if (input == "P" || input == "p") {
+      if (pages.size() > 1) {
+        pages.pop_back();
+      } else {
+        description = "You Are On The First Page: " + prompt;
+      }
+    } else if (std::regex_match(input, std::regex("^[1-9]\\d*$")) &&
+               std::stoul(input) <= page.quacks.size()) {
+      this->quackPage(page.quacks[std::stoul(input) - 1].toQuack());
+    } else {
+      description = "Input Is Invalid: " + prompt;
+    }
+  }
+}
+
+/**
+ * @brief Shows the hashtags mentioned most over the last hour or the last day.
+ *
+ * @details
+ * - Starts on the last hour; entering H or D switches between the two windows.
+ * - Lists each hashtag with its number of mentions, most mentioned first.
+ */
+void Quacker::trendingPage() {
+  const size_t TrendCount = 10;
+  Trending::Window window = Trending::Window::Hour;
+  std::string description = "Enter H for the last hour, D for the last day, or press Enter to return.";
+
+  while (true) {
+    std::system("clear");
+    const bool hourly = window == Trending::Window::Hour;
+    std::cout << QUACKER_BANNER << "\n" << description << "\n\n--- Trending "
+              << (hourly ? "In The Last Hour" : "Today") << " ---\n";
+
+    std::vector<Trending::Trend> trends = pond.trendingHashtags(window, TrendCount);
+    if (trends.empty()) {
+      std::cout << "Nothing Is Trending " << (hourly ? "This Hour" : "Today") << ", Start A Conversation :)\n";
+    }
+    int32_t i = 1;
+    for (const Trending::Trend& trend : trends) {
+      std::ostringstream oss;
+      oss << "----------------------------------------------------------------------------------------------------\n";
+      oss << std::setw(3) << std::right << i++ << ". " << std::setw(60) << std::left << trend.hashtag
+          << trend.mentions << (trend.mentions == 1 ? " quack" : " quacks") << "\n";
+      std::cout << oss.str();
+    }
+    if (!trends.empty()) {
+      std::cout << "----------------------------------------------------------------------------------------------------\n";
+    }
+
+    std::cout << "\nSelection: ";
+    std::string input;
+    std::getline(std::cin, input);
+    input = trim(input);
+    if (input.empty()) {
+      return;
+    }
+    if (input == "H" || input == "h") {
+      window = Trending::Window::Hour;
+    } else if (input == "D" || input == "d") {
+      window = Trending::Window::Day;
+    } else {
+      description = "Input Is Invalid: Enter H for the last hour, D for the last day, or press Enter to return.";
+      continue;
+    }
+    description = "Enter H for the last hour, D for the last day, or press Enter to return.";
+  }
+}
+
+/**
+ * @brief Shows the user's lists with their sizes, creates new ones and opens them.
+ *
+ * @details
+ * - Entering C asks for the name of a new list.
+ * - Selecting a list (1,2,3,...) opens its quacks.
+ */
+void Quacker::listsPage() {
+  const int32_t user_id = *(this->_user_id);
+  const std::string prompt = "Select a list (1,2,3,...) to view, C to create a list OR press Enter to return... ";
+  std::string description = prompt;
+
+  while (true) {
+    std::system("clear");
+    std::cout << QUACKER_BANNER << "\n" << description << "\n\n--- Your Lists ---\n";
+
+    std::vector<Pond::ListSummary> lists = pond.getLists(user_id);
+    if (lists.empty()) {
+      std::cout << "You Have No Lists Yet, Create One With C :)\n";
+    }
+    int32_t i = 1;
+    for (const Pond::ListSummary& list : lists) {
+      std::ostringstream oss;
+      oss << "----------------------------------------------------------------------------------------------------\n";
+      oss << std::setw(3) << std::right << i++ << ". " << std::setw(60) << std::left << list.name
+          << list.quacks << (list.quacks == 1 ? " quack" : " quacks") << "\n";
+      std::cout << oss.str();
+    }
+    if (!lists.empty()) {
+      std::cout << "----------------------------------------------------------------------------------------------------\n";
+    }
+
+    std::cout << "\nSelection: ";
+    std::string input;
+    std::getline(std::cin, input);
+    input = trim(input);
+    description = prompt;
+    if (input.empty()) {
+      return;
+    }
+    if (input == "C" || input == "c") {
+      std::cout << "Name of the new list or press Enter to cancel: ";
+      std::string list_name;
+      std::getline(std::cin, list_name);
+      list_name = trim(list_name);
+      if (!list_name.empty() && !pond.createList(user_id, list_name)) {
+        description = "You Already Have A List Named " + list_name + ": " + prompt;
+      }
+    } else if (std::regex_match(input, std::regex("^[1-9]\\d*$")) && input.size() < 9 &&
+               std::stoul(input) <= lists.size()) {
+      this->listPage(lists[std::stoul(input) - 1].name);
+    } else {
+      description = "Input Is Invalid: " + prompt;
+    }
+  }
+}
+
+/**
+ * @brief Shows the quacks in one of the user's lists, most recent first, a page at a time.
+ *
+ * @details
+ * - Fetches each page by the cursor the previous page ended at, so paging stays fast
+ *   in lists of any size.
+ * - Entering N shows the next page and P the previous one.
+ * - Selecting a quack (1,2,3,...) opens it to reply or requack.
+ */
+void Quacker::listPage(const std::string& list_name) {
+  const size_t PageSize = 5;
+  const std::string prompt = "Select a quack (1,2,3,...) to reply/requack, N for the next page, "
+                             "P for the previous page OR press Enter to return... ";
+  std::vector<std::optional<Pond::ListCursor>> pages{std::nullopt};  // where each page seen starts
+  std::string description = prompt;
+
+  while (true) {
+    std::system("clear");
+    std::cout << QUACKER_BANNER << "\n" << description << "\n\n--- " << list_name
+              << " (Page " << pages.size() << ") ---\n";
+
+    Pond::ListPage page = pond.getListQuacks(*(this->_user_id), list_name, pages.back(), PageSize);
+    if (page.quacks.empty()) {
+      std::cout << (pages.size() == 1 ? "This List Is Empty, Add Quacks To It From Their Quack Page.\n"
+                                      : "No More Quacks In This List.\n");
+    }
+    for (size_t i = 0; i < page.quacks.size(); ++i) {
+      const Pond::QuackView& result = page.quacks[i];
+      const std::string author = pond.getUsername(result.writer_id);
+      std::ostringstream header;
+      header << "Quack ID: " << result.tid << ", Author: " << (author.empty() ? "Unknown" : author);
+      std::ostringstream oss;
+      for (int dash = 0; dash < 100; ++dash) oss << '-';
+      oss << '\n' << i + 1 << ".\n";
+      oss << header.str() << std::string(std::max<size_t>(1, 69 - std::min<size_t>(69, header.str().length())), ' ');
+      oss << "Date and Time: " << (result.date.empty() ? "Unknown" : result.date);
+      oss << " " << (result.time.empty() ? "Unknown" : result.time) << "\n\n";
+      oss << "Text: " << formatTweetText(result.text, 94) << "\n\n";
+      std::cout << oss.str();
+    }
+    if (!page.quacks.empty()) {
+      for (int dash = 0; dash < 100; ++dash) std::cout << '-';
+      std::cout << '\n';
+    }
+
+    std::cout << "\nSelection: ";
+    std::string input;
+    std::getline(std::cin, input);
+    input = trim(input);
+    description = prompt;
+    if (input.empty()) {
+      return;
+    }
+    if (input == "N" || input == "n") {
+      if (page.next) {
+        pages.push_back(page.next);
+      } else {
+        description = "You Have No More Quacks To Display: " + prompt;
+      }
+    } else if (input == "P" || input == "p") {
+      if (pages.size() > 1) {
+        pages.pop_back();
+      } else {
+        description = "You Are On The First Page: " + prompt;
+      }
+    } else if (std::regex_match(input, std::regex("^[1-9]\\d*$")) &&
+               std::stoul(input) <= page.quacks.size()) {
+      this->quackPage(page.quacks[std::stoul(input) - 1].toQuack());
+    } else {
+      description = "Input Is Invalid: " + prompt;
+    }
+  }
+}
+
 /**
  * @brief Processes and formats the current user's feed for display.
  *
@@ -1540,6 +2095,63 @@ std::string Quacker::trim(const std::string& str) {
   return (start < end) ? std::string(start, end) : std::string();
 }
 
+/**
+ * @brief Checks whether a search combines hashtags (`#a #b`, `#a|#b`, `-#c`) rather
+ *        than listing comma-separated keywords.
+ *
+ * A lone hashtag is left to the keyword search, which handles it the same way.
+ *
+ * @param search_term The trimmed search input.
+ * @return true if every space-separated term is a hashtag, optionally prefixed with '-',
+ *         and the terms are combined with spaces, '|' or '-'.
+ */
+bool Quacker::isHashtagQuery(const std::string& search_term) {
+  if (search_term.empty() || search_term.find(',') != std::string::npos ||
+      (search_term.find_first_of(" |") == std::string::npos && search_term[0] != '-')) {
+    return false;
+  }
+  std::istringstream terms(search_term);
+  std::string term;
+  while (terms >> term) {
+    size_t start = term[0] == '-' ? 1 : 0;
+    if (term.size() <= start + 1 || term[start] != '#') {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Lists completions numbered from 1 and asks the user to pick one.
+ *
+ * Input other than a listed number is rejected and asked for again.
+ *
+ * @param completions The completions to list, best first.
+ * @param unit What each completion's weight counts, e.g. "mentions".
+ * @return The text of the chosen completion, or std::nullopt if the user pressed Enter.
+ */
+std::optional<std::string> Quacker::pickCompletion(const std::vector<PrefixIndex::Completion>& completions,
+                                                   const std::string& unit) {
+  std::cout << "\n";
+  for (size_t i = 0; i < completions.size(); ++i) {
+    std::cout << "  " << i + 1 << ". " << std::setw(40) << std::left << completions[i].text
+              << completions[i].weight << " " << unit << "\n";
+  }
+  std::cout << "\nSelect a completion (1,2,3,...) OR press Enter to keep typing: ";
+  std::string input;
+  std::getline(std::cin, input);
+  std::regex positive_integer_regex("^[1-9]\\d*$");
+  while (!input.empty()) {
+    if (std::regex_match(input, positive_integer_regex) && std::stoul(input) <= completions.size()) {
+      return completions[std::stoul(input) - 1].text;
+    }
+    std::cout << "\033[A\033[2K" << std::flush;
+    std::cout << "Input Is Invalid: Select a completion (1,2,3,...) OR press Enter to keep typing: ";
+    std::getline(std::cin, input);
+  }
+  return std::nullopt;
+}
+
 /**
  * @brief Formats a given text to wrap lines at a specified width.
  *
@@ -1551,13 +2163,20 @@ std::string Quacker::trim(const std::string& str) {
  * @param line_width The maximum width of each line.
  * @return A formatted string with line breaks added as necessary.
  */
-std::string Quacker::formatTweetText(const std::string& text, int line_width) {
-    std::istringstream words(text);  // Stream to split text into words
-    std::string word;
+std::string Quacker::formatTweetText(std::string_view text, int line_width) {
     std::ostringstream formattedText;
     int currentLineLength = 0;
 
-    while (words >> word) {
+    size_t pos = 0;
+    while (true) {
+        // Split on whitespace without copying the text into a stream
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) ++pos;
+        if (pos == text.size()) break;
+        size_t word_end = pos;
+        while (word_end < text.size() && !std::isspace(static_cast<unsigned char>(text[word_end]))) ++word_end;
+        std::string_view word = text.substr(pos, word_end - pos);
+        pos = word_end;
+
         if (currentLineLength + word.length() + 1 > static_cast<std::string::size_type>(line_width)) {
             formattedText << "\n";
             currentLineLength = 0;
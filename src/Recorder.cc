@@ -0,0 +1,272 @@
+#include "Recorder.hh"
+#include "Varint.hh"
+
+namespace {
+
+const char LOG_MAGIC[4] = {'Q', 'K', 'L', 'G'};
+const uint8_t LOG_VERSION = 1;
+
+const uint8_t TAG_INT = 0;
+const uint8_t TAG_TEXT = 1;
+
+} // namespace
+
+// =============================================================================
+// Call
+// =============================================================================
+
+/**
+ * @brief Appends the finished call to the log and releases the nesting level it held.
+ */
+Recorder::Call::~Call() {
+  if (_owner) {
+    --_owner->_depth;
+  }
+  if (_recorder) {
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - _start).count();
+    _recorder->_write(_op, _started_at, static_cast<uint32_t>(elapsed), _result_size, _arg_count, _args);
+  }
+}
+
+void Recorder::Call::_encode(int64_t value) {
+  _args.push_back(static_cast<char>(TAG_INT));
+  varint::put(_args, varint::zigzag(value));
+}
+
+void Recorder::Call::_encode(const std::string& value) {
+  _args.push_back(static_cast<char>(TAG_TEXT));
+  varint::put(_args, value.size());
+  _args.append(value);
+}
+
+void Recorder::Call::_encode(const Secret& secret) {
+  _args.push_back(static_cast<char>(TAG_TEXT));
+  varint::put(_args, secret.value.size());
+  _args.append(secret.value.size(), SECRET_CHAR);
+}
+
+void Recorder::Call::_encode(const std::vector<std::pair<int32_t, int32_t>>& pairs) {
+  std::string text;
+  for (const auto& [first, second] : pairs) {
+    if (!text.empty()) {
+      text.push_back(',');
+    }
+    text += std::to_string(first) + ':' + std::to_string(second);
+  }
+  _encode(text);
+}
+
+// =============================================================================
+// Public Methods
+// =============================================================================
+
+Recorder::Recorder()
+  : _file(nullptr), _last_started_at(0), _depth(0) {
+}
+
+Recorder::~Recorder() {
+  close();
+}
+
+/**
+ * @brief Creates the log file at the given path, replacing any existing log.
+ *
+ * @param path The log file to write.
+ * @return true if the log was opened; false otherwise.
+ */
+bool Recorder::open(const std::string& path) {
+  close();
+
+  _file = std::fopen(path.c_str(), "wb");
+  if (!_file) {
+    return false;
+  }
+
+  std::fwrite(LOG_MAGIC, 1, sizeof(LOG_MAGIC), _file);
+  std::fputc(LOG_VERSION, _file);
+  _last_started_at = 0;
+  return true;
+}
+
+/**
+ * @brief Flushes and closes the log, if one is open.
+ */
+void Recorder::close() {
+  if (_file) {
+    std::fclose(_file);
+    _file = nullptr;
+  }
+}
+
+/**
+ * @brief Reads every record of a log file.
+ *
+ * @param path The log file to read.
+ * @param[out] entries The decoded records, in recording order.
+ * @return true if the file was a valid log; false otherwise. A truncated final
+ *         record (e.g. from a crash) is ignored rather than treated as an error.
+ */
+bool Recorder::readLog(const std::string& path, std::vector<Entry>& entries) {
+  std::FILE* file = std::fopen(path.c_str(), "rb");
+  if (!file) {
+    return false;
+  }
+
+  char magic[sizeof(LOG_MAGIC)];
+  if (std::fread(magic, 1, sizeof(magic), file) != sizeof(magic) ||
+      !std::equal(magic, magic + sizeof(magic), LOG_MAGIC) ||
+      std::fgetc(file) != LOG_VERSION) {
+    std::fclose(file);
+    return false;
+  }
+
+  int64_t clock = 0;
+  int64_t first = -1;
+  while (true) {
+    int op = std::fgetc(file);
+    if (op == EOF) {
+      break;
+    }
+
+    Entry entry;
+    uint64_t delta, duration, result_size;
+    int arg_count;
+    if (!varint::read(file, delta) || !varint::read(file, duration) || !varint::read(file, result_size) ||
+        (arg_count = std::fgetc(file)) == EOF) {
+      break;
+    }
+
+    bool complete = true;
+    for (int i = 0; i < arg_count && complete; ++i) {
+      Arg arg{false, 0, ""};
+      int tag = std::fgetc(file);
+      uint64_t value;
+      if (tag == EOF || !varint::read(file, value)) {
+        complete = false;
+      }
+      else if (tag == TAG_TEXT) {
+        arg.is_text = true;
+        arg.text.resize(value);
+        complete = std::fread(&arg.text[0], 1, value, file) == value;
+      }
+      else {
+        arg.number = varint::unzigzag(value);
+      }
+      entry.args.push_back(std::move(arg));
+    }
+    if (!complete) {
+      break;
+    }
+
+    clock += static_cast<int64_t>(delta);
+    if (first < 0) {
+      first = clock;
+    }
+    entry.op = static_cast<Op>(op);
+    entry.offset_us = clock - first;
+    entry.duration_us = static_cast<uint32_t>(duration);
+    entry.result_size = static_cast<uint32_t>(result_size);
+    entries.push_back(std::move(entry));
+  }
+
+  std::fclose(file);
+  return true;
+}
+
+/**
+ * @brief Returns the Pond method name for an op, for reports.
+ */
+const char* Recorder::opName(Op op) {
+  switch (op) {
+    case Op::AddUser:         return "addUser";
+    case Op::AddHashtag:      return "addHashtag";
+    case Op::ValidateQuack:   return "validateQuack";
+    case Op::AddQuack:        return "addQuack";
+    case Op::AddReply:        return "addReply";
+    case Op::AddRequack:      return "addRequack";
+    case Op::AddToList:       return "addToList";
+    case Op::CreateList:      return "createList";
+    case Op::CheckLogin:      return "checkLogin";
+    case Op::Follow:          return "follow";
+    case Op::Unfollow:        return "unfollow";
+    case Op::SearchForUsers:  return "searchForUsers";
+    case Op::SearchForQuacks: return "searchForQuacks";
+    case Op::GetFeed:         return "getFeed";
+    case Op::GetRequackCount: return "getRequackCount";
+    case Op::GetReplies:      return "getReplies";
+    case Op::GetUsername:     return "getUsername";
+    case Op::GetQuackFromID:  return "getQuackFromID";
+    case Op::GetFollowers:    return "getFollowers";
+    case Op::GetFollows:      return "getFollows";
+    case Op::GetQuacks:       return "getQuacks";
+    case Op::SearchQuackViews: return "searchQuackViews";
+    case Op::GetQuackViews:   return "getQuackViews";
+    case Op::GetQuackViewFromID: return "getQuackViewFromID";
+    case Op::SuggestFollows:  return "suggestFollows";
+    case Op::PrecomputeSuggestions: return "precomputeSuggestions";
+    case Op::FollowDistance:  return "followDistance";
+    case Op::RankUsers:       return "rankUsers";
+    case Op::TrendingHashtags: return "trendingHashtags";
+    case Op::HashtagSeries:   return "hashtagSeries";
+    case Op::TopHashtags:     return "topHashtags";
+    case Op::BackfillHashtagRollups: return "backfillHashtagRollups";
+    case Op::SearchHashtags:  return "searchHashtags";
+    case Op::SearchRanked:    return "searchRanked";
+    case Op::OpenQuackSearch: return "openQuackSearch";
+    case Op::OpenUserSearch:  return "openUserSearch";
+    case Op::CountQuackMatches: return "countQuackMatches";
+    case Op::CountUserMatches: return "countUserMatches";
+    case Op::CompleteHashtag: return "completeHashtag";
+    case Op::CompleteUsername: return "completeUsername";
+    case Op::SearchForUsersWithin: return "searchForUsersWithin";
+    case Op::SearchForQuacksWithin: return "searchForQuacksWithin";
+    case Op::SearchQuackViewsWithin: return "searchQuackViewsWithin";
+    case Op::GetFeedWithin: return "getFeedWithin";
+    case Op::GetThread: return "getThread";
+    case Op::GetLists: return "getLists";
+    case Op::GetListQuacks: return "getListQuacks";
+    case Op::AddRequacks: return "addRequacks";
+    case Op::FindNearDuplicates: return "findNearDuplicates";
+    case Op::DuplicateReport: return "duplicateReport";
+  }
+  return "unknown";
+}
+
+// =============================================================================
+// Private Methods
+// =============================================================================
+
+int64_t Recorder::_wallMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Encodes one record and appends it to the log.
+ *
+ * Timestamps are stored as the delta from the previous record, which keeps them to one
+ * or two bytes for busy sessions; the first record of a log carries the absolute time.
+ */
+void Recorder::_write(Op op, int64_t started_at, uint32_t duration_us, uint32_t result_size,
+                      uint8_t arg_count, const std::string& args) {
+  if (!_file) {
+    return;
+  }
+
+  int64_t delta = started_at - _last_started_at;
+  if (delta < 0) {
+    delta = 0;  // wall clock stepped backwards; keep the log monotonic
+  }
+  _last_started_at += delta;
+
+  std::string record;
+  record.push_back(static_cast<char>(op));
+  varint::put(record, static_cast<uint64_t>(delta));
+  varint::put(record, duration_us);
+  varint::put(record, result_size);
+  record.push_back(static_cast<char>(arg_count));
+  record.append(args);
+
+  std::fwrite(record.data(), 1, record.size(), _file);
+}
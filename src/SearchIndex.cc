@@ -0,0 +1,334 @@
+#include "SearchIndex.hh"
+#include "Varint.hh"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// BM25 term frequency saturation and length normalization
+const double K1 = 1.2;
+const double B = 0.75;
+
+// A quack posted now scores up to (1 + RECENCY_WEIGHT) times one posted long ago; the
+// boost halves every RECENCY_HALF_LIFE_US
+const double RECENCY_WEIGHT = 1.0;
+const double RECENCY_HALF_LIFE_US = 7 * 24 * 3600 * 1e6;
+
+
+double recency(int64_t ts, int64_t now) {
+  const double age = static_cast<double>(std::max<int64_t>(0, now - ts));
+  return 1.0 + RECENCY_WEIGHT * std::exp2(-age / RECENCY_HALF_LIFE_US);
+}
+
+using Hit = SearchIndex::Hit;
+
+/**
+ * @brief Orders hits best first: highest score, then newest ID.
+ */
+bool better(const Hit& a, const Hit& b) {
+  return a.score != b.score ? a.score > b.score : a.tid > b.tid;
+}
+
+} // namespace
+
+// =============================================================================
+// Public Methods
+// =============================================================================
+
+/**
+ * @brief Splits text into the lower-cased words the index is built from.
+ *
+ * Words are runs of ASCII letters and digits and of non-ASCII bytes, so punctuation
+ * and the '#' of a hashtag separate words and UTF-8 text stays whole.
+ */
+void SearchIndex::tokenize(const std::string& text, std::vector<std::string>& out) {
+  std::string word;
+  for (char c : text) {
+    if (c >= 'A' && c <= 'Z') {
+      word.push_back(static_cast<char>(c - 'A' + 'a'));
+    } else if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || static_cast<unsigned char>(c) >= 0x80) {
+      word.push_back(c);
+    } else if (!word.empty()) {
+      out.push_back(std::move(word));
+      word.clear();
+    }
+  }
+  if (!word.empty()) {
+    out.push_back(std::move(word));
+  }
+}
+
+/**
+ * @brief Indexes a quack; indexing the same ID again changes nothing.
+ *
+ * New quacks take the next ID, so their postings are appended. An older quack is
+ * spliced into each of its words' lists by decoding and re-encoding the list.
+ * Negative IDs are not indexed.
+ *
+ * @param ts The quack's timestamp, in microseconds since the Unix epoch.
+ * @return true if the quack was new to the index.
+ */
+bool SearchIndex::add(int32_t tid, int64_t ts, const std::string& text) {
+  if (tid < 0) {
+    return false;
+  }
+  if (static_cast<size_t>(tid) >= this->_documents.size()) {
+    this->_documents.resize(static_cast<size_t>(tid) + 1);
+  }
+  if (this->_documents[tid].indexed) {
+    return false;
+  }
+
+  std::vector<std::string> words;
+  tokenize(text, words);
+  this->_documents[tid] = Document{ts, static_cast<uint32_t>(words.size()), true};
+  ++this->_document_count;
+  this->_total_length += words.size();
+  this->_last_tid = std::max(this->_last_tid, tid);
+
+  std::sort(words.begin(), words.end());
+  for (size_t i = 0; i < words.size(); ) {
+    size_t run = i + 1;
+    while (run < words.size() && words[run] == words[i]) {
+      ++run;
+    }
+    const uint32_t tf = static_cast<uint32_t>(run - i);
+    Postings& postings = this->_postings[words[i]];
+    if (postings.size() == 0 || tid > postings.last()) {
+      postings.append(tid, tf, this->_documents[tid]);
+    } else {
+      std::vector<Entry> entries;
+      postings.decode(entries);
+      auto position = std::lower_bound(entries.begin(), entries.end(), tid,
+                                       [](const Entry& entry, int32_t id) { return entry.tid < id; });
+      entries.insert(position, Entry{tid, tf});
+      postings.clear();
+      for (const Entry& entry : entries) {
+        postings.append(entry.tid, entry.tf, this->_documents[entry.tid]);
+      }
+    }
+    i = run;
+  }
+  return true;
+}
+
+/**
+ * @brief Returns the best matches for any of the words in `query`.
+ *
+ * A match scores the sum of BM25 weights of the query words it uses, times its recency
+ * boost. The words' posting lists are walked together from the largest ID down, one
+ * block at a time, and the best `k` matches are kept in a heap whose front is the worst.
+ * Once the heap is full, each step first bounds the score of every quack at or above
+ * the highest block start among the lists by the blocks' largest term frequency,
+ * shortest length and newest timestamp. If that cannot beat the heap's front, the whole
+ * stretch is skipped, and blocks that lie entirely inside it are never decoded.
+ *
+ * @param k The number of matches to return.
+ * @param now Microseconds since the Unix epoch that recency is measured from.
+ * @param after When set, only matches ranked below this cursor are considered, and
+ *              its `now` is used in place of `now`.
+ * @return Up to `k` matches, highest score first, then newest ID.
+ */
+std::vector<Hit> SearchIndex::search(const std::string& query, size_t k, int64_t now, const Cursor* after) const {
+  // One query word's posting list, walked from its last block down
+  struct Walk {
+    const Postings* postings;
+    double idf;
+    ptrdiff_t block;              // -1 once the list is exhausted
+    std::vector<Entry> entries;   // the current block, once decoded
+    ptrdiff_t position;           // the next entry of `entries` to visit
+    bool decoded;
+  };
+
+  std::vector<Hit> heap;
+  if (k == 0 || this->_document_count == 0) {
+    return heap;
+  }
+  if (after) {
+    now = after->now;
+  }
+
+  std::vector<std::string> words;
+  tokenize(query, words);
+  std::sort(words.begin(), words.end());
+  words.erase(std::unique(words.begin(), words.end()), words.end());
+
+  const double documents = static_cast<double>(this->_document_count);
+  std::vector<Walk> walks;
+  for (const std::string& word : words) {
+    auto postings = this->_postings.find(word);
+    if (postings == this->_postings.end() || postings->second.size() == 0) {
+      continue;
+    }
+    const double n = static_cast<double>(postings->second.size());
+    const double idf = std::log(1.0 + (documents - n + 0.5) / (n + 0.5));
+    walks.push_back(Walk{&postings->second, idf,
+                         static_cast<ptrdiff_t>(postings->second.blocks().size()) - 1, {}, -1, false});
+  }
+
+  const double average_length = std::max(1.0, static_cast<double>(this->_total_length) / documents);
+  auto weight = [average_length](uint32_t tf, uint32_t length) {
+    return tf * (K1 + 1.0) / (tf + K1 * (1.0 - B + B * length / average_length));
+  };
+  auto decode = [](Walk& walk) {
+    walk.entries.clear();
+    walk.postings->decodeBlock(static_cast<size_t>(walk.block), walk.entries);
+    walk.position = static_cast<ptrdiff_t>(walk.entries.size()) - 1;
+    walk.decoded = true;
+  };
+  // Moves a walk past its current entry, into the block below once the block is done
+  auto step = [](Walk& walk) {
+    if (--walk.position < 0) {
+      --walk.block;
+      walk.decoded = false;
+    }
+  };
+  // The largest ID a walk has left: exact once decoded, else below the next block's start
+  auto highest = [](const Walk& walk) {
+    if (walk.decoded) {
+      return walk.entries[walk.position].tid;
+    }
+    const std::vector<Postings::Block>& blocks = walk.postings->blocks();
+    return static_cast<size_t>(walk.block) + 1 < blocks.size() ? blocks[walk.block + 1].first - 1
+                                                                : walk.postings->last();
+  };
+
+  while (true) {
+    walks.erase(std::remove_if(walks.begin(), walks.end(), [](const Walk& walk) { return walk.block < 0; }),
+                walks.end());
+    if (walks.empty()) {
+      break;
+    }
+
+    if (heap.size() == k) {
+      int32_t floor = INT32_MIN;
+      for (const Walk& walk : walks) {
+        floor = std::max(floor, walk.postings->blocks()[walk.block].first);
+      }
+      double bound = 0.0;
+      for (const Walk& walk : walks) {
+        if (highest(walk) >= floor) {
+          const Postings::Block& block = walk.postings->blocks()[walk.block];
+          bound += walk.idf * weight(block.max_tf, block.min_length) * recency(block.max_ts, now);
+        }
+      }
+      if (bound < heap.front().score) {
+        // Nothing at or above `floor` can make the heap; drop it from every walk
+        for (Walk& walk : walks) {
+          if (walk.postings->blocks()[walk.block].first == floor) {
+            --walk.block;
+            walk.decoded = false;
+            continue;
+          }
+          if (highest(walk) < floor) {
+            continue;
+          }
+          if (!walk.decoded) {
+            decode(walk);
+          }
+          while (walk.block >= 0 && walk.decoded && walk.entries[walk.position].tid >= floor) {
+            step(walk);
+          }
+        }
+        continue;
+      }
+    }
+
+    int32_t tid = INT32_MIN;
+    for (Walk& walk : walks) {
+      if (!walk.decoded) {
+        decode(walk);
+      }
+      tid = std::max(tid, walk.entries[walk.position].tid);
+    }
+
+    const Document& document = this->_documents[tid];
+    double score = 0.0;
+    for (Walk& walk : walks) {
+      if (walk.entries[walk.position].tid == tid) {
+        score += walk.idf * weight(walk.entries[walk.position].tf, document.length);
+        step(walk);
+      }
+    }
+    const Hit hit{tid, score * recency(document.ts, now)};
+    if (after && !better(Hit{after->tid, after->score}, hit)) {
+      continue;
+    }
+    if (heap.size() < k) {
+      heap.push_back(hit);
+      std::push_heap(heap.begin(), heap.end(), better);
+    } else if (better(hit, heap.front())) {
+      std::pop_heap(heap.begin(), heap.end(), better);
+      heap.back() = hit;
+      std::push_heap(heap.begin(), heap.end(), better);
+    }
+  }
+
+  std::sort_heap(heap.begin(), heap.end(), better);
+  return heap;
+}
+
+/**
+ * @brief Forgets every quack.
+ */
+void SearchIndex::clear() {
+  this->_postings.clear();
+  this->_documents.clear();
+  this->_document_count = 0;
+  this->_total_length = 0;
+  this->_last_tid = INT32_MIN;
+}
+
+// =============================================================================
+// Private Methods
+// =============================================================================
+
+/**
+ * @brief Appends a posting for an ID larger than any in the list, starting a new block
+ *        every 128 postings and widening the current block's bounds.
+ */
+void SearchIndex::Postings::append(int32_t tid, uint32_t tf, const Document& document) {
+  if (this->_size % BLOCK == 0) {
+    this->_blocks.push_back(Block{tid, static_cast<uint32_t>(this->_data.size()), tf, document.length, document.ts});
+  } else {
+    varint::put(this->_data, static_cast<uint32_t>(tid) - static_cast<uint32_t>(this->_last));
+    Block& block = this->_blocks.back();
+    block.max_tf = std::max(block.max_tf, tf);
+    block.min_length = std::min(block.min_length, document.length);
+    block.max_ts = std::max(block.max_ts, document.ts);
+  }
+  varint::put(this->_data, tf);
+  this->_last = tid;
+  ++this->_size;
+}
+
+/**
+ * @brief Appends the postings of one block, ascending.
+ */
+void SearchIndex::Postings::decodeBlock(size_t block, std::vector<Entry>& out) const {
+  const size_t count = std::min(BLOCK, this->_size - block * BLOCK);
+  const uint8_t* cursor = this->_data.data() + this->_blocks[block].offset;
+  int32_t tid = this->_blocks[block].first;
+  out.push_back(Entry{tid, varint::get(cursor)});
+  for (size_t i = 1; i < count; ++i) {
+    tid = static_cast<int32_t>(static_cast<uint32_t>(tid) + varint::get(cursor));
+    out.push_back(Entry{tid, varint::get(cursor)});
+  }
+}
+
+/**
+ * @brief Appends every posting, ascending.
+ */
+void SearchIndex::Postings::decode(std::vector<Entry>& out) const {
+  out.reserve(out.size() + this->_size);
+  for (size_t block = 0; block < this->_blocks.size(); ++block) {
+    this->decodeBlock(block, out);
+  }
+}
+
+void SearchIndex::Postings::clear() {
+  this->_blocks.clear();
+  this->_data.clear();
+  this->_size = 0;
+}
@@ -0,0 +1,290 @@
+#include "SimHashIndex.hh"
+#include "SearchIndex.hh"
+#include "ThreadPool.hh"
+
+#include <algorithm>
+
+namespace {
+
+/**
+ * @brief Hashes a word to 64 well-mixed bits: FNV-1a followed by the MurmurHash3
+ *        finalizer, so every bit of the result depends on every byte.
+ */
+uint64_t hashWord(const std::string& word) {
+  uint64_t hash = 1469598103934665603ULL;
+  for (unsigned char c : word) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ULL;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+/**
+ * @brief Returns every band mask with at most `PROBE_BITS` bits set, the empty one
+ *        first, so a band value XORed with each gives the values a lookup probes.
+ */
+const std::vector<uint16_t>& probeMasks() {
+  static_assert(SimHashIndex::BAND_BITS == 16, "bands are stored as 16-bit values");
+  static const std::vector<uint16_t> masks = [] {
+    std::vector<uint16_t> masks;
+    for (uint32_t mask = 0; mask < 1u << SimHashIndex::BAND_BITS; ++mask) {
+      if (__builtin_popcount(mask) <= SimHashIndex::PROBE_BITS) {
+        masks.push_back(static_cast<uint16_t>(mask));
+      }
+    }
+    return masks;
+  }();
+  return masks;
+}
+
+} // namespace
+
+// =============================================================================
+// Public Methods
+// =============================================================================
+
+/**
+ * @brief Computes the SimHash fingerprint of a quack's text.
+ *
+ * Every word adds one to the counters of the bits set in its hash and takes one from
+ * the others; the fingerprint keeps the bits whose counter ended up positive. Text
+ * without words fingerprints as 0.
+ */
+uint64_t SimHashIndex::fingerprint(const std::string& text) {
+  static const std::string NUMBER = "0";
+
+  std::vector<std::string> words;
+  SearchIndex::tokenize(text, words);
+  int32_t counters[64] = {};
+  for (const std::string& word : words) {
+    const bool number = std::any_of(word.begin(), word.end(), [](char c) { return c >= '0' && c <= '9'; });
+    const uint64_t hash = hashWord(number ? NUMBER : word);
+    for (int bit = 0; bit < 64; ++bit) {
+      counters[bit] += (hash >> bit & 1) ? 1 : -1;
+    }
+  }
+
+  uint64_t fingerprint = 0;
+  for (int bit = 0; bit < 64; ++bit) {
+    if (counters[bit] > 0) {
+      fingerprint |= 1ULL << bit;
+    }
+  }
+  return fingerprint;
+}
+
+/**
+ * @brief Indexes a quack; indexing the same ID again changes nothing.
+ *
+ * @return true if the quack was new to the index.
+ */
+bool SimHashIndex::add(int32_t tid, uint64_t fingerprint) {
+  if (!this->_fingerprints.emplace(tid, fingerprint).second) {
+    return false;
+  }
+  this->_last_tid = std::max(this->_last_tid, tid);
+
+  std::vector<int32_t>& tids = this->_quacks[fingerprint];
+  if (tids.empty()) {
+    for (int band = 0; band < BANDS; ++band) {
+      this->_buckets[band].resize(size_t{1} << BAND_BITS);
+      this->_buckets[band][_band(fingerprint, band)].push_back(fingerprint);
+    }
+  }
+  // New quacks take the next ID, so this almost always appends
+  tids.insert(std::upper_bound(tids.begin(), tids.end(), tid), tid);
+  return true;
+}
+
+bool SimHashIndex::fingerprintOf(int32_t tid, uint64_t& fingerprint) const {
+  auto found = this->_fingerprints.find(tid);
+  if (found == this->_fingerprints.end()) {
+    return false;
+  }
+  fingerprint = found->second;
+  return true;
+}
+
+/**
+ * @brief Appends the quacks within `max_distance` bits of `fingerprint`, nearest
+ *        first and newest first among equals.
+ *
+ * Each of the query's bands probes the buckets of every value within `PROBE_BITS` bits
+ * of it; a candidate is only compared at the first band it is probed in, so none is
+ * counted twice.
+ *
+ * @param max_distance Clamped to `MAX_DISTANCE`.
+ * @param limit The most matches to append.
+ */
+void SimHashIndex::near(uint64_t fingerprint, int max_distance, size_t limit, std::vector<Match>& out) const {
+  max_distance = std::min(max_distance, MAX_DISTANCE);
+  std::vector<std::pair<int, uint64_t>> found;  // (distance, fingerprint)
+  for (int band = 0; band < BANDS; ++band) {
+    if (this->_buckets[band].empty()) {
+      break;
+    }
+    const uint16_t value = _band(fingerprint, band);
+    for (uint16_t mask : probeMasks()) {
+      for (uint64_t candidate : this->_buckets[band][value ^ mask]) {
+        if (_probedEarlierBand(fingerprint, candidate, band)) {
+          continue;
+        }
+        const int d = distance(fingerprint, candidate);
+        if (d <= max_distance) {
+          found.emplace_back(d, candidate);
+        }
+      }
+    }
+  }
+  std::sort(found.begin(), found.end());
+
+  for (const auto& [d, candidate] : found) {
+    const std::vector<int32_t>& tids = this->_quacks.at(candidate);
+    for (auto tid = tids.rbegin(); tid != tids.rend(); ++tid) {
+      if (limit == 0) {
+        return;
+      }
+      out.push_back(Match{*tid, d});
+      --limit;
+    }
+  }
+}
+
+/**
+ * @brief Groups every indexed quack with its near copies, comparing buckets on `pool`.
+ *
+ * Every non-empty bucket is one task, comparing its fingerprints pairwise and against
+ * the buckets of the larger band values within `PROBE_BITS` bits of its own, on distinct
+ * fingerprints only, so identical copies cost nothing beyond sharing a group. A pair is
+ * only compared in the first band whose values are within `PROBE_BITS` bits, so every
+ * pair is checked once. The links found are then joined into groups with a union-find.
+ *
+ * @param max_distance Clamped to `MAX_DISTANCE`.
+ * @return The groups of two or more quacks, largest first, each in ascending ID order.
+ */
+std::vector<std::vector<int32_t>> SimHashIndex::clusters(int max_distance, ThreadPool& pool) const {
+  max_distance = std::min(max_distance, MAX_DISTANCE);
+
+  std::vector<uint64_t> fingerprints;
+  fingerprints.reserve(this->_quacks.size());
+  std::unordered_map<uint64_t, uint32_t> index;
+  index.reserve(this->_quacks.size());
+  for (const auto& entry : this->_quacks) {
+    index.emplace(entry.first, static_cast<uint32_t>(fingerprints.size()));
+    fingerprints.push_back(entry.first);
+  }
+
+  std::vector<std::pair<int, uint16_t>> tasks;  // (band, value) of every bucket
+  for (int band = 0; band < BANDS; ++band) {
+    for (size_t value = 0; value < this->_buckets[band].size(); ++value) {
+      if (!this->_buckets[band][value].empty()) {
+        tasks.emplace_back(band, static_cast<uint16_t>(value));
+      }
+    }
+  }
+
+  std::vector<std::vector<std::pair<uint32_t, uint32_t>>> links(tasks.size());
+  pool.parallelFor(tasks.size(), 1, [&](size_t begin, size_t end) {
+    for (size_t task = begin; task < end; ++task) {
+      const int band = tasks[task].first;
+      const uint16_t value = tasks[task].second;
+      const std::vector<uint64_t>& bucket = this->_buckets[band][value];
+      auto link = [&](uint64_t a, uint64_t b) {
+        if (distance(a, b) <= max_distance && !_probedEarlierBand(a, b, band)) {
+          links[task].emplace_back(index.at(a), index.at(b));
+        }
+      };
+
+      for (size_t i = 0; i < bucket.size(); ++i) {
+        for (size_t j = i + 1; j < bucket.size(); ++j) {
+          link(bucket[i], bucket[j]);
+        }
+      }
+      // Pairs across two buckets are compared from the smaller value's bucket
+      for (uint16_t mask : probeMasks()) {
+        const uint16_t other = static_cast<uint16_t>(value ^ mask);
+        if (other <= value) {
+          continue;
+        }
+        for (uint64_t a : bucket) {
+          for (uint64_t b : this->_buckets[band][other]) {
+            link(a, b);
+          }
+        }
+      }
+    }
+  });
+
+  std::vector<uint32_t> parent(fingerprints.size());
+  for (uint32_t i = 0; i < parent.size(); ++i) {
+    parent[i] = i;
+  }
+  auto root = [&parent](uint32_t i) {
+    while (parent[i] != i) {
+      parent[i] = parent[parent[i]];
+      i = parent[i];
+    }
+    return i;
+  };
+  for (const auto& task : links) {
+    for (const auto& [a, b] : task) {
+      const uint32_t ra = root(a);
+      const uint32_t rb = root(b);
+      if (ra != rb) {
+        parent[std::max(ra, rb)] = std::min(ra, rb);
+      }
+    }
+  }
+
+  std::unordered_map<uint32_t, std::vector<int32_t>> by_root;
+  for (uint32_t i = 0; i < fingerprints.size(); ++i) {
+    const std::vector<int32_t>& tids = this->_quacks.at(fingerprints[i]);
+    std::vector<int32_t>& group = by_root[root(i)];
+    group.insert(group.end(), tids.begin(), tids.end());
+  }
+  std::vector<std::vector<int32_t>> groups;
+  for (auto& entry : by_root) {
+    if (entry.second.size() > 1) {
+      std::sort(entry.second.begin(), entry.second.end());
+      groups.push_back(std::move(entry.second));
+    }
+  }
+  std::sort(groups.begin(), groups.end(), [](const std::vector<int32_t>& a, const std::vector<int32_t>& b) {
+    return a.size() != b.size() ? a.size() > b.size() : a.front() < b.front();
+  });
+  return groups;
+}
+
+/**
+ * @brief Forgets every quack.
+ */
+void SimHashIndex::clear() {
+  this->_fingerprints.clear();
+  this->_quacks.clear();
+  for (auto& buckets : this->_buckets) {
+    buckets.clear();
+  }
+  this->_last_tid = INT32_MIN;
+}
+
+// =============================================================================
+// Private Methods
+// =============================================================================
+
+/**
+ * @brief Returns true if `a` and `b` are within `PROBE_BITS` bits on a band before
+ *        `band`, i.e. a banded scan already compared them at an earlier band.
+ */
+bool SimHashIndex::_probedEarlierBand(uint64_t a, uint64_t b, int band) {
+  for (int earlier = 0; earlier < band; ++earlier) {
+    if (__builtin_popcount(_band(a, earlier) ^ _band(b, earlier)) <= PROBE_BITS) {
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,197 @@
+#include "SpamDetector.hh"
+
+namespace {
+
+const int64_t MINUTE_US = 60 * 1000000LL;
+
+uint32_t minuteOf(int64_t ts) {
+  return static_cast<uint32_t>(ts / MINUTE_US);
+}
+
+/**
+ * @brief Fibonacci hashing: spreads consecutive user IDs across the table.
+ */
+size_t homeSlot(int32_t user_id, unsigned shift) {
+  return static_cast<size_t>((static_cast<uint64_t>(static_cast<uint32_t>(user_id)) * 0x9E3779B97F4A7C15ULL) >> shift);
+}
+
+} // namespace
+
+// =============================================================================
+// Public Methods
+// =============================================================================
+
+SpamDetector::SpamDetector(size_t capacity) {
+  size_t slots = PROBES;
+  unsigned bits = 3;
+  while (slots < capacity) {
+    slots <<= 1;
+    ++bits;
+  }
+  this->_slots = std::make_unique<Slot[]>(slots);
+  this->_mask = slots - 1;
+  this->_shift = 64 - bits;
+  this->clear();
+  this->setLimits(Limits());
+}
+
+/**
+ * @brief Counts one write by `user_id` at `ts`.
+ *
+ * The kind's counter is bumped with a compare-and-swap that also rolls it over to a
+ * new minute, carrying the old count into the previous-minute counter when the minutes
+ * are adjacent. Writes stamped just before the counter's minute, from a thread that
+ * took its timestamp earlier, count towards the newer minute.
+ *
+ * @param ts Microseconds since the Unix epoch, as in `Clock::Stamp::ts`.
+ * @return true if the user is now over the limit for any kind of write.
+ */
+bool SpamDetector::record(int32_t user_id, Write write, int64_t ts) {
+  const uint32_t minute = minuteOf(ts);
+  Slot* slot = this->_claim(user_id, minute);
+  if (!slot) {
+    return false;
+  }
+
+  const size_t kind = static_cast<size_t>(write);
+  std::atomic<uint64_t>& current = slot->current[kind];
+  uint64_t word = current.load(std::memory_order_relaxed);
+  uint64_t next;
+  do {
+    const uint32_t at = static_cast<uint32_t>(word >> 32);
+    next = at >= minute ? word + 1 : (static_cast<uint64_t>(minute) << 32 | 1);
+  } while (!current.compare_exchange_weak(word, next, std::memory_order_relaxed));
+
+  const uint32_t at = static_cast<uint32_t>(word >> 32);
+  if (at < minute) {
+    slot->previous[kind].store(at + 1 == minute ? static_cast<uint32_t>(word) : 0, std::memory_order_relaxed);
+  }
+  return this->_over(*slot, ts);
+}
+
+/**
+ * @brief Returns true if `user_id` is over the limit for any kind of write at `ts`,
+ *        without counting a write.
+ */
+bool SpamDetector::flagged(int32_t user_id, int64_t ts) const {
+  const Slot* slot = this->_find(user_id);
+  return slot && this->_over(*slot, ts);
+}
+
+SpamDetector::Limits SpamDetector::limits() const {
+  Limits limits;
+  limits.quacks = this->_limits[static_cast<size_t>(Write::Quack)].load(std::memory_order_relaxed);
+  limits.requacks = this->_limits[static_cast<size_t>(Write::Requack)].load(std::memory_order_relaxed);
+  limits.follows = this->_limits[static_cast<size_t>(Write::Follow)].load(std::memory_order_relaxed);
+  return limits;
+}
+
+void SpamDetector::setLimits(const Limits& limits) {
+  this->_limits[static_cast<size_t>(Write::Quack)].store(limits.quacks, std::memory_order_relaxed);
+  this->_limits[static_cast<size_t>(Write::Requack)].store(limits.requacks, std::memory_order_relaxed);
+  this->_limits[static_cast<size_t>(Write::Follow)].store(limits.follows, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Forgets every user. Not safe while other threads record writes.
+ */
+void SpamDetector::clear() {
+  for (size_t i = 0; i <= this->_mask; ++i) {
+    Slot& slot = this->_slots[i];
+    slot.user.store(EMPTY, std::memory_order_relaxed);
+    for (size_t kind = 0; kind < KINDS; ++kind) {
+      slot.current[kind].store(0, std::memory_order_relaxed);
+      slot.previous[kind].store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+// =============================================================================
+// Private Methods
+// =============================================================================
+
+/**
+ * @brief Returns the slot holding `user_id`, or nullptr if the user is not tracked.
+ */
+const SpamDetector::Slot* SpamDetector::_find(int32_t user_id) const {
+  const size_t home = homeSlot(user_id, this->_shift);
+  for (size_t probe = 0; probe < PROBES; ++probe) {
+    const Slot& slot = this->_slots[(home + probe) & this->_mask];
+    const int32_t user = slot.user.load(std::memory_order_acquire);
+    if (user == user_id) {
+      return &slot;
+    }
+    if (user == EMPTY) {
+      return nullptr;
+    }
+  }
+  return nullptr;
+}
+
+/**
+ * @brief Returns the slot holding `user_id`, taking an empty slot or one idle for two
+ *        minutes if the user has none; nullptr if every nearby slot is in use.
+ *
+ * An idle slot is taken over without resetting its counters: they are all from before
+ * the previous minute, so they read as zero and roll over on the next write.
+ */
+SpamDetector::Slot* SpamDetector::_claim(int32_t user_id, uint32_t minute) {
+  const size_t home = homeSlot(user_id, this->_shift);
+  for (size_t probe = 0; probe < PROBES; ++probe) {
+    Slot& slot = this->_slots[(home + probe) & this->_mask];
+    int32_t user = slot.user.load(std::memory_order_acquire);
+    if (user == user_id) {
+      return &slot;
+    }
+    if (user == EMPTY) {
+      // Users fill a probe run in order, so the user has no slot further along it
+      if (slot.user.compare_exchange_strong(user, user_id, std::memory_order_acq_rel) || user == user_id) {
+        return &slot;
+      }
+    }
+  }
+  for (size_t probe = 0; probe < PROBES; ++probe) {
+    Slot& slot = this->_slots[(home + probe) & this->_mask];
+    bool idle = true;
+    for (size_t kind = 0; kind < KINDS && idle; ++kind) {
+      idle = (slot.current[kind].load(std::memory_order_relaxed) >> 32) + 1 < minute;
+    }
+    int32_t user = slot.user.load(std::memory_order_acquire);
+    if (idle && (slot.user.compare_exchange_strong(user, user_id, std::memory_order_acq_rel) || user == user_id)) {
+      return &slot;
+    }
+  }
+  return nullptr;
+}
+
+/**
+ * @brief Estimates the writes of one kind over the sixty seconds before `ts`.
+ */
+uint32_t SpamDetector::_rate(const Slot& slot, size_t kind, int64_t ts) const {
+  const uint64_t word = slot.current[kind].load(std::memory_order_relaxed);
+  const uint32_t at = static_cast<uint32_t>(word >> 32);
+  const uint32_t count = static_cast<uint32_t>(word);
+  const uint32_t minute = minuteOf(ts);
+  const int64_t left = MINUTE_US - ts % MINUTE_US;  // how much of the minute before is still in the window
+
+  if (at >= minute) {
+    const uint32_t previous = slot.previous[kind].load(std::memory_order_relaxed);
+    return count + static_cast<uint32_t>(previous * left / MINUTE_US);
+  }
+  if (at + 1 == minute) {
+    return static_cast<uint32_t>(count * left / MINUTE_US);
+  }
+  return 0;
+}
+
+/**
+ * @brief Returns true if any of the slot's rates exceeds its limit.
+ */
+bool SpamDetector::_over(const Slot& slot, int64_t ts) const {
+  for (size_t kind = 0; kind < KINDS; ++kind) {
+    if (this->_rate(slot, kind, ts) > this->_limits[kind].load(std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+  return false;
+}
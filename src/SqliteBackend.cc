@@ -0,0 +1,1374 @@
+#include "SqliteBackend.hh"
+#include "SimHashIndex.hh"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <system_error>
+
+namespace {
+
+/**
+ * Schema migrations, applied in order by `loadDatabase`. `PRAGMA user_version` records how
+ * many have already run, so each script executes exactly once per database file.
+ * `schema.sql` creates the latest schema directly and sets `user_version` to match.
+ */
+const char* const MIGRATIONS[] = {
+  // 1: single integer microsecond timestamp per tweet and retweet, indexed for feeds
+  "ALTER TABLE tweets ADD COLUMN ts INTEGER;"
+  "UPDATE tweets SET ts = COALESCE(CAST(strftime('%s', tdate || ' ' || ttime) AS INTEGER), "
+  "                                CAST(strftime('%s', tdate) AS INTEGER), 0) * 1000000;"
+  "ALTER TABLE retweets ADD COLUMN ts INTEGER;"
+  "UPDATE retweets SET ts = COALESCE("
+  "  (SELECT CAST(strftime('%s', retweets.rdate || ' ' || t.ttime) AS INTEGER) FROM tweets t WHERE t.tid = retweets.tid),"
+  "  CAST(strftime('%s', rdate) AS INTEGER), 0) * 1000000;"
+  "CREATE INDEX IF NOT EXISTS tweets_writer_ts ON tweets (writer_id, ts DESC, tid DESC);"
+  "CREATE INDEX IF NOT EXISTS tweets_ts ON tweets (ts DESC, tid DESC);"
+  "CREATE INDEX IF NOT EXISTS retweets_retweeter_ts ON retweets (retweeter_id, ts DESC, tid DESC, spam);",
+
+  // 2: follow counter, so connections holding a FollowGraph notice each other's follows
+  "CREATE TABLE IF NOT EXISTS follows_version (id INTEGER PRIMARY KEY CHECK (id = 0), version INTEGER NOT NULL);"
+  "INSERT OR IGNORE INTO follows_version (id, version) VALUES (0, 0);"
+  "CREATE TRIGGER IF NOT EXISTS follows_inserted AFTER INSERT ON follows "
+  "BEGIN UPDATE follows_version SET version = version + 1; END;"
+  "CREATE TRIGGER IF NOT EXISTS follows_deleted AFTER DELETE ON follows "
+  "BEGIN UPDATE follows_version SET version = version + 1; END;"
+  "CREATE TRIGGER IF NOT EXISTS follows_updated AFTER UPDATE OF flwer, flwee ON follows "
+  "BEGIN UPDATE follows_version SET version = version + 2; END;",
+
+  // 3: influence scores from the PageRank batch job, for ranking user search results
+  "CREATE TABLE IF NOT EXISTS user_rank (usr INTEGER PRIMARY KEY, score REAL NOT NULL, "
+  "FOREIGN KEY (usr) REFERENCES users(usr) ON DELETE CASCADE);",
+
+  // 4: hourly hashtag rollups, kept current by triggers on both sides of the quack/hashtag
+  // join (hashtags are inserted before their quack) and backfilled from history
+  "CREATE TABLE IF NOT EXISTS hashtag_hourly (term TEXT NOT NULL, hour INTEGER NOT NULL, "
+  "mentions INTEGER NOT NULL, PRIMARY KEY (term, hour)) WITHOUT ROWID;"
+  "CREATE INDEX IF NOT EXISTS hashtag_hourly_hour ON hashtag_hourly (hour, term, mentions);"
+  "CREATE TRIGGER IF NOT EXISTS hashtag_mention_rollup AFTER INSERT ON hashtag_mentions "
+  "BEGIN INSERT INTO hashtag_hourly (term, hour, mentions) "
+  "SELECT LOWER(NEW.term), t.ts / 3600000000, 1 FROM tweets t WHERE t.tid = NEW.tid AND t.ts IS NOT NULL "
+  "ON CONFLICT (term, hour) DO UPDATE SET mentions = mentions + 1; END;"
+  "CREATE TRIGGER IF NOT EXISTS quack_hashtags_rollup AFTER INSERT ON tweets WHEN NEW.ts IS NOT NULL "
+  "BEGIN INSERT INTO hashtag_hourly (term, hour, mentions) "
+  "SELECT LOWER(term), NEW.ts / 3600000000, COUNT(*) FROM hashtag_mentions WHERE tid = NEW.tid GROUP BY LOWER(term) "
+  "ON CONFLICT (term, hour) DO UPDATE SET mentions = mentions + excluded.mentions; END;"
+  "INSERT INTO hashtag_hourly (term, hour, mentions) "
+  "SELECT LOWER(ht.term), t.ts / 3600000000, COUNT(*) FROM hashtag_mentions ht JOIN tweets t ON t.tid = ht.tid "
+  "WHERE t.ts IS NOT NULL GROUP BY 1, 2;",
+
+  // 5: hashtag dictionary; mentions refer to terms by integer ID instead of repeating the
+  // text, and the rollup triggers (which read the old term column) are rebuilt against it.
+  // Mentions that differed only in case collapse into one, so the rollups are recounted.
+  "DROP TRIGGER IF EXISTS hashtag_mention_rollup;"
+  "DROP TRIGGER IF EXISTS quack_hashtags_rollup;"
+  "CREATE TABLE IF NOT EXISTS hashtags (term_id INTEGER PRIMARY KEY, term_lower TEXT NOT NULL UNIQUE);"
+  "INSERT OR IGNORE INTO hashtags (term_lower) SELECT DISTINCT LOWER(term) FROM hashtag_mentions ORDER BY 1;"
+  "CREATE TABLE hashtag_mentions_by_id (tid INTEGER NOT NULL, term_id INTEGER NOT NULL, "
+  "PRIMARY KEY (tid, term_id), FOREIGN KEY (tid) REFERENCES tweets(tid) ON DELETE CASCADE, "
+  "FOREIGN KEY (term_id) REFERENCES hashtags(term_id)) WITHOUT ROWID;"
+  "INSERT OR IGNORE INTO hashtag_mentions_by_id (tid, term_id) "
+  "SELECT ht.tid, h.term_id FROM hashtag_mentions ht JOIN hashtags h ON h.term_lower = LOWER(ht.term) "
+  "WHERE ht.tid IS NOT NULL;"
+  "DROP TABLE hashtag_mentions;"
+  "ALTER TABLE hashtag_mentions_by_id RENAME TO hashtag_mentions;"
+  "CREATE INDEX IF NOT EXISTS hashtag_mentions_term ON hashtag_mentions (term_id, tid);"
+  "CREATE TRIGGER IF NOT EXISTS hashtag_mention_rollup AFTER INSERT ON hashtag_mentions "
+  "BEGIN INSERT INTO hashtag_hourly (term, hour, mentions) "
+  "SELECT h.term_lower, t.ts / 3600000000, 1 FROM tweets t, hashtags h "
+  "WHERE t.tid = NEW.tid AND t.ts IS NOT NULL AND h.term_id = NEW.term_id "
+  "ON CONFLICT (term, hour) DO UPDATE SET mentions = mentions + 1; END;"
+  "CREATE TRIGGER IF NOT EXISTS quack_hashtags_rollup AFTER INSERT ON tweets WHEN NEW.ts IS NOT NULL "
+  "BEGIN INSERT INTO hashtag_hourly (term, hour, mentions) "
+  "SELECT h.term_lower, NEW.ts / 3600000000, 1 FROM hashtag_mentions ht, hashtags h "
+  "WHERE ht.tid = NEW.tid AND h.term_id = ht.term_id "
+  "ON CONFLICT (term, hour) DO UPDATE SET mentions = mentions + excluded.mentions; END;"
+  "DELETE FROM hashtag_hourly;"
+  "INSERT INTO hashtag_hourly (term, hour, mentions) "
+  "SELECT h.term_lower, t.ts / 3600000000, COUNT(*) FROM hashtag_mentions ht "
+  "JOIN hashtags h ON h.term_id = ht.term_id JOIN tweets t ON t.tid = ht.tid "
+  "WHERE t.ts IS NOT NULL GROUP BY 1, 2;",
+
+  // 6: lower-cased copies of user names and quack text, so searches compare pre-folded
+  // input instead of calling LOWER() on every row. Pond's inserts fill them directly; the
+  // triggers cover rows written without them and later edits.
+  "ALTER TABLE users ADD COLUMN name_lower TEXT;"
+  "UPDATE users SET name_lower = LOWER(name);"
+  "CREATE INDEX IF NOT EXISTS users_name_lower ON users (name_lower, usr);"
+  "CREATE TRIGGER IF NOT EXISTS users_name_folded AFTER INSERT ON users WHEN NEW.name_lower IS NULL "
+  "BEGIN UPDATE users SET name_lower = LOWER(NEW.name) WHERE usr = NEW.usr; END;"
+  "CREATE TRIGGER IF NOT EXISTS users_name_refolded AFTER UPDATE OF name ON users "
+  "BEGIN UPDATE users SET name_lower = LOWER(NEW.name) WHERE usr = NEW.usr; END;"
+  "ALTER TABLE tweets ADD COLUMN text_lower TEXT;"
+  "UPDATE tweets SET text_lower = LOWER(text);"
+  "CREATE TRIGGER IF NOT EXISTS tweets_text_folded AFTER INSERT ON tweets WHEN NEW.text_lower IS NULL "
+  "BEGIN UPDATE tweets SET text_lower = LOWER(NEW.text) WHERE tid = NEW.tid; END;"
+  "CREATE TRIGGER IF NOT EXISTS tweets_text_refolded AFTER UPDATE OF text ON tweets "
+  "BEGIN UPDATE tweets SET text_lower = LOWER(NEW.text) WHERE tid = NEW.tid; END;",
+
+  // 7: replies by the quack they answer, for walking reply threads
+  "CREATE INDEX IF NOT EXISTS tweets_replyto ON tweets (replyto_tid, tid);",
+
+  // 8: list entries carry their quack's timestamp, so a page of a list is a range scan in
+  // time order, and lists count their entries; Pond's inserts fill the timestamp, the
+  // trigger covers entries written without it
+  "ALTER TABLE include ADD COLUMN ts INTEGER;"
+  "UPDATE include SET ts = COALESCE((SELECT t.ts FROM tweets t WHERE t.tid = include.tid), 0);"
+  "CREATE INDEX IF NOT EXISTS include_list_ts ON include (owner_id, lname, ts DESC, tid DESC);"
+  "CREATE TRIGGER IF NOT EXISTS include_dated AFTER INSERT ON include WHEN NEW.ts IS NULL "
+  "BEGIN UPDATE include SET ts = COALESCE((SELECT ts FROM tweets WHERE tid = NEW.tid), 0) "
+  "WHERE owner_id = NEW.owner_id AND lname = NEW.lname AND tid = NEW.tid; END;"
+  "ALTER TABLE lists ADD COLUMN quacks INTEGER NOT NULL DEFAULT 0;"
+  "UPDATE lists SET quacks = (SELECT COUNT(*) FROM include i WHERE i.owner_id = lists.owner_id AND i.lname = lists.lname);"
+  "CREATE TRIGGER IF NOT EXISTS include_added AFTER INSERT ON include "
+  "BEGIN UPDATE lists SET quacks = quacks + 1 WHERE owner_id = NEW.owner_id AND lname = NEW.lname; END;"
+  "CREATE TRIGGER IF NOT EXISTS include_removed AFTER DELETE ON include "
+  "BEGIN UPDATE lists SET quacks = quacks - 1 WHERE owner_id = OLD.owner_id AND lname = OLD.lname; END;",
+
+  // 9: SimHash fingerprint of each quack's text, for finding near copies; backfilled with
+  // the simhash() function the backend registers, which also covers rows written
+  // without a fingerprint by other connections when they are read
+  "ALTER TABLE tweets ADD COLUMN simhash INTEGER;"
+  "UPDATE tweets SET simhash = simhash(text);",
+};
+
+/**
+ * @brief `simhash(text)`: the SimHash fingerprint Pond stores with each quack, as a
+ *        signed 64-bit integer.
+ */
+void simhashFunction(sqlite3_context* context, int, sqlite3_value** argv) {
+  const unsigned char* text = sqlite3_value_text(argv[0]);
+  if (!text) {
+    sqlite3_result_null(context);
+    return;
+  }
+  const uint64_t fingerprint = SimHashIndex::fingerprint(reinterpret_cast<const char*>(text));
+  sqlite3_result_int64(context, static_cast<sqlite3_int64>(fingerprint));
+}
+
+} // namespace
+
+namespace sql {
+
+template <>
+struct Row<std::pair<int32_t, int32_t>> {
+  static constexpr int columns = 2;
+  static std::pair<int32_t, int32_t> read(sqlite3_stmt* stmt) {
+    return {sqlite3_column_int(stmt, 0), sqlite3_column_int(stmt, 1)};
+  }
+};
+
+template <>
+struct Row<std::pair<int32_t, uint64_t>> {
+  static constexpr int columns = 2;
+  static std::pair<int32_t, uint64_t> read(sqlite3_stmt* stmt) {
+    return {sqlite3_column_int(stmt, 0), static_cast<uint64_t>(sqlite3_column_int64(stmt, 1))};
+  }
+};
+
+template <>
+struct Row<std::pair<int32_t, double>> {
+  static constexpr int columns = 2;
+  static std::pair<int32_t, double> read(sqlite3_stmt* stmt) {
+    return {sqlite3_column_int(stmt, 0), sqlite3_column_double(stmt, 1)};
+  }
+};
+
+template <>
+struct Row<std::pair<int64_t, std::string>> {
+  static constexpr int columns = 2;
+  static std::pair<int64_t, std::string> read(sqlite3_stmt* stmt) {
+    return {sqlite3_column_int64(stmt, 0), columnText(stmt, 1)};
+  }
+};
+
+template <>
+struct Row<std::pair<int32_t, std::string>> {
+  static constexpr int columns = 2;
+  static std::pair<int32_t, std::string> read(sqlite3_stmt* stmt) {
+    return {sqlite3_column_int(stmt, 0), columnText(stmt, 1)};
+  }
+};
+
+template <>
+struct Row<std::pair<std::string, int64_t>> {
+  static constexpr int columns = 2;
+  static std::pair<std::string, int64_t> read(sqlite3_stmt* stmt) {
+    return {columnText(stmt, 0), sqlite3_column_int64(stmt, 1)};
+  }
+};
+
+template <>
+struct Row<std::pair<int64_t, int64_t>> {
+  static constexpr int columns = 2;
+  static std::pair<int64_t, int64_t> read(sqlite3_stmt* stmt) {
+    return {sqlite3_column_int64(stmt, 0), sqlite3_column_int64(stmt, 1)};
+  }
+};
+
+template <>
+struct Row<Pond::ListSummary> {
+  static constexpr int columns = 2;
+  static Pond::ListSummary read(sqlite3_stmt* stmt) {
+    return Pond::ListSummary{columnText(stmt, 0), sqlite3_column_int64(stmt, 1)};
+  }
+};
+
+template <>
+struct Row<Pond::User> {
+  static constexpr int columns = 2;
+  static Pond::User read(sqlite3_stmt* stmt) {
+    Pond::User user;
+    user.usr = sqlite3_column_int(stmt, 0);
+    user.name = columnText(stmt, 1);
+    return user;
+  }
+};
+
+/**
+ * Quack rows are only ever read into a `QuackResults`, which copies the text columns into
+ * its arena itself; `columns` is what `Query` checks the statement against.
+ */
+template <>
+struct Row<Pond::QuackView> {
+  static constexpr int columns = 7;  // tid, writer_id, text, tdate, ttime, replyto_tid, ts
+};
+
+template <>
+struct Append<Pond::QuackResults, Pond::QuackView> {
+  static void reserve(Pond::QuackResults& out, size_t rows) { out.reserve(out.size() + rows); }
+  static void row(Pond::QuackResults& out, sqlite3_stmt* stmt) { out.appendRow(stmt); }
+};
+
+} // namespace sql
+
+namespace {
+
+using sql::In;
+using sql::Out;
+using sql::Query;
+
+/**
+ * @brief A `QuackResults` sink that skips quacks already collected by an earlier keyword.
+ *
+ * Rows it appends are added to `remember` when that is set.
+ */
+struct UniqueQuacks {
+  Pond::QuackResults& results;
+  const std::unordered_set<int32_t>& seen;
+  std::unordered_set<int32_t>* remember;
+};
+
+/**
+ * @brief A `QuackResults` sink for thread rows, which carry each quack's depth below the
+ *        root in an eighth column.
+ */
+struct ThreadRows {
+  Pond::QuackResults& quacks;
+  std::vector<int32_t>& depths;
+};
+
+/**
+ * @brief A `RowStream` over an open statement; a default-constructed cursor streams no rows.
+ */
+template <typename Container, typename T>
+class StatementStream : public RowStream<Container>
+{
+public:
+  explicit StatementStream(sql::Cursor<T> cursor) : _cursor(std::move(cursor)) {}
+
+  bool next(size_t n, Container& out) override { return this->_cursor.next(n, out); }
+  bool done() const override { return this->_cursor.done(); }
+
+private:
+  sql::Cursor<T> _cursor;
+};
+
+template <typename Container, typename T>
+std::unique_ptr<RowStream<Container>> streamOf(std::optional<sql::Cursor<T>> cursor) {
+  if (!cursor) {
+    return nullptr;
+  }
+  return std::make_unique<StatementStream<Container, T>>(std::move(*cursor));
+}
+
+} // namespace
+
+namespace sql {
+
+template <>
+struct Append<ThreadRows, Pond::QuackView> {
+  static void reserve(ThreadRows& out, size_t rows) {
+    out.quacks.reserve(out.quacks.size() + rows);
+    out.depths.reserve(out.depths.size() + rows);
+  }
+  static void row(ThreadRows& out, sqlite3_stmt* stmt) {
+    out.quacks.appendRow(stmt);
+    out.depths.push_back(sqlite3_column_int(stmt, 7));
+  }
+};
+
+template <>
+struct Append<UniqueQuacks, Pond::QuackView> {
+  static void reserve(UniqueQuacks& out, size_t rows) { out.results.reserve(out.results.size() + rows); }
+  static void row(UniqueQuacks& out, sqlite3_stmt* stmt) {
+    int32_t quack_id = sqlite3_column_int(stmt, 0);
+    if (out.seen.find(quack_id) == out.seen.end()) {
+      out.results.appendRow(stmt);
+      if (out.remember) {
+        out.remember->insert(quack_id);
+      }
+    }
+  }
+};
+
+template <>
+struct Row<Backend::FeedEntry> {
+  static constexpr int columns = 8;
+  static Backend::FeedEntry read(sqlite3_stmt* stmt) {
+    Backend::FeedEntry entry;
+    entry.tid = sqlite3_column_int(stmt, 1);
+    entry.name = columnText(stmt, 2);
+    entry.date = columnText(stmt, 4);
+    entry.time = columnText(stmt, 5);
+    entry.text = columnText(stmt, 6);
+    entry.ts = sqlite3_column_int64(stmt, 7);
+    return entry;
+  }
+};
+
+} // namespace sql
+
+namespace {
+
+/**
+ * @brief ASCII lower-casing, the same folding SQLite's `LOWER()` applies, for keys of
+ *        the hashtag dictionary and input compared against the lower-cased columns.
+ */
+std::string fold(const std::string& text) {
+  std::string folded(text);
+  std::transform(folded.begin(), folded.end(), folded.begin(), [](char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+  });
+  return folded;
+}
+
+/**
+ * @brief Rewrites a lower-cased LIKE pattern as the GLOB pattern matching the same
+ *        lower-cased text.
+ *
+ * Unlike LIKE, GLOB is case-sensitive, so SQLite can turn its literal prefix into a range
+ * scan on an ordinary index. `%` becomes `*`, `_` becomes `?`, and GLOB's own special
+ * characters are bracketed to stay literal.
+ */
+std::string likeToGlob(const std::string& pattern) {
+  std::string glob;
+  glob.reserve(pattern.size());
+  for (char c : pattern) {
+    switch (c) {
+      case '%': glob.push_back('*'); break;
+      case '_': glob.push_back('?'); break;
+      case '*': glob += "[*]"; break;
+      case '?': glob += "[?]"; break;
+      case '[': glob += "[[]"; break;
+      default:  glob.push_back(c);
+    }
+  }
+  return glob;
+}
+
+// -----------------------------------------------------------------------------
+// Users
+// -----------------------------------------------------------------------------
+
+constexpr char INSERT_USER[] =
+  "INSERT INTO users (usr, name, name_lower, email, phone, pwd) "
+  "VALUES (?1, ?2, LOWER(?2), ?3, ?4, ?5)";
+using InsertUser = Query<INSERT_USER, Out<void>, In<int32_t, std::string, std::string, int64_t, std::string>>;
+
+constexpr char SELECT_LOGIN[] =
+  "SELECT usr "
+  "FROM users "
+  "WHERE usr = ? "
+  "AND pwd = ?";
+using SelectLogin = Query<SELECT_LOGIN, Out<int32_t>, In<int32_t, std::string>>;
+
+// Most influential first; users the rank job has not scored yet count as 0
+constexpr char SEARCH_USERS[] =
+  "SELECT u.usr, u.name "
+  "FROM users u "
+  "LEFT JOIN user_rank r ON r.usr = u.usr "
+  // the search terms are bound lower-cased
+  "WHERE u.name_lower LIKE '%' || ? || '%' "
+  "ORDER BY COALESCE(r.score, 0) DESC, LENGTH(u.name), u.usr";
+using SearchUsers = Query<SEARCH_USERS, Out<Pond::User>, In<std::string>>;
+
+// Scans users_name_lower, which covers it, rather than the table
+constexpr char COUNT_USERS[] =
+  "SELECT COUNT(*) "
+  "FROM users "
+  "WHERE name_lower LIKE '%' || ? || '%'";
+using CountUsers = Query<COUNT_USERS, Out<int64_t>, In<std::string>>;
+
+constexpr char SELECT_USERNAME[] =
+  "SELECT name "
+  "FROM users "
+  "WHERE usr = ?";
+using SelectUsername = Query<SELECT_USERNAME, Out<std::string>, In<int32_t>>;
+
+// Users come back in the order of the bound IDs
+constexpr char SELECT_USERS_BY_ID[] =
+  "SELECT u.usr, u.name "
+  "FROM json_each(?) j "
+  "JOIN users u ON u.usr = j.value "
+  "ORDER BY j.key";
+using SelectUsersByID = Query<SELECT_USERS_BY_ID, Out<Pond::User>, In<std::vector<int32_t>>>;
+
+constexpr char SELECT_USERS_FROM[] =
+  "SELECT usr, name "
+  "FROM users "
+  "WHERE usr >= ? "
+  "ORDER BY usr";
+using SelectUsersFrom = Query<SELECT_USERS_FROM, Out<Pond::User>, In<int32_t>>;
+
+constexpr char MAX_USER_ID[] = "SELECT MAX(usr) FROM users";
+using MaxUserID = Query<MAX_USER_ID, Out<int32_t>>;
+
+// -----------------------------------------------------------------------------
+// Follows
+// -----------------------------------------------------------------------------
+
+constexpr char INSERT_FOLLOW[] =
+  "INSERT INTO follows (flwer, flwee, start_date) "
+  "VALUES (?, ?, ?)";
+using InsertFollow = Query<INSERT_FOLLOW, Out<void>, In<int32_t, int32_t, const char*>>;
+
+constexpr char DELETE_FOLLOW[] =
+  "DELETE FROM follows "
+  "WHERE flwer = ? "
+  "AND flwee = ?";
+using DeleteFollow = Query<DELETE_FOLLOW, Out<void>, In<int32_t, int32_t>>;
+
+constexpr char SELECT_FOLLOW_EDGES[] = "SELECT flwer, flwee FROM follows";
+using SelectFollowEdges = Query<SELECT_FOLLOW_EDGES, Out<std::pair<int32_t, int32_t>>>;
+
+// Run directly rather than through Query: the statement stays prepared (see followsVersion)
+constexpr char SELECT_FOLLOWS_VERSION[] = "SELECT version FROM follows_version";
+
+// -----------------------------------------------------------------------------
+// Ranks
+// -----------------------------------------------------------------------------
+
+constexpr char SELECT_USER_RANKS[] = "SELECT usr, score FROM user_rank";
+using SelectUserRanks = Query<SELECT_USER_RANKS, Out<std::pair<int32_t, double>>>;
+
+constexpr char DELETE_USER_RANKS[] = "DELETE FROM user_rank";
+using DeleteUserRanks = Query<DELETE_USER_RANKS, Out<void>>;
+
+// Scores for IDs with no user are dropped rather than violating the foreign key
+constexpr char INSERT_USER_RANKS[] =
+  "INSERT INTO user_rank (usr, score) "
+  "SELECT json_extract(j.value, '$[0]'), json_extract(j.value, '$[1]') "
+  "FROM json_each(?) j "
+  "WHERE json_extract(j.value, '$[0]') IN (SELECT usr FROM users)";
+using InsertUserRanks = Query<INSERT_USER_RANKS, Out<void>, In<std::vector<std::pair<int32_t, double>>>>;
+
+// -----------------------------------------------------------------------------
+// Quacks
+// -----------------------------------------------------------------------------
+
+// replyto_tid is NULL for quacks that are not replies
+constexpr char INSERT_QUACK[] =
+  "INSERT INTO tweets (tid, writer_id, text, text_lower, tdate, ttime, replyto_tid, ts, simhash) "
+  "VALUES (?1, ?2, ?3, LOWER(?3), ?4, ?5, ?6, ?7, ?8)";
+using InsertQuack = Query<INSERT_QUACK, Out<void>,
+                          In<int32_t, int32_t, std::string, const char*, const char*, std::optional<int32_t>, int64_t,
+                             int64_t>>;
+
+// Terms are only ever added, so an ID once read stays valid for the life of the file
+constexpr char INSERT_TERM[] =
+  "INSERT INTO hashtags (term_lower) VALUES (?) "
+  "ON CONFLICT (term_lower) DO NOTHING";
+using InsertTerm = Query<INSERT_TERM, Out<void>, In<std::string>>;
+
+constexpr char SELECT_TERM_ID[] = "SELECT term_id FROM hashtags WHERE term_lower = ?";
+using SelectTermID = Query<SELECT_TERM_ID, Out<int64_t>, In<std::string>>;
+
+// The primary key makes a term at most one mention per quack, in any case
+constexpr char INSERT_HASHTAG[] =
+  "INSERT INTO hashtag_mentions (tid, term_id) VALUES (?, ?) "
+  "ON CONFLICT (tid, term_id) DO NOTHING";
+using InsertHashtag = Query<INSERT_HASHTAG, Out<void>, In<int32_t, int64_t>>;
+
+constexpr char SELECT_QUACK_BY_ID[] =
+  "SELECT tid, writer_id, text, tdate, ttime, replyto_tid, ts "
+  "FROM tweets "
+  "WHERE tid = ?";
+using SelectQuackByID = Query<SELECT_QUACK_BY_ID, Out<Pond::QuackView>, In<int32_t>>;
+
+constexpr char SELECT_QUACKS_BY_ID[] =
+  "SELECT tid, writer_id, text, tdate, ttime, replyto_tid, ts "
+  "FROM tweets "
+  "WHERE tid IN (SELECT value FROM json_each(?)) "
+  "ORDER BY ts DESC, tid DESC";
+using SelectQuacksByID = Query<SELECT_QUACKS_BY_ID, Out<Pond::QuackView>, In<std::vector<int32_t>>>;
+
+constexpr char SELECT_QUACKS_FROM[] =
+  "SELECT tid, writer_id, text, tdate, ttime, replyto_tid, ts "
+  "FROM tweets "
+  "WHERE tid >= ? "
+  "ORDER BY tid "
+  "LIMIT ?";
+using SelectQuacksFrom = Query<SELECT_QUACKS_FROM, Out<Pond::QuackView>, In<int32_t, int64_t>>;
+
+constexpr char SELECT_SIMHASHES_FROM[] =
+  "SELECT tid, COALESCE(simhash, simhash(text)) "
+  "FROM tweets "
+  "WHERE tid >= ? "
+  "ORDER BY tid "
+  "LIMIT ?";
+using SelectSimhashesFrom = Query<SELECT_SIMHASHES_FROM, Out<std::pair<int32_t, uint64_t>>, In<int32_t, int64_t>>;
+
+constexpr char SELECT_QUACKS_BY_WRITER[] =
+  "SELECT tid, writer_id, text, tdate, ttime, replyto_tid, ts "
+  "FROM tweets "
+  "WHERE writer_id = ? "
+  "ORDER BY ts DESC, tid DESC";
+using SelectQuacksByWriter = Query<SELECT_QUACKS_BY_WRITER, Out<Pond::QuackView>, In<int32_t>>;
+
+constexpr char SELECT_REPLIES[] =
+  "SELECT tid "
+  "FROM tweets "
+  "WHERE replyto_tid = ? "
+  "ORDER BY tid";
+using SelectReplies = Query<SELECT_REPLIES, Out<int32_t>, In<int32_t>>;
+
+// Depth first from the root (?1): the queue always yields its deepest pending quack, and
+// the pending quacks of one depth are siblings, taken in ID order. Rows come out in the
+// order the queue yields them. Each step is a range scan on tweets_replyto, and the
+// LIMIT (?3) stops the walk itself, not just the output.
+constexpr char SELECT_THREAD[] =
+  "WITH RECURSIVE thread (tid, writer_id, text, tdate, ttime, replyto_tid, ts, depth) AS ("
+  "  SELECT tid, writer_id, text, tdate, ttime, replyto_tid, ts, 0 FROM tweets WHERE tid = ?1 "
+  "  UNION ALL "
+  "  SELECT t.tid, t.writer_id, t.text, t.tdate, t.ttime, t.replyto_tid, t.ts, thread.depth + 1 "
+  "  FROM thread JOIN tweets t ON t.replyto_tid = thread.tid "
+  "  WHERE thread.depth < ?2 "
+  "  ORDER BY 8 DESC, 1 "
+  "  LIMIT ?3"
+  ") "
+  "SELECT tid, writer_id, text, tdate, ttime, replyto_tid, ts, depth FROM thread";
+using SelectThread = Query<SELECT_THREAD, Out<Pond::QuackView>, In<int32_t, int32_t, int64_t>>;
+
+constexpr char MAX_QUACK_ID[] = "SELECT MAX(tid) FROM tweets";
+using MaxQuackID = Query<MAX_QUACK_ID, Out<int32_t>>;
+
+// Range scan on hashtag_mentions_term, then a primary key lookup per quack
+constexpr char SEARCH_QUACKS_BY_TERM_ID[] =
+  "SELECT t.tid, t.writer_id, t.text, t.tdate, t.ttime, t.replyto_tid, t.ts "
+  "FROM hashtag_mentions ht "
+  "JOIN tweets t ON t.tid = ht.tid "
+  "WHERE ht.term_id = ? "
+  "ORDER BY t.ts DESC, t.tid DESC";
+using SearchQuacksByTermID = Query<SEARCH_QUACKS_BY_TERM_ID, Out<Pond::QuackView>, In<int64_t>>;
+
+// Patterns with wildcards are matched against the dictionary, never the mentions. They are
+// bound as GLOB patterns over the lower-cased terms, so a literal prefix is a range scan on
+// the dictionary's unique index.
+constexpr char SEARCH_QUACKS_BY_TERM_PATTERN[] =
+  "SELECT t.tid, t.writer_id, t.text, t.tdate, t.ttime, t.replyto_tid, t.ts "
+  "FROM hashtags h "
+  "JOIN hashtag_mentions ht ON ht.term_id = h.term_id "
+  "JOIN tweets t ON t.tid = ht.tid "
+  "WHERE h.term_lower GLOB ? "
+  "ORDER BY t.ts DESC, t.tid DESC";
+using SearchQuacksByTermPattern = Query<SEARCH_QUACKS_BY_TERM_PATTERN, Out<Pond::QuackView>, In<std::string>>;
+
+// The counts join tweets like the searches, so mentions of missing quacks are not counted
+constexpr char COUNT_QUACKS_BY_TERM_ID[] =
+  "SELECT COUNT(*) "
+  "FROM hashtag_mentions ht "
+  "JOIN tweets t ON t.tid = ht.tid "
+  "WHERE ht.term_id = ?";
+using CountQuacksByTermID = Query<COUNT_QUACKS_BY_TERM_ID, Out<int64_t>, In<int64_t>>;
+
+constexpr char COUNT_QUACKS_BY_TERM_PATTERN[] =
+  "SELECT COUNT(*) "
+  "FROM hashtags h "
+  "JOIN hashtag_mentions ht ON ht.term_id = h.term_id "
+  "JOIN tweets t ON t.tid = ht.tid "
+  "WHERE h.term_lower GLOB ?";
+using CountQuacksByTermPattern = Query<COUNT_QUACKS_BY_TERM_PATTERN, Out<int64_t>, In<std::string>>;
+
+// Range scan on tweets_ts
+constexpr char SELECT_HASHTAG_MENTIONS_SINCE[] =
+  "SELECT t.ts, h.term_lower "
+  "FROM tweets t "
+  "JOIN hashtag_mentions ht ON ht.tid = t.tid "
+  "JOIN hashtags h ON h.term_id = ht.term_id "
+  "WHERE t.ts >= ? "
+  "ORDER BY t.ts, t.tid";
+using SelectHashtagMentionsSince = Query<SELECT_HASHTAG_MENTIONS_SINCE, Out<std::pair<int64_t, std::string>>, In<int64_t>>;
+
+// Range scan on the primary key
+constexpr char SELECT_HASHTAG_MENTIONS_FROM[] =
+  "SELECT ht.tid, h.term_lower "
+  "FROM hashtag_mentions ht "
+  "JOIN hashtags h ON h.term_id = ht.term_id "
+  "WHERE ht.tid >= ? "
+  "ORDER BY ht.tid";
+using SelectHashtagMentionsFrom = Query<SELECT_HASHTAG_MENTIONS_FROM, Out<std::pair<int32_t, std::string>>, In<int32_t>>;
+
+constexpr char SELECT_HASHTAGS_OF[] =
+  "SELECT h.term_lower "
+  "FROM hashtag_mentions ht "
+  "JOIN hashtags h ON h.term_id = ht.term_id "
+  "WHERE ht.tid = ?";
+using SelectHashtagsOf = Query<SELECT_HASHTAGS_OF, Out<std::string>, In<int32_t>>;
+
+// ?1 is the keyword and ?2 the keyword as a hashtag, both lower-cased; each may be a whole
+// word anywhere in the text
+constexpr char SEARCH_QUACKS_BY_WORD[] =
+  "SELECT tid, writer_id, text, tdate, ttime, replyto_tid, ts "
+  "FROM tweets "
+  "WHERE text_lower LIKE '% ' || ?1 || ' %' "
+  "OR text_lower LIKE '% ' || ?2 || ' %' "
+  "OR text_lower LIKE '% ' || ?1 "
+  "OR text_lower LIKE '% ' || ?2 "
+  "OR text_lower LIKE ?1 || ' %' "
+  "OR text_lower LIKE ?2 || ' %' "
+  "OR text_lower = ?1 "
+  "OR text_lower = ?2 "
+  "ORDER BY ts DESC, tid DESC";
+using SearchQuacksByWord = Query<SEARCH_QUACKS_BY_WORD, Out<Pond::QuackView>, In<std::string, std::string>>;
+
+// Still a scan, but no row is copied out
+constexpr char COUNT_QUACKS_BY_WORD[] =
+  "SELECT COUNT(*) "
+  "FROM tweets "
+  "WHERE text_lower LIKE '% ' || ?1 || ' %' "
+  "OR text_lower LIKE '% ' || ?2 || ' %' "
+  "OR text_lower LIKE '% ' || ?1 "
+  "OR text_lower LIKE '% ' || ?2 "
+  "OR text_lower LIKE ?1 || ' %' "
+  "OR text_lower LIKE ?2 || ' %' "
+  "OR text_lower = ?1 "
+  "OR text_lower = ?2";
+using CountQuacksByWord = Query<COUNT_QUACKS_BY_WORD, Out<int64_t>, In<std::string, std::string>>;
+
+// The feed is merged from pages of each followee's quacks and requacks. A page seeks
+// tweets_writer_ts or retweets_retweeter_ts just past the last row read from the same
+// followee (?2, ?3), so rows merged before a deadline interrupts a page are a true prefix
+// of the feed, and no statement stays open however many users are followed.
+constexpr char SELECT_FEED_QUACKS_BY[] =
+  "SELECT 'tweet' AS type, t.tid, u.name, t.writer_id, t.tdate, t.ttime, t.text, t.ts "
+  "FROM tweets t "
+  "JOIN users u ON u.usr = t.writer_id "
+  "WHERE t.writer_id = ?1 AND (t.ts, t.tid) < (?2, ?3) "
+  "ORDER BY t.ts DESC, t.tid DESC "
+  "LIMIT ?4";
+using SelectFeedQuacksBy = Query<SELECT_FEED_QUACKS_BY, Out<Backend::FeedEntry>, In<int32_t, int64_t, int32_t, int64_t>>;
+
+constexpr char SELECT_FEED_REQUACKS_BY[] =
+  "SELECT 'retweet' AS type, t.tid, u.name, r.retweeter_id, r.rdate, t.ttime, t.text, r.ts "
+  "FROM retweets r "
+  "JOIN tweets t ON t.tid = r.tid "
+  "JOIN users u ON u.usr = r.retweeter_id "
+  "WHERE r.retweeter_id = ?1 AND r.spam = 0 AND (r.ts, r.tid) < (?2, ?3) "
+  "ORDER BY r.ts DESC, r.tid DESC "
+  "LIMIT ?4";
+using SelectFeedRequacksBy = Query<SELECT_FEED_REQUACKS_BY, Out<Backend::FeedEntry>, In<int32_t, int64_t, int32_t, int64_t>>;
+
+// Rows in the first page of a followee's quacks or requacks; each later page is twice
+// the size of the one before, up to FEED_MAX_PAGE
+constexpr int64_t FEED_FIRST_PAGE = 16;
+constexpr int64_t FEED_MAX_PAGE = 1024;
+
+/**
+ * @brief The quacks or the requacks of one followee, read a page at a time for the feed.
+ */
+struct FeedSource {
+  int32_t user_id;
+  bool requacks;
+  std::vector<Backend::FeedEntry> rows;  // the current page
+  size_t next = 0;                       // the first row of the page not yet merged
+  int64_t page = FEED_FIRST_PAGE;
+  bool done = false;                     // no rows left past the current page
+
+  /**
+   * @brief Replaces the current page with the rows after it.
+   *
+   * @return false if the page could not be read.
+   */
+  bool readPage(sqlite3* db) {
+    int64_t ts = INT64_MAX;
+    int32_t tid = INT32_MAX;
+    if (!this->rows.empty()) {
+      ts = this->rows.back().ts;
+      tid = this->rows.back().tid;
+    }
+    this->rows.clear();
+    this->next = 0;
+    bool read = this->requacks ? SelectFeedRequacksBy::all(db, this->rows, this->user_id, ts, tid, this->page)
+                               : SelectFeedQuacksBy::all(db, this->rows, this->user_id, ts, tid, this->page);
+    this->done = static_cast<int64_t>(this->rows.size()) < this->page;
+    this->page = std::min(this->page * 2, FEED_MAX_PAGE);
+    return read;
+  }
+};
+
+// -----------------------------------------------------------------------------
+// Hashtag rollups
+// -----------------------------------------------------------------------------
+
+// Range scan on the primary key
+constexpr char SELECT_HASHTAG_HOURS[] =
+  "SELECT hour, mentions "
+  "FROM hashtag_hourly "
+  "WHERE term = ? AND hour >= ? AND hour < ? "
+  "ORDER BY hour";
+using SelectHashtagHours = Query<SELECT_HASHTAG_HOURS, Out<std::pair<int64_t, int64_t>>, In<std::string, int64_t, int64_t>>;
+
+// Covered by hashtag_hourly_hour
+constexpr char SELECT_TOP_HASHTAGS_BETWEEN[] =
+  "SELECT term, SUM(mentions) AS total "
+  "FROM hashtag_hourly "
+  "WHERE hour >= ? AND hour < ? "
+  "GROUP BY term "
+  "ORDER BY total DESC, term "
+  "LIMIT ?";
+using SelectTopHashtagsBetween = Query<SELECT_TOP_HASHTAGS_BETWEEN, Out<std::pair<std::string, int64_t>>, In<int64_t, int64_t, int64_t>>;
+
+constexpr char DELETE_HASHTAG_ROLLUPS[] = "DELETE FROM hashtag_hourly";
+using DeleteHashtagRollups = Query<DELETE_HASHTAG_ROLLUPS, Out<void>>;
+
+constexpr char BACKFILL_HASHTAG_ROLLUPS[] =
+  "INSERT INTO hashtag_hourly (term, hour, mentions) "
+  "SELECT h.term_lower, t.ts / 3600000000, COUNT(*) "
+  "FROM hashtag_mentions ht "
+  "JOIN hashtags h ON h.term_id = ht.term_id "
+  "JOIN tweets t ON t.tid = ht.tid "
+  "WHERE t.ts IS NOT NULL "
+  "GROUP BY 1, 2";
+using BackfillHashtagRollups = Query<BACKFILL_HASHTAG_ROLLUPS, Out<void>>;
+
+// -----------------------------------------------------------------------------
+// Requacks
+// -----------------------------------------------------------------------------
+
+// A repeat marks the existing requack. The writer comes from the quack, and a missing
+// quack inserts nothing and returns no row.
+constexpr char UPSERT_REQUACK[] =
+  "INSERT INTO retweets (tid, retweeter_id, writer_id, rdate, spam, ts) "
+  "SELECT tid, ?2, writer_id, ?4, ?3, ?5 FROM tweets WHERE tid = ?1 "
+  "ON CONFLICT (tid, retweeter_id) DO UPDATE SET spam = 1 "
+  "RETURNING spam";
+using UpsertRequack = Query<UPSERT_REQUACK, Out<int32_t>, In<int32_t, int32_t, int32_t, const char*, int64_t>>;
+
+constexpr char COUNT_REQUACKS[] =
+  "SELECT COUNT(tid) "
+  "FROM retweets "
+  "WHERE tid = ?";
+using CountRequacks = Query<COUNT_REQUACKS, Out<int32_t>, In<int32_t>>;
+
+constexpr char REQUACKED_ANY[] =
+  "SELECT EXISTS (SELECT 1 FROM retweets "
+  "WHERE retweeter_id = ? AND tid IN (SELECT value FROM json_each(?)))";
+using RequackedAny = Query<REQUACKED_ANY, Out<int32_t>, In<int32_t, std::vector<int32_t>>>;
+
+// -----------------------------------------------------------------------------
+// Lists
+// -----------------------------------------------------------------------------
+
+constexpr char INSERT_LIST[] =
+  "INSERT INTO lists (owner_id, lname) "
+  "VALUES (?, ?)";
+using InsertList = Query<INSERT_LIST, Out<void>, In<int32_t, std::string>>;
+
+// Entries of quacks that do not exist are dated 0, like those the migration found
+constexpr char INSERT_LIST_ENTRY[] =
+  "INSERT INTO include (owner_id, lname, tid, ts) "
+  "VALUES (?1, ?2, ?3, COALESCE((SELECT ts FROM tweets WHERE tid = ?3), 0))";
+using InsertListEntry = Query<INSERT_LIST_ENTRY, Out<void>, In<int32_t, std::string, int32_t>>;
+
+constexpr char SELECT_LIST[] = "SELECT 1 FROM lists WHERE owner_id = ? AND lname = ?";
+using SelectList = Query<SELECT_LIST, Out<int32_t>, In<int32_t, std::string>>;
+
+constexpr char SELECT_LISTS[] =
+  "SELECT lname, quacks "
+  "FROM lists "
+  "WHERE owner_id = ? "
+  "ORDER BY lname";
+using SelectLists = Query<SELECT_LISTS, Out<Pond::ListSummary>, In<int32_t>>;
+
+// Range scans on include_list_ts, from the newest entry or from just past the cursor
+constexpr char SELECT_LIST_QUACKS[] =
+  "SELECT t.tid, t.writer_id, t.text, t.tdate, t.ttime, t.replyto_tid, t.ts "
+  "FROM include i "
+  "JOIN tweets t ON t.tid = i.tid "
+  "WHERE i.owner_id = ? AND i.lname = ? "
+  "ORDER BY i.ts DESC, i.tid DESC "
+  "LIMIT ?";
+using SelectListQuacks = Query<SELECT_LIST_QUACKS, Out<Pond::QuackView>, In<int32_t, std::string, int64_t>>;
+
+constexpr char SELECT_LIST_QUACKS_AFTER[] =
+  "SELECT t.tid, t.writer_id, t.text, t.tdate, t.ttime, t.replyto_tid, t.ts "
+  "FROM include i "
+  "JOIN tweets t ON t.tid = i.tid "
+  "WHERE i.owner_id = ? AND i.lname = ? AND (i.ts, i.tid) < (?, ?) "
+  "ORDER BY i.ts DESC, i.tid DESC "
+  "LIMIT ?";
+using SelectListQuacksAfter =
+  Query<SELECT_LIST_QUACKS_AFTER, Out<Pond::QuackView>, In<int32_t, std::string, int64_t, int32_t, int64_t>>;
+
+// -----------------------------------------------------------------------------
+// Schema
+// -----------------------------------------------------------------------------
+
+constexpr char USER_VERSION[] = "PRAGMA user_version";
+using UserVersion = Query<USER_VERSION, Out<int32_t>>;
+
+constexpr char VACUUM_INTO[] = "VACUUM INTO ?";
+using VacuumInto = Query<VACUUM_INTO, Out<void>, In<std::string>>;
+
+constexpr char BEGIN_IMMEDIATE[] = "BEGIN IMMEDIATE";
+using BeginImmediate = Query<BEGIN_IMMEDIATE, Out<void>>;
+
+constexpr char COMMIT[] = "COMMIT";
+using Commit = Query<COMMIT, Out<void>>;
+
+constexpr char ROLLBACK[] = "ROLLBACK";
+using Rollback = Query<ROLLBACK, Out<void>>;
+
+} // namespace
+
+// =============================================================================
+// Public Methods
+// =============================================================================
+
+/**
+ * @brief Constructs a backend with no open connection; every operation fails until
+ *        `open` succeeds.
+ */
+SqliteBackend::SqliteBackend()
+  : _db(nullptr), _follows_version(nullptr) {
+}
+
+/**
+ * @brief Closes the connection if one was opened.
+ */
+SqliteBackend::~SqliteBackend() {
+  sqlite3_finalize(_follows_version);
+  if (_db) {
+    sqlite3_close(_db);
+  }
+}
+
+/**
+ * @brief Opens a connection to the SQLite database specified by the filename and runs
+ *        any pending schema migrations.
+ *
+ * @param db_filename The name of the database file to open.
+ * @return int Returns SQLITE_OK (0) if the database was successfully opened,
+ *         or a non-zero SQLite error code if it failed.
+ */
+int SqliteBackend::open(const std::string& db_filename) {
+  int exit_code = sqlite3_open(db_filename.c_str(), &this->_db);
+  if (exit_code) {
+    std::cerr << "Can't open database: " << sqlite3_errmsg(this->_db) << std::endl;
+    return exit_code;
+  }
+
+  // Wait for other connections (e.g. parallel replay sessions) instead of failing with SQLITE_BUSY
+  sqlite3_busy_timeout(this->_db, 5000);
+
+  sqlite3_create_function(this->_db, "simhash", 1, SQLITE_UTF8 | SQLITE_DETERMINISTIC, nullptr, simhashFunction,
+                          nullptr, nullptr);
+
+  if (!this->_migrate()) {
+    std::cerr << "Can't migrate database: " << sqlite3_errmsg(this->_db) << std::endl;
+    return SQLITE_ERROR;
+  }
+  return 0;
+}
+
+/**
+ * @brief Bounds the reads that follow by `deadline` through a progress handler that
+ *        interrupts the running statement once it has expired.
+ *
+ * SQLite calls the handler every `DEADLINE_CHECK_STEPS` virtual machine instructions,
+ * well under a millisecond apart, and a statement it interrupts fails with
+ * SQLITE_INTERRUPT after the rows already stepped. The handler is removed again with the
+ * deadline, so unbounded calls pay nothing.
+ */
+void SqliteBackend::setDeadline(const Deadline* deadline) {
+  const int DEADLINE_CHECK_STEPS = 1000;
+  Backend::setDeadline(deadline);
+  if (deadline) {
+    sqlite3_progress_handler(this->_db, DEADLINE_CHECK_STEPS, [](void* backend) {
+      return static_cast<int>(static_cast<SqliteBackend*>(backend)->_deadlinePassed());
+    }, this);
+  } else {
+    sqlite3_progress_handler(this->_db, 0, nullptr, nullptr);
+  }
+}
+
+bool SqliteBackend::insertUser(int32_t usr, const std::string& name, const std::string& email,
+                               int64_t phone, const std::string& pwd) {
+  return InsertUser::exec(this->_db, usr, name, email, phone, pwd);
+}
+
+std::optional<int32_t> SqliteBackend::maxUserID() {
+  // MAX() of an empty table is NULL, which reads as 0
+  return MaxUserID::one(this->_db);
+}
+
+std::optional<int32_t> SqliteBackend::checkLogin(int32_t usr, const std::string& pwd) {
+  return SelectLogin::one(this->_db, usr, pwd);
+}
+
+bool SqliteBackend::searchUsers(const std::string& search_terms, std::vector<Pond::User>& out) {
+  return SearchUsers::all(this->_db, out, fold(search_terms));
+}
+
+std::unique_ptr<RowStream<std::vector<Pond::User>>> SqliteBackend::streamUsers(const std::string& search_terms) {
+  return streamOf<std::vector<Pond::User>>(SearchUsers::open(this->_db, fold(search_terms)));
+}
+
+std::optional<int64_t> SqliteBackend::countUsers(const std::string& search_terms) {
+  return CountUsers::one(this->_db, fold(search_terms));
+}
+
+std::optional<std::string> SqliteBackend::username(int32_t usr) {
+  return SelectUsername::one(this->_db, usr);
+}
+
+bool SqliteBackend::usersByID(const std::vector<int32_t>& usrs, std::vector<Pond::User>& out) {
+  return SelectUsersByID::all(this->_db, out, usrs);
+}
+
+bool SqliteBackend::usersFrom(int32_t first_usr, std::vector<Pond::User>& out) {
+  return SelectUsersFrom::all(this->_db, out, first_usr);
+}
+
+bool SqliteBackend::insertFollow(int32_t flwer, int32_t flwee, const char* start_date) {
+  return InsertFollow::exec(this->_db, flwer, flwee, start_date);
+}
+
+bool SqliteBackend::deleteFollow(int32_t flwer, int32_t flwee) {
+  return DeleteFollow::exec(this->_db, flwer, flwee);
+}
+
+bool SqliteBackend::followEdges(std::vector<std::pair<int32_t, int32_t>>& out) {
+  return SelectFollowEdges::all(this->_db, out);
+}
+
+/**
+ * @brief Reads the follow counter maintained by the `follows` triggers.
+ *
+ * Pond checks the counter before every follow graph read, so unlike the other queries
+ * this statement is prepared once and reset after each use.
+ */
+std::optional<int64_t> SqliteBackend::followsVersion() {
+  if (!this->_follows_version &&
+      sqlite3_prepare_v2(this->_db, SELECT_FOLLOWS_VERSION, -1, &this->_follows_version, nullptr) != SQLITE_OK) {
+    sqlite3_finalize(this->_follows_version);
+    this->_follows_version = nullptr;
+    return std::nullopt;
+  }
+
+  std::optional<int64_t> version;
+  if (sqlite3_step(this->_follows_version) == SQLITE_ROW) {
+    version = sqlite3_column_int64(this->_follows_version, 0);
+  }
+  sqlite3_reset(this->_follows_version);
+  return version;
+}
+
+bool SqliteBackend::insertQuack(int32_t tid, int32_t writer_id, const std::string& text, uint64_t simhash,
+                                const Clock::Stamp& now, std::optional<int32_t> replyto_tid) {
+  return InsertQuack::exec(this->_db, tid, writer_id, text, now.date, now.time, replyto_tid, now.ts,
+                           static_cast<int64_t>(simhash));
+}
+
+std::optional<int32_t> SqliteBackend::maxQuackID() {
+  // MAX() of an empty table is NULL, which reads as 0
+  return MaxQuackID::one(this->_db);
+}
+
+bool SqliteBackend::quackByID(int32_t tid, Pond::QuackResults& out) {
+  return SelectQuackByID::all(this->_db, out, tid);
+}
+
+bool SqliteBackend::quacksByID(const std::vector<int32_t>& tids, Pond::QuackResults& out) {
+  return SelectQuacksByID::all(this->_db, out, tids);
+}
+
+bool SqliteBackend::quacksFrom(int32_t first_tid, size_t limit, Pond::QuackResults& out) {
+  return SelectQuacksFrom::all(this->_db, out, first_tid, static_cast<int64_t>(limit));
+}
+
+bool SqliteBackend::simhashesFrom(int32_t first_tid, size_t limit,
+                                  std::vector<std::pair<int32_t, uint64_t>>& out) {
+  return SelectSimhashesFrom::all(this->_db, out, first_tid, static_cast<int64_t>(limit));
+}
+
+bool SqliteBackend::quacksByWriter(int32_t writer_id, Pond::QuackResults& out) {
+  return SelectQuacksByWriter::all(this->_db, out, writer_id);
+}
+
+bool SqliteBackend::replies(int32_t tid, std::vector<int32_t>& out) {
+  return SelectReplies::all(this->_db, out, tid);
+}
+
+bool SqliteBackend::thread(int32_t root_tid, int32_t max_depth, size_t limit, Pond::QuackResults& out,
+                           std::vector<int32_t>& depths) {
+  ThreadRows sink{out, depths};
+  return SelectThread::all(this->_db, sink, root_tid, max_depth, static_cast<int64_t>(limit));
+}
+
+/**
+ * @brief Appends the feed by merging statements that each return their rows in feed
+ *        order, stepping each only when its next row is the newest left.
+ *
+ * If a statement fails, e.g. when the deadline interrupts it, the merge stops there, so
+ * the rows already appended are the newest of the feed in order.
+ */
+bool SqliteBackend::feed(const std::vector<int32_t>& followees, std::vector<FeedEntry>& out) {
+  std::vector<FeedSource> sources;
+  sources.reserve(2 * followees.size());
+  for (int32_t followee : followees) {
+    sources.push_back(FeedSource{followee, false, {}});
+    sources.push_back(FeedSource{followee, true, {}});
+  }
+
+  // The sources with rows left to merge, newest next row on top
+  std::vector<size_t> heap;
+  auto newer = [&sources](size_t a, size_t b) {
+    const FeedEntry& x = sources[a].rows[sources[a].next];
+    const FeedEntry& y = sources[b].rows[sources[b].next];
+    return x.ts != y.ts ? x.ts < y.ts : x.tid < y.tid;
+  };
+  auto push = [&](size_t i) {
+    heap.push_back(i);
+    std::push_heap(heap.begin(), heap.end(), newer);
+  };
+
+  for (size_t i = 0; i < sources.size(); ++i) {
+    if (!sources[i].readPage(this->_db)) {
+      return false;
+    }
+    if (!sources[i].rows.empty()) {
+      push(i);
+    }
+  }
+  while (!heap.empty()) {
+    std::pop_heap(heap.begin(), heap.end(), newer);
+    const size_t i = heap.back();
+    heap.pop_back();
+    FeedSource& source = sources[i];
+    out.push_back(std::move(source.rows[source.next++]));
+    if (source.next == source.rows.size()) {
+      if (source.done) {
+        continue;
+      }
+      if (!source.readPage(this->_db)) {
+        return false;
+      }
+    }
+    if (source.next < source.rows.size()) {
+      push(i);
+    }
+  }
+  return true;
+}
+
+bool SqliteBackend::searchQuacksByHashtag(const std::string& pattern, Pond::QuackResults& out,
+                                          const std::unordered_set<int32_t>& seen) {
+  UniqueQuacks sink{out, seen, nullptr};
+  const std::string folded = fold(pattern);
+  if (folded.find_first_of("%_") != std::string::npos) {
+    return SearchQuacksByTermPattern::all(this->_db, sink, likeToGlob(folded));
+  }
+  std::optional<int64_t> term_id;
+  if (!this->_termID(folded, false, term_id)) {
+    return false;
+  }
+  return !term_id || SearchQuacksByTermID::all(this->_db, sink, *term_id);
+}
+
+bool SqliteBackend::searchQuacksByWord(const std::string& keyword, Pond::QuackResults& out,
+                                       std::unordered_set<int32_t>& seen) {
+  UniqueQuacks sink{out, seen, &seen};
+  const std::string folded = fold(keyword);
+  return SearchQuacksByWord::all(this->_db, sink, folded, "#" + folded);
+}
+
+std::unique_ptr<RowStream<Pond::QuackResults>> SqliteBackend::streamQuacksByHashtag(const std::string& pattern) {
+  const std::string folded = fold(pattern);
+  if (folded.find_first_of("%_") != std::string::npos) {
+    return streamOf<Pond::QuackResults>(SearchQuacksByTermPattern::open(this->_db, likeToGlob(folded)));
+  }
+  std::optional<int64_t> term_id;
+  if (!this->_termID(folded, false, term_id)) {
+    return nullptr;
+  }
+  if (!term_id) {
+    return streamOf<Pond::QuackResults>(std::optional<sql::Cursor<Pond::QuackView>>(std::in_place));
+  }
+  return streamOf<Pond::QuackResults>(SearchQuacksByTermID::open(this->_db, *term_id));
+}
+
+std::unique_ptr<RowStream<Pond::QuackResults>> SqliteBackend::streamQuacksByWord(const std::string& keyword) {
+  const std::string folded = fold(keyword);
+  return streamOf<Pond::QuackResults>(SearchQuacksByWord::open(this->_db, folded, "#" + folded));
+}
+
+std::optional<int64_t> SqliteBackend::countQuacksByHashtag(const std::string& pattern) {
+  const std::string folded = fold(pattern);
+  if (folded.find_first_of("%_") != std::string::npos) {
+    return CountQuacksByTermPattern::one(this->_db, likeToGlob(folded));
+  }
+  std::optional<int64_t> term_id;
+  if (!this->_termID(folded, false, term_id)) {
+    return std::nullopt;
+  }
+  return term_id ? CountQuacksByTermID::one(this->_db, *term_id) : std::optional<int64_t>(0);
+}
+
+std::optional<int64_t> SqliteBackend::countQuacksByWord(const std::string& keyword) {
+  const std::string folded = fold(keyword);
+  return CountQuacksByWord::one(this->_db, folded, "#" + folded);
+}
+
+bool SqliteBackend::hashtagMentionsSince(int64_t since, std::vector<std::pair<int64_t, std::string>>& out) {
+  return SelectHashtagMentionsSince::all(this->_db, out, since);
+}
+
+bool SqliteBackend::hashtagMentionsFrom(int32_t first_tid, std::vector<std::pair<int32_t, std::string>>& out) {
+  return SelectHashtagMentionsFrom::all(this->_db, out, first_tid);
+}
+
+bool SqliteBackend::hashtagsOf(int32_t tid, std::vector<std::string>& out) {
+  return SelectHashtagsOf::all(this->_db, out, tid);
+}
+
+bool SqliteBackend::hashtagHours(const std::string& term, int64_t from_hour, int64_t to_hour,
+                                 std::vector<std::pair<int64_t, int64_t>>& out) {
+  return SelectHashtagHours::all(this->_db, out, fold(term), from_hour, to_hour);
+}
+
+bool SqliteBackend::topHashtagsBetween(int64_t from_hour, int64_t to_hour, size_t limit,
+                                       std::vector<std::pair<std::string, int64_t>>& out) {
+  return SelectTopHashtagsBetween::all(this->_db, out, from_hour, to_hour, static_cast<int64_t>(limit));
+}
+
+/**
+ * @brief Recomputes the rollups in one transaction, so readers see either the old
+ *        counts or the new ones.
+ */
+bool SqliteBackend::rebuildHashtagRollups() {
+  if (!BeginImmediate::exec(this->_db)) {
+    return false;
+  }
+  if (!DeleteHashtagRollups::exec(this->_db) || !BackfillHashtagRollups::exec(this->_db) ||
+      !Commit::exec(this->_db)) {
+    Rollback::exec(this->_db);
+    return false;
+  }
+  return true;
+}
+
+std::optional<int32_t> SqliteBackend::upsertRequack(int32_t tid, int32_t retweeter_id, int32_t spam,
+                                                    const Clock::Stamp& now) {
+  std::vector<int32_t> flags;
+  if (!UpsertRequack::all(this->_db, flags, tid, retweeter_id, spam, now.date, now.ts)) {
+    return std::nullopt;
+  }
+  return flags.empty() ? -1 : flags.front();
+}
+
+/**
+ * @brief Upserts each requack in one immediate transaction, so a batch costs a single
+ *        commit and a failure part way leaves none of it behind.
+ */
+bool SqliteBackend::upsertRequacks(const std::vector<RequackWrite>& requacks, const Clock::Stamp& now,
+                                   std::vector<int32_t>& out) {
+  if (!BeginImmediate::exec(this->_db)) {
+    return false;
+  }
+  const size_t first = out.size();
+  out.reserve(first + requacks.size());
+  for (const RequackWrite& requack : requacks) {
+    std::optional<int32_t> spam = this->upsertRequack(requack.tid, requack.retweeter_id, requack.spam, now);
+    if (!spam) {
+      Rollback::exec(this->_db);
+      out.resize(first);
+      return false;
+    }
+    out.push_back(*spam);
+  }
+  if (!Commit::exec(this->_db)) {
+    Rollback::exec(this->_db);
+    out.resize(first);
+    return false;
+  }
+  return true;
+}
+
+std::optional<int32_t> SqliteBackend::requackCount(int32_t tid) {
+  return CountRequacks::one(this->_db, tid);
+}
+
+std::optional<bool> SqliteBackend::requackedAny(int32_t retweeter_id, const std::vector<int32_t>& tids) {
+  std::optional<int32_t> found = RequackedAny::one(this->_db, retweeter_id, tids);
+  if (!found) {
+    return std::nullopt;
+  }
+  return *found != 0;
+}
+
+std::optional<bool> SqliteBackend::insertHashtag(int32_t tid, const std::string& term) {
+  std::optional<int64_t> term_id;
+  if (!this->_termID(fold(term), true, term_id) || !term_id || !InsertHashtag::exec(this->_db, tid, *term_id)) {
+    return std::nullopt;
+  }
+  // Counts the mention row alone, not the rollup rows its trigger writes
+  return sqlite3_changes(this->_db) > 0;
+}
+
+bool SqliteBackend::insertList(int32_t owner_id, const std::string& lname) {
+  return InsertList::exec(this->_db, owner_id, lname);
+}
+
+bool SqliteBackend::insertListEntry(int32_t owner_id, const std::string& lname, int32_t tid) {
+  return InsertListEntry::exec(this->_db, owner_id, lname, tid);
+}
+
+bool SqliteBackend::listExists(int32_t owner_id, const std::string& lname) {
+  return SelectList::one(this->_db, owner_id, lname).has_value();
+}
+
+bool SqliteBackend::lists(int32_t owner_id, std::vector<Pond::ListSummary>& out) {
+  return SelectLists::all(this->_db, out, owner_id);
+}
+
+bool SqliteBackend::listQuacks(int32_t owner_id, const std::string& lname, const std::optional<Pond::ListCursor>& after,
+                               size_t limit, Pond::QuackResults& out) {
+  if (after) {
+    return SelectListQuacksAfter::all(this->_db, out, owner_id, lname, after->ts, after->tid,
+                                      static_cast<int64_t>(limit));
+  }
+  return SelectListQuacks::all(this->_db, out, owner_id, lname, static_cast<int64_t>(limit));
+}
+
+bool SqliteBackend::userRanks(std::vector<std::pair<int32_t, double>>& out) {
+  return SelectUserRanks::all(this->_db, out);
+}
+
+/**
+ * @brief Swaps in the new scores in one transaction, so searches never see a mix of
+ *        two runs or an empty table.
+ */
+bool SqliteBackend::replaceUserRanks(const std::vector<std::pair<int32_t, double>>& ranks) {
+  if (!BeginImmediate::exec(this->_db)) {
+    return false;
+  }
+  if (!DeleteUserRanks::exec(this->_db) || !InsertUserRanks::exec(this->_db, ranks) || !Commit::exec(this->_db)) {
+    Rollback::exec(this->_db);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Writes a compacted copy of the database to `filename` with `VACUUM INTO`.
+ *
+ * The copy is written to a temporary file and renamed over `filename`, so a failed
+ * copy leaves any previous file in place.
+ *
+ * @param filename The file to write; an existing file is replaced, unless it is the
+ *        open database itself.
+ * @return true if the copy was written.
+ */
+bool SqliteBackend::snapshot(const std::string& filename) {
+  std::error_code error;
+  const char* db_filename = sqlite3_db_filename(this->_db, "main");
+  if (db_filename && *db_filename && std::filesystem::equivalent(db_filename, filename, error)) {
+    return false;
+  }
+
+  // VACUUM INTO refuses to overwrite an existing file
+  const std::string temp_filename = filename + ".tmp";
+  std::remove(temp_filename.c_str());
+  if (!VacuumInto::exec(this->_db, temp_filename) || std::rename(temp_filename.c_str(), filename.c_str()) != 0) {
+    std::remove(temp_filename.c_str());
+    return false;
+  }
+  return true;
+}
+
+std::string SqliteBackend::lastError() const {
+  return this->_db ? sqlite3_errmsg(this->_db) : "no database open";
+}
+
+// =============================================================================
+// Private Methods
+// =============================================================================
+
+/**
+ * @brief Brings the database schema up to date by running any pending migrations.
+ *
+ * Each migration runs in its own transaction together with the `user_version` bump,
+ * so an interrupted upgrade never leaves a half-migrated schema behind.
+ *
+ * @return true if the schema is current; false if a migration failed.
+ */
+bool SqliteBackend::_migrate() {
+  std::optional<int32_t> version = UserVersion::one(this->_db);
+  if (!version) {
+    return false;
+  }
+
+  const int32_t latest = sizeof(MIGRATIONS) / sizeof(MIGRATIONS[0]);
+  for (int32_t v = *version; v < latest; ++v) {
+    std::string script = std::string("BEGIN;") + MIGRATIONS[v] +
+                         "PRAGMA user_version = " + std::to_string(v + 1) + ";COMMIT;";
+    if (sqlite3_exec(this->_db, script.c_str(), nullptr, nullptr, nullptr) != SQLITE_OK) {
+      sqlite3_exec(this->_db, "ROLLBACK", nullptr, nullptr, nullptr);
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Resolves a lower-cased hashtag to its dictionary ID through `_term_ids`.
+ *
+ * IDs are cached only once read back from the database, and dictionary rows are never
+ * deleted, so a cached ID never goes stale.
+ *
+ * @param folded The hashtag, lower-cased.
+ * @param create Add the hashtag to the dictionary if it is missing.
+ * @param term_id Set to the ID; left empty if the hashtag is missing and `create` is unset.
+ * @return false if the database failed.
+ */
+bool SqliteBackend::_termID(const std::string& folded, bool create, std::optional<int64_t>& term_id) {
+  auto cached = this->_term_ids.find(folded);
+  if (cached != this->_term_ids.end()) {
+    term_id = cached->second;
+    return true;
+  }
+  if (create && !InsertTerm::exec(this->_db, folded)) {
+    return false;
+  }
+  std::vector<int64_t> ids;
+  if (!SelectTermID::all(this->_db, ids, folded)) {
+    return false;
+  }
+  if (!ids.empty()) {
+    term_id = ids.front();
+    this->_term_ids.emplace(folded, ids.front());
+  }
+  return true;
+}
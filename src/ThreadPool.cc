@@ -0,0 +1,132 @@
+#include "ThreadPool.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+// =============================================================================
+// Public Methods
+// =============================================================================
+
+/**
+ * @brief Starts the worker threads.
+ *
+ * @param threads The total number of threads to use, counting the caller of
+ *                `parallelFor`; 0 means one per hardware thread.
+ */
+ThreadPool::ThreadPool(size_t threads) {
+  if (threads == 0) {
+    threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+  }
+  for (size_t i = 1; i < threads; ++i) {
+    this->_workers.emplace_back(&ThreadPool::_work, this);
+  }
+}
+
+/**
+ * @brief Finishes queued work and joins the workers.
+ */
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    this->_stopping = true;
+  }
+  this->_ready.notify_all();
+  for (std::thread& worker : this->_workers) {
+    worker.join();
+  }
+}
+
+/**
+ * @brief Calls `body(begin, end)` over disjoint chunks covering `[0, n)` and waits
+ *        for all of them to finish.
+ *
+ * Chunks are claimed from a shared counter, so threads that finish early take more of
+ * the range. One helper task is queued per worker and the caller claims chunks as well.
+ * Once the caller runs out of chunks it only waits for helpers that have started;
+ * helpers that start later find the call finished and return without running `body`,
+ * so nested calls never wait on a queue their own workers are blocking.
+ *
+ * @param n The size of the index range.
+ * @param chunk The number of indexes per chunk; 0 picks about four chunks per thread.
+ * @param body The work for one chunk; called concurrently from several threads.
+ */
+void ThreadPool::parallelFor(size_t n, size_t chunk, const std::function<void(size_t, size_t)>& body) {
+  if (n == 0) {
+    return;
+  }
+  if (chunk == 0) {
+    chunk = std::max<size_t>(1, n / (this->size() * 4));
+  }
+  const size_t chunks = (n + chunk - 1) / chunk;
+  const size_t helpers = std::min(this->_workers.size(), chunks - 1);
+
+  // Shared with queued helpers, which may outlive this call
+  struct Progress {
+    std::atomic<size_t> next{0};
+    size_t active = 0;
+    bool closed = false;
+    std::mutex mutex;
+    std::condition_variable idle;
+  };
+  auto progress = std::make_shared<Progress>();
+  const std::function<void(size_t, size_t)>* work = &body;
+
+  auto claim = [progress, n, chunk, chunks, work]() {
+    for (size_t c; (c = progress->next.fetch_add(1)) < chunks; ) {
+      (*work)(c * chunk, std::min(n, (c + 1) * chunk));
+    }
+  };
+
+  if (helpers > 0) {
+    {
+      std::lock_guard<std::mutex> lock(this->_mutex);
+      for (size_t i = 0; i < helpers; ++i) {
+        this->_tasks.emplace_back([progress, claim]() {
+          {
+            std::lock_guard<std::mutex> lock(progress->mutex);
+            if (progress->closed) {
+              return;
+            }
+            ++progress->active;
+          }
+          claim();
+          std::lock_guard<std::mutex> lock(progress->mutex);
+          if (--progress->active == 0) {
+            progress->idle.notify_one();
+          }
+        });
+      }
+    }
+    this->_ready.notify_all();
+  }
+
+  claim();
+
+  std::unique_lock<std::mutex> lock(progress->mutex);
+  progress->closed = true;
+  progress->idle.wait(lock, [&]() { return progress->active == 0; });
+}
+
+// =============================================================================
+// Private Methods
+// =============================================================================
+
+/**
+ * @brief Runs queued tasks until the pool is destroyed.
+ */
+void ThreadPool::_work() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(this->_mutex);
+      this->_ready.wait(lock, [this]() { return this->_stopping || !this->_tasks.empty(); });
+      if (this->_tasks.empty()) {
+        return;
+      }
+      task = std::move(this->_tasks.front());
+      this->_tasks.pop_front();
+    }
+    task();
+  }
+}
@@ -0,0 +1,145 @@
+#include "Trending.hh"
+
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+using Trend = Trending::Trend;
+
+/**
+ * @brief Orders trends best first: most mentions, then alphabetically.
+ */
+bool better(const Trend& a, const Trend& b) {
+  return a.mentions != b.mentions ? a.mentions > b.mentions : a.hashtag < b.hashtag;
+}
+
+std::string lower(const std::string& text) {
+  std::string folded(text);
+  std::transform(folded.begin(), folded.end(), folded.begin(), [](unsigned char c) {
+    return static_cast<char>(std::tolower(c));
+  });
+  return folded;
+}
+
+} // namespace
+
+// =============================================================================
+// Public Methods
+// =============================================================================
+
+/**
+ * @brief Counts one mention of `hashtag` at `ts` in both windows.
+ */
+void Trending::add(const std::string& hashtag, int64_t ts) {
+  const std::string folded = lower(hashtag);
+  this->_hour.add(folded, ts);
+  this->_day.add(folded, ts);
+}
+
+/**
+ * @brief Returns the most mentioned hashtags within `window` up to `now`.
+ *
+ * Keeps a bounded heap of the best `k` while scanning the window's totals, so a query
+ * costs one pass over the hashtags mentioned within the window.
+ *
+ * @param k The number of hashtags to return.
+ * @param now Microseconds since the Unix epoch; buckets before the window are dropped.
+ * @return Up to `k` hashtags, most mentions first, then alphabetically.
+ */
+std::vector<Trend> Trending::top(Window window, size_t k, int64_t now) {
+  Ring& ring = window == Window::Hour ? this->_hour : this->_day;
+  ring.advance(now);
+
+  std::vector<Trend> heap;
+  if (k == 0) {
+    return heap;
+  }
+  // The front of the heap is the worst trend kept so far
+  for (const auto& [hashtag, mentions] : ring.totals()) {
+    if (heap.size() < k) {
+      heap.push_back(Trend{hashtag, mentions});
+      std::push_heap(heap.begin(), heap.end(), better);
+    } else if (better(Trend{hashtag, mentions}, heap.front())) {
+      std::pop_heap(heap.begin(), heap.end(), better);
+      heap.back() = Trend{hashtag, mentions};
+      std::push_heap(heap.begin(), heap.end(), better);
+    }
+  }
+  std::sort_heap(heap.begin(), heap.end(), better);
+  return heap;
+}
+
+/**
+ * @brief Forgets every mention.
+ */
+void Trending::clear() {
+  this->_hour.clear();
+  this->_day.clear();
+}
+
+// =============================================================================
+// Ring
+// =============================================================================
+
+Trending::Ring::Ring(int64_t bucket_us, size_t buckets)
+  : _bucket_us(bucket_us), _buckets(buckets) {
+}
+
+/**
+ * @brief Counts a mention in the bucket covering `ts`, moving the window forward first
+ *        if `ts` is past the newest bucket.
+ */
+void Trending::Ring::add(const std::string& hashtag, int64_t ts) {
+  const int64_t bucket = ts / this->_bucket_us;
+  const int64_t span = static_cast<int64_t>(this->_buckets.size());
+  if (this->_head != INT64_MIN && bucket <= this->_head - span) {
+    return;  // older than the window
+  }
+  this->advance(ts);
+  ++this->_buckets[bucket % span][hashtag];
+  ++this->_totals[hashtag];
+}
+
+/**
+ * @brief Moves the window forward to end at the bucket covering `ts`, dropping the
+ *        buckets that fall out of it.
+ */
+void Trending::Ring::advance(int64_t ts) {
+  const int64_t bucket = ts / this->_bucket_us;
+  if (this->_head == INT64_MIN) {
+    this->_head = bucket;
+    return;
+  }
+  if (bucket <= this->_head) {
+    return;
+  }
+  // Past a full turn of the ring every bucket is dropped, however far time moved
+  const int64_t span = static_cast<int64_t>(this->_buckets.size());
+  for (int64_t b = this->_head + 1; b <= bucket && b <= this->_head + span; ++b) {
+    this->_expire(b);
+  }
+  this->_head = bucket;
+}
+
+void Trending::Ring::clear() {
+  for (auto& counts : this->_buckets) {
+    counts.clear();
+  }
+  this->_totals.clear();
+  this->_head = INT64_MIN;
+}
+
+/**
+ * @brief Empties the slot that `bucket` reuses, taking its counts off the totals.
+ */
+void Trending::Ring::_expire(int64_t bucket) {
+  auto& counts = this->_buckets[bucket % static_cast<int64_t>(this->_buckets.size())];
+  for (const auto& [hashtag, mentions] : counts) {
+    auto total = this->_totals.find(hashtag);
+    if ((total->second -= mentions) == 0) {
+      this->_totals.erase(total);
+    }
+  }
+  counts.clear();
+}
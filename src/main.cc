@@ -10,6 +10,8 @@
  * This function initializes the Quacker application with a database file
  * specified via command-line arguments. It checks for proper usage and
  * the existence of the provided file before proceeding.
+ *
+ * Usage: quacker [--record <log>] <filename>
  * 
  * @param argc Number of command-line arguments.
  * @param argv Array of command-line argument strings.
@@ -17,14 +19,21 @@
  *         ERROR_FILE if the file is not found, or 0 for success.
  */
 int main(int argc, char* argv[]) {
+  std::string record_filename;
+  if (argc == 4 && std::string(argv[1]) == "--record") {
+    record_filename = argv[2];
+    argv += 2;
+    argc -= 2;
+  }
+
   if (argc != 2) {
-    std::cerr << "Incorrect Usage: Expected quacker <filename>" << std::endl;
+    std::cerr << "Incorrect Usage: Expected quacker [--record <log>] <filename>" << std::endl;
     return ERROR_USAGE;
   } else if (!std::filesystem::exists(argv[1])) {
     std::cerr << "File Not Found: Cannot find database " << argv[1] << std::endl;
     return ERROR_FILE;
   }
   
-  Quacker quacker(argv[1]);
+  Quacker quacker(argv[1], record_filename);
   quacker.run();
 }
\ No newline at end of file
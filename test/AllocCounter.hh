@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @class AllocCounter
+ * @brief Counts the heap allocations made through the global `operator new`, for tests
+ *        that bound how much a call allocates.
+ *
+ * Linking AllocCounter.cc into a binary replaces every form of the global `operator new`
+ * with one that counts, per thread, before handing the request to `malloc`. Allocations
+ * SQLite makes through its own allocator are not counted.
+ */
+class AllocCounter
+{
+public:
+
+  /**
+   * @brief Returns the allocations made so far by the calling thread.
+   */
+  static uint64_t count();
+};
@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "AllocCounter.hh"
+#include "Pond.hh"
+
+namespace {
+
+// Calls measured per engine after the warm-up, and calls made first so the engine's
+// containers and statement cache reach a steady state
+const int CALLS = 200;
+const int WARM_UP = 20;
+
+// Quacks carol writes for the read calls, each with a word no other quack has
+const int READ_QUACKS = 10;
+
+/**
+ * @brief The most heap allocations a Pond call may make, on average and in any single
+ *        call, on either engine, with the short arguments used here.
+ *
+ * The average catches one more allocation on every call; the maximum catches a call
+ * that only sometimes allocates far more, and leaves room for the occasional call that
+ * grows a container. Reads return `READ_QUACKS` quacks or feed lines. Raise a limit only
+ * for an allocation the call needs.
+ */
+struct Limit {
+  const char* call;
+  double average;
+  uint64_t most;
+};
+
+const Limit LIMITS[] = {
+  {"addUser", 10, 14},
+  {"checkLogin", 0, 0},
+  {"addQuack", 18, 28},
+  {"addReply", 17, 24},
+  {"follow", 1, 1},
+  {"unfollow", 1, 1},
+  {"addRequack", 3, 5},
+  {"getQuacks", 14, 14},
+  {"getFeed", 90, 90},
+  {"searchForQuacks", 31, 31},
+  {"searchForUsers", 3, 3},
+  {"getReplies", 1, 1},
+  {"getQuackFromID", 4, 4},
+  {"getFollowers", 2, 2},
+};
+
+/**
+ * @brief The arguments of every measured call, built before measuring so only the calls'
+ *        own allocations are counted.
+ */
+struct Args {
+  std::vector<std::string> names;
+  std::vector<std::string> emails;
+  std::string password = "password";
+  std::string quack = "quacking along at the pond";
+  std::string reply = "a reply from the pond";
+  std::string read_word = "quackenbush";
+  std::string reader_name = "carol";
+
+  Args() {
+    for (int i = 0; i < WARM_UP + CALLS; ++i) {
+      names.push_back("duck" + std::to_string(i));
+      emails.push_back("duck" + std::to_string(i) + "@example.com");
+    }
+  }
+};
+
+/**
+ * @brief The users and quacks the measured calls act on.
+ *
+ * alice and bob take the writes. carol's quacks and dave, who only follows carol, are
+ * left alone by them, so the reads return the same `READ_QUACKS` results throughout.
+ */
+struct Fixture {
+  int32_t alice;
+  int32_t bob;
+  int32_t carol;
+  int32_t dave;
+  int32_t quack_id;                // alice's quack that bob replies to
+  int32_t read_quack_id;           // carol's quack with `READ_QUACKS` replies
+  std::vector<int32_t> requacks;   // alice's quacks for bob to requack, one per call
+};
+
+/**
+ * @brief Runs call `i` of the named kind.
+ */
+void run(Pond& pond, const std::string& call, int i, const Args& args, const Fixture& f) {
+  if (call == "addUser") {
+    pond.addUser(args.names[i], args.emails[i], 5550100 + i, args.password);
+  } else if (call == "checkLogin") {
+    pond.checkLogin(f.alice, args.password);
+  } else if (call == "addQuack") {
+    pond.addQuack(f.alice, args.quack);
+  } else if (call == "addReply") {
+    pond.addReply(f.bob, f.quack_id, args.reply);
+  } else if (call == "follow") {
+    pond.follow(f.alice, f.bob);
+  } else if (call == "unfollow") {
+    pond.unfollow(f.alice, f.bob);
+  } else if (call == "addRequack") {
+    pond.addRequack(f.bob, f.requacks[i]);
+  } else if (call == "getQuacks") {
+    pond.getQuacks(f.carol);
+  } else if (call == "getFeed") {
+    pond.getFeed(f.dave);
+  } else if (call == "searchForQuacks") {
+    pond.searchForQuacks(args.read_word);
+  } else if (call == "searchForUsers") {
+    pond.searchForUsers(args.reader_name);
+  } else if (call == "getReplies") {
+    pond.getReplies(f.read_quack_id);
+  } else if (call == "getQuackFromID") {
+    pond.getQuackFromID(f.read_quack_id);
+  } else if (call == "getFollowers") {
+    pond.getFollowers(f.carol);
+  }
+}
+
+/**
+ * @brief Measures every call in `LIMITS` on one engine.
+ *
+ * @return The number of calls over their limit.
+ */
+int checkEngine(Pond& pond, const std::string& engine) {
+  const Args args;
+  Fixture f;
+  f.alice = *pond.addUser("alice", "alice@example.com", 5550001, args.password);
+  f.bob = *pond.addUser("bob", "bob@example.com", 5550002, args.password);
+  f.carol = *pond.addUser(args.reader_name, "carol@example.com", 5550003, args.password);
+  f.dave = *pond.addUser("dave", "dave@example.com", 5550004, args.password);
+  f.quack_id = *pond.addQuack(f.alice, args.quack);
+  for (int i = 0; i < WARM_UP + CALLS; ++i) {
+    f.requacks.push_back(*pond.addQuack(f.alice, "quack number " + std::to_string(i) + " to requack"));
+  }
+  for (int i = 0; i < READ_QUACKS; ++i) {
+    f.read_quack_id = *pond.addQuack(f.carol, args.read_word + " at the marsh, take " + std::to_string(i));
+  }
+  for (int i = 0; i < READ_QUACKS; ++i) {
+    pond.addReply(f.dave, f.read_quack_id, "reply " + std::to_string(i));
+  }
+  pond.follow(f.dave, f.carol);
+
+  int over = 0;
+  for (const Limit& limit : LIMITS) {
+    const std::string call = limit.call;
+    uint64_t most = 0;
+    uint64_t total = 0;
+    for (int i = 0; i < WARM_UP + CALLS; ++i) {
+      // follow and unfollow alternate, so each measures a real change
+      if (call == "follow" && i > 0) {
+        pond.unfollow(f.alice, f.bob);
+      } else if (call == "unfollow") {
+        pond.follow(f.alice, f.bob);
+      }
+      const uint64_t before = AllocCounter::count();
+      run(pond, call, i, args, f);
+      const uint64_t allocations = AllocCounter::count() - before;
+      if (i >= WARM_UP) {
+        most = std::max(most, allocations);
+        total += allocations;
+      }
+    }
+
+    const double average = static_cast<double>(total) / CALLS;
+    const bool ok = average <= limit.average && most <= limit.most;
+    std::cout << (ok ? "ok    " : "FAIL  ") << std::setw(8) << std::left << engine << std::setw(17)
+              << call << "avg " << std::setw(7) << std::fixed << std::setprecision(2) << average
+              << "max " << std::setw(5) << most << "limits " << std::setprecision(0) << limit.average
+              << "/" << limit.most << "\n";
+    if (!ok) {
+      ++over;
+    }
+  }
+  return over;
+}
+
+} // namespace
+
+/**
+ * @brief Bounds the heap allocations of Pond's hot reads and writes on both storage
+ *        engines.
+ *
+ * Usage: alloc-test
+ *
+ * Each call in `LIMITS` is made repeatedly after a warm-up, and the average and the
+ * largest allocations per call are checked against its limits. The SQLite engine runs on a scratch copy of
+ * test/test.db.
+ */
+int main() {
+  int over = 0;
+
+  Pond memory;
+  if (!memory.loadMemory("")) {
+    return 1;
+  }
+  over += checkEngine(memory, "memory");
+
+  const std::filesystem::path scratch = std::filesystem::temp_directory_path() / "quacker-alloc-test.db";
+  std::filesystem::copy_file("test/test.db", scratch, std::filesystem::copy_options::overwrite_existing);
+  {
+    Pond sqlite;
+    if (sqlite.loadDatabase(scratch.string())) {
+      return 1;
+    }
+    over += checkEngine(sqlite, "sqlite");
+  }
+  std::filesystem::remove(scratch);
+
+  return over ? 1 : 0;
+}
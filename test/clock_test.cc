@@ -0,0 +1,139 @@
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "AllocCounter.hh"
+#include "Clock.hh"
+#include "Pond.hh"
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+  std::cout << (ok ? "ok    " : "FAIL  ") << what << "\n";
+  if (!ok) {
+    ++failures;
+  }
+}
+
+/**
+ * @brief The current wall-clock second, read from the system clock rather than `Clock`,
+ *        whose `ts` can run ahead of it in a tight loop and whose reads re-render its
+ *        cached strings.
+ */
+std::time_t wallSecond() {
+  return std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+}
+
+/**
+ * @brief Spins until the wall clock enters a new second, so the next `Clock::now()`
+ *        re-renders the thread's cached date and time.
+ */
+void waitForNextSecond() {
+  const std::time_t second = wallSecond();
+  while (wallSecond() == second) {
+  }
+}
+
+/**
+ * @brief Takes timestamps until two wall-clock second boundaries have passed, checking
+ *        that none allocates and that `ts` only grows.
+ */
+void checkNow() {
+  Clock::now();  // the first call on a thread renders its strings
+
+  const uint64_t before = AllocCounter::count();
+  const std::time_t last_second = wallSecond() + 2;
+  Clock::Stamp previous = Clock::now();
+  size_t calls = 0;
+  bool increasing = true;
+  bool formatted = true;
+  while (wallSecond() <= last_second) {
+    Clock::Stamp stamp = Clock::now();
+    increasing = increasing && stamp.ts > previous.ts;
+    formatted = formatted && std::strlen(stamp.date) == 10 && std::strlen(stamp.time) == 8;
+    previous = stamp;
+    ++calls;
+  }
+  const uint64_t allocations = AllocCounter::count() - before;
+
+  check(allocations == 0, "Clock::now() made " + std::to_string(allocations) + " allocations over " +
+                          std::to_string(calls) + " calls spanning two seconds");
+  check(increasing, "Clock::now() ts strictly increases");
+  check(formatted, "Clock::now() date and time are YYYY-MM-DD and HH:MM:SS");
+}
+
+/**
+ * @brief Runs a fixed sequence of timestamped writes on a fresh in-memory Pond and
+ *        returns the allocations of each.
+ *
+ * @param new_second Start every write in a new second, so its timestamp re-renders the
+ *        cached strings instead of copying them.
+ */
+std::vector<uint64_t> writeAllocations(bool new_second) {
+  Pond pond;
+  pond.loadMemory("");
+  const int32_t alice = *pond.addUser("alice", "alice@example.com", 5550100, "password");
+  const int32_t bob = *pond.addUser("bob", "bob@example.com", 5550101, "password");
+  const std::string text = "quacking along at the pond";
+
+  // Let the engine's containers reach a steady size first
+  for (int i = 0; i < 4; ++i) {
+    pond.addQuack(alice, text);
+    pond.follow(alice, bob);
+    pond.unfollow(alice, bob);
+  }
+
+  std::vector<uint64_t> counts;
+  for (int i = 0; i < 3; ++i) {
+    if (new_second) {
+      waitForNextSecond();
+    }
+    uint64_t before = AllocCounter::count();
+    pond.addQuack(alice, text);
+    counts.push_back(AllocCounter::count() - before);
+
+    if (new_second) {
+      waitForNextSecond();
+    }
+    before = AllocCounter::count();
+    pond.follow(alice, bob);
+    counts.push_back(AllocCounter::count() - before);
+
+    pond.unfollow(alice, bob);
+  }
+  return counts;
+}
+
+/**
+ * @brief Checks that the timestamps `addQuack` and `follow` take add no allocations:
+ *        writes that each start a new second, and so re-render the clock's strings,
+ *        allocate exactly as much as the same writes within one second.
+ */
+void checkWrites() {
+  const std::vector<uint64_t> cached = writeAllocations(false);
+  const std::vector<uint64_t> rendered = writeAllocations(true);
+  std::string counts;
+  for (size_t i = 0; i < cached.size(); ++i) {
+    counts += " " + std::to_string(cached[i]) + "/" + std::to_string(rendered[i]);
+  }
+  check(cached == rendered, "addQuack/follow allocate the same with cached and re-rendered timestamps:" + counts);
+}
+
+} // namespace
+
+/**
+ * @brief Checks that taking timestamps never touches the heap, alone or on Pond's write
+ *        path.
+ *
+ * Usage: clock-test
+ */
+int main() {
+  checkNow();
+  checkWrites();
+  return failures ? 1 : 0;
+}
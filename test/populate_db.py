@@ -1,7 +1,13 @@
 import sqlite3
+from datetime import datetime, timezone
 from faker import Faker
 import random
 
+def to_ts(day, clock="00:00:00"):
+    # microseconds since the Unix epoch (UTC), matching Pond's ts columns
+    moment = datetime.strptime(f"{day} {clock}", "%Y-%m-%d %H:%M:%S").replace(tzinfo=timezone.utc)
+    return int(moment.timestamp()) * 1000000
+
 def populate_db(db_name, user_count=100, tweet_count=500, list_count=200, follow_count=300):
     conn = sqlite3.connect(db_name)
     cursor = conn.cursor()
@@ -66,12 +72,12 @@ def populate_db(db_name, user_count=100, tweet_count=500, list_count=200, follow
         ttime = fake.time()
         replyto_tid = random.choice([None] + list(range(1, tid)))
         
-        tweets.append((tid, writer_id, text, tdate, ttime, replyto_tid))
+        tweets.append((tid, writer_id, text, tdate, ttime, replyto_tid, to_ts(tdate, ttime)))
         
         for term in hashtags_in_tweet:
             hashtags.append((tid, term))
     
-    cursor.executemany("INSERT INTO tweets (tid, writer_id, text, tdate, ttime, replyto_tid) VALUES (?, ?, ?, ?, ?, ?)", tweets)
+    cursor.executemany("INSERT INTO tweets (tid, writer_id, text, tdate, ttime, replyto_tid, ts) VALUES (?, ?, ?, ?, ?, ?, ?)", tweets)
     cursor.executemany("INSERT INTO hashtag_mentions (tid, term) VALUES (?, ?)", hashtags)
     
     # Generate retweets
@@ -84,8 +90,8 @@ def populate_db(db_name, user_count=100, tweet_count=500, list_count=200, follow
         writer_id = tweets[tid - 1][1]
         spam = random.randint(0, 1)
         rdate = fake.date_between(start_date='-1y', end_date='today')
-        retweets.append((tid, retweeter_id, writer_id, spam, rdate))
-    cursor.executemany("INSERT INTO retweets (tid, retweeter_id, writer_id, spam, rdate) VALUES (?, ?, ?, ?, ?)", retweets)
+        retweets.append((tid, retweeter_id, writer_id, spam, rdate, to_ts(rdate, tweets[tid - 1][4])))
+    cursor.executemany("INSERT INTO retweets (tid, retweeter_id, writer_id, spam, rdate, ts) VALUES (?, ?, ?, ?, ?, ?)", retweets)
 
     # Generate include data
     includes = []
@@ -0,0 +1,67 @@
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "definitions.hh"
+#include "Pond.hh"
+
+/**
+ * @brief Reports the groups of near-duplicate quacks in a Quacker database.
+ *
+ * Usage: quacker-dedup [--distance N] <database>
+ *
+ * Compares the SimHash fingerprints of every quack, in parallel across cores, and
+ * groups quacks whose fingerprints are at most N bits apart (default
+ * `SimHashIndex::DEFAULT_DISTANCE`, at most `SimHashIndex::MAX_DISTANCE`). Prints the
+ * quacks compared, the groups found, the time spent comparing and the largest groups
+ * with the text of their first quack.
+ */
+int main(int argc, char* argv[]) {
+  int distance = SimHashIndex::DEFAULT_DISTANCE;
+  std::vector<std::string> positional;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--distance") == 0 && i + 1 < argc) {
+      distance = std::atoi(argv[++i]);
+    } else {
+      positional.push_back(argv[i]);
+    }
+  }
+
+  if (positional.size() != 1 || distance < 0) {
+    std::cerr << "Incorrect Usage: Expected quacker-dedup [--distance N] <database>" << std::endl;
+    return ERROR_USAGE;
+  } else if (!std::filesystem::exists(positional[0])) {
+    std::cerr << "File Not Found: Cannot find database " << positional[0] << std::endl;
+    return ERROR_FILE;
+  }
+
+  Pond pond;
+  if (pond.loadDatabase(positional[0])) {
+    return ERROR_FILE;
+  }
+  std::optional<Pond::DuplicateReport> report = pond.duplicateReport(distance);
+  if (!report) {
+    std::cerr << "SQL Error: Could not read quacks from " << positional[0] << std::endl;
+    return ERROR_SQL;
+  }
+
+  size_t copies = 0;
+  for (const std::vector<int32_t>& group : report->groups) {
+    copies += group.size();
+  }
+  std::cout << "Compared " << report->quacks << " quacks (" << report->fingerprints
+            << " distinct fingerprints) within " << report->max_distance << " bits\n"
+            << report->groups.size() << " groups of near copies covering " << copies << " quacks\n"
+            << std::fixed << std::setprecision(3) << report->seconds << " s comparing\n";
+  for (size_t i = 0; i < report->groups.size() && i < 10; ++i) {
+    const std::vector<int32_t>& group = report->groups[i];
+    std::cout << "  " << std::setw(8) << std::right << group.size() << "  "
+              << pond.getQuackFromID(group.front()).text << "\n";
+  }
+  return 0;
+}
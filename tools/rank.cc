@@ -0,0 +1,58 @@
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "definitions.hh"
+#include "Pond.hh"
+
+/**
+ * @brief Recomputes the influence scores of every user in a Quacker database.
+ *
+ * Usage: quacker-rank [--cold] <database>
+ *
+ * Runs PageRank over the follow graph and replaces the `user_rank` table. By default
+ * the iteration starts from the scores already stored, so a rerun after a modest
+ * number of follow changes needs fewer iterations; `--cold` starts from uniform
+ * scores. Prints the graph size, the iterations run, the final residual and the time
+ * spent iterating.
+ */
+int main(int argc, char* argv[]) {
+  bool cold = false;
+  std::vector<std::string> positional;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--cold") == 0) {
+      cold = true;
+    } else {
+      positional.push_back(argv[i]);
+    }
+  }
+
+  if (positional.size() != 1) {
+    std::cerr << "Incorrect Usage: Expected quacker-rank [--cold] <database>" << std::endl;
+    return ERROR_USAGE;
+  } else if (!std::filesystem::exists(positional[0])) {
+    std::cerr << "File Not Found: Cannot find database " << positional[0] << std::endl;
+    return ERROR_FILE;
+  }
+
+  Pond pond;
+  if (pond.loadDatabase(positional[0])) {
+    return ERROR_FILE;
+  }
+  std::optional<Pond::RankReport> report = pond.rankUsers(!cold);
+  if (!report) {
+    std::cerr << "SQL Error: Could not rank users in " << positional[0] << std::endl;
+    return ERROR_SQL;
+  }
+
+  std::cout << "Ranked " << report->users << " users over " << report->edges << " follows ("
+            << (report->warm_start ? "warm start" : "cold start") << ")\n"
+            << report->iterations << " iterations, residual " << std::scientific << std::setprecision(2)
+            << report->residual << (report->converged ? " (converged)" : " (iteration cap reached)") << "\n"
+            << std::fixed << std::setprecision(3) << report->seconds << " s iterating\n";
+  return 0;
+}
@@ -0,0 +1,351 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AllocCounter.hh"
+#include "definitions.hh"
+#include "Pond.hh"
+#include "Recorder.hh"
+
+namespace {
+
+/**
+ * @brief Latency samples collected for one Pond method during a replay.
+ */
+struct OpStats {
+  std::vector<int64_t> replay_us;
+  int64_t recorded_us = 0;
+  uint64_t allocations = 0;
+  uint32_t result_mismatches = 0;
+};
+
+int64_t argInt(const Recorder::Entry& entry, size_t i) {
+  return i < entry.args.size() ? entry.args[i].number : 0;
+}
+
+std::string argText(const Recorder::Entry& entry, size_t i) {
+  return i < entry.args.size() ? entry.args[i].text : std::string();
+}
+
+/**
+ * @brief Rebuilds the deadline of a recorded call from the microseconds it had left,
+ *        or -1 for one without a time limit.
+ */
+Deadline replayDeadline(int64_t remaining_us) {
+  if (remaining_us < 0) {
+    return Deadline();
+  }
+  return Deadline(std::chrono::microseconds(remaining_us));
+}
+
+/**
+ * @brief Re-executes one recorded call against a Pond.
+ *
+ * Passwords were recorded as stand-ins of `Recorder::SECRET_CHAR`, so users the replay
+ * creates get the stand-in as their password and the recorded logins of those users
+ * succeed as they did originally. Logins of users already in the database fail.
+ *
+ * @return The result size of the replayed call, comparable to the recorded one.
+ */
+size_t dispatch(Pond& pond, const Recorder::Entry& entry) {
+  using Op = Recorder::Op;
+  switch (entry.op) {
+    case Op::AddUser:
+      return pond.addUser(argText(entry, 0), argText(entry, 1), argInt(entry, 2), argText(entry, 3)).has_value();
+    case Op::AddHashtag:
+      return pond.addHashtag(argInt(entry, 0), argText(entry, 1));
+    case Op::ValidateQuack:
+      return pond.validateQuack(argInt(entry, 0), argText(entry, 1));
+    case Op::AddQuack:
+      return pond.addQuack(argInt(entry, 0), argText(entry, 1)).has_value();
+    case Op::AddReply:
+      return pond.addReply(argInt(entry, 0), argInt(entry, 1), argText(entry, 2)).has_value();
+    case Op::AddRequack: {
+      int32_t status = pond.addRequack(argInt(entry, 0), argInt(entry, 1));
+      return status != 3;
+    }
+    case Op::AddRequacks: {
+      std::vector<std::pair<int32_t, int32_t>> requacks;
+      std::string pairs = argText(entry, 0);
+      for (size_t at = 0; at < pairs.size();) {
+        size_t end = std::min(pairs.find(',', at), pairs.size());
+        size_t colon = pairs.find(':', at);
+        requacks.emplace_back(std::atoi(pairs.substr(at, colon - at).c_str()),
+                              std::atoi(pairs.substr(colon + 1, end - colon - 1).c_str()));
+        at = end + 1;
+      }
+      return pond.addRequacks(requacks).size();
+    }
+    case Op::AddToList:
+      return pond.addToList(argText(entry, 0), argInt(entry, 1), argInt(entry, 2));
+    case Op::CreateList:
+      return pond.createList(argInt(entry, 0), argText(entry, 1));
+    case Op::CheckLogin:
+      return pond.checkLogin(argInt(entry, 0), argText(entry, 1)).has_value();
+    case Op::Follow:
+      return pond.follow(argInt(entry, 0), argInt(entry, 1));
+    case Op::Unfollow:
+      return pond.unfollow(argInt(entry, 0), argInt(entry, 1));
+    case Op::SearchForUsers:
+      return pond.searchForUsers(argText(entry, 0)).size();
+    case Op::SearchForQuacks:
+      return pond.searchForQuacks(argText(entry, 0)).size();
+    case Op::GetFeed:
+      return pond.getFeed(argInt(entry, 0)).size();
+    case Op::GetRequackCount:
+      pond.getRequackCount(argInt(entry, 0));
+      return 1;
+    case Op::GetReplies:
+      return pond.getReplies(argInt(entry, 0)).size();
+    case Op::GetUsername:
+      return !pond.getUsername(argInt(entry, 0)).empty();
+    case Op::GetQuackFromID:
+      return pond.getQuackFromID(argInt(entry, 0)).tid == argInt(entry, 0);
+    case Op::GetFollowers:
+      return pond.getFollowers(argInt(entry, 0)).size();
+    case Op::GetFollows:
+      return pond.getFollows(argInt(entry, 0)).size();
+    case Op::GetQuacks:
+      return pond.getQuacks(argInt(entry, 0)).size();
+    case Op::SearchQuackViews:
+      return pond.searchQuackViews(argText(entry, 0)).size();
+    case Op::GetQuackViews:
+      return pond.getQuackViews(argInt(entry, 0)).size();
+    case Op::GetQuackViewFromID:
+      return pond.getQuackViewFromID(argInt(entry, 0)).size();
+    case Op::SuggestFollows:
+      return pond.suggestFollows(argInt(entry, 0), argInt(entry, 1)).size();
+    case Op::PrecomputeSuggestions:
+      return pond.precomputeSuggestions(argInt(entry, 0));
+    case Op::FollowDistance:
+      return pond.followDistance(argInt(entry, 0), argInt(entry, 1), argInt(entry, 2)).size();
+    case Op::RankUsers: {
+      std::optional<Pond::RankReport> report = pond.rankUsers(argInt(entry, 0) != 0);
+      return report ? report->iterations : 0;
+    }
+    case Op::TrendingHashtags:
+      return pond.trendingHashtags(static_cast<Trending::Window>(argInt(entry, 0)), argInt(entry, 1)).size();
+    case Op::HashtagSeries:
+      return pond.hashtagSeries(argText(entry, 0), argInt(entry, 1), argInt(entry, 2)).size();
+    case Op::TopHashtags:
+      return pond.topHashtags(argInt(entry, 0), argInt(entry, 1), argInt(entry, 2)).size();
+    case Op::BackfillHashtagRollups:
+      return pond.backfillHashtagRollups();
+    case Op::SearchHashtags:
+      return pond.searchHashtags(argText(entry, 0)).size();
+    case Op::SearchRanked: {
+      std::optional<SearchIndex::Cursor> after;
+      if (argInt(entry, 2)) {
+        const int64_t bits = argInt(entry, 3);
+        double score;
+        std::memcpy(&score, &bits, sizeof(score));
+        after = SearchIndex::Cursor{score, static_cast<int32_t>(argInt(entry, 4)), argInt(entry, 5)};
+      }
+      return pond.searchRanked(argText(entry, 0), argInt(entry, 1), after).quacks.size();
+    }
+    case Op::OpenQuackSearch:
+      pond.openQuackSearch(argText(entry, 0));
+      return 0;
+    case Op::OpenUserSearch:
+      pond.openUserSearch(argText(entry, 0));
+      return 0;
+    case Op::CountQuackMatches:
+      return pond.countQuackMatches(argText(entry, 0)).value_or(0);
+    case Op::CountUserMatches:
+      return pond.countUserMatches(argText(entry, 0)).value_or(0);
+    case Op::CompleteHashtag:
+      return static_cast<int64_t>(pond.completeHashtag(argText(entry, 0), static_cast<size_t>(argInt(entry, 1))).size());
+    case Op::CompleteUsername:
+      return static_cast<int64_t>(pond.completeUsername(argText(entry, 0), static_cast<size_t>(argInt(entry, 1))).size());
+    case Op::SearchForUsersWithin: {
+      Deadline deadline = replayDeadline(argInt(entry, 1));
+      return pond.searchForUsers(argText(entry, 0), deadline).results.size();
+    }
+    case Op::SearchForQuacksWithin: {
+      Deadline deadline = replayDeadline(argInt(entry, 1));
+      return pond.searchForQuacks(argText(entry, 0), deadline).results.size();
+    }
+    case Op::SearchQuackViewsWithin: {
+      Deadline deadline = replayDeadline(argInt(entry, 1));
+      return pond.searchQuackViews(argText(entry, 0), deadline).results.size();
+    }
+    case Op::GetFeedWithin: {
+      Deadline deadline = replayDeadline(argInt(entry, 1));
+      return pond.getFeed(argInt(entry, 0), deadline).results.size();
+    }
+    case Op::GetThread:
+      return pond.getThread(argInt(entry, 0), argInt(entry, 1), argInt(entry, 2)).quacks.size();
+    case Op::GetLists:
+      return pond.getLists(argInt(entry, 0)).size();
+    case Op::GetListQuacks: {
+      std::optional<Pond::ListCursor> after;
+      if (argInt(entry, 2)) {
+        after = Pond::ListCursor{argInt(entry, 3), static_cast<int32_t>(argInt(entry, 4))};
+      }
+      return pond.getListQuacks(argInt(entry, 0), argText(entry, 1), after, argInt(entry, 5)).quacks.size();
+    }
+    case Op::FindNearDuplicates:
+      return pond.findNearDuplicates(argText(entry, 0), argInt(entry, 1), argInt(entry, 2)).size();
+    case Op::DuplicateReport: {
+      std::optional<Pond::DuplicateReport> report = pond.duplicateReport(argInt(entry, 0));
+      return report ? report->groups.size() : 0;
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief Replays every `sessions`-th entry of the log, starting at `session`, on its own connection.
+ *
+ * Each session keeps the relative order of its calls. When `paced` is set the session waits
+ * until each call's original offset from the start of the log before issuing it. With
+ * `memory` the session runs on its own in-memory copy of the database.
+ */
+void runSession(const std::string& db_filename, const std::vector<Recorder::Entry>& entries,
+                size_t session, size_t sessions, bool paced, bool memory,
+                std::chrono::steady_clock::time_point start, std::map<Recorder::Op, OpStats>& stats) {
+  Pond pond;
+  if (memory ? !pond.loadMemory(db_filename) : pond.loadDatabase(db_filename) != 0) {
+    return;
+  }
+
+  for (size_t i = session; i < entries.size(); i += sessions) {
+    const Recorder::Entry& entry = entries[i];
+    if (paced) {
+      std::this_thread::sleep_until(start + std::chrono::microseconds(entry.offset_us));
+    }
+
+    OpStats& op_stats = stats[entry.op];
+    uint64_t allocations_before = AllocCounter::count();
+    auto begin = std::chrono::steady_clock::now();
+    size_t result_size = dispatch(pond, entry);
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - begin).count();
+    op_stats.allocations += AllocCounter::count() - allocations_before;
+
+    op_stats.replay_us.push_back(elapsed);
+    op_stats.recorded_us += entry.duration_us;
+    if (result_size != entry.result_size) {
+      ++op_stats.result_mismatches;
+    }
+  }
+}
+
+int64_t percentile(std::vector<int64_t>& samples, double p) {
+  if (samples.empty()) {
+    return 0;
+  }
+  size_t index = static_cast<size_t>(p * (samples.size() - 1));
+  std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+  return samples[index];
+}
+
+} // namespace
+
+/**
+ * @brief Replays a log captured with `quacker --record` against another database.
+ *
+ * Usage: quacker-replay [--paced] [--sessions N] [--memory] <log> <database>
+ *
+ * By default calls are issued as fast as possible; `--paced` keeps the original
+ * inter-arrival times. `--sessions N` spreads the calls round-robin over N connections
+ * running in parallel. `--memory` replays against the in-memory engine, seeded from the
+ * database, to show how much of each call's latency is spent in SQLite. A per-method report is printed when the replay finishes with the
+ * replay latency next to the latency originally recorded, and the average number of heap
+ * allocations each call made.
+ */
+int main(int argc, char* argv[]) {
+  bool paced = false;
+  bool memory = false;
+  size_t sessions = 1;
+  std::vector<std::string> positional;
+
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--paced") == 0) {
+      paced = true;
+    } else if (std::strcmp(argv[i], "--memory") == 0) {
+      memory = true;
+    } else if (std::strcmp(argv[i], "--sessions") == 0 && i + 1 < argc) {
+      sessions = std::max(1, std::atoi(argv[++i]));
+    } else {
+      positional.push_back(argv[i]);
+    }
+  }
+
+  if (positional.size() != 2) {
+    std::cerr << "Incorrect Usage: Expected quacker-replay [--paced] [--sessions N] [--memory] <log> <database>" << std::endl;
+    return ERROR_USAGE;
+  } else if (!std::filesystem::exists(positional[1])) {
+    std::cerr << "File Not Found: Cannot find database " << positional[1] << std::endl;
+    return ERROR_FILE;
+  }
+
+  std::vector<Recorder::Entry> entries;
+  if (!Recorder::readLog(positional[0], entries)) {
+    std::cerr << "Log Error: " << positional[0] << " is not a Quacker call log" << std::endl;
+    return ERROR_FILE;
+  }
+
+  if (memory) {
+    // The in-memory engine only reads the file, so bring its schema up to date first
+    Pond pond;
+    if (pond.loadDatabase(positional[1])) {
+      return ERROR_FILE;
+    }
+  }
+
+  std::vector<std::map<Recorder::Op, OpStats>> session_stats(sessions);
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t s = 0; s < sessions; ++s) {
+    threads.emplace_back(runSession, std::cref(positional[1]), std::cref(entries), s, sessions,
+                         paced, memory, start, std::ref(session_stats[s]));
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  // Merge the per-session samples
+  std::map<Recorder::Op, OpStats> stats;
+  for (auto& per_session : session_stats) {
+    for (auto& [op, op_stats] : per_session) {
+      OpStats& merged = stats[op];
+      merged.replay_us.insert(merged.replay_us.end(), op_stats.replay_us.begin(), op_stats.replay_us.end());
+      merged.recorded_us += op_stats.recorded_us;
+      merged.allocations += op_stats.allocations;
+      merged.result_mismatches += op_stats.result_mismatches;
+    }
+  }
+
+  std::cout << "Replayed " << entries.size() << " calls in " << std::fixed << std::setprecision(3)
+            << wall_s << " s (" << std::setprecision(0) << (wall_s > 0 ? entries.size() / wall_s : 0)
+            << " calls/s, " << sessions << (sessions == 1 ? " session" : " sessions")
+            << (paced ? ", paced" : ", max speed") << (memory ? ", in-memory" : "") << ")\n\n";
+  std::cout << std::left << std::setw(23) << "method" << std::right
+            << std::setw(8) << "calls" << std::setw(14) << "recorded avg"
+            << std::setw(12) << "replay avg" << std::setw(10) << "p50" << std::setw(10) << "p99"
+            << std::setw(13) << "allocs/call" << std::setw(12) << "mismatches" << "\n";
+  for (auto& [op, op_stats] : stats) {
+    size_t calls = op_stats.replay_us.size();
+    int64_t total = 0;
+    for (int64_t sample : op_stats.replay_us) total += sample;
+    std::cout << std::left << std::setw(23) << Recorder::opName(op) << std::right
+              << std::setw(8) << calls
+              << std::setw(12) << op_stats.recorded_us / static_cast<int64_t>(calls) << "us"
+              << std::setw(10) << total / static_cast<int64_t>(calls) << "us"
+              << std::setw(8) << percentile(op_stats.replay_us, 0.50) << "us"
+              << std::setw(8) << percentile(op_stats.replay_us, 0.99) << "us"
+              << std::setw(13) << op_stats.allocations / calls
+              << std::setw(12) << op_stats.result_mismatches << "\n";
+  }
+  return 0;
+}
@@ -0,0 +1,43 @@
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "definitions.hh"
+#include "Pond.hh"
+
+/**
+ * @brief Rebuilds the hourly hashtag rollups of a Quacker database from its quacks.
+ *
+ * Usage: quacker-rollup <database>
+ *
+ * The rollups are maintained as quacks are posted and backfilled when a database is
+ * upgraded; this repairs them after quacks or hashtags were changed behind the
+ * triggers' back, e.g. deleted. Prints the time taken and the most mentioned hashtags.
+ */
+int main(int argc, char* argv[]) {
+  if (argc != 2) {
+    std::cerr << "Incorrect Usage: Expected quacker-rollup <database>" << std::endl;
+    return ERROR_USAGE;
+  } else if (!std::filesystem::exists(argv[1])) {
+    std::cerr << "File Not Found: Cannot find database " << argv[1] << std::endl;
+    return ERROR_FILE;
+  }
+
+  Pond pond;
+  if (pond.loadDatabase(argv[1])) {
+    return ERROR_FILE;
+  }
+  auto start = std::chrono::steady_clock::now();
+  if (!pond.backfillHashtagRollups()) {
+    return ERROR_SQL;
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << "Rebuilt hashtag rollups in " << std::fixed << std::setprecision(3) << seconds << " s\n";
+  for (const Trending::Trend& trend : pond.topHashtags(0, INT64_MAX, 10)) {
+    std::cout << "  " << std::setw(40) << std::left << trend.hashtag << trend.mentions << "\n";
+  }
+  return 0;
+}